@@ -9,10 +9,12 @@ if( ${_OPT}has_tests )
    enable_testing()
 
    #[[
-      add_unit_test(NAME name [MOCK_PREFS] [MOCK_AUDIO] SOURCES file1 ... LIBRARIES lib1 ...)
+      add_unit_test(NAME name [MOCK_PREFS] [MOCK_AUDIO] [MOCK_SAMPLE_BLOCKS] SOURCES file1 ... LIBRARIES lib1 ...)
 
       If MOCK_PREFS is specified, a test can instantiate a mocked Prefs object.
       If MOCK_AUDIO is specified, a test will initialize PortAudio.
+      If MOCK_SAMPLE_BLOCKS is specified, a test can make sample blocks in
+      memory with MockSampleBlockFactory.
 
       Audio mocking is a subject to change when Audio I/O is refactored.
 
@@ -24,7 +26,7 @@ if( ${_OPT}has_tests )
    function( add_unit_test )
       cmake_parse_arguments(
          ADD_UNIT_TEST # Prefix
-         "MOCK_PREFS;MOCK_AUDIO;WAV_FILE_IO" # Options
+         "MOCK_PREFS;MOCK_AUDIO;MOCK_SAMPLE_BLOCKS;WAV_FILE_IO" # Options
          "NAME" # One value keywords
          "SOURCES;LIBRARIES"
          ${ARGN}
@@ -53,6 +55,15 @@ if( ${_OPT}has_tests )
          target_sources( ${test_executable_name} PRIVATE "${CMAKE_SOURCE_DIR}/tests/MockedAudio.cpp" "${CMAKE_SOURCE_DIR}/tests/MockedAudio.h" )
       endif()
 
+      if (ADD_UNIT_TEST_MOCK_SAMPLE_BLOCKS)
+         target_sources( ${test_executable_name} PRIVATE
+            "${CMAKE_SOURCE_DIR}/tests/MockSampleBlock.cpp"
+            "${CMAKE_SOURCE_DIR}/tests/MockSampleBlock.h"
+            "${CMAKE_SOURCE_DIR}/tests/MockSampleBlockFactory.h"
+         )
+         target_include_directories( ${test_executable_name} PRIVATE "${CMAKE_SOURCE_DIR}/tests" )
+      endif()
+
       if (ADD_UNIT_TEST_WAV_FILE_IO)
          target_sources( ${test_executable_name} PRIVATE
             "${CMAKE_SOURCE_DIR}/tests/AudioFileInfo.h"
@@ -19,6 +19,7 @@ Paul Licameli split from AudioIO.cpp
 
 #include "IteratorX.h"
 #include "Meter.h"
+#include "MeterThread.h"
 #include "Prefs.h"
 
 #include "portaudio.h"
@@ -96,7 +97,10 @@ AudioIOBase *AudioIOBase::Get()
    return ugAudioIO.get();
 }
 
-AudioIOBase::AudioIOBase() = default;
+AudioIOBase::AudioIOBase()
+   : mMeterThread{ std::make_unique<MeterThread>() }
+{
+}
 
 AudioIOBase::~AudioIOBase() = default;
 
@@ -310,6 +314,7 @@ void AudioIOBase::SetCaptureMeter(
    }
    else
       mInputMeter.reset();
+   PublishMeters();
 }
 
 void AudioIOBase::SetPlaybackMeter(
@@ -327,6 +332,23 @@ void AudioIOBase::SetPlaybackMeter(
    }
    else
       mOutputMeter.reset();
+   PublishMeters();
+}
+
+void AudioIOBase::AddCaptureMeterConsumer(const std::weak_ptr<Meter> &meter)
+{
+   mMeterThread->AddMeter(MeterThread::Capture, meter);
+}
+
+void AudioIOBase::AddPlaybackMeterConsumer(const std::weak_ptr<Meter> &meter)
+{
+   mMeterThread->AddMeter(MeterThread::Playback, meter);
+}
+
+void AudioIOBase::PublishMeters()
+{
+   mMeterThread->SetMeter(MeterThread::Capture, mInputMeter);
+   mMeterThread->SetMeter(MeterThread::Playback, mOutputMeter);
 }
 
 bool AudioIOBase::IsPaused() const
@@ -33,6 +33,7 @@ class AudacityProject;
 class AudioIOListener;
 class BoundedEnvelope;
 class Meter;
+class MeterThread;
 using PRCrossfadeData = std::vector< std::vector < float > >;
 
 #define BAD_STREAM_TIME (-DBL_MAX)
@@ -114,6 +115,13 @@ public:
    void SetPlaybackMeter(
       const std::shared_ptr<AudacityProject> &project, const std::weak_ptr<Meter> &meter);
 
+   //! Add a meter, such as a loudness meter, that receives every block of
+   //! recorded samples with its statistics, besides the capture meter
+   void AddCaptureMeterConsumer(const std::weak_ptr<Meter> &meter);
+   //! Add a meter that receives every block of played samples with its
+   //! statistics, besides the playback meter
+   void AddPlaybackMeterConsumer(const std::weak_ptr<Meter> &meter);
+
    /** \brief update state after changing what audio devices are selected
     *
     * Called when the devices stored in the preferences are changed to update
@@ -258,6 +266,12 @@ protected:
 
    std::weak_ptr<Meter> mInputMeter{};
    std::weak_ptr<Meter> mOutputMeter{};
+   //! Analyses samples for the meters, off the audio thread
+   const std::unique_ptr<MeterThread> mMeterThread;
+
+   //! Pass mInputMeter and mOutputMeter to mMeterThread after changing them
+   /*! Called on the main thread */
+   void PublishMeters();
 
    #if USE_PORTMIXER
    PxMixer            *mPortMixer;
@@ -13,3 +13,9 @@ Paul Licameli split from MeterPanelBase.cpp
 Meter::~Meter()
 {
 }
+
+void Meter::UpdateDisplay(unsigned numChannels,
+   unsigned long numFrames, const float *sampleData, const MeterStats *)
+{
+   UpdateDisplay(numChannels, numFrames, sampleData);
+}
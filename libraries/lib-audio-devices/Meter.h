@@ -11,6 +11,8 @@ Paul Licameli split from MeterPanelBase.h
 #ifndef __AUDACITY_METER__
 #define __AUDACITY_METER__
 
+struct MeterStats;
+
 //! AudioIO uses this to send sample buffers for real-time display updates
 class AUDIO_DEVICES_API Meter /* not final */
 {
@@ -21,6 +23,11 @@ public:
    virtual void Reset(double sampleRate, bool resetClipping) = 0;
    virtual void UpdateDisplay(unsigned numChannels,
                       unsigned long numFrames, const float *sampleData) = 0;
+   //! Called by MeterThread, with the statistics of each of the channels
+   /*! The default ignores the statistics and calls the other overload */
+   virtual void UpdateDisplay(unsigned numChannels,
+      unsigned long numFrames, const float *sampleData,
+      const MeterStats *stats);
    virtual bool IsMeterDisabled() const = 0;
    virtual float GetMaxPeak() const = 0;
    virtual bool IsClipping() const = 0;
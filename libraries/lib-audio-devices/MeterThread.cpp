@@ -0,0 +1,225 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MeterThread.cpp
+
+**********************************************************************/
+#include "MeterThread.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "Meter.h"
+#include "MemoryX.h"
+
+namespace {
+//! Capacity of one slot of the queue, in samples of all channels
+constexpr size_t SlotSamples = 4096;
+//! Enough for about a second of stereo at 44100 Hz, if the consumer stalls
+constexpr size_t NSlots = 64;
+
+//! How often the consumer looks for blocks, while a stream is open and
+//! meters are set
+/*! The callback must not notify a condition variable, which may lock */
+constexpr auto PollInterval = std::chrono::milliseconds(5);
+}
+
+//! Single-producer, single-consumer queue of blocks of samples
+class MeterThread::BlockQueue final
+{
+public:
+   struct Header {
+      unsigned nChannels;
+      size_t nFrames;
+   };
+
+   BlockQueue()
+      : mSamples(NSlots * SlotSamples)
+      , mHeaders(NSlots)
+   {}
+
+   //! Producer only; splits the block among slots as needed
+   void Put(const float *samples, unsigned nChannels, size_t nFrames) noexcept
+   {
+      if (nChannels == 0 || nChannels > SlotSamples)
+         return;
+      const auto framesPerSlot = SlotSamples / nChannels;
+      auto write = mWrite.load(std::memory_order_relaxed);
+      const auto read = mRead.load(std::memory_order_acquire);
+      while (nFrames > 0 && write - read < NSlots) {
+         const auto index = write % NSlots;
+         const auto frames = std::min(nFrames, framesPerSlot);
+         std::memcpy(&mSamples[index * SlotSamples], samples,
+            frames * nChannels * sizeof(float));
+         mHeaders[index] = { nChannels, frames };
+         mWrite.store(++write, std::memory_order_release);
+         samples += frames * nChannels;
+         nFrames -= frames;
+      }
+      // Anything left is dropped
+   }
+
+   //! Consumer only; @return null if empty
+   const Header *Front(const float *&samples) const noexcept
+   {
+      const auto read = mRead.load(std::memory_order_relaxed);
+      if (read == mWrite.load(std::memory_order_acquire))
+         return nullptr;
+      const auto index = read % NSlots;
+      samples = &mSamples[index * SlotSamples];
+      return &mHeaders[index];
+   }
+
+   //! Consumer only; releases the slot of Front() to the producer
+   void Pop() noexcept
+   {
+      mRead.fetch_add(1, std::memory_order_release);
+   }
+
+private:
+   std::vector<float> mSamples;
+   std::vector<Header> mHeaders;
+   //! Counts of slots ever written and read
+   std::atomic<size_t> mWrite{ 0 };
+   std::atomic<size_t> mRead{ 0 };
+};
+
+MeterThread::MeterThread() = default;
+
+MeterThread::~MeterThread()
+{
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mStopping = true;
+   }
+   mCondition.notify_all();
+   if (mThread.joinable())
+      mThread.join();
+}
+
+void MeterThread::SetMeter(
+   Direction direction, const std::weak_ptr<Meter> &meter)
+{
+   if (meter.expired() && !mThread.joinable())
+      return;
+   Start();
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mMeters[direction] = meter;
+      UpdateActive(direction);
+   }
+   mCondition.notify_all();
+}
+
+void MeterThread::AddMeter(
+   Direction direction, const std::weak_ptr<Meter> &meter)
+{
+   Start();
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mExtraMeters[direction].push_back(meter);
+      UpdateActive(direction);
+   }
+   mCondition.notify_all();
+}
+
+void MeterThread::SetStreaming(bool streaming)
+{
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mStreaming = streaming;
+      for (unsigned direction = 0; direction < nDirections; ++direction)
+         UpdateActive(static_cast<Direction>(direction));
+   }
+   mCondition.notify_all();
+}
+
+void MeterThread::Put(Direction direction, const float *samples,
+   unsigned nChannels, unsigned long nFrames) noexcept
+{
+   if (mActive[direction].load(std::memory_order_acquire))
+      mQueues[direction]->Put(samples, nChannels, nFrames);
+}
+
+void MeterThread::UpdateActive(Direction direction)
+{
+   auto &extras = mExtraMeters[direction];
+   extras.erase(std::remove_if(extras.begin(), extras.end(),
+      [](const auto &pMeter){ return pMeter.expired(); }), extras.end());
+   mActive[direction].store(
+      mStreaming && (!mMeters[direction].expired() || !extras.empty()),
+      std::memory_order_release);
+}
+
+void MeterThread::Start()
+{
+   // Allocate before the callback can see that meters are set
+   if (mThread.joinable())
+      return;
+   for (auto &pQueue : mQueues)
+      pQueue = std::make_unique<BlockQueue>();
+   mThread = std::thread{ [this]{ Run(); } };
+}
+
+void MeterThread::Run()
+{
+   while (true) {
+      bool any = false;
+      for (unsigned direction = 0; direction < nDirections; ++direction) {
+         auto &queue = *mQueues[direction];
+         const float *samples;
+         while (const auto pHeader = queue.Front(samples)) {
+            Dispatch(static_cast<Direction>(direction),
+               samples, pHeader->nChannels, pHeader->nFrames);
+            queue.Pop();
+            any = true;
+         }
+      }
+      if (any)
+         continue;
+
+      std::unique_lock<std::mutex> lock{ mMutex };
+      if (mStopping)
+         return;
+      const auto active = [this]{
+         return std::any_of(std::begin(mActive), std::end(mActive),
+            [](const auto &flag){ return flag.load(); });
+      };
+      if (active())
+         mCondition.wait_for(lock, PollInterval);
+      else
+         mCondition.wait(lock, [&]{ return mStopping || active(); });
+   }
+}
+
+void MeterThread::Dispatch(Direction direction,
+   const float *samples, unsigned nChannels, size_t nFrames)
+{
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      if (auto pMeter = mMeters[direction].lock())
+         mLocked.push_back(move(pMeter));
+      for (const auto &wMeter : mExtraMeters[direction])
+         if (auto pMeter = wMeter.lock())
+            mLocked.push_back(move(pMeter));
+      UpdateActive(direction);
+   }
+
+   // Analyse once, for all meters that want it
+   bool analysed = false;
+   for (const auto &pMeter : mLocked) {
+      if (pMeter->IsMeterDisabled())
+         continue;
+      if (!analysed) {
+         mStats.resize(nChannels);
+         ComputeMeterStats(samples, nChannels, nFrames,
+            nChannels, mStats.data(), MAX_AUDIO);
+         analysed = true;
+      }
+      pMeter->UpdateDisplay(nChannels, nFrames, samples, mStats.data());
+   }
+   mLocked.clear();
+}
@@ -0,0 +1,97 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MeterThread.h
+
+  @brief Analyses the samples of the audio callback for meters, on a thread
+  of its own
+
+**********************************************************************/
+#ifndef __AUDACITY_METER_THREAD__
+#define __AUDACITY_METER_THREAD__
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "MeterStats.h"
+
+class Meter;
+
+//! Receives blocks of samples from the audio callback, computes their
+//! statistics once, and passes both to any number of meters
+/*!
+ The callback only copies the samples into a preallocated queue with a single
+ producer and a single consumer; it neither waits, nor allocates, nor touches
+ the meters.  If the queue is full, the block is dropped.
+
+ Meters are called on the thread of this object, as they were on the thread
+ of the callback before.
+ */
+class AUDIO_DEVICES_API MeterThread final
+{
+public:
+   enum Direction : unsigned {
+      Capture,
+      Playback,
+      nDirections
+   };
+
+   MeterThread();
+   ~MeterThread();
+
+   MeterThread(const MeterThread &) = delete;
+   MeterThread &operator=(const MeterThread &) = delete;
+
+   //! Replace the meter that AudioIOBase shows for one direction
+   /*! Called on the main thread */
+   void SetMeter(Direction direction, const std::weak_ptr<Meter> &meter);
+
+   //! Add a meter that receives the same blocks as the one set by SetMeter
+   /*! Called on the main thread.  It is removed when it expires. */
+   void AddMeter(Direction direction, const std::weak_ptr<Meter> &meter);
+
+   //! Tell whether an audio stream is open, so that blocks may come
+   /*! Called on the main thread, when the stream starts and after it stops.
+    While there is no stream, the thread of this object sleeps. */
+   void SetStreaming(bool streaming);
+
+   //! Queue a block of interleaved samples
+   /*! Called only on the thread of the audio callback; wait-free */
+   void Put(Direction direction, const float *samples,
+      unsigned nChannels, unsigned long nFrames) noexcept;
+
+private:
+   class BlockQueue;
+
+   //! Requires mMutex to be locked
+   void UpdateActive(Direction direction);
+   void Start();
+   void Run();
+   void Dispatch(Direction direction,
+      const float *samples, unsigned nChannels, size_t nFrames);
+
+   std::unique_ptr<BlockQueue> mQueues[nDirections];
+   //! Whether blocks are wanted; read by the callback
+   std::atomic<bool> mActive[nDirections]{};
+
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   std::weak_ptr<Meter> mMeters[nDirections];
+   std::vector<std::weak_ptr<Meter>> mExtraMeters[nDirections];
+   bool mStopping{ false };
+   bool mStreaming{ false };
+
+   //! Used only on the thread of this object
+   std::vector<std::shared_ptr<Meter>> mLocked;
+   std::vector<MeterStats> mStats;
+
+   std::thread mThread;
+};
+
+#endif
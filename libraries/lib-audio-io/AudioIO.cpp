@@ -101,9 +101,11 @@ time warp info and AudioIOListener and whether the playback is looped.
 
 #include "Channel.h"
 #include "Meter.h"
+#include "MeterThread.h"
 #include "Mix.h"
 #include "Resample.h"
 #include "RingBuffer.h"
+#include "WideRingBuffer.h"
 #include "Decibels.h"
 #include "Prefs.h"
 #include "Project.h"
@@ -114,6 +116,7 @@ time warp info and AudioIOListener and whether the playback is looped.
 #include "BasicUI.h"
 
 #include "Gain.h"
+#include "Telemetry.h"
 
 #ifdef EXPERIMENTAL_AUTOMATED_INPUT_LEVEL_ADJUSTMENT
    #define LOWER_BOUND 0.0
@@ -123,6 +126,19 @@ time warp info and AudioIOListener and whether the playback is looped.
 using std::max;
 using std::min;
 
+namespace {
+// Always recorded; see the "Audio Telemetry" scripting command
+Telemetry::Timer sCallbackTimer{ "AudioIO", "Callback" };
+Telemetry::Timer sExchangeTimer{ "AudioIO", "SequenceBufferExchange" };
+Telemetry::Timer sFillTimer{ "AudioIO", "FillPlayBuffers" };
+Telemetry::Timer sDrainTimer{ "AudioIO", "DrainRecordBuffers" };
+Telemetry::Gauge sPlaybackReady{ "AudioIO", "Playback frames ready" };
+Telemetry::Gauge sCaptureFree{ "AudioIO", "Capture frames free" };
+Telemetry::Counter sInputXruns{ "AudioIO", "Input xruns" };
+Telemetry::Counter sOutputXruns{ "AudioIO", "Output xruns" };
+Telemetry::Counter sLostSamples{ "AudioIO", "Lost capture frames" };
+}
+
 AudioIO *AudioIO::Get()
 {
    return static_cast< AudioIO* >( AudioIOBase::Get() );
@@ -163,6 +179,12 @@ double AudioIoCallback::mCachedBestRateOut;
 bool AudioIoCallback::mCachedBestRatePlaying;
 bool AudioIoCallback::mCachedBestRateCapturing;
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#endif
+
 #ifdef __WXGTK__
    // Might #define this for a useful thing on Linux
    #undef REALTIME_ALSA_THREAD
@@ -748,7 +770,11 @@ bool AudioIO::StartPortAudioStream(const AudioIOStartStreamOptions &options,
    }
 #endif
 
-   return (success = (mLastPaError == paNoError));
+   success = (mLastPaError == paNoError);
+   if (success)
+      // Wake the meters before the callback can run
+      mMeterThread->SetStreaming(true);
+   return success;
 }
 
 wxString AudioIO::LastPaErrorString()
@@ -927,7 +953,7 @@ int AudioIO::StartStream(const TransportSequences &sequences,
    mScratchBuffers.clear();
    mScratchPointers.clear();
    mPlaybackMixers.clear();
-   mCaptureBuffers.clear();
+   mCaptureBuffer.reset();
    mResample.clear();
    mPlaybackSchedule.mTimeQueue.Clear();
 
@@ -999,6 +1025,9 @@ int AudioIO::StartStream(const TransportSequences &sequences,
       return 0;
    }
 
+   mAdaptiveBuffering = AudioIOAdaptiveBuffering.Read();
+   SetAudioThreadRealtime(mAdaptiveBuffering);
+
    {
       double mixerStart = t0;
       if (pStartTime)
@@ -1212,6 +1241,10 @@ bool AudioIO::AllocateBuffers(
       bDone = true; // assume success
       try
       {
+         // Forget the adaptation to any previous stream; recording alone
+         // needs only the rate, and playback sets the queue limits below
+         mPacer.Reset(0, 0, 0, mRate);
+
          if( mNumPlaybackChannels > 0 ) {
             // Allocate output buffers.
             // Allow at least 2x of the buffer latency.
@@ -1264,6 +1297,18 @@ bool AudioIO::AllocateBuffers(
             mPlaybackQueueMinimum = mPlaybackSamplesToCopy *
                ((mPlaybackQueueMinimum + mPlaybackSamplesToCopy - 1) / mPlaybackSamplesToCopy);
 
+            // Adaptation may raise the minimum, leaving room for one batch
+            const auto maxQueueMinimum = playbackBufferSize -
+               std::min(playbackBufferSize, mPlaybackSamplesToCopy);
+            mPacer.Reset(mPlaybackQueueMinimum, maxQueueMinimum,
+               mPlaybackSamplesToCopy, mRate);
+
+            // The mixers must produce as much at once as FillPlayBuffers may
+            // ask, which grows with the adapted minimum
+            const auto mixerBufferSize = std::max({ mPlaybackSamplesToCopy,
+               mPlaybackQueueMinimum,
+               mAdaptiveBuffering ? maxQueueMinimum : size_t{ 0 } });
+
             if (mPlaybackSequences.empty())
                // Make at least one playback buffer
                mPlaybackBuffers[0] =
@@ -1311,7 +1356,7 @@ bool AudioIO::AllocateBuffers(
                   // Don't throw for read errors, just play silence:
                   false,
                   warpOptions, startTime, endTime, pSequence->NChannels(),
-                  std::max( mPlaybackSamplesToCopy, mPlaybackQueueMinimum ),
+                  mixerBufferSize,
                   false, // not interleaved
                   mRate, floatSample,
                   false, // low quality dithering and resampling
@@ -1341,15 +1386,14 @@ bool AudioIO::AllocateBuffers(
                return false;
             }
 
-            mCaptureBuffers.resize(0);
-            mCaptureBuffers.resize(mNumCaptureChannels);
+            mCaptureBuffer.reset();
+            mCaptureBuffer = std::make_unique<WideRingBuffer>(
+               mCaptureFormat, mNumCaptureChannels, captureBufferSize);
             mResample.resize(0);
             mResample.resize(mNumCaptureChannels);
             mFactor = sampleRate / mRate;
 
             for (unsigned int i = 0; i < mNumCaptureChannels; ++i) {
-               mCaptureBuffers[i] = std::make_unique<RingBuffer>(
-                  mCaptureFormat, captureBufferSize);
                mResample[i] =
                   std::make_unique<Resample>(true, mFactor, mFactor);
                   // constant rate resampling
@@ -1391,7 +1435,7 @@ void AudioIO::StartStreamCleanup(bool bOnlyBuffers)
    mScratchBuffers.clear();
    mScratchPointers.clear();
    mPlaybackMixers.clear();
-   mCaptureBuffers.clear();
+   mCaptureBuffer.reset();
    mResample.clear();
    mPlaybackSchedule.mTimeQueue.Clear();
 
@@ -1401,6 +1445,7 @@ void AudioIO::StartStreamCleanup(bool bOnlyBuffers)
       Pa_CloseStream( mPortStreamV19 );
       mPortStreamV19 = NULL;
       mStreamToken = 0;
+      mMeterThread->SetStreaming(false);
    }
 
    mPlaybackSchedule.GetPolicy().Finalize( mPlaybackSchedule );
@@ -1418,6 +1463,7 @@ void AudioIO::SetMeters()
       pInputMeter->Reset(mRate, true);
    if (auto pOutputMeter = mOutputMeter.lock())
       pOutputMeter->Reset(mRate, true);
+   PublishMeters();
 }
 
 void AudioIO::StopStream()
@@ -1518,6 +1564,7 @@ void AudioIO::StopStream()
 
       mPortStreamV19 = NULL;
    }
+   mMeterThread->SetStreaming(false);
 
 
 
@@ -1562,7 +1609,7 @@ void AudioIO::StopStream()
       // Offset all recorded sequences to account for latency
       //
       if (mCaptureSequences.size() > 0) {
-         mCaptureBuffers.clear();
+         mCaptureBuffer.reset();
          mResample.clear();
 
          //
@@ -1627,6 +1674,7 @@ void AudioIO::StopStream()
 
    mInputMeter.reset();
    mOutputMeter.reset();
+   PublishMeters();
 
    if (pListener && mNumCaptureChannels > 0)
       pListener->OnAudioIOStopRecording();
@@ -1807,9 +1855,11 @@ void AudioIO::AudioThread(std::atomic<bool> &finish)
       // Set LoopActive outside the tests to avoid race condition
       gAudioIO->mAudioThreadSequenceBufferExchangeLoopActive
          .store(true, std::memory_order_relaxed);
+      auto wake = loopPassStart + interval;
       if( gAudioIO->mAudioThreadShouldCallSequenceBufferExchangeOnce
          .load(std::memory_order_acquire) )
       {
+         Telemetry::SetThreadName("Audio thread");
          gAudioIO->SequenceBufferExchange();
          gAudioIO->mAudioThreadShouldCallSequenceBufferExchangeOnce
             .store(false, std::memory_order_release);
@@ -1833,7 +1883,8 @@ void AudioIO::AudioThread(std::atomic<bool> &finish)
          // This is unlike the case with mAudioThreadShouldCallSequenceBufferExchangeOnce where the
          // store really means that the one-time exchange was done.
 
-         gAudioIO->SequenceBufferExchange();
+         Telemetry::SetThreadName("Audio thread");
+         wake = gAudioIO->PacedSequenceBufferExchange(loopPassStart, interval);
       }
       else
       {
@@ -1856,7 +1907,7 @@ void AudioIO::AudioThread(std::atomic<bool> &finish)
       gAudioIO->mAudioThreadSequenceBufferExchangeLoopActive
          .store(false, std::memory_order_relaxed);
 
-      std::this_thread::sleep_until( loopPassStart + interval );
+      std::this_thread::sleep_until( wake );
    }
 }
 
@@ -1889,7 +1940,7 @@ size_t AudioIoCallback::GetCommonlyWrittenForPlayback()
 
 size_t AudioIO::GetCommonlyAvailCapture()
 {
-   return MinValue(mCaptureBuffers, &RingBuffer::AvailForGet);
+   return mCaptureBuffer->AvailForGet();
 }
 
 // This method is the data gateway between the audio thread (which
@@ -1897,12 +1948,74 @@ size_t AudioIO::GetCommonlyAvailCapture()
 // (which communicates with the audio device).
 void AudioIO::SequenceBufferExchange()
 {
+   Telemetry::Scope scope{ sExchangeTimer };
    FillPlayBuffers();
    DrainRecordBuffers();
 }
 
+std::chrono::steady_clock::time_point AudioIO::PacedSequenceBufferExchange(
+   std::chrono::steady_clock::time_point passStart,
+   std::chrono::milliseconds interval)
+{
+   using Clock = std::chrono::steady_clock;
+   if (!mAdaptiveBuffering) {
+      SequenceBufferExchange();
+      return passStart + interval;
+   }
+
+   const bool playing = !mPlaybackSequences.empty();
+   const bool recording = !mCaptureSequences.empty();
+   constexpr auto NoLimit = AudioThreadPacer::NoLimit;
+   AudioThreadPacer::Pass pass{ NoLimit, NoLimit, NoLimit };
+   if (playing)
+      pass.playbackReadyBefore = GetCommonlyReadyPlayback();
+   const auto start = Clock::now();
+   SequenceBufferExchange();
+   const auto end = Clock::now();
+   pass.cost = end - start;
+   if (playing)
+      pass.playbackReadyAfter = GetCommonlyReadyPlayback();
+   if (recording)
+      pass.captureFree = mCaptureBuffer->AvailForPut();
+
+   const auto sleep = std::chrono::duration_cast<Clock::duration>(
+      mPacer.Update(pass, interval));
+   mPlaybackQueueMinimum = mPacer.GetQueueMinimum();
+   // Always sleep a little, in case the thread is scheduled as realtime
+   return std::max(end + std::chrono::duration_cast<Clock::duration>(
+         AudioThreadPacer::MinInterval),
+      std::min(passStart + interval, end + sleep));
+}
+
+void AudioIO::SetAudioThreadRealtime(bool realtime)
+{
+#ifdef __linux__
+   if (realtime == mAudioThreadRealtime || !mAudioThread.joinable())
+      return;
+   int policy = SCHED_OTHER;
+   sched_param param{};
+   if (realtime) {
+      // Below the usual priorities of audio callback threads, and within the
+      // limit granted to the user, if any
+      constexpr int AudioThreadPriority = 10;
+      policy = SCHED_FIFO;
+      param.sched_priority = AudioThreadPriority;
+      rlimit limit{};
+      if (getrlimit(RLIMIT_RTPRIO, &limit) == 0 &&
+          limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur > 0)
+         param.sched_priority = std::min<int>(
+            param.sched_priority, limit.rlim_cur);
+   }
+   // Fails harmlessly, without privilege
+   if (pthread_setschedparam(mAudioThread.native_handle(), policy, &param)
+       == 0)
+      mAudioThreadRealtime = realtime;
+#endif
+}
+
 void AudioIO::FillPlayBuffers()
 {
+   Telemetry::Scope scope{ sFillTimer };
    std::optional<RealtimeEffects::ProcessingScope> pScope;
    if (mpTransportState && mpTransportState->mpRealtimeInitialization)
       pScope.emplace(
@@ -2117,6 +2230,7 @@ void AudioIO::TransformPlayBuffers(
 
 void AudioIO::DrainRecordBuffers()
 {
+   Telemetry::Scope scope{ sDrainTimer };
    if (mRecordingException || mCaptureSequences.empty())
       return;
 
@@ -2195,7 +2309,7 @@ void AudioIO::DrainRecordBuffers()
 
                   // The ring buffer might have grown concurrently -- don't discard more
                   // than the "avail" value noted above.
-                  discarded = mCaptureBuffers[i]->Discard(std::min(avail, size));
+                  discarded = std::min(avail, size);
 
                   if (discarded < size)
                      // We need to visit this again to complete the
@@ -2236,8 +2350,8 @@ void AudioIO::DrainRecordBuffers()
                else
                   format = mCaptureFormat;
                temp.Allocate(size, format);
-               const auto got =
-                  mCaptureBuffers[i]->Get(temp.ptr(), format, toGet);
+               const auto got = mCaptureBuffer->Get(
+                  i, temp.ptr(), format, discarded, toGet);
                // wxASSERT(got == toGet);
                // but we can't assert in this thread
                wxUnusedVar(got);
@@ -2250,8 +2364,8 @@ void AudioIO::DrainRecordBuffers()
                format = floatSample;
                SampleBuffer temp1(toGet, floatSample);
                temp.Allocate(size, format);
-               const auto got =
-                  mCaptureBuffers[i]->Get(temp1.ptr(), floatSample, toGet);
+               const auto got = mCaptureBuffer->Get(
+                  i, temp1.ptr(), floatSample, discarded, toGet);
                // wxASSERT(got == toGet);
                // but we can't assert in this thread
                wxUnusedVar(got);
@@ -2294,6 +2408,8 @@ void AudioIO::DrainRecordBuffers()
                narrowestSampleFormat
             ) || newBlocks;
          } // end loop over capture channels
+         // Release the frames of all channels at once
+         mCaptureBuffer->Consume(avail);
 
          // Now update the recording schedule position
          mRecordingSchedule.mPosition += avail / mRate;
@@ -2801,8 +2917,7 @@ void AudioIoCallback::UpdateTimePosition(unsigned long framesPerBuffer)
 void AudioIoCallback::DrainInputBuffers(
    constSamplePtr inputBuffer,
    unsigned long framesPerBuffer,
-   const PaStreamCallbackFlags statusFlags,
-   float * tempFloats
+   const PaStreamCallbackFlags statusFlags
 )
 {
    const auto numPlaybackChannels = mNumPlaybackChannels;
@@ -2832,9 +2947,8 @@ void AudioIoCallback::DrainInputBuffers(
    // So we have not decided to enable this extra detection yet in
    // production
 
-   size_t len = framesPerBuffer;
-   for(unsigned t = 0; t < numCaptureChannels; t++)
-      len = std::min( len, mCaptureBuffers[t]->AvailForPut() );
+   size_t len = std::min<size_t>(
+      framesPerBuffer, mCaptureBuffer->AvailForPut());
 
    if (mSimulateRecordingErrors && 100LL * rand() < RAND_MAX)
       // Make spurious errors for purposes of testing the error
@@ -2867,59 +2981,20 @@ void AudioIoCallback::DrainInputBuffers(
    if (len < framesPerBuffer)
    {
       mLostSamples += (framesPerBuffer - len);
+      sLostSamples.Add(framesPerBuffer - len);
       wxPrintf(wxT("lost %d samples\n"), (int)(framesPerBuffer - len));
    }
 
    if (len <= 0)
       return;
 
-   // We have an ASSERT in the AudioIO constructor to alert us to
-   // possible issues with the (short*) cast.  We'd have a problem if
-   // sizeof(short) > sizeof(float) since our buffers are sized for floats.
-   for(unsigned t = 0; t < numCaptureChannels; t++) {
-
-      // dmazzoni:
-      // Un-interleave.  Ugly special-case code required because the
-      // capture channels could be in three different sample formats;
-      // it'd be nice to be able to call CopySamples, but it can't
-      // handle multiplying by the gain and then clipping.  Bummer.
-
-      switch(mCaptureFormat) {
-         case floatSample: {
-            auto inputFloats = (const float *)inputBuffer;
-            for(unsigned i = 0; i < len; i++)
-               tempFloats[i] =
-                  inputFloats[numCaptureChannels*i+t];
-         } break;
-         case int24Sample:
-            // We should never get here. Audacity's int24Sample format
-            // is different from PortAudio's sample format and so we
-            // make PortAudio return float samples when recording in
-            // 24-bit samples.
-            wxASSERT(false);
-            break;
-         case int16Sample: {
-            auto inputShorts = (const short *)inputBuffer;
-            short *tempShorts = (short *)tempFloats;
-            for( unsigned i = 0; i < len; i++) {
-               float tmp = inputShorts[numCaptureChannels*i+t];
-               tmp = std::clamp(tmp, -32768.0f, 32767.0f);
-               tempShorts[i] = (short)(tmp);
-            }
-         } break;
-      } // switch
-
-      // JKC: mCaptureFormat must be for samples with sizeof(float) or
-      // fewer bytes (because tempFloats is sized for floats).  All
-      // formats are 2 or 4 bytes, so we are OK.
-      const auto put =
-         mCaptureBuffers[t]->Put(
-            (samplePtr)tempFloats, mCaptureFormat, len);
-      // wxASSERT(put == len);
-      // but we can't assert in this thread
-      wxUnusedVar(put);
-      mCaptureBuffers[t]->Flush();
-   }
+   // De-interleave straight into the planes of the ring buffer, which has
+   // mCaptureFormat, then let the audio thread see all channels at once
+   const auto put = mCaptureBuffer->PutInterleaved(
+      inputBuffer, mCaptureFormat, numCaptureChannels, len);
+   // wxASSERT(put == len);
+   // but we can't assert in this thread
+   mCaptureBuffer->Commit(put);
 }
 
 
@@ -2991,20 +3066,14 @@ void AudioIoCallback::DoPlaythrough(
 }
 
 /* Send data to recording VU meter if applicable */
-// Also computes rms
 void AudioIoCallback::SendVuInputMeterData(
    const float *inputSamples,
    unsigned long framesPerBuffer
    )
 {
-   const auto numCaptureChannels = mNumCaptureChannels;
-   auto pInputMeter = mInputMeter.lock();
-   if ( !pInputMeter )
-      return;
-   if( pInputMeter->IsMeterDisabled())
-      return;
-   pInputMeter->UpdateDisplay(
-      numCaptureChannels, framesPerBuffer, inputSamples);
+   // Only a copy; the meter thread does the rest
+   mMeterThread->Put(MeterThread::Capture,
+      inputSamples, mNumCaptureChannels, framesPerBuffer);
 }
 
 /* Send data to playback VU meter if applicable */
@@ -3012,17 +3081,10 @@ void AudioIoCallback::SendVuOutputMeterData(
    const float *outputMeterFloats,
    unsigned long framesPerBuffer)
 {
-   const auto numPlaybackChannels = mNumPlaybackChannels;
-
-   auto pOutputMeter = mOutputMeter.lock();
-   if (!pOutputMeter)
-      return;
-   if( pOutputMeter->IsMeterDisabled() )
-      return;
    if( !outputMeterFloats)
       return;
-   pOutputMeter->UpdateDisplay(
-      numPlaybackChannels, framesPerBuffer, outputMeterFloats);
+   mMeterThread->Put(MeterThread::Playback,
+      outputMeterFloats, mNumPlaybackChannels, framesPerBuffer);
 
       //v Vaughan, 2011-02-25: Moved this update back to TrackPanel::OnTimer()
       //    as it helps with playback issues reported by Bill and noted on Bug 258.
@@ -3104,6 +3166,21 @@ int AudioIoCallback::AudioCallback(
    const PaStreamCallbackTimeInfo *timeInfo,
    const PaStreamCallbackFlags statusFlags, void * WXUNUSED(userData) )
 {
+   Telemetry::Scope scope{ sCallbackTimer };
+   Telemetry::SetThreadName("Audio callback");
+   if (statusFlags & (paInputOverflow | paInputUnderflow))
+      sInputXruns.Add();
+   if ((statusFlags & (paOutputUnderflow | paOutputOverflow))
+       && !(statusFlags & paPrimingOutput))
+      sOutputXruns.Add();
+   // Levels of the ring buffers, before this callback changes them
+   if (mStreamToken > 0) {
+      if (!mPlaybackBuffers.empty())
+         sPlaybackReady.Record(GetCommonlyReadyPlayback());
+      if (mCaptureBuffer)
+         sCaptureFree.Record(mCaptureBuffer->AvailForPut());
+   }
+
    // Poll sequences for change of state.
    // (User might click mute and solo buttons.)
    mbHasSoloSequences = CountSoloingSequences() > 0 ;
@@ -3201,8 +3278,7 @@ int AudioIoCallback::AudioCallback(
    DrainInputBuffers(
       inputBuffer,
       framesPerBuffer,
-      statusFlags,
-      tempFloats);
+      statusFlags);
 
    SendVuOutputMeterData( outputMeterFloats, framesPerBuffer);
 
@@ -3352,3 +3428,4 @@ bool AudioIO::IsCapturing() const
 }
 
 BoolSetting SoundActivatedRecord{ "/AudioIO/SoundActivatedRecord", false };
+BoolSetting AudioIOAdaptiveBuffering{ "/AudioIO/AdaptiveBuffering", false };
@@ -15,6 +15,7 @@
 
 #include "AudioIOBase.h" // to inherit
 #include "AudioIOSequences.h"
+#include "AudioThreadPacer.h" // member variable
 #include "PlaybackSchedule.h" // member variable
 
 #include <functional>
@@ -33,6 +34,7 @@ class wxArrayString;
 class AudioIOBase;
 class AudioIO;
 class RingBuffer;
+class WideRingBuffer;
 class Mixer;
 class OtherPlayableSequence;
 class RealtimeEffectState;
@@ -213,8 +215,7 @@ public:
    void DrainInputBuffers(
       constSamplePtr inputBuffer, 
       unsigned long framesPerBuffer,
-      const PaStreamCallbackFlags statusFlags,
-      float * tempFloats
+      const PaStreamCallbackFlags statusFlags
    );
    void UpdateTimePosition(
       unsigned long framesPerBuffer
@@ -269,7 +270,8 @@ public:
    std::vector<std::unique_ptr<Resample>> mResample;
 
    using RingBuffers = std::vector<std::unique_ptr<RingBuffer>>;
-   RingBuffers mCaptureBuffers;
+   //! All capture channels, committed and consumed together
+   std::unique_ptr<WideRingBuffer> mCaptureBuffer;
    RecordableSequences mCaptureSequences;
    /*! Read by worker threads but unchanging during playback */
    RingBuffers mPlaybackBuffers;
@@ -300,6 +302,11 @@ public:
    size_t              mHardwarePlaybackLatencyFrames {};
    /// Occupancy of the queue we try to maintain, with bigger batches if needed
    size_t              mPlaybackQueueMinimum;
+   /// Whether the audio thread adapts mPlaybackQueueMinimum and its sleep
+   /*! Read by a worker thread but unchanging during playback */
+   bool                mAdaptiveBuffering{ false };
+   /// Used only by the audio thread, after AllocateBuffers
+   AudioThreadPacer    mPacer;
 
    double              mMinCaptureSecsToCopy;
    /*! Read by a worker thread but unchanging during playback */
@@ -616,6 +623,17 @@ private:
     */
    void SequenceBufferExchange();
 
+   //! SequenceBufferExchange, and adaptation of the queue and the sleep to
+   //! the load, if enabled
+   /*! @return when the audio thread should wake next */
+   std::chrono::steady_clock::time_point PacedSequenceBufferExchange(
+      std::chrono::steady_clock::time_point passStart,
+      std::chrono::milliseconds interval);
+
+   //! Request or give up realtime scheduling of the audio thread, where the
+   //! system allows it
+   void SetAudioThreadRealtime(bool realtime);
+
    //! First part of SequenceBufferExchange
    void FillPlayBuffers();
    void TransformPlayBuffers(
@@ -661,8 +679,10 @@ private:
    PostRecordingAction mPostRecordingAction;
 
    bool mDelayingActions{ false };
+   bool mAudioThreadRealtime{ false };
 };
 
 AUDIO_IO_API extern BoolSetting SoundActivatedRecord;
+AUDIO_IO_API extern BoolSetting AudioIOAdaptiveBuffering;
 
 #endif
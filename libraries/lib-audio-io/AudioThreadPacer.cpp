@@ -0,0 +1,59 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AudioThreadPacer.cpp
+
+**********************************************************************/
+#include "AudioThreadPacer.h"
+
+#include <algorithm>
+
+void AudioThreadPacer::Reset(
+   size_t minimum, size_t maximum, size_t step, double rate)
+{
+   mBaseMinimum = minimum;
+   mMaximum = std::max(minimum, maximum);
+   mStep = std::max<size_t>(1, step);
+   mRate = rate > 0 ? rate : 1;
+   mQueueMinimum = minimum;
+   mCalm = 0;
+   mCost = {};
+}
+
+auto AudioThreadPacer::Update(const Pass &pass, Duration interval) -> Duration
+{
+   mCost = std::max(mCost * 0.99, pass.cost);
+
+   const auto lowWater = mQueueMinimum / 4;
+   if (pass.playbackReadyBefore != NoLimit) {
+      if (pass.playbackReadyBefore < lowWater) {
+         // The callback nearly ran dry:  prefetch more
+         mQueueMinimum = std::min(mMaximum, mQueueMinimum + mStep);
+         mCalm = 0;
+      }
+      else if (pass.playbackReadyBefore >= mQueueMinimum - lowWater) {
+         if (++mCalm >= CalmPasses && mQueueMinimum > mBaseMinimum) {
+            mQueueMinimum = std::max(mBaseMinimum,
+               mQueueMinimum - std::min(mQueueMinimum, mStep));
+            mCalm = 0;
+         }
+      }
+      else
+         mCalm = 0;
+   }
+
+   // Wake before the deadlines, with time for a pass as slow as recent ones
+   auto result = interval;
+   const auto margin = 2 * mCost;
+   if (pass.playbackReadyAfter != NoLimit) {
+      const auto slack = pass.playbackReadyAfter -
+         std::min(pass.playbackReadyAfter, mQueueMinimum / 4);
+      result = std::min(result, Duration{ slack / mRate } - margin);
+   }
+   if (pass.captureFree != NoLimit)
+      result = std::min(result,
+         Duration{ pass.captureFree / mRate / 2 } - margin);
+   return std::clamp(result, std::min(MinInterval, interval), interval);
+}
@@ -0,0 +1,84 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AudioThreadPacer.h
+
+  @brief Adapts the prefetch depth and wake-up times of the audio thread to
+  the load
+
+**********************************************************************/
+#ifndef __AUDACITY_AUDIO_THREAD_PACER__
+#define __AUDACITY_AUDIO_THREAD_PACER__
+
+#include <chrono>
+#include <cstddef>
+
+//! Chooses how many frames AudioIO keeps queued for playback, and when the
+//! audio thread wakes next, from what it observes in each pass
+/*!
+ The queue minimum grows by one batch whenever the audio thread wakes to find
+ less than a quarter of it left, which means the callback nearly ran dry.  It
+ shrinks back by one batch after a long enough calm, but never below the
+ minimum given to Reset(), which comes from the preferences.
+
+ The next wake-up is no later than the interval of the PlaybackPolicy, and is
+ earlier if the playback queue would otherwise drain to that quarter, or the
+ capture queue fill halfway, while the audio thread sleeps.  It allows for
+ the slowest recent pass.
+
+ Used only by the audio thread, except for Reset()
+ */
+class AUDIO_IO_API AudioThreadPacer final
+{
+public:
+   using Duration = std::chrono::duration<double>;
+
+   //! Shortest sleep between passes
+   static constexpr Duration MinInterval{ 0.001 };
+   //! Passes with ample slack before the queue minimum shrinks
+   static constexpr unsigned CalmPasses = 500;
+
+   //! Called before the audio thread processes a stream
+   /*!
+    @param minimum the queue minimum from the preferences
+    @param maximum the largest queue minimum allowed, to leave room in the
+    ring buffers
+    @param step frames added or removed at once
+    */
+   void Reset(size_t minimum, size_t maximum, size_t step, double rate);
+
+   //! Observations of one pass of the audio thread
+   struct Pass {
+      //! Frames queued for playback when the pass began, or `NoLimit` if not
+      //! playing
+      size_t playbackReadyBefore;
+      //! Frames queued for playback when the pass ended, or `NoLimit`
+      size_t playbackReadyAfter;
+      //! Room for captured frames when the pass ended, or `NoLimit` if not
+      //! recording
+      size_t captureFree;
+      //! How long the pass took
+      Duration cost;
+   };
+   static constexpr size_t NoLimit = ~size_t{};
+
+   //! @return how long to sleep after the pass, at most `interval`
+   Duration Update(const Pass &pass, Duration interval);
+
+   size_t GetQueueMinimum() const { return mQueueMinimum; }
+
+private:
+   size_t mBaseMinimum{};
+   size_t mMaximum{};
+   size_t mStep{ 1 };
+   double mRate{ 1 };
+
+   size_t mQueueMinimum{};
+   unsigned mCalm{};
+   //! Decays slowly, so that one slow pass counts for a while
+   Duration mCost{};
+};
+
+#endif
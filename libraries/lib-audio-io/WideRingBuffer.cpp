@@ -0,0 +1,182 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file WideRingBuffer.cpp
+
+**********************************************************************/
+#include "WideRingBuffer.h"
+#include "Dither.h"
+#include <algorithm>
+
+WideRingBuffer::WideRingBuffer(
+   sampleFormat format, size_t nChannels, size_t size)
+   : mNChannels{ nChannels }
+   , mBufferSize{ std::max<size_t>(size, 64) }
+   , mFormat{ format }
+   , mBuffer{ mNChannels * mBufferSize, mFormat }
+{
+}
+
+WideRingBuffer::~WideRingBuffer()
+{
+}
+
+// Calculations of free and filled space, given snapshots taken of the start
+// and end values; as in RingBuffer
+
+size_t WideRingBuffer::Filled(size_t start, size_t end) const
+{
+   return (end + mBufferSize - start) % mBufferSize;
+}
+
+size_t WideRingBuffer::Free(size_t start, size_t end) const
+{
+   return std::max<size_t>(mBufferSize - Filled( start, end ), 4) - 4;
+}
+
+samplePtr WideRingBuffer::Plane(size_t iChannel) const
+{
+   return mBuffer.ptr() + iChannel * mBufferSize * SAMPLE_SIZE(mFormat);
+}
+
+//
+// For the writer only:
+// Only the writer writes the end, so it can read it again relaxed
+// And it reads the start written by reader, with acquire order,
+// so that any reading done in Get() happens-before any reuse of the space.
+//
+
+size_t WideRingBuffer::AvailForPut() const
+{
+   auto start = mStart.load( std::memory_order_relaxed );
+   return Free( start, mEnd.load( std::memory_order_relaxed ) );
+}
+
+size_t WideRingBuffer::Put(size_t iChannel,
+   constSamplePtr buffer, sampleFormat format, size_t samples)
+{
+   if (iChannel >= mNChannels)
+      return 0;
+   auto start = mStart.load( std::memory_order_acquire );
+   auto pos = mEnd.load( std::memory_order_relaxed );
+   samples = std::min( samples, Free( start, pos ) );
+   const auto plane = Plane(iChannel);
+   const auto result = samples;
+   while (samples) {
+      auto block = std::min( samples, mBufferSize - pos );
+      CopySamples(buffer, format,
+         plane + pos * SAMPLE_SIZE(mFormat), mFormat,
+         block, DitherType::none);
+      buffer += block * SAMPLE_SIZE(format);
+      pos = (pos + block) % mBufferSize;
+      samples -= block;
+   }
+   return result;
+}
+
+size_t WideRingBuffer::PutInterleaved(constSamplePtr buffer,
+   sampleFormat format, size_t stride, size_t frames)
+{
+   auto start = mStart.load( std::memory_order_acquire );
+   auto pos = mEnd.load( std::memory_order_relaxed );
+   frames = std::min( frames, Free( start, pos ) );
+   const auto result = frames;
+   while (frames) {
+      auto block = std::min( frames, mBufferSize - pos );
+      // De-interleave straight into the planes
+      for (size_t iChannel = 0; iChannel < mNChannels; ++iChannel)
+         CopySamples(buffer + iChannel * SAMPLE_SIZE(format), format,
+            Plane(iChannel) + pos * SAMPLE_SIZE(mFormat), mFormat,
+            block, DitherType::none, stride, 1);
+      buffer += block * stride * SAMPLE_SIZE(format);
+      pos = (pos + block) % mBufferSize;
+      frames -= block;
+   }
+   return result;
+}
+
+size_t WideRingBuffer::Commit(size_t frames)
+{
+   auto start = mStart.load( std::memory_order_relaxed );
+   auto end = mEnd.load( std::memory_order_relaxed );
+   frames = std::min( frames, Free( start, end ) );
+   // Atomically update the end with release, so the nonatomic writes just
+   // done to the buffer, in all channels, don't get reordered after
+   mEnd.store( (end + frames) % mBufferSize, std::memory_order_release );
+   return frames;
+}
+
+//
+// For the reader only:
+// Only the reader writes the start, so it can read it again relaxed
+// But it reads the end written by the writer, who also sends sample data
+// with the changes of end; therefore that must be read with acquire order
+// if we do more than merely query the size or throw samples away
+//
+
+size_t WideRingBuffer::AvailForGet() const
+{
+   auto end = mEnd.load( std::memory_order_relaxed ); // get away with it here
+   auto start = mStart.load( std::memory_order_relaxed );
+   return Filled( start, end );
+}
+
+size_t WideRingBuffer::Get(size_t iChannel, samplePtr buffer,
+   sampleFormat format, size_t offset, size_t samples) const
+{
+   if (iChannel >= mNChannels)
+      return 0;
+   // Must match the writer's release with acquire for well defined reads of
+   // the buffer
+   auto end = mEnd.load( std::memory_order_acquire );
+   auto start = mStart.load( std::memory_order_relaxed );
+   const auto filled = Filled( start, end );
+   offset = std::min( offset, filled );
+   samples = std::min( samples, filled - offset );
+   const auto plane = Plane(iChannel);
+   const auto result = samples;
+   auto pos = (start + offset) % mBufferSize;
+   while (samples) {
+      auto block = std::min( samples, mBufferSize - pos );
+      CopySamples(plane + pos * SAMPLE_SIZE(mFormat), mFormat,
+         buffer, format,
+         block, DitherType::none);
+      buffer += block * SAMPLE_SIZE(format);
+      pos = (pos + block) % mBufferSize;
+      samples -= block;
+   }
+   return result;
+}
+
+std::pair<constSamplePtr, size_t>
+WideRingBuffer::GetBlock(size_t iChannel, unsigned iBlock) const
+{
+   if (iChannel >= mNChannels)
+      return { nullptr, 0 };
+   auto end = mEnd.load( std::memory_order_acquire );
+   auto start = mStart.load( std::memory_order_relaxed );
+   const auto size = Filled( start, end );
+   // How many in the first part:
+   const auto size0 = std::min( size, mBufferSize - start );
+   // How many wrap around the ring buffer:
+   const auto size1 = size - size0;
+   const auto plane = Plane(iChannel);
+   if (iBlock == 0)
+      return {
+         size0 ? plane + start * SAMPLE_SIZE(mFormat) : nullptr, size0 };
+   else
+      return { size1 ? plane : nullptr, size1 };
+}
+
+size_t WideRingBuffer::Consume(size_t frames)
+{
+   auto end = mEnd.load( std::memory_order_relaxed ); // get away with it here
+   auto start = mStart.load( std::memory_order_relaxed );
+   frames = std::min( frames, Filled( start, end ) );
+   // Communicate to writer that we have consumed some data, in all channels,
+   // with nonrelaxed ordering
+   mStart.store( (start + frames) % mBufferSize, std::memory_order_release );
+   return frames;
+}
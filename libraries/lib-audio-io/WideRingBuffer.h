@@ -0,0 +1,91 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file WideRingBuffer.h
+
+  @brief A RingBuffer for all channels of a stream at once
+
+**********************************************************************/
+#ifndef __AUDACITY_WIDE_RING_BUFFER__
+#define __AUDACITY_WIDE_RING_BUFFER__
+
+#include "SampleFormat.h"
+#include <atomic>
+#include <utility>
+
+//! Lock-free queue of samples of several channels, for one writer and one
+//! reader, like RingBuffer
+/*!
+ All channels are held in one allocation, as contiguous planes of equal size,
+ and share one pair of indices.  The writer fills any channels and then
+ commits frames of all of them with one atomic store; the reader likewise
+ reads any channels and then consumes frames of all of them at once.
+ */
+class WideRingBuffer final : public NonInterferingBase {
+ public:
+   WideRingBuffer(sampleFormat format, size_t nChannels, size_t size);
+   ~WideRingBuffer();
+
+   size_t NChannels() const { return mNChannels; }
+
+   //
+   // For the writer only:
+   //
+
+   size_t AvailForPut() const;
+   //! Write to one channel, after what was committed, without committing
+   /*! Does not apply dithering
+    @return how many were written, limited by AvailForPut()
+    */
+   size_t Put(size_t iChannel,
+      constSamplePtr buffer, sampleFormat format, size_t samples);
+   //! Write all channels from interleaved frames, without committing
+   /*! Does not apply dithering
+    @param stride samples per frame in buffer, at least NChannels()
+    @return how many frames were written, limited by AvailForPut()
+    */
+   size_t PutInterleaved(constSamplePtr buffer, sampleFormat format,
+      size_t stride, size_t frames);
+   //! Let the reader see frames of all channels, written by Put or
+   //! PutInterleaved
+   /*! @return how many were committed, limited by AvailForPut() */
+   size_t Commit(size_t frames);
+
+   //
+   // For the reader only:
+   //
+
+   size_t AvailForGet() const;
+   //! Copy from one channel, starting `offset` after the first available
+   //! sample, without consuming
+   /*! Does not apply dithering
+    @return how many were copied
+    */
+   size_t Get(size_t iChannel, samplePtr buffer, sampleFormat format,
+      size_t offset, size_t samples) const;
+   //! Read-only access to available samples of one channel, which are in at
+   //! most two blocks
+   std::pair<constSamplePtr, size_t>
+   GetBlock(size_t iChannel, unsigned iBlock) const;
+   //! Release frames of all channels to the writer
+   /*! @return how many were consumed, limited by AvailForGet() */
+   size_t Consume(size_t frames);
+
+ private:
+   size_t Filled(size_t start, size_t end) const;
+   size_t Free(size_t start, size_t end) const;
+   samplePtr Plane(size_t iChannel) const;
+
+   // Align the two atomics to avoid false sharing
+   NonInterfering< std::atomic<size_t> > mStart{ 0 }, mEnd{ 0 };
+
+   const size_t  mNChannels;
+   const size_t  mBufferSize;
+
+   const sampleFormat  mFormat;
+   const SampleBuffer  mBuffer;
+};
+
+#endif
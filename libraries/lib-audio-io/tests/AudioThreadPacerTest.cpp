@@ -0,0 +1,120 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  AudioThreadPacerTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "AudioThreadPacer.h"
+
+namespace {
+using Duration = AudioThreadPacer::Duration;
+constexpr auto NoLimit = AudioThreadPacer::NoLimit;
+constexpr double rate = 44100;
+constexpr size_t minimum = 1000, maximum = 4000, step = 500;
+constexpr Duration interval{ 0.1 };
+
+//! A pass that began and ended with the given frames queued for playback
+AudioThreadPacer::Pass Playing(size_t ready, Duration cost = {})
+{
+   return { ready, ready, NoLimit, cost };
+}
+}
+
+TEST_CASE("AudioThreadPacer grows the queue when the callback nearly ran dry")
+{
+   AudioThreadPacer pacer;
+   pacer.Reset(minimum, maximum, step, rate);
+   REQUIRE(pacer.GetQueueMinimum() == minimum);
+
+   // A quarter of the minimum is the low water mark
+   pacer.Update(Playing(minimum / 4), interval);
+   REQUIRE(pacer.GetQueueMinimum() == minimum);
+
+   pacer.Update(Playing(minimum / 4 - 1), interval);
+   REQUIRE(pacer.GetQueueMinimum() == minimum + step);
+
+   // But not beyond the maximum
+   for (int i = 0; i < 10; ++i)
+      pacer.Update(Playing(0), interval);
+   REQUIRE(pacer.GetQueueMinimum() == maximum);
+
+   // Not playing changes nothing
+   pacer.Update({ NoLimit, NoLimit, 0, {} }, interval);
+   REQUIRE(pacer.GetQueueMinimum() == maximum);
+}
+
+TEST_CASE("AudioThreadPacer shrinks the queue after a calm")
+{
+   AudioThreadPacer pacer;
+   pacer.Reset(minimum, maximum, step, rate);
+   pacer.Update(Playing(0), interval);
+   pacer.Update(Playing(0), interval);
+   REQUIRE(pacer.GetQueueMinimum() == minimum + 2 * step);
+
+   const auto full = [&]{ return Playing(pacer.GetQueueMinimum()); };
+   for (unsigned i = 1; i < AudioThreadPacer::CalmPasses; ++i)
+      pacer.Update(full(), interval);
+   REQUIRE(pacer.GetQueueMinimum() == minimum + 2 * step);
+
+   // A pass that is neither calm nor short starts the count again
+   pacer.Update(Playing(pacer.GetQueueMinimum() / 2), interval);
+   for (unsigned i = 1; i < AudioThreadPacer::CalmPasses; ++i)
+      pacer.Update(full(), interval);
+   REQUIRE(pacer.GetQueueMinimum() == minimum + 2 * step);
+
+   pacer.Update(full(), interval);
+   REQUIRE(pacer.GetQueueMinimum() == minimum + step);
+
+   // But not below the minimum from Reset()
+   for (unsigned i = 0; i < 3 * AudioThreadPacer::CalmPasses; ++i)
+      pacer.Update(full(), interval);
+   REQUIRE(pacer.GetQueueMinimum() == minimum);
+}
+
+TEST_CASE("AudioThreadPacer wakes before the queues reach their deadlines")
+{
+   AudioThreadPacer pacer;
+   pacer.Reset(minimum, maximum, step, rate);
+
+   // Plenty queued:  sleep the whole interval
+   REQUIRE(pacer.Update(Playing(rate), interval) == interval);
+
+   // Wake before the playback queue drains to the low water mark
+   const size_t tenMs = rate / 100;
+   REQUIRE(pacer.Update(Playing(minimum / 4 + tenMs), interval).count() ==
+      Approx(0.01));
+
+   // Wake before the capture queue fills halfway
+   REQUIRE(pacer.Update({ NoLimit, NoLimit, 2 * tenMs, {} }, interval)
+      .count() == Approx(0.01));
+
+   // But always sleep a little
+   REQUIRE(pacer.Update(Playing(0), interval) ==
+      AudioThreadPacer::MinInterval);
+
+   // And never longer than the interval of the policy
+   const Duration shortInterval{ 0.0005 };
+   REQUIRE(pacer.Update(Playing(0), shortInterval) == shortInterval);
+}
+
+TEST_CASE("AudioThreadPacer allows for slow passes until reset")
+{
+   AudioThreadPacer pacer;
+   pacer.Reset(minimum, maximum, step, rate);
+   const size_t tenMs = rate / 100;
+   const Duration cost{ 0.002 };
+
+   // Twice the cost of the slowest recent pass is the margin
+   pacer.Update(Playing(rate, cost), interval);
+   REQUIRE(pacer.Update(Playing(minimum / 4 + tenMs), interval).count() ==
+      Approx(0.01 - 2 * cost.count() * 0.99));
+
+   // Reset forgets it, and the rate of the previous stream
+   pacer.Reset(0, 0, 0, rate / 2);
+   REQUIRE(pacer.Update({ NoLimit, NoLimit, tenMs, {} }, interval).count() ==
+      Approx(0.01));
+}
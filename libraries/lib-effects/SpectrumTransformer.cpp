@@ -11,9 +11,26 @@ Edward Hui
 #include "SpectrumTransformer.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <thread>
+#include <pffft.h>
 #include "FFT.h"
 #include "WaveTrack.h"
 
+namespace {
+//! Most windows transformed in advance at once
+constexpr size_t MaxSpectra = 32;
+//! Least window size for the vectorized transforms
+constexpr size_t MinPffftSize = 32;
+//! Segments of ProcessConcurrently are not longer than this, if they need not
+//! be, to limit the memory holding their output
+constexpr size_t MaxSegmentSize = 1 << 20;
+}
+
 SpectrumTransformer::SpectrumTransformer( bool needsOutput,
    eWindowFunctions inWindowType,
    eWindowFunctions outWindowType,
@@ -25,8 +42,11 @@ SpectrumTransformer::SpectrumTransformer( bool needsOutput,
 , mStepSize{ mWindowSize / mStepsPerWindow }
 , mLeadingPadding{ leadingPadding }
 , mTrailingPadding{ trailingPadding }
-, hFFT{ GetFFT(mWindowSize) }
+, mSetup{ mWindowSize >= MinPffftSize
+   ? GetRealPffftSetup(mWindowSize) : nullptr }
+, hFFT{ mSetup ? nullptr : GetFFT(mWindowSize) }
 , mFFTBuffer( mWindowSize )
+, mWork( mWindowSize )
 , mInWaveBuffer( mWindowSize )
 , mOutOverlapBuffer( mWindowSize )
 , mNeedsOutput{ needsOutput }
@@ -82,6 +102,17 @@ SpectrumTransformer::SpectrumTransformer( bool needsOutput,
       wxASSERT(false);
    for (size_t ii = 0; ii < mWindowSize; ++ii)
       *pWindow++ /= denom;
+
+   if (mSetup) {
+      // The inverse transform of pffft is not normalized; do that in the
+      // output window
+      const float scale = 1.0f / mWindowSize;
+      if (mOutWindow.empty())
+         mOutWindow.resize(mWindowSize, scale);
+      else
+         for (auto &x : mOutWindow)
+            x *= scale;
+   }
 }
 
 auto SpectrumTransformer::NewWindow(size_t windowSize)
@@ -103,7 +134,17 @@ bool SpectrumTransformer::DoFinish()
 void
 TrackSpectrumTransformer::DoOutput(const float *outBuffer, size_t mStepSize)
 {
-   mOutputTrack->Append((constSamplePtr)outBuffer, floatSample, mStepSize);
+   if (mpSegmentOutput) {
+      // Discard output of the samples before and after the segment
+      const auto skip = limitSampleBufferSize(mStepSize, mSkip);
+      const auto keep = limitSampleBufferSize(mStepSize - skip, mKeep);
+      mpSegmentOutput->insert(mpSegmentOutput->end(),
+         outBuffer + skip, outBuffer + skip + keep);
+      mSkip -= skip;
+      mKeep -= keep;
+   }
+   else
+      mOutputTrack->Append((constSamplePtr)outBuffer, floatSample, mStepSize);
 }
 
 bool SpectrumTransformer::Start(size_t queueLength)
@@ -146,6 +187,7 @@ bool SpectrumTransformer::Start(size_t queueLength)
    }
 
    mInSampleCount = 0;
+   mNSpectra = mNextSpectrum = 0;
 
    return true;
 }
@@ -169,7 +211,7 @@ bool SpectrumTransformer::ProcessSamples( const WindowProcessor &processor,
       mInWavePos += avail;
 
       if (mInWavePos == mWindowSize) {
-         FillFirstWindow();
+         FillFirstWindow(buffer, len);
 
          // invoke derived method
          if ( (success = processor(*this)), success )
@@ -198,20 +240,53 @@ void SpectrumTransformer::ResizeQueue(size_t queueLength)
       mQueue[ii] = NewWindow(mWindowSize);
 }
 
-void SpectrumTransformer::FillFirstWindow()
+void SpectrumTransformer::TransformWindows(const float *buffer, size_t len)
 {
-   // Transform samples to frequency domain, windowed as needed
-   {
-      auto pFFTBuffer = mFFTBuffer.data(), pInWaveBuffer = mInWaveBuffer.data();
+   // Each further step of samples in the buffer completes another window
+   const auto nWindows =
+      buffer ? std::min(MaxSpectra, 1 + len / mStepSize) : 1;
+   mSpectra.resize(MaxSpectra * mWindowSize);
+   for (size_t jj = 0; jj < nWindows; ++jj) {
+      // Gather the window from the old and the new samples, windowed as needed
+      const auto offset = jj * mStepSize;
+      const auto nOld = offset < mWindowSize ? mWindowSize - offset : 0;
+      const auto pFFTBuffer = mFFTBuffer.data();
+      std::copy_n(mInWaveBuffer.data() + offset, nOld, pFFTBuffer);
+      if (nOld < mWindowSize)
+         std::copy_n(buffer + (offset + nOld - mWindowSize),
+            mWindowSize - nOld, pFFTBuffer + nOld);
       if (mInWindow.size() > 0) {
          auto pInWindow = mInWindow.data();
          for (size_t ii = 0; ii < mWindowSize; ++ii)
-            *pFFTBuffer++ = *pInWaveBuffer++ * *pInWindow++;
+            pFFTBuffer[ii] *= pInWindow[ii];
+      }
+
+      const auto pSpectrum = mSpectra.data() + jj * mWindowSize;
+      if (mSetup)
+         pffft_transform_ordered(mSetup,
+            pFFTBuffer, pSpectrum, mWork.data(), PFFFT_FORWARD);
+      else {
+         RealFFTf(pFFTBuffer, hFFT.get());
+         pSpectrum[0] = pFFTBuffer[0];
+         pSpectrum[1] = pFFTBuffer[1];
+         const auto last = mSpectrumSize - 1;
+         for (size_t ii = 1; ii < last; ++ii) {
+            const int kk = hFFT->BitReversed[ii];
+            pSpectrum[2 * ii] = pFFTBuffer[kk];
+            pSpectrum[2 * ii + 1] = pFFTBuffer[kk + 1];
+         }
       }
-      else
-         memmove(pFFTBuffer, pInWaveBuffer, mWindowSize * sizeof(float));
    }
-   RealFFTf(mFFTBuffer.data(), hFFT.get());
+   mNSpectra = nWindows;
+   mNextSpectrum = 0;
+}
+
+void SpectrumTransformer::FillFirstWindow(const float *buffer, size_t len)
+{
+   // Transform samples to frequency domain, if not done already
+   if (mNextSpectrum == mNSpectra)
+      TransformWindows(buffer, len);
+   const auto pSpectrum = mSpectra.data() + mNextSpectrum++ * mWindowSize;
 
    auto &record = Nth(0);
 
@@ -219,18 +294,16 @@ void SpectrumTransformer::FillFirstWindow()
    {
       float *pReal = &record.mRealFFTs[1];
       float *pImag = &record.mImagFFTs[1];
-      int *pBitReversed = &hFFT->BitReversed[1];
       const auto last = mSpectrumSize - 1;
       for (size_t ii = 1; ii < last; ++ii) {
-         const int kk = *pBitReversed++;
-         *pReal++ = mFFTBuffer[kk];
-         *pImag++ = mFFTBuffer[kk + 1];
+         *pReal++ = pSpectrum[2 * ii];
+         *pImag++ = pSpectrum[2 * ii + 1];
       }
       // DC and Fs/2 bins need to be handled specially
-      const float dc = mFFTBuffer[0];
+      const float dc = pSpectrum[0];
       record.mRealFFTs[0] = dc;
 
-      const float nyquist = mFFTBuffer[1];
+      const float nyquist = pSpectrum[1];
       record.mImagFFTs[0] = nyquist; // For Fs/2, not really imaginary
    }
 }
@@ -297,27 +370,28 @@ void SpectrumTransformer::OutputStep()
       mFFTBuffer[1] = record.mImagFFTs[0];
 
       // Invert the FFT into the output buffer
-      InverseRealFFTf(mFFTBuffer.data(), hFFT.get());
+      const float *pResult;
+      if (mSetup) {
+         pffft_transform_ordered(mSetup, mFFTBuffer.data(), mFFTBuffer.data(),
+            mWork.data(), PFFFT_BACKWARD);
+         pResult = mFFTBuffer.data();
+      }
+      else {
+         InverseRealFFTf(mFFTBuffer.data(), hFFT.get());
+         ReorderToTime(hFFT.get(), mFFTBuffer.data(), mWork.data());
+         pResult = mWork.data();
+      }
 
       // Overlap-add
+      auto pOut = mOutOverlapBuffer.data();
       if (mOutWindow.size() > 0) {
-         auto pOut = mOutOverlapBuffer.data();
          auto pWindow = mOutWindow.data();
-         auto pBitReversed = &hFFT->BitReversed[0];
-         for (size_t jj = 0; jj < last; ++jj) {
-            auto kk = *pBitReversed++;
-            *pOut++ += mFFTBuffer[kk] * (*pWindow++);
-            *pOut++ += mFFTBuffer[kk + 1] * (*pWindow++);
-         }
+         for (size_t jj = 0; jj < mWindowSize; ++jj)
+            pOut[jj] += pResult[jj] * pWindow[jj];
       }
       else {
-         auto pOut = mOutOverlapBuffer.data();
-         auto pBitReversed = &hFFT->BitReversed[0];
-         for (size_t jj = 0; jj < last; ++jj) {
-            auto kk = *pBitReversed++;
-            *pOut++ += mFFTBuffer[kk];
-            *pOut++ += mFFTBuffer[kk + 1];
-         }
+         for (size_t jj = 0; jj < mWindowSize; ++jj)
+            pOut[jj] += pResult[jj];
       }
       auto buffer = mOutOverlapBuffer.data();
       if (mOutStepCount >= 0) {
@@ -341,6 +415,19 @@ bool SpectrumTransformer::QueueIsFull() const
 bool TrackSpectrumTransformer::Process(const WindowProcessor &processor,
    const WaveChannel &channel, size_t queueLength, sampleCount start,
    sampleCount len)
+{
+   const auto bLoopSuccess =
+      ProcessRange(processor, channel, queueLength, start, len);
+
+   if (!Finish(processor))
+      return false;
+
+   return bLoopSuccess;
+}
+
+bool TrackSpectrumTransformer::ProcessRange(const WindowProcessor &processor,
+   const WaveChannel &channel, size_t queueLength, sampleCount start,
+   sampleCount len)
 {
    mpChannel = &channel;
 
@@ -364,10 +451,132 @@ bool TrackSpectrumTransformer::Process(const WindowProcessor &processor,
       bLoopSuccess = ProcessSamples(processor, buffer.data(), blockSize);
    }
 
-   if (!Finish(processor))
+   return bLoopSuccess;
+}
+
+bool TrackSpectrumTransformer::ProcessSegment(
+   const WindowProcessor &processor, const WaveChannel &channel,
+   size_t queueLength, sampleCount start, sampleCount end,
+   sampleCount segmentStart, sampleCount segmentEnd,
+   size_t preRoll, size_t postRoll, FloatVector &output)
+{
+   const auto inputStart = std::max(start, segmentStart - preRoll);
+   const auto inputEnd = std::min(end, segmentEnd + postRoll);
+
+   // With leading padding, output begins at the first input sample
+   mSkip = segmentStart - inputStart;
+   mKeep = segmentEnd - segmentStart;
+   output.clear();
+   output.reserve(mKeep.as_size_t());
+   mpSegmentOutput = &output;
+
+   if (!ProcessRange(
+      processor, channel, queueLength, inputStart, inputEnd - inputStart))
       return false;
+   // Flush at the end of all input only; elsewhere the post-roll suffices to
+   // push the segment through the queue
+   const auto success = (inputEnd == end) ? Finish(processor) : DoFinish();
+   assert(!success || mKeep == 0);
+   return success;
+}
 
-   return bLoopSuccess;
+bool TrackSpectrumTransformer::ProcessConcurrently(const Factory &factory,
+   const WindowProcessor &processor,
+   const std::vector<const WaveChannel*> &channels,
+   const std::vector<WaveChannel*> &outputs,
+   size_t queueLength, sampleCount start, sampleCount len,
+   size_t warmUpSteps, const ProgressReport &progress, size_t nThreads)
+{
+   assert(channels.size() == outputs.size());
+   if (channels.empty())
+      return true;
+   if (nThreads == 0)
+      nThreads = std::max(1u, std::thread::hardware_concurrency());
+
+   // All transformers from the factory have the same settings
+   size_t stepSize, preRoll, postRoll;
+   {
+      const auto pTransformer = factory(*outputs[0]);
+      assert(pTransformer->NeedsOutput());
+      assert(pTransformer->mLeadingPadding);
+      assert(pTransformer->mTrailingPadding);
+      stepSize = pTransformer->mStepSize;
+      // Enough steps for a window to pass through the queue and out
+      const auto steps = queueLength + pTransformer->mStepsPerWindow;
+      preRoll = (steps + warmUpSteps) * stepSize;
+      postRoll = steps * stepSize;
+   }
+   // Whole steps, so that all segments see windows in the same places
+   const auto segmentSize = stepSize *
+      (std::max(MaxSegmentSize, 8 * (preRoll + postRoll)) / stepSize);
+
+   struct Segment {
+      size_t iChannel;
+      sampleCount start, end;
+   };
+   std::vector<Segment> segments;
+   for (size_t iChannel = 0; iChannel < channels.size(); ++iChannel)
+      for (auto segmentStart = start; segmentStart < start + len;
+         segmentStart += segmentSize)
+         segments.push_back({ iChannel, segmentStart,
+            std::min(start + len, segmentStart + segmentSize) });
+
+   std::atomic<bool> cancelled{ false };
+   const WindowProcessor cancellable = [&](SpectrumTransformer &transformer) {
+      return !cancelled.load(std::memory_order_relaxed) &&
+         processor(transformer);
+   };
+   const auto launch = [&](const Segment &segment) {
+      return std::async(std::launch::async,
+         [&, segment](std::unique_ptr<TrackSpectrumTransformer> pTransformer) {
+            FloatVector output;
+            if (!pTransformer->ProcessSegment(cancellable,
+               *channels[segment.iChannel], queueLength, start, start + len,
+               segment.start, segment.end, preRoll, postRoll, output))
+               cancelled = true;
+            return output;
+         },
+         // Made on this thread, but used only by the worker
+         factory(*outputs[segment.iChannel]));
+   };
+
+   // Keep a few more segments in progress than there are threads, so that
+   // the workers are busy while this thread writes output
+   const auto maxPending = 2 * nThreads;
+   std::deque<std::future<FloatVector>> pending;
+   size_t nLaunched = 0;
+   double done = 0;
+   const double total = len.as_double() * channels.size();
+   try {
+      for (const auto &segment : segments) {
+         while (nLaunched < segments.size() && pending.size() < maxPending)
+            pending.push_back(launch(segments[nLaunched++]));
+         auto future = std::move(pending.front());
+         pending.pop_front();
+         using namespace std::chrono_literals;
+         while (future.wait_for(50ms) != std::future_status::ready)
+            if (progress && !cancelled && !progress(done / total))
+               cancelled = true;
+         const auto output = future.get();
+         if (cancelled)
+            break;
+         outputs[segment.iChannel]->Append(
+            (constSamplePtr)output.data(), floatSample, output.size());
+         done += (segment.end - segment.start).as_double();
+         if (progress && !progress(done / total))
+            cancelled = true;
+      }
+   }
+   catch (...) {
+      // Stop the other workers; destruction of their futures waits for them
+      cancelled = true;
+      throw;
+   }
+   const bool success = !cancelled;
+   // If cancelled, this waits for the workers to stop
+   cancelled = true;
+   pending.clear();
+   return success;
 }
 
 bool TrackSpectrumTransformer::DoFinish()
@@ -12,10 +12,11 @@ Paul Licameli
 #ifndef __AUDACITY_SPECTRUM_TRANSFORMER__
 #define __AUDACITY_SPECTRUM_TRANSFORMER__
  
+#include <cassert>
 #include <functional>
 #include <memory>
 #include <vector>
-#include "audacity/Types.h"
+#include "PowerSpectrumGetter.h"
 #include "RealFFTf.h"
 #include "SampleCount.h"
 
@@ -31,8 +32,12 @@ class WaveChannel;
  @par The procedure that modifies coefficients can be varied, and can employ lookahead
  and -behind to nearby windows.  May also be used just to gather information
  without producing output.
+
+ @par When input comes in large buffers, windows are transformed several at a
+ time, ahead of their turn in the queue.  The procedure still sees them one at
+ a time and in order.
 */
-class SpectrumTransformer /* not final */
+class EFFECTS_API SpectrumTransformer /* not final */
 {
 public:
    // Public interface
@@ -147,7 +152,15 @@ public:
 
 private:
    void ResizeQueue(size_t queueLength);
-   void FillFirstWindow();
+   //! Transform the window just completed in mInWaveBuffer, and maybe more
+   //! that the rest of the input will complete
+   /*!
+    @param buffer the rest of the input, or null if flushing
+    @param len the number of samples in buffer
+    */
+   void TransformWindows(const float *buffer, size_t len);
+   //! Put the spectrum of the window just completed in the queue
+   void FillFirstWindow(const float *buffer, size_t len);
    void RotateWindows();
    void OutputStep();
 
@@ -164,26 +177,39 @@ protected:
 
 private:
    std::vector<std::unique_ptr<Window>> mQueue;
+   //! For vectorized transforms, or null if the window is too small for them
+   PFFFT_Setup *const mSetup;
+   //! Used only if mSetup is null
    HFFT     hFFT;
    sampleCount mInSampleCount = 0;
    sampleCount mOutStepCount = 0; //!< sometimes negative
    size_t mInWavePos = 0;
 
    //! These have size mWindowSize:
-   FloatVector mFFTBuffer;
+   PffftFloatVector mFFTBuffer;
+   PffftFloatVector mWork;
    FloatVector mInWaveBuffer;
    FloatVector mOutOverlapBuffer;
    //! These have size mWindowSize, or 0 for rectangular window:
    FloatVector mInWindow;
    FloatVector mOutWindow;
 
+   //! Spectra of windows transformed in advance, each of mWindowSize values:
+   //! the real parts of the DC and Fs/2 bins, then interleaved real and
+   //! imaginary parts of the other bins
+   PffftFloatVector mSpectra;
+   size_t mNSpectra = 0;
+   //! Index of the next of mSpectra to put in the queue
+   size_t mNextSpectrum = 0;
+
    const bool mNeedsOutput;
 };
 
 class WaveTrack;
 
 //! Subclass of SpectrumTransformer that rewrites a track
-class TrackSpectrumTransformer /* not final */ : public SpectrumTransformer {
+class EFFECTS_API TrackSpectrumTransformer /* not final */
+   : public SpectrumTransformer {
 public:
    /*!
     @copydoc SpectrumTransformer::SpectrumTransformer(bool,
@@ -207,6 +233,42 @@ public:
    bool Process(const WindowProcessor &processor, const WaveChannel &channel,
       size_t queueLength, sampleCount start, sampleCount len);
 
+   //! Makes a transformer for ProcessConcurrently(), with the same settings
+   //! each time, for one of the output channels
+   using Factory = std::function<
+      std::unique_ptr<TrackSpectrumTransformer>(WaveChannel &output)>;
+
+   //! Receives the fraction of work done; returns false to cancel
+   using ProgressReport = std::function<bool(double fraction)>;
+
+   //! Like Process() for each of several channels, appending to the
+   //! corresponding output channel; but each channel is divided into segments
+   //! that are transformed concurrently by transformers made by `factory`
+   /*!
+    Each segment is preceded by samples that are processed but not output, so
+    that the queue fills with the same windows as in a single pass, and the
+    processor then has `warmUpSteps` more windows in which to forget any
+    state made from the zero-padded windows at the start.  If the state of the
+    processor depends only on so many windows before, the result is the same
+    as that of Process().
+
+    The processor is called on worker threads; it must not use state shared
+    with other transformers.  `factory` and `progress` are called only on the
+    calling thread, which also does all writing to the output channels.
+
+    @pre the transformers need output and use leading and trailing padding
+    @pre `channels.size() == outputs.size()`
+    @param nThreads number of worker threads, or zero to use as many as there
+    are hardware threads
+    */
+   static bool ProcessConcurrently(const Factory &factory,
+      const WindowProcessor &processor,
+      const std::vector<const WaveChannel*> &channels,
+      const std::vector<WaveChannel*> &outputs,
+      size_t queueLength, sampleCount start, sampleCount len,
+      size_t warmUpSteps, const ProgressReport &progress,
+      size_t nThreads = 0);
+
    //! Final flush and trimming of tail samples
    static bool PostProcess(WaveTrack &outputTrack, sampleCount len);
 
@@ -216,8 +278,28 @@ protected:
    bool DoFinish() override;
 
 private:
+   //! Start(), then ProcessSamples() for samples read from the channel
+   bool ProcessRange(const WindowProcessor &processor,
+      const WaveChannel &channel, size_t queueLength,
+      sampleCount start, sampleCount len);
+
+   //! Transform part of the channel for ProcessConcurrently(), collecting
+   //! the output for [segmentStart, segmentEnd) in `output`
+   bool ProcessSegment(const WindowProcessor &processor,
+      const WaveChannel &channel, size_t queueLength,
+      sampleCount start, sampleCount end,
+      sampleCount segmentStart, sampleCount segmentEnd,
+      size_t preRoll, size_t postRoll, FloatVector &output);
+
    WaveChannel *const mOutputTrack;
    const WaveChannel *mpChannel = nullptr;
+
+   //! If not null, output goes here instead of to mOutputTrack
+   FloatVector *mpSegmentOutput = nullptr;
+   //! Count of output samples to discard before collecting
+   sampleCount mSkip = 0;
+   //! Count of output samples still to collect
+   sampleCount mKeep = 0;
 };
 
 #endif
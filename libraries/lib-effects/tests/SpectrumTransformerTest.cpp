@@ -0,0 +1,224 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SpectrumTransformerTest.cpp
+
+**********************************************************************/
+#include "SpectrumTransformer.h"
+#include "FFT.h"
+#include "MockSampleBlockFactory.h"
+#include "WaveTrack.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+constexpr auto sampleRate = 44100;
+constexpr size_t windowSize = 2048;
+constexpr unsigned stepsPerWindow = 4;
+constexpr size_t queueLength = 5;
+
+//! A band's gain falls to the floor in fewer steps than this after the band
+//! becomes quiet
+constexpr size_t warmUpSteps = 24;
+
+//! Attenuates quiet bands, like noise reduction: the gain of a band is one
+//! while the newest window is loud in it, and then decays to a floor; the
+//! gains apply to the last window of the queue
+struct Gate
+{
+   bool Process(SpectrumTransformer& transformer)
+   {
+      constexpr float threshold = 1.0f;
+      constexpr float release = 0.9f;
+      constexpr float floor = 0.1f;
+      const auto& newest = transformer.Newest();
+      const auto size = newest.mRealFFTs.size();
+      gains.resize(size, 1.0f);
+      for (size_t ii = 0; ii < size; ++ii)
+      {
+         const auto re = newest.mRealFFTs[ii];
+         const auto im = newest.mImagFFTs[ii];
+         gains[ii] = re * re + im * im >= threshold ?
+                        1.0f :
+                        std::max(floor, gains[ii] * release);
+      }
+      if (transformer.QueueIsFull())
+      {
+         auto& latest = transformer.Latest();
+         for (size_t ii = 0; ii < size; ++ii)
+         {
+            latest.mRealFFTs[ii] *= gains[ii];
+            latest.mImagFFTs[ii] *= gains[ii];
+         }
+      }
+      return true;
+   }
+
+   std::vector<float> gains;
+};
+
+struct Gated
+{
+   virtual ~Gated() = default;
+   Gate gate;
+};
+
+bool GateProcessor(SpectrumTransformer& transformer)
+{
+   return dynamic_cast<Gated&>(transformer).gate.Process(transformer);
+}
+
+//! Collects output in memory
+struct BufferTransformer final : SpectrumTransformer, Gated
+{
+   BufferTransformer()
+       : SpectrumTransformer { true, eWinFuncHann, eWinFuncHann, windowSize,
+                               stepsPerWindow, true, true }
+   {
+   }
+
+   void DoOutput(const float* outBuffer, size_t stepSize) override
+   {
+      output.insert(output.end(), outBuffer, outBuffer + stepSize);
+   }
+
+   std::vector<float> output;
+};
+
+struct TrackTransformer final : TrackSpectrumTransformer, Gated
+{
+   explicit TrackTransformer(WaveChannel& output)
+       : TrackSpectrumTransformer { &output,        true,
+                                    eWinFuncHann,   eWinFuncHann,
+                                    windowSize,     stepsPerWindow,
+                                    true,           true }
+   {
+   }
+};
+
+//! Bursts of a tone in quiet noise, the same each time
+std::vector<float> Signal(size_t numSamples, unsigned seed)
+{
+   std::vector<float> samples(numSamples);
+   auto state = seed;
+   for (size_t i = 0; i < numSamples; ++i)
+   {
+      // A linear congruential generator, the same on all platforms
+      state = state * 1664525u + 1013904223u;
+      const auto noise =
+         1e-3f * (static_cast<float>(state >> 8) / (1 << 24) - 0.5f);
+      const bool burst = (i / 30000) % 3 == 0;
+      samples[i] = noise + (burst ? 0.5f * std::sin(0.1f * i) : 0.0f);
+   }
+   return samples;
+}
+
+std::shared_ptr<WaveTrack> MakeTrack(
+   const SampleBlockFactoryPtr& factory, const std::vector<float>& samples)
+{
+   const auto track = WaveTrack::Create(factory, floatSample, sampleRate);
+   if (!samples.empty())
+      track->GetChannel(0)->Append(
+         reinterpret_cast<constSamplePtr>(samples.data()), floatSample,
+         samples.size());
+   track->Flush();
+   return track;
+}
+
+//! Index of the first difference, so that failures do not print whole signals
+size_t Mismatch(const std::vector<float>& a, const std::vector<float>& b)
+{
+   REQUIRE(a.size() == b.size());
+   return std::mismatch(a.begin(), a.end(), b.begin()).first - a.begin();
+}
+
+std::vector<float> Samples(const WaveTrack& track, size_t numSamples)
+{
+   std::vector<float> samples(numSamples);
+   track.GetFloats(samples.data(), 0, numSamples);
+   return samples;
+}
+} // namespace
+
+TEST_CASE("SpectrumTransformer transforms in batches as one window at a time")
+{
+   const auto input = Signal(100000, 1);
+
+   BufferTransformer batched;
+   REQUIRE(batched.Start(queueLength));
+   REQUIRE(batched.ProcessSamples(GateProcessor, input.data(), input.size()));
+   REQUIRE(batched.Finish(GateProcessor));
+
+   BufferTransformer serial;
+   REQUIRE(serial.Start(queueLength));
+   for (const auto& sample : input)
+      REQUIRE(serial.ProcessSamples(GateProcessor, &sample, 1));
+   REQUIRE(serial.Finish(GateProcessor));
+
+   REQUIRE(batched.output.size() >= input.size());
+   REQUIRE(Mismatch(batched.output, serial.output) == serial.output.size());
+}
+
+TEST_CASE("TrackSpectrumTransformer::ProcessConcurrently")
+{
+   const auto factory = std::make_shared<MockSampleBlockFactory>();
+
+   // Longer than a segment, so that each channel is cut into several
+   constexpr size_t numSamples = 2500000;
+   constexpr size_t start = 1000;
+   constexpr size_t len = numSamples - 2 * start;
+   const std::vector<std::shared_ptr<WaveTrack>> inputs {
+      MakeTrack(factory, Signal(numSamples, 1)),
+      MakeTrack(factory, Signal(numSamples, 2)),
+   };
+
+   // Process each channel in one pass
+   std::vector<std::vector<float>> expected;
+   for (const auto& input : inputs)
+   {
+      const auto output = MakeTrack(factory, {});
+      TrackTransformer transformer { *output->GetChannel(0) };
+      REQUIRE(transformer.Process(
+         GateProcessor, *input->GetChannel(0), queueLength, start, len));
+      output->Flush();
+      expected.push_back(Samples(*output, len));
+   }
+
+   // Process the channels in segments on several threads
+   std::vector<std::shared_ptr<WaveTrack>> outputs;
+   std::vector<const WaveChannel*> pChannels;
+   std::vector<WaveChannel*> pOutputs;
+   for (const auto& input : inputs)
+   {
+      outputs.push_back(MakeTrack(factory, {}));
+      pChannels.push_back(input->GetChannel(0).get());
+      pOutputs.push_back(outputs.back()->GetChannel(0).get());
+   }
+   double lastFraction = 0;
+   const auto progress = [&](double fraction) {
+      REQUIRE(fraction >= lastFraction);
+      lastFraction = fraction;
+      return true;
+   };
+   REQUIRE(TrackSpectrumTransformer::ProcessConcurrently(
+      [](WaveChannel& output) {
+         return std::make_unique<TrackTransformer>(output);
+      },
+      GateProcessor, pChannels, pOutputs, queueLength, start, len,
+      warmUpSteps, progress, 4));
+   REQUIRE(lastFraction == 1.0);
+
+   for (size_t iChannel = 0; iChannel < outputs.size(); ++iChannel)
+   {
+      outputs[iChannel]->Flush();
+      REQUIRE(outputs[iChannel]->GetVisibleSampleCount() == len);
+      REQUIRE(Mismatch(Samples(*outputs[iChannel], len), expected[iChannel]) ==
+         len);
+   }
+}
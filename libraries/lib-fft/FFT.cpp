@@ -48,8 +48,12 @@
 #include <stdlib.h>
 #include <math.h>
 
+#include "PowerSpectrumGetter.h"
 #include "RealFFTf.h"
 
+#include <algorithm>
+#include <pffft.h>
+
 using Floats = ArrayOf<float>;
 static ArraysOf<int> gFFTBitTable;
 static const size_t MaxFastBits = 16;
@@ -219,36 +223,116 @@ void FFT(size_t NumSamples,
    }
 }
 
+namespace {
+// pffft does real transforms of powers of two only from this size up
+constexpr size_t MinPffftSize = 32;
+
+/*
+ * Buffers and tables for the transforms of one or more frames of the same
+ * size.  The SIMD transforms of pffft are used if the size allows;
+ * otherwise RealFFTf() from RealFFTf.h.
+ */
+struct Workspace
+{
+   explicit Workspace(size_t NumSamples)
+      : NumSamples{ NumSamples }
+      , setup{ NumSamples >= MinPffftSize
+         ? GetRealPffftSetup(NumSamples) : nullptr }
+      , hFFT{ setup ? nullptr : GetFFT(NumSamples) }
+      , buffer(NumSamples)
+      , work(NumSamples)
+   {}
+
+   // Transforms In into buffer, which then holds the real parts of the DC
+   // and Fs/2 bins, followed by interleaved real and imaginary parts of the
+   // other bins
+   void Forward(const float *In)
+   {
+      if (setup) {
+         std::copy(In, In + NumSamples, buffer.begin());
+         pffft_transform_ordered(setup,
+            buffer.data(), buffer.data(), work.data(), PFFFT_FORWARD);
+      }
+      else {
+         std::copy(In, In + NumSamples, work.begin());
+         RealFFTf(work.data(), hFFT.get());
+         buffer[0] = work[0];
+         buffer[1] = work[1];
+         for (size_t i = 1; i < NumSamples / 2; i++) {
+            buffer[2*i  ] = work[hFFT->BitReversed[i]  ];
+            buffer[2*i+1] = work[hFFT->BitReversed[i]+1];
+         }
+      }
+   }
+
+   // Inverse of Forward, replacing buffer with the time domain signal
+   void Inverse()
+   {
+      if (setup) {
+         pffft_transform_ordered(setup,
+            buffer.data(), buffer.data(), work.data(), PFFFT_BACKWARD);
+         const float scale = 1.0f / NumSamples;
+         for (auto &x : buffer)
+            x *= scale;
+      }
+      else {
+         InverseRealFFTf(buffer.data(), hFFT.get());
+         ReorderToTime(hFFT.get(), buffer.data(), work.data());
+         std::copy(work.begin(), work.end(), buffer.begin());
+      }
+   }
+
+   void PowerSpectrum(float *Out) const
+   {
+      Out[0] = buffer[0] * buffer[0];
+      for (size_t i = 1; i < NumSamples / 2; i++)
+         Out[i] = buffer[2*i] * buffer[2*i] + buffer[2*i+1] * buffer[2*i+1];
+      Out[NumSamples / 2] = buffer[1] * buffer[1];
+   }
+
+   void RealFFT(float *RealOut, float *ImagOut) const
+   {
+      for (size_t i = 1; i < NumSamples / 2; i++) {
+         RealOut[i] = buffer[2*i  ];
+         ImagOut[i] = buffer[2*i+1];
+      }
+      // Handle the (real-only) DC and Fs/2 bins
+      RealOut[0] = buffer[0];
+      RealOut[NumSamples / 2] = buffer[1];
+      ImagOut[0] = ImagOut[NumSamples / 2] = 0;
+      // Fill in the upper half using symmetry properties
+      for(size_t i = NumSamples / 2 + 1; i < NumSamples; i++) {
+         RealOut[i] =  RealOut[NumSamples-i];
+         ImagOut[i] = -ImagOut[NumSamples-i];
+      }
+   }
+
+   const size_t NumSamples;
+   PFFFT_Setup *const setup;
+   const HFFT hFFT;
+   PffftFloatVector buffer;
+   PffftFloatVector work;
+};
+}
+
 /*
  * Real Fast Fourier Transform
- *
- * This is merely a wrapper of RealFFTf() from RealFFTf.h.
  */
 
 void RealFFT(size_t NumSamples, const float *RealIn, float *RealOut, float *ImagOut)
 {
-   auto hFFT = GetFFT(NumSamples);
-   Floats pFFT{ NumSamples };
-   // Copy the data into the processing buffer
-   for(size_t i = 0; i < NumSamples; i++)
-      pFFT[i] = RealIn[i];
-
-   // Perform the FFT
-   RealFFTf(pFFT.get(), hFFT.get());
-
-   // Copy the data into the real and imaginary outputs
-   for (size_t i = 1; i<(NumSamples / 2); i++) {
-      RealOut[i]=pFFT[hFFT->BitReversed[i]  ];
-      ImagOut[i]=pFFT[hFFT->BitReversed[i]+1];
-   }
-   // Handle the (real-only) DC and Fs/2 bins
-   RealOut[0] = pFFT[0];
-   RealOut[NumSamples / 2] = pFFT[1];
-   ImagOut[0] = ImagOut[NumSamples / 2] = 0;
-   // Fill in the upper half using symmetry properties
-   for(size_t i = NumSamples / 2 + 1; i < NumSamples; i++) {
-      RealOut[i] =  RealOut[NumSamples-i];
-      ImagOut[i] = -ImagOut[NumSamples-i];
+   Workspace workspace{ NumSamples };
+   workspace.Forward(RealIn);
+   workspace.RealFFT(RealOut, ImagOut);
+}
+
+void RealFFTs(size_t NumSamples, size_t NumFrames,
+              const float *RealIn, float *RealOut, float *ImagOut)
+{
+   Workspace workspace{ NumSamples };
+   for (size_t i = 0; i < NumFrames; ++i) {
+      workspace.Forward(RealIn + i * NumSamples);
+      workspace.RealFFT(RealOut + i * NumSamples, ImagOut + i * NumSamples);
    }
 }
 
@@ -260,64 +344,49 @@ void RealFFT(size_t NumSamples, const float *RealIn, float *RealOut, float *Imag
  * and as a result the output is purely real.
  * Only the first half of RealIn and ImagIn are used due to this
  * symmetry assumption.
- *
- * This is merely a wrapper of InverseRealFFTf() from RealFFTf.h.
  */
 void InverseRealFFT(size_t NumSamples, const float *RealIn, const float *ImagIn,
 		    float *RealOut)
 {
-   auto hFFT = GetFFT(NumSamples);
-   Floats pFFT{ NumSamples };
+   Workspace workspace{ NumSamples };
+   auto &buffer = workspace.buffer;
    // Copy the data into the processing buffer
-   for (size_t i = 0; i < (NumSamples / 2); i++)
-      pFFT[2*i  ] = RealIn[i];
-   if(ImagIn == NULL) {
-      for (size_t i = 0; i < (NumSamples / 2); i++)
-         pFFT[2*i+1] = 0;
-   } else {
-      for (size_t i = 0; i < (NumSamples / 2); i++)
-         pFFT[2*i+1] = ImagIn[i];
+   for (size_t i = 0; i < (NumSamples / 2); i++) {
+      buffer[2*i  ] = RealIn[i];
+      buffer[2*i+1] = ImagIn ? ImagIn[i] : 0;
    }
    // Put the fs/2 component in the imaginary part of the DC bin
-   pFFT[1] = RealIn[NumSamples / 2];
+   buffer[1] = RealIn[NumSamples / 2];
 
-   // Perform the FFT
-   InverseRealFFTf(pFFT.get(), hFFT.get());
+   workspace.Inverse();
 
    // Copy the data to the (purely real) output buffer
-   ReorderToTime(hFFT.get(), pFFT.get(), RealOut);
+   std::copy(buffer.begin(), buffer.end(), RealOut);
 }
 
 /*
  * PowerSpectrum
  *
- * This function uses RealFFTf() from RealFFTf.h to perform the real
- * FFT computation, and then squares the real and imaginary part of
- * each coefficient, extracting the power and throwing away the phase.
- *
- * For speed, it does not call RealFFT, but duplicates some
- * of its code.
+ * This function performs the real FFT computation, and then squares the
+ * real and imaginary part of each coefficient, extracting the power and
+ * throwing away the phase.
  */
 
 void PowerSpectrum(size_t NumSamples, const float *In, float *Out)
 {
-   auto hFFT = GetFFT(NumSamples);
-   Floats pFFT{ NumSamples };
-   // Copy the data into the processing buffer
-   for (size_t i = 0; i<NumSamples; i++)
-      pFFT[i] = In[i];
-
-   // Perform the FFT
-   RealFFTf(pFFT.get(), hFFT.get());
+   Workspace workspace{ NumSamples };
+   workspace.Forward(In);
+   workspace.PowerSpectrum(Out);
+}
 
-   // Copy the data into the real and imaginary outputs
-   for (size_t i = 1; i<NumSamples / 2; i++) {
-      Out[i]= (pFFT[hFFT->BitReversed[i]  ]*pFFT[hFFT->BitReversed[i]  ])
-         + (pFFT[hFFT->BitReversed[i]+1]*pFFT[hFFT->BitReversed[i]+1]);
+void PowerSpectra(size_t NumSamples, size_t NumFrames,
+                  const float *In, float *Out)
+{
+   Workspace workspace{ NumSamples };
+   for (size_t i = 0; i < NumFrames; ++i) {
+      workspace.Forward(In + i * NumSamples);
+      workspace.PowerSpectrum(Out + i * (NumSamples / 2 + 1));
    }
-   // Handle the (real-only) DC and Fs/2 bins
-   Out[0] = pFFT[0]*pFFT[0];
-   Out[NumSamples / 2] = pFFT[1]*pFFT[1];
 }
 
 /*
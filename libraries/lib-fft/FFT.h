@@ -66,6 +66,17 @@ class TranslatableString;
 FFT_API
 void PowerSpectrum(size_t NumSamples, const float *In, float *Out);
 
+/*
+ * Computes the power spectra of NumFrames frames, each of NumSamples
+ * consecutive values of In, into NumFrames rows of NumSamples / 2 + 1
+ * values of Out.  Tables and buffers are reused for all frames, so this is
+ * faster than repeated calls to PowerSpectrum.
+ */
+
+FFT_API
+void PowerSpectra(size_t NumSamples, size_t NumFrames,
+                  const float *In, float *Out);
+
 /*
  * Computes an FFT when the input data is real but you still
  * want complex data as output.  The output arrays are the
@@ -77,6 +88,15 @@ FFT_API
 void RealFFT(size_t NumSamples,
              const float *RealIn, float *RealOut, float *ImagOut);
 
+/*
+ * RealFFT of NumFrames frames, each of NumSamples consecutive values of
+ * RealIn, giving NumSamples values per frame in RealOut and ImagOut
+ */
+
+FFT_API
+void RealFFTs(size_t NumSamples, size_t NumFrames,
+              const float *RealIn, float *RealOut, float *ImagOut);
+
 /*
  * Computes an Inverse FFT when the input data is conjugate symmetric
  * so the output is purely real.  NumSamples must be a power of
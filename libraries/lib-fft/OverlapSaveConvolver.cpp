@@ -0,0 +1,219 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  OverlapSaveConvolver.cpp
+
+**********************************************************************/
+#include "OverlapSaveConvolver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <future>
+#include <thread>
+#include <pffft.h>
+
+namespace {
+//! Most blocks processed at once by one call to ProcessBlocks
+constexpr size_t MaxBatch = 64;
+//! Half the least size of real transforms supported by pffft
+constexpr size_t MinBlockSize = 16;
+
+size_t NextPowerOfTwo(size_t n)
+{
+   size_t result = 1;
+   while (result < n)
+      result <<= 1;
+   return result;
+}
+}
+
+OverlapSaveConvolver::Kernel::Kernel(
+   const float *impulseResponse, size_t length, size_t blockSize)
+   : mLength{ length }
+   , mBlockSize{ blockSize
+      ? blockSize : std::max(MinBlockSize, NextPowerOfTwo(length)) }
+   , mNPartitions{
+      std::max<size_t>(1, (length + mBlockSize - 1) / mBlockSize) }
+   , mSetup{ GetRealPffftSetup(2 * mBlockSize) }
+{
+   assert(mBlockSize >= MinBlockSize);
+   assert((mBlockSize & (mBlockSize - 1)) == 0);
+
+   const auto fftSize = 2 * mBlockSize;
+   mSpectra.resize(mNPartitions * fftSize);
+
+   // Zero-pad each partition of the response to the transform size
+   PffftFloatVector window(fftSize), work(fftSize);
+   for (size_t p = 0; p < mNPartitions; ++p) {
+      std::fill(window.begin(), window.end(), 0.0f);
+      const auto begin = p * mBlockSize;
+      const auto end = std::min(length, begin + mBlockSize);
+      if (begin < end)
+         std::copy(impulseResponse + begin, impulseResponse + end,
+            window.begin());
+      pffft_transform(mSetup, window.data(),
+         mSpectra.data() + p * fftSize, work.data(), PFFFT_FORWARD);
+   }
+}
+
+OverlapSaveConvolver::Kernel::~Kernel() = default;
+
+struct OverlapSaveConvolver::Scratch
+{
+   explicit Scratch(size_t fftSize)
+      : window(fftSize), work(fftSize), accumulator(fftSize)
+   {}
+   PffftFloatVector window;
+   PffftFloatVector work;
+   PffftFloatVector accumulator;
+};
+
+namespace {
+//! Call `f(i, scratch)` for each `i` in [0, n), using at most as many threads
+//! as there are elements of `scratches`; the calling thread is one of them
+template<typename Scratch, typename F>
+void ParallelFor(std::vector<Scratch> &scratches, size_t n, const F &f)
+{
+   const auto nWorkers = std::min(scratches.size(), n);
+   if (nWorkers <= 1) {
+      for (size_t i = 0; i < n; ++i)
+         f(i, scratches[0]);
+      return;
+   }
+
+   std::atomic<size_t> next{ 0 };
+   const auto work = [&](Scratch &scratch) {
+      size_t i;
+      while ((i = next++) < n)
+         f(i, scratch);
+   };
+   std::vector<std::future<void>> futures;
+   futures.reserve(nWorkers - 1);
+   for (size_t i = 1; i < nWorkers; ++i)
+      futures.emplace_back(
+         std::async(std::launch::async, work, std::ref(scratches[i])));
+   work(scratches[0]);
+   for (auto &future : futures)
+      future.get();
+}
+}
+
+OverlapSaveConvolver::OverlapSaveConvolver(
+   std::shared_ptr<const Kernel> pKernel, size_t nThreads)
+   : mpKernel{ std::move(pKernel) }
+   , mBlockSize{ mpKernel->BlockSize() }
+   , mNThreads{ nThreads
+      ? nThreads : std::max(1u, std::thread::hardware_concurrency()) }
+   , mHistorySize{ mpKernel->NPartitions() - 1 + MaxBatch }
+   , mInput(2 * mBlockSize)
+   , mOutput(mBlockSize)
+   , mHistory(mHistorySize * 2 * mBlockSize)
+   , mResults(MaxBatch * mBlockSize)
+{
+   mScratch.reserve(mNThreads);
+   for (size_t i = 0; i < mNThreads; ++i)
+      mScratch.emplace_back(2 * mBlockSize);
+}
+
+OverlapSaveConvolver::~OverlapSaveConvolver() = default;
+
+void OverlapSaveConvolver::Reset()
+{
+   std::fill(mInput.begin(), mInput.end(), 0.0f);
+   std::fill(mOutput.begin(), mOutput.end(), 0.0f);
+   mFill = 0;
+   // Spectra in mHistory from before are not used again
+   mBlockCount = 0;
+}
+
+void OverlapSaveConvolver::Process(
+   const float *input, float *output, size_t len)
+{
+   const auto blockSize = mBlockSize;
+   while (len > 0) {
+      if (mFill == 0 && len >= blockSize) {
+         // Whole blocks, possibly on several threads
+         const auto nBlocks = std::min(len / blockSize, MaxBatch);
+         const auto count = nBlocks * blockSize;
+         // This consumes the input before any output is written
+         ProcessBlocks(input, nBlocks, mResults.data());
+         // Output lags by one block
+         std::copy_n(mOutput.data(), blockSize, output);
+         std::copy_n(mResults.data(), count - blockSize, output + blockSize);
+         std::copy_n(
+            mResults.data() + count - blockSize, blockSize, mOutput.data());
+         input += count;
+         output += count;
+         len -= count;
+      }
+      else {
+         const auto count = std::min(blockSize - mFill, len);
+         const auto pIn = mInput.data() + blockSize + mFill;
+         const auto pOut = mOutput.data() + mFill;
+         for (size_t i = 0; i < count; ++i) {
+            const auto sample = input[i];
+            output[i] = pOut[i];
+            pIn[i] = sample;
+         }
+         mFill += count;
+         input += count;
+         output += count;
+         len -= count;
+         if (mFill == blockSize) {
+            ProcessBlocks(mInput.data() + blockSize, 1, mOutput.data());
+            mFill = 0;
+         }
+      }
+   }
+}
+
+void OverlapSaveConvolver::ProcessBlocks(
+   const float *input, size_t nBlocks, float *results)
+{
+   assert(nBlocks <= MaxBatch);
+   const auto &kernel = *mpKernel;
+   const auto setup = kernel.mSetup;
+   const auto blockSize = mBlockSize;
+   const auto fftSize = 2 * blockSize;
+   const auto nPartitions = kernel.NPartitions();
+   const auto firstBlock = mBlockCount;
+   const auto spectrum = [&](unsigned long long block) {
+      return mHistory.data() + (block % mHistorySize) * fftSize;
+   };
+
+   // Transform the windows of the new blocks, each preceded by the block
+   // before it.  This can't overwrite spectra still needed below, because
+   // of the size of the history.
+   ParallelFor(mScratch, nBlocks, [&](size_t j, Scratch &scratch) {
+      const auto window = scratch.window.data();
+      const auto previous =
+         (j == 0) ? mInput.data() : input + (j - 1) * blockSize;
+      std::copy_n(previous, blockSize, window);
+      std::copy_n(input + j * blockSize, blockSize, window + blockSize);
+      pffft_transform(setup, window, spectrum(firstBlock + j),
+         scratch.work.data(), PFFFT_FORWARD);
+   });
+
+   // Multiply by the partitions of the response and sum; transform back;
+   // the second half of each window is valid output
+   const auto scale = 1.0f / fftSize;
+   ParallelFor(mScratch, nBlocks, [&](size_t j, Scratch &scratch) {
+      const auto block = firstBlock + j;
+      const auto accumulator = scratch.accumulator.data();
+      std::fill(scratch.accumulator.begin(), scratch.accumulator.end(), 0.0f);
+      const auto nTerms = std::min<unsigned long long>(nPartitions, block + 1);
+      for (size_t p = 0; p < nTerms; ++p)
+         pffft_zconvolve_accumulate(setup, spectrum(block - p),
+            kernel.mSpectra.data() + p * fftSize, accumulator, scale);
+      const auto window = scratch.window.data();
+      pffft_transform(setup, accumulator, window,
+         scratch.work.data(), PFFFT_BACKWARD);
+      std::copy_n(window + blockSize, blockSize, results + j * blockSize);
+   });
+
+   std::copy_n(input + (nBlocks - 1) * blockSize, blockSize, mInput.data());
+   mBlockCount += nBlocks;
+}
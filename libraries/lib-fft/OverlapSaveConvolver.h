@@ -0,0 +1,106 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  OverlapSaveConvolver.h
+
+**********************************************************************/
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "PowerSpectrumGetter.h" // PffftFloatVector
+
+/*!
+ * @brief Uniformly partitioned overlap-save convolution with a finite impulse
+ * response, using the vectorized pffft transforms
+ *
+ * The impulse response is split into partitions of the block size, so that
+ * long responses cost little more than short ones, and latency is fixed at
+ * one block, whatever the length of the response.
+ *
+ * When given more than one thread and more than one block of input at once,
+ * the blocks are transformed and filtered concurrently.  The result is the
+ * same as that of serial processing.
+ */
+class FFT_API OverlapSaveConvolver
+{
+public:
+   //! Frequency domain partitions of an impulse response
+   /*!
+    Immutable after construction, so it can be shared among the convolvers of
+    several channels
+    */
+   class FFT_API Kernel
+   {
+   public:
+      /*!
+       @param impulseResponse `length` filter taps
+       @param blockSize power of two, at least 16; or zero, to choose the
+       least power of two not less than `length`
+       */
+      Kernel(const float *impulseResponse, size_t length, size_t blockSize = 0);
+      ~Kernel();
+
+      size_t BlockSize() const { return mBlockSize; }
+      size_t NPartitions() const { return mNPartitions; }
+      size_t Length() const { return mLength; }
+
+   private:
+      friend OverlapSaveConvolver;
+      size_t mLength;
+      size_t mBlockSize;
+      size_t mNPartitions;
+      PFFFT_Setup *const mSetup;
+      //! `mNPartitions` unordered spectra of twice the block size
+      PffftFloatVector mSpectra;
+   };
+
+   /*!
+    @param nThreads at most so many threads process long inputs; zero means
+    as many as there are hardware threads
+    */
+   explicit OverlapSaveConvolver(
+      std::shared_ptr<const Kernel> pKernel, size_t nThreads = 1);
+   ~OverlapSaveConvolver();
+
+   //! Output lags input by this many samples, which is the block size
+   size_t GetLatency() const { return mBlockSize; }
+
+   //! Forget all input, as if newly constructed
+   void Reset();
+
+   //! Filter samples; `input` and `output` may be equal
+   void Process(const float *input, float *output, size_t len);
+
+private:
+   struct Scratch;
+
+   //! Filter whole blocks of `input`, continuing the previous blocks, and
+   //! write the last `mBlockSize` samples of each filtered window to `results`
+   void ProcessBlocks(const float *input, size_t nBlocks, float *results);
+
+   const std::shared_ptr<const Kernel> mpKernel;
+   const size_t mBlockSize;
+   const size_t mNThreads;
+   //! Capacity of mHistory, in spectra
+   const size_t mHistorySize;
+
+   //! The previous block of input, then the block being filled
+   std::vector<float> mInput;
+   //! Filtered samples of the last complete block
+   std::vector<float> mOutput;
+   //! Number of samples in the second half of mInput
+   size_t mFill{ 0 };
+
+   //! Ring of spectra of past input windows; block number `n` goes into slot
+   //! `n % mHistorySize`
+   PffftFloatVector mHistory;
+   unsigned long long mBlockCount{ 0 };
+
+   std::vector<Scratch> mScratch;
+   //! Results of batches of blocks
+   std::vector<float> mResults;
+};
@@ -10,7 +10,13 @@
 **********************************************************************/
 #include "PowerSpectrumGetter.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <future>
+#include <limits>
+#include <mutex>
+#include <thread>
 #include <pffft.h>
 
 void PffftSetupDeleter::Pffft_destroy_setup(PFFFT_Setup *p)
@@ -28,6 +34,23 @@ void PffftAllocatorBase::Pffft_aligned_free(void *p)
    pffft_aligned_free(p);
 }
 
+PFFFT_Setup *GetRealPffftSetup(size_t fftSize)
+{
+   static PffftSetupHolder setups[std::numeric_limits<size_t>::digits];
+   static std::mutex mutex;
+
+   assert(fftSize >= 32 && (fftSize & (fftSize - 1)) == 0);
+   size_t bits = 0;
+   while ((size_t{ 1 } << bits) < fftSize)
+      ++bits;
+
+   std::lock_guard<std::mutex> lock{ mutex };
+   auto &setup = setups[bits];
+   if (!setup)
+      setup.reset(pffft_new_setup(fftSize, PFFFT_REAL));
+   return setup.get();
+}
+
 PffftFloats PffftFloatVector::aligned(PffftAlignedCount c)
 {
    return PffftFloats{ data() + c };
@@ -40,7 +63,7 @@ PffftConstFloats PffftFloatVector::aligned(PffftAlignedCount c) const
 
 PowerSpectrumGetter::PowerSpectrumGetter(int fftSize)
     : mFftSize { fftSize }
-    , mSetup { pffft_new_setup(fftSize, PFFFT_REAL) }
+    , mSetup { GetRealPffftSetup(fftSize) }
     , mWork(fftSize)
 {
 }
@@ -49,16 +72,51 @@ PowerSpectrumGetter::~PowerSpectrumGetter()
 {
 }
 
-void PowerSpectrumGetter::operator()(
-   PffftFloats alignedBuffer, PffftFloats alignedOutput)
+namespace {
+void GetPowerSpectrum(PFFFT_Setup *setup, int fftSize,
+   float *buffer, float *output, float *work)
 {
-   const auto buffer = alignedBuffer.get();
-   const auto output = alignedOutput.get();
-   pffft_transform_ordered(mSetup.get(),
-      buffer, buffer, mWork.data(), PFFFT_FORWARD);
+   pffft_transform_ordered(setup, buffer, buffer, work, PFFFT_FORWARD);
    output[0] = buffer[0] * buffer[0];
-   for (auto i = 1; i < mFftSize / 2; ++i)
+   for (auto i = 1; i < fftSize / 2; ++i)
       output[i] =
          buffer[i * 2] * buffer[i * 2] + buffer[i * 2 + 1] * buffer[i * 2 + 1];
-   output[mFftSize / 2] = buffer[1] * buffer[1];
+   output[fftSize / 2] = buffer[1] * buffer[1];
+}
+}
+
+void PowerSpectrumGetter::operator()(
+   PffftFloats alignedBuffer, PffftFloats alignedOutput)
+{
+   GetPowerSpectrum(mSetup, mFftSize,
+      alignedBuffer.get(), alignedOutput.get(), mWork.data());
+}
+
+void PowerSpectrumGetter::operator()(PffftFloats alignedBuffers,
+   PffftFloats alignedOutputs, size_t numFrames, size_t nThreads)
+{
+   const PffftAlignedCount bufferStride(mFftSize);
+   const PffftAlignedCount outputStride(mFftSize / 2 + 1);
+   if (nThreads == 0)
+      nThreads = std::max(1u, std::thread::hardware_concurrency());
+   nThreads = std::min(nThreads, numFrames);
+
+   std::atomic<size_t> next{ 0 };
+   const auto work = [&](float *workBuffer) {
+      size_t i;
+      while ((i = next++) < numFrames)
+         GetPowerSpectrum(mSetup, mFftSize,
+            (alignedBuffers + bufferStride * i).get(),
+            (alignedOutputs + outputStride * i).get(), workBuffer);
+   };
+   std::vector<PffftFloatVector> workBuffers(
+      nThreads > 1 ? nThreads - 1 : 0, PffftFloatVector(mFftSize));
+   std::vector<std::future<void>> futures;
+   futures.reserve(workBuffers.size());
+   for (auto &workBuffer : workBuffers)
+      futures.emplace_back(
+         std::async(std::launch::async, work, workBuffer.data()));
+   work(mWork.data());
+   for (auto &future : futures)
+      future.get();
 }
@@ -24,6 +24,15 @@ private:
 };
 using PffftSetupHolder = std::unique_ptr<PFFFT_Setup, PffftSetupDeleter>;
 
+//! Setup for real transforms of the given size, shared by all threads
+/*!
+ Setups are made on first demand and kept until the program ends.  pffft does
+ not modify them while transforming, so concurrent use is safe.
+
+ @pre `fftSize` is a power of two, at least 32
+ */
+FFT_API PFFFT_Setup *GetRealPffftSetup(size_t fftSize);
+
 struct FFT_API PffftAllocatorBase {
    static void *Pffft_aligned_malloc(size_t nb_bytes);
    static void Pffft_aligned_free(void *);
@@ -220,8 +229,21 @@ public:
     */
    void operator()(PffftFloats alignedBuffer, PffftFloats alignedOutput);
 
+   /*!
+    * @brief Computes the power spectra of many frames at once
+    * @param alignedBuffers `numFrames` frames of `fftSize` samples, one every
+    * `PffftAlignedCount(fftSize)` floats. Overwritten.
+    * @param alignedOutputs `numFrames` spectra of `fftSize / 2 + 1` samples,
+    * one every `PffftAlignedCount(fftSize / 2 + 1)` floats
+    * @param nThreads frames are transformed on at most so many threads,
+    * including the calling one; zero means as many as there are hardware
+    * threads
+    */
+   void operator()(PffftFloats alignedBuffers, PffftFloats alignedOutputs,
+      size_t numFrames, size_t nThreads = 1);
+
 private:
    const int mFftSize;
-   PffftSetupHolder mSetup;
+   PFFFT_Setup *const mSetup;
    PffftFloatVector mWork;
 };
@@ -37,12 +37,15 @@
 */
 
 #include "RealFFTf.h"
+#include "PowerSpectrumGetter.h"
 
-#include <vector>
+#include <algorithm>
+
+#include <limits>
+#include <mutex>
 #include <stdlib.h>
 #include <math.h>
-
-#include <wx/thread.h>
+#include <pffft.h>
 
 #ifndef M_PI
 #define	M_PI		3.14159265358979323846  /* pi */
@@ -83,6 +86,10 @@ HFFT InitializeFFT(size_t fftlen)
       h->SinTable[h->BitReversed[i]+1]=(fft_type)-cos(2*M_PI*i/(2*h->Points));
    }
 
+   // pffft does real transforms of powers of two only from this size up
+   if (fftlen >= 32 && (fftlen & (fftlen - 1)) == 0)
+      h->pffftSetup = GetRealPffftSetup(fftlen);
+
 #ifdef EXPERIMENTAL_EQ_SSE_THREADED
    // NEW SSE FFT routines work on live data
    for(size_t i = 0; i < 32; i++)
@@ -93,51 +100,92 @@ HFFT InitializeFFT(size_t fftlen)
    return h;
 }
 
-enum : size_t { MAX_HFFT = 10 };
+// Tables for each power of two are made on first demand and kept; they are
+// never modified after that, so many threads may use them at once
+static std::unique_ptr<FFTParam>
+   hFFTArray[std::numeric_limits<size_t>::digits];
+static std::mutex getFFTMutex;
 
-// Maintain a pool:
-static std::vector< std::unique_ptr<FFTParam> > hFFTArray(MAX_HFFT);
-wxCriticalSection getFFTMutex;
+// Returns the base 2 logarithm of fftlen, or -1 if it is not a power of two
+static int PowerOfTwoBits(size_t fftlen)
+{
+   if (fftlen == 0 || (fftlen & (fftlen - 1)))
+      return -1;
+   int bits = 0;
+   while (fftlen >>= 1)
+      ++bits;
+   return bits;
+}
 
 /* Get a handle to the FFT tables of the desired length */
 /* This version keeps common tables rather than allocating a NEW table every time */
 HFFT GetFFT(size_t fftlen)
 {
-   // To do:  smarter policy about when to retain in the pool and when to
-   // allocate a unique instance.
-
-   wxCriticalSectionLocker locker{ getFFTMutex };
-   
-   size_t h = 0;
-   auto n = fftlen/2;
-   auto size = hFFTArray.size();
-   for(;
-       (h < size) && hFFTArray[h] && (n != hFFTArray[h]->Points);
-       h++)
-      ;
-   if(h < size) {
-      if(hFFTArray[h] == NULL) {
-         hFFTArray[h].reset( InitializeFFT(fftlen).release() );
-      }
-      return HFFT{ hFFTArray[h].get() };
-   } else {
-      // All buffers used, so fall back to allocating a NEW set of tables
+   const auto bits = PowerOfTwoBits(fftlen);
+   if (bits < 0)
+      // Not cached
       return InitializeFFT(fftlen);
-   }
+
+   std::lock_guard<std::mutex> locker{ getFFTMutex };
+   auto &cached = hFFTArray[bits];
+   if (!cached)
+      cached.reset( InitializeFFT(fftlen).release() );
+   return HFFT{ cached.get() };
 }
 
 /* Release a previously requested handle to the FFT tables */
 void FFTDeleter::operator() (FFTParam *hFFT) const
 {
-   wxCriticalSectionLocker locker{ getFFTMutex };
-
-   auto it = hFFTArray.begin(), end = hFFTArray.end();
-   while (it != end && it->get() != hFFT)
-      ++it;
-   if ( it != end )
-      ;
-   else
-      delete hFFT;
+   const auto bits = PowerOfTwoBits(2 * hFFT->Points);
+   if (bits >= 0) {
+      std::lock_guard<std::mutex> locker{ getFFTMutex };
+      if (hFFTArray[bits].get() == hFFT)
+         // Cached tables are kept
+         return;
+   }
+   delete hFFT;
+}
+
+namespace {
+// Aligned memory for pffft, one for each thread, because the tables may be
+// shared; holds the data and then the work area, each of 2 * h->Points
+float *PffftScratch(const FFTParam *h)
+{
+   thread_local PffftFloatVector scratch;
+   if (scratch.size() < 4 * h->Points)
+      scratch.resize(4 * h->Points);
+   return scratch.data();
+}
+
+void PffftRealFFTf(fft_type *buffer, const FFTParam *h)
+{
+   const auto n = 2 * h->Points;
+   const auto data = PffftScratch(h), work = data + n;
+   std::copy(buffer, buffer + n, data);
+   // The result is the DC and Fs/2 bins, then the other bins in order
+   pffft_transform_ordered(h->pffftSetup, data, data, work, PFFFT_FORWARD);
+   buffer[0] = data[0];
+   buffer[1] = data[1];
+   for (size_t i = 1; i < h->Points; i++) {
+      buffer[h->BitReversed[i]  ] = data[2*i  ];
+      buffer[h->BitReversed[i]+1] = data[2*i+1];
+   }
+}
+
+void PffftInverseRealFFTf(fft_type *buffer, const FFTParam *h)
+{
+   const auto n = 2 * h->Points;
+   const auto data = PffftScratch(h), work = data + n;
+   // The input is already in the order that pffft expects
+   std::copy(buffer, buffer + n, data);
+   pffft_transform_ordered(h->pffftSetup, data, data, work, PFFFT_BACKWARD);
+   // pffft does not scale
+   const auto scale = 1.0f / n;
+   for (size_t i = 0; i < h->Points; i++) {
+      buffer[h->BitReversed[i]  ] = data[2*i  ] * scale;
+      buffer[h->BitReversed[i]+1] = data[2*i+1] * scale;
+   }
+}
 }
 
 /*
@@ -160,6 +208,11 @@ void FFTDeleter::operator() (FFTParam *hFFT) const
 */
 void RealFFTf(fft_type *buffer, const FFTParam *h)
 {
+   if (h->pffftSetup) {
+      PffftRealFFTf(buffer, h);
+      return;
+   }
+
    fft_type *A,*B;
    const fft_type *sptr;
    const fft_type *endptr1,*endptr2;
@@ -262,6 +315,11 @@ void RealFFTf(fft_type *buffer, const FFTParam *h)
 */
 void InverseRealFFTf(fft_type *buffer, const FFTParam *h)
 {
+   if (h->pffftSetup) {
+      PffftInverseRealFFTf(buffer, h);
+      return;
+   }
+
    fft_type *A,*B;
    const fft_type *sptr;
    const fft_type *endptr1,*endptr2;
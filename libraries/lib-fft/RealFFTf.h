@@ -3,11 +3,16 @@
 
 #include "MemoryX.h"
 
+struct PFFFT_Setup;
+
 using fft_type = float;
 struct FFTParam {
    ArrayOf<int> BitReversed;
    ArrayOf<fft_type> SinTable;
    size_t Points;
+   //! If not null, RealFFTf and InverseRealFFTf use the SIMD transforms of
+   //! pffft, and rearrange the results as the scalar code would
+   PFFFT_Setup *pffftSetup{};
 #ifdef EXPERIMENTAL_EQ_SSE_THREADED
    int pow2Bits;
 #endif
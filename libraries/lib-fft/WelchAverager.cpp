@@ -0,0 +1,156 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  WelchAverager.cpp
+
+**********************************************************************/
+#include "WelchAverager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <future>
+#include <thread>
+
+namespace {
+//! Chunks hold about so many samples, or one window if that is more
+constexpr size_t ChunkSamples = 1 << 16;
+//! Chunks analyzed by each thread in one round
+constexpr size_t ChunksPerThread = 2;
+
+//! Reverse the order of the low `nBits` bits of `i`
+unsigned long long ReverseBits(unsigned long long i, unsigned nBits)
+{
+   unsigned long long result = 0;
+   for (unsigned b = 0; b < nBits; ++b, i >>= 1)
+      result = (result << 1) | (i & 1);
+   return result;
+}
+}
+
+WelchAverager::WelchAverager(
+   const float *window, size_t windowSize, size_t nThreads)
+   : mWindow(window, window + windowSize)
+   , mWindowSize{ windowSize }
+   , mNThreads{ nThreads
+      ? nThreads : std::max(1u, std::thread::hardware_concurrency()) }
+   , mWindowsPerChunk{ std::max<size_t>(1, ChunkSamples / (windowSize / 2)) }
+   , mSums(windowSize / 2)
+{
+   assert(windowSize > 0 && windowSize % 2 == 0);
+}
+
+WelchAverager::~WelchAverager() = default;
+
+bool WelchAverager::Process(unsigned long long length,
+   const Reader &reader, const Analysis &analysis, const Progress &progress)
+{
+   const auto windowSize = mWindowSize;
+   const auto hop = windowSize / 2;
+   std::fill(mSums.begin(), mSums.end(), 0.0);
+   mNWindows = 0;
+   mTotalWindows = (length < windowSize) ? 0 : (length - windowSize) / hop + 1;
+   if (mTotalWindows == 0)
+      return true;
+
+   // Chunks are visited in bit-reversed order of their indices, which
+   // divides the signal ever more finely
+   const auto nChunks =
+      (mTotalWindows + mWindowsPerChunk - 1) / mWindowsPerChunk;
+   unsigned nBits = 0;
+   while ((1ull << nBits) < nChunks)
+      ++nBits;
+   const auto nCounts = 1ull << nBits;
+   unsigned long long counter = 0;
+
+   const auto roundSize = static_cast<size_t>(std::min<unsigned long long>(
+      mNThreads * ChunksPerThread, nChunks));
+   const auto nWorkers = std::min(mNThreads, roundSize);
+   const auto chunkLength = (mWindowsPerChunk + 1) * hop;
+   std::vector<float> samples(roundSize * chunkLength);
+   std::vector<float> accumulators(roundSize * hop);
+   std::vector<std::vector<float>> frames(
+      nWorkers, std::vector<float>(mWindowsPerChunk * windowSize));
+   std::vector<unsigned long long> chunks;
+   chunks.reserve(roundSize);
+
+   const auto windowsOf = [&](unsigned long long chunk) {
+      return static_cast<size_t>(std::min<unsigned long long>(
+         mWindowsPerChunk, mTotalWindows - chunk * mWindowsPerChunk));
+   };
+
+   // Window the frames of chunk number `j` of the round, and analyze them
+   const auto analyzeChunk = [&](size_t j, std::vector<float> &buffer) {
+      const auto nFrames = windowsOf(chunks[j]);
+      const auto source = samples.data() + j * chunkLength;
+      for (size_t f = 0; f < nFrames; ++f) {
+         const auto in = source + f * hop;
+         const auto out = buffer.data() + f * windowSize;
+         for (size_t i = 0; i < windowSize; ++i)
+            out[i] = mWindow[i] * in[i];
+      }
+      const auto accumulator = accumulators.data() + j * hop;
+      std::fill(accumulator, accumulator + hop, 0.0f);
+      analysis(buffer.data(), nFrames, accumulator);
+   };
+
+   while (mNWindows < mTotalWindows) {
+      chunks.clear();
+      while (chunks.size() < roundSize && counter < nCounts) {
+         const auto chunk = ReverseBits(counter++, nBits);
+         if (chunk < nChunks)
+            chunks.push_back(chunk);
+      }
+
+      // Reading is serial
+      for (size_t j = 0; j < chunks.size(); ++j)
+         if (!reader(chunks[j] * mWindowsPerChunk * hop,
+               (windowsOf(chunks[j]) + 1) * hop,
+               samples.data() + j * chunkLength))
+            return false;
+
+      // Analysis is not
+      const auto n = chunks.size();
+      if (nWorkers <= 1 || n <= 1)
+         for (size_t j = 0; j < n; ++j)
+            analyzeChunk(j, frames[0]);
+      else {
+         std::atomic<size_t> next{ 0 };
+         const auto work = [&](std::vector<float> &buffer) {
+            size_t j;
+            while ((j = next++) < n)
+               analyzeChunk(j, buffer);
+         };
+         std::vector<std::future<void>> futures;
+         const auto nThreads = std::min(nWorkers, n);
+         futures.reserve(nThreads - 1);
+         for (size_t i = 1; i < nThreads; ++i)
+            futures.emplace_back(
+               std::async(std::launch::async, work, std::ref(frames[i])));
+         work(frames[0]);
+         for (auto &future : futures)
+            future.get();
+      }
+
+      // Sum in the order of the chunks, whatever the number of threads
+      for (size_t j = 0; j < n; ++j) {
+         const auto accumulator = accumulators.data() + j * hop;
+         for (size_t i = 0; i < hop; ++i)
+            mSums[i] += accumulator[i];
+         mNWindows += windowsOf(chunks[j]);
+      }
+
+      if (progress && !progress(*this))
+         return false;
+   }
+   return true;
+}
+
+void WelchAverager::GetAverage(float *output) const
+{
+   const auto scale = mNWindows ? 1.0 / mNWindows : 0.0;
+   for (size_t i = 0; i < mSums.size(); ++i)
+      output[i] = mSums[i] * scale;
+}
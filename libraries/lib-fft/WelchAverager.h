@@ -0,0 +1,91 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  WelchAverager.h
+
+**********************************************************************/
+#pragma once
+
+#include <functional>
+#include <vector>
+
+/*!
+ * @brief Averages some function of the half-overlapping windows of a long
+ * signal, as in Welch's method of estimating the power spectrum
+ *
+ * Consecutive windows are grouped in chunks.  The chunks are not visited in
+ * order, but in rounds spread over the whole signal, so that the partial
+ * average after any round is already representative of all of it and can be
+ * shown while the rest is computed.
+ *
+ * The chunks of each round are analyzed concurrently.  The sums are
+ * accumulated in double precision, in an order that does not depend on the
+ * number of threads, so neither does the result.
+ */
+class FFT_API WelchAverager
+{
+public:
+   //! Adds the results for some windows to the sums
+   /*!
+    Called on several threads at once, with different arguments
+    @param frames `nFrames` consecutive frames of `windowSize` samples,
+    multiplied by the window function; may be overwritten
+    @param accumulator `windowSize / 2` sums, to add to
+    */
+   using Analysis =
+      std::function<void(float *frames, size_t nFrames, float *accumulator)>;
+
+   //! Fills `buffer` with `len` samples of the signal beginning at `start`
+   /*!
+    Called only on the thread that called Process()
+    @return false to stop processing
+    */
+   using Reader = std::function<
+      bool(unsigned long long start, size_t len, float *buffer)>;
+
+   //! Called on the thread of Process() after each round
+   /*!
+    @return false to stop processing
+    */
+   using Progress = std::function<bool(const WelchAverager &)>;
+
+   /*!
+    @param window `windowSize` values of the window function
+    @param windowSize even and positive
+    @param nThreads at most so many threads analyze the chunks, including the
+    calling one; zero means as many as there are hardware threads
+    */
+   WelchAverager(const float *window, size_t windowSize, size_t nThreads = 0);
+   ~WelchAverager();
+
+   //! Analyze all windows of a signal of `length` samples, replacing any
+   //! previous results
+   /*!
+    @return false if `reader` or `progress` stopped processing; then the
+    windows analyzed so far remain available
+    */
+   bool Process(unsigned long long length,
+      const Reader &reader, const Analysis &analysis,
+      const Progress &progress = {});
+
+   //! Number of windows analyzed by the last Process()
+   unsigned long long GetNWindows() const { return mNWindows; }
+   //! Number of whole windows in the signal given to the last Process()
+   unsigned long long GetTotalWindows() const { return mTotalWindows; }
+
+   //! Write `windowSize / 2` averages of the windows analyzed so far; zeroes
+   //! if there are none
+   void GetAverage(float *output) const;
+
+private:
+   const std::vector<float> mWindow;
+   const size_t mWindowSize;
+   const size_t mNThreads;
+   const size_t mWindowsPerChunk;
+
+   std::vector<double> mSums;
+   unsigned long long mNWindows{ 0 };
+   unsigned long long mTotalWindows{ 0 };
+};
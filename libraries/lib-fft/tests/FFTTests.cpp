@@ -0,0 +1,173 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  FFTTests.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "FFT.h"
+#include "PowerSpectrumGetter.h"
+#include "RealFFTf.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+std::vector<float> RandomSignal(size_t length)
+{
+   std::mt19937 engine{ 1234 };
+   std::uniform_real_distribution<float> distribution{ -1.0f, 1.0f };
+   std::vector<float> signal(length);
+   for (auto &x : signal)
+      x = distribution(engine);
+   return signal;
+}
+
+//! Slow reference computation of the spectrum
+void Dft(size_t n, const float *in, double *re, double *im)
+{
+   for (size_t k = 0; k <= n / 2; ++k) {
+      re[k] = im[k] = 0;
+      for (size_t i = 0; i < n; ++i) {
+         const auto phase = -2 * M_PI * k * i / n;
+         re[k] += in[i] * cos(phase);
+         im[k] += in[i] * sin(phase);
+      }
+   }
+}
+}
+
+TEST_CASE("RealFFT agrees with the discrete Fourier transform")
+{
+   // Sizes below and above the least size of the vectorized transforms
+   for (size_t n : { 2, 8, 16, 32, 256, 2048 }) {
+      const auto signal = RandomSignal(n);
+      std::vector<double> re(n / 2 + 1), im(n / 2 + 1);
+      Dft(n, signal.data(), re.data(), im.data());
+
+      std::vector<float> realOut(n), imagOut(n), power(n / 2 + 1);
+      RealFFT(n, signal.data(), realOut.data(), imagOut.data());
+      PowerSpectrum(n, signal.data(), power.data());
+
+      const auto tolerance = 1e-4 * n;
+      for (size_t k = 0; k <= n / 2; ++k) {
+         REQUIRE(std::abs(realOut[k] - re[k]) < tolerance);
+         REQUIRE(std::abs(imagOut[k] - im[k]) < tolerance);
+         REQUIRE(std::abs(power[k] - (re[k] * re[k] + im[k] * im[k]))
+            < tolerance * n);
+      }
+      // Upper half is conjugate symmetric
+      for (size_t k = n / 2 + 1; k < n; ++k) {
+         REQUIRE(realOut[k] == realOut[n - k]);
+         REQUIRE(imagOut[k] == -imagOut[n - k]);
+      }
+   }
+}
+
+TEST_CASE("InverseRealFFT inverts RealFFT")
+{
+   for (size_t n : { 4, 16, 64, 1024 }) {
+      const auto signal = RandomSignal(n);
+      std::vector<float> re(n), im(n), result(n);
+      RealFFT(n, signal.data(), re.data(), im.data());
+      InverseRealFFT(n, re.data(), im.data(), result.data());
+      for (size_t i = 0; i < n; ++i)
+         REQUIRE(std::abs(result[i] - signal[i]) < 1e-5);
+   }
+}
+
+TEST_CASE("RealFFTf agrees with the discrete Fourier transform")
+{
+   // Sizes below and above the least size of the vectorized transforms
+   for (size_t n : { 8, 16, 32, 256, 4096 }) {
+      const auto signal = RandomSignal(n);
+      std::vector<double> re(n / 2 + 1), im(n / 2 + 1);
+      Dft(n, signal.data(), re.data(), im.data());
+
+      const auto hFFT = GetFFT(n);
+      auto buffer = signal;
+      RealFFTf(buffer.data(), hFFT.get());
+      std::vector<float> realOut(n / 2 + 1), imagOut(n / 2 + 1);
+      ReorderToFreq(hFFT.get(), buffer.data(), realOut.data(), imagOut.data());
+
+      const auto tolerance = 1e-4 * n;
+      for (size_t k = 0; k <= n / 2; ++k) {
+         REQUIRE(std::abs(realOut[k] - re[k]) < tolerance);
+         REQUIRE(std::abs(imagOut[k] - im[k]) < tolerance);
+      }
+
+      // The inverse takes bins in order, and not bit-reversed
+      for (size_t k = 1; k < n / 2; ++k) {
+         buffer[2 * k] = realOut[k];
+         buffer[2 * k + 1] = imagOut[k];
+      }
+      buffer[0] = realOut[0];
+      buffer[1] = realOut[n / 2];
+      InverseRealFFTf(buffer.data(), hFFT.get());
+      std::vector<float> result(n);
+      ReorderToTime(hFFT.get(), buffer.data(), result.data());
+      for (size_t i = 0; i < n; ++i)
+         REQUIRE(std::abs(result[i] - signal[i]) < 1e-5);
+   }
+}
+
+TEST_CASE("Batch transforms agree with single ones")
+{
+   constexpr size_t nFrames = 5;
+   for (size_t n : { 16, 512 }) {
+      const auto signal = RandomSignal(n * nFrames);
+      const auto nBins = n / 2 + 1;
+
+      std::vector<float> powers(nBins * nFrames),
+         re(n * nFrames), im(n * nFrames);
+      PowerSpectra(n, nFrames, signal.data(), powers.data());
+      RealFFTs(n, nFrames, signal.data(), re.data(), im.data());
+
+      std::vector<float> power(nBins), re1(n), im1(n);
+      for (size_t i = 0; i < nFrames; ++i) {
+         PowerSpectrum(n, signal.data() + i * n, power.data());
+         RealFFT(n, signal.data() + i * n, re1.data(), im1.data());
+         for (size_t k = 0; k < nBins; ++k)
+            REQUIRE(powers[i * nBins + k] == power[k]);
+         for (size_t k = 0; k < n; ++k) {
+            REQUIRE(re[i * n + k] == re1[k]);
+            REQUIRE(im[i * n + k] == im1[k]);
+         }
+      }
+   }
+}
+
+TEST_CASE("PowerSpectrumGetter batches agree with single frames")
+{
+   constexpr size_t n = 256, nFrames = 37;
+   const auto nBins = n / 2 + 1;
+   const PffftAlignedCount frameStride(n), spectrumStride(nBins);
+   const auto signal = RandomSignal(n * nFrames);
+
+   PffftFloatVector expected(nFrames * spectrumStride);
+   {
+      PowerSpectrumGetter getter(n);
+      PffftFloatVector frame(n);
+      for (size_t i = 0; i < nFrames; ++i) {
+         std::copy_n(signal.data() + i * n, n, frame.data());
+         getter(frame.aligned(), expected.aligned(spectrumStride, i));
+      }
+   }
+
+   for (size_t nThreads : { 1, 4 }) {
+      PffftFloatVector frames(nFrames * frameStride);
+      for (size_t i = 0; i < nFrames; ++i)
+         std::copy_n(signal.data() + i * n, n, frames.data() + i * frameStride);
+      PffftFloatVector actual(nFrames * spectrumStride);
+      PowerSpectrumGetter getter(n);
+      getter(frames.aligned(), actual.aligned(), nFrames, nThreads);
+      for (size_t i = 0; i < nFrames; ++i)
+         for (size_t k = 0; k < nBins; ++k)
+            REQUIRE(actual[i * spectrumStride + k] ==
+               expected[i * spectrumStride + k]);
+   }
+}
@@ -0,0 +1,139 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  WelchAveragerTests.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "WelchAverager.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+std::vector<float> RandomSignal(size_t length)
+{
+   std::mt19937 engine{ 4321 };
+   std::uniform_real_distribution<float> distribution{ -1.0f, 1.0f };
+   std::vector<float> signal(length);
+   for (auto &x : signal)
+      x = distribution(engine);
+   return signal;
+}
+
+//! Sums the squares of the first half of each frame
+void Analyze(float *frames, size_t nFrames, size_t windowSize, float *sums)
+{
+   for (size_t f = 0; f < nFrames; ++f)
+      for (size_t i = 0; i < windowSize / 2; ++i) {
+         const auto x = frames[f * windowSize + i];
+         sums[i] += x * x;
+      }
+}
+}
+
+TEST_CASE("WelchAverager")
+{
+   constexpr size_t windowSize = 256, hop = windowSize / 2;
+   // Not a whole number of windows or of chunks
+   const auto signal = RandomSignal(20000 * hop + 77);
+   std::vector<float> window(windowSize);
+   for (size_t i = 0; i < windowSize; ++i)
+      window[i] = 0.5f + i / float(windowSize);
+
+   const auto reader =
+      [&](unsigned long long start, size_t len, float *buffer) {
+         REQUIRE(start + len <= signal.size());
+         std::copy_n(signal.data() + start, len, buffer);
+         return true;
+      };
+   const auto analysis = [&](float *frames, size_t nFrames, float *sums) {
+      Analyze(frames, nFrames, windowSize, sums);
+   };
+
+   // Serial reference
+   const auto nWindows = (signal.size() - windowSize) / hop + 1;
+   std::vector<double> expected(hop);
+   for (size_t w = 0; w < nWindows; ++w)
+      for (size_t i = 0; i < hop; ++i) {
+         const auto x = window[i] * signal[w * hop + i];
+         expected[i] += x * x;
+      }
+   for (auto &x : expected)
+      x /= nWindows;
+
+   SECTION("averages all windows, whatever the number of threads")
+   {
+      std::vector<float> first;
+      for (size_t nThreads : { 1, 3, 8 }) {
+         WelchAverager averager{ window.data(), windowSize, nThreads };
+         REQUIRE(averager.Process(signal.size(), reader, analysis));
+         REQUIRE(averager.GetNWindows() == nWindows);
+         REQUIRE(averager.GetTotalWindows() == nWindows);
+         std::vector<float> average(hop);
+         averager.GetAverage(average.data());
+         for (size_t i = 0; i < hop; ++i)
+            REQUIRE(average[i] == Approx(expected[i]));
+         if (first.empty())
+            first = average;
+         else
+            REQUIRE(average == first);
+      }
+   }
+
+   SECTION("reads each chunk once and reports progress")
+   {
+      WelchAverager averager{ window.data(), windowSize, 4 };
+      unsigned long long read = 0;
+      const auto countingReader =
+         [&](unsigned long long start, size_t len, float *buffer) {
+            read += len - hop;
+            return reader(start, len, buffer);
+         };
+      unsigned long long previous = 0;
+      size_t nRounds = 0;
+      REQUIRE(averager.Process(signal.size(), countingReader, analysis,
+         [&](const WelchAverager &averager) {
+            REQUIRE(averager.GetNWindows() > previous);
+            previous = averager.GetNWindows();
+            ++nRounds;
+            return true;
+         }));
+      REQUIRE(read == nWindows * hop);
+      REQUIRE(previous == nWindows);
+      REQUIRE(nRounds > 1);
+   }
+
+   SECTION("stops when progress says so, keeping partial results")
+   {
+      WelchAverager averager{ window.data(), windowSize, 2 };
+      REQUIRE(!averager.Process(signal.size(), reader, analysis,
+         [](const WelchAverager &) { return false; }));
+      REQUIRE(averager.GetNWindows() > 0);
+      REQUIRE(averager.GetNWindows() < nWindows);
+      // Chunks of the first round are spread over the signal, so the partial
+      // average is already close
+      std::vector<float> average(hop);
+      averager.GetAverage(average.data());
+      double error = 0, total = 0;
+      for (size_t i = 0; i < hop; ++i) {
+         error += std::abs(average[i] - expected[i]);
+         total += expected[i];
+      }
+      REQUIRE(error < 0.1 * total);
+   }
+
+   SECTION("handles signals shorter than a window")
+   {
+      WelchAverager averager{ window.data(), windowSize };
+      REQUIRE(averager.Process(windowSize - 1, reader, analysis));
+      REQUIRE(averager.GetNWindows() == 0);
+      std::vector<float> average(hop, 1.0f);
+      averager.GetAverage(average.data());
+      REQUIRE(average == std::vector<float>(hop, 0.0f));
+   }
+}
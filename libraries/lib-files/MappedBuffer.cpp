@@ -0,0 +1,74 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MappedBuffer.cpp
+
+**********************************************************************/
+#include "MappedBuffer.h"
+
+#include <wx/string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedBuffer::MappedBuffer(const wxString &path, bool writable)
+{
+#ifdef _WIN32
+   const auto file = ::CreateFileW(path.wc_str(),
+      GENERIC_READ | (writable ? GENERIC_WRITE : 0),
+      FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL, nullptr);
+   if (file == INVALID_HANDLE_VALUE)
+      return;
+   mFile = file;
+   LARGE_INTEGER size;
+   if (!::GetFileSizeEx(mFile, &size) || size.QuadPart <= 0)
+      return;
+   mMapping = ::CreateFileMappingW(mFile, nullptr,
+      writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+   if (!mMapping)
+      return;
+   mData = ::MapViewOfFile(mMapping,
+      writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+   if (mData)
+      mSize = static_cast<size_t>(size.QuadPart);
+#else
+   mFile = ::open(path.fn_str(), writable ? O_RDWR : O_RDONLY);
+   if (mFile < 0)
+      return;
+   struct stat info;
+   if (::fstat(mFile, &info) != 0 || info.st_size <= 0)
+      return;
+   const auto data = ::mmap(nullptr, info.st_size,
+      PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED, mFile, 0);
+   if (data == MAP_FAILED)
+      return;
+   mData = data;
+   mSize = static_cast<size_t>(info.st_size);
+#endif
+}
+
+MappedBuffer::~MappedBuffer()
+{
+#ifdef _WIN32
+   if (mData)
+      ::UnmapViewOfFile(mData);
+   if (mMapping)
+      ::CloseHandle(mMapping);
+   if (mFile)
+      ::CloseHandle(mFile);
+#else
+   if (mData)
+      ::munmap(mData, mSize);
+   if (mFile >= 0)
+      ::close(mFile);
+#endif
+}
@@ -0,0 +1,45 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MappedBuffer.h
+
+  @brief Maps an existing file into memory, such as a buffer that a script
+  shares through /dev/shm
+
+**********************************************************************/
+#ifndef __AUDACITY_MAPPED_BUFFER__
+#define __AUDACITY_MAPPED_BUFFER__
+
+#include <cstddef>
+
+class wxString;
+
+//! Maps the whole of an existing file, which must not be empty
+/*! If mapping fails, Floats() is null */
+class FILES_API MappedBuffer final
+{
+public:
+   MappedBuffer(const wxString &path, bool writable);
+   ~MappedBuffer();
+
+   MappedBuffer(const MappedBuffer &) = delete;
+   MappedBuffer &operator=(const MappedBuffer &) = delete;
+
+   float *Floats() const { return static_cast<float*>(mData); }
+   size_t NFloats() const { return mSize / sizeof(float); }
+
+private:
+#ifdef _WIN32
+   //! Handles of the file and the mapping, or null
+   void *mFile{};
+   void *mMapping{};
+#else
+   int mFile{ -1 };
+#endif
+   void *mData{};
+   size_t mSize{};
+};
+
+#endif
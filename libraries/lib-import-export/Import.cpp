@@ -483,34 +483,13 @@ std::unique_ptr<ExtImportItem> Importer::CreateDefaultImportItem()
 }
 
 // returns number of tracks imported
-bool Importer::Import(
-   AudacityProject& project, const FilePath& fName,
-   ImportProgressListener* importProgressListener,
-   WaveTrackFactory* trackFactory, TrackHolders& tracks, Tags* tags,
-   std::optional<LibFileFormats::AcidizerTags>& outAcidTags,
-   TranslatableString& errorMessage)
+auto Importer::GetImportPlugins(const FilePath &fName) -> ImportPluginPtrs
 {
-   AudacityProject *pProj = &project;
-   auto cleanup = valueRestorer( pProj->mbBusyImporting, true );
-
    const FileExtension extension{ fName.AfterLast(wxT('.')) };
 
-   // Bug #2647: Peter has a Word 2000 .doc file that is recognized and imported by FFmpeg.
-   if (wxFileName(fName).GetExt() == wxT("doc")) {
-      errorMessage =
-         XO("\"%s\" \nis a not an audio file. \nAudacity cannot open this type of file.")
-         .Format( fName );
-      return false;
-   }
-
-   using ImportPluginPtrs = std::vector< ImportPlugin* >;
-
    // This list is used to call plugins in correct order
    ImportPluginPtrs importPlugins;
 
-   // This list is used to remember plugins that should have been compatible with the file.
-   ImportPluginPtrs compatiblePlugins;
-
    // Not implemented (yet?)
    wxString mime_type = wxT("*");
 
@@ -622,6 +601,54 @@ bool Importer::Import(
       }
    }
 
+   return importPlugins;
+}
+
+std::unique_ptr<ImportFileHandle> Importer::OpenForWorkerThread(
+   AudacityProject *pProject, const FilePath &fName)
+{
+   // Leave the special cases to Import()
+   if (wxFileName(fName).GetExt() == wxT("doc"))
+      return nullptr;
+
+   for (const auto plugin : GetImportPlugins(fName)) {
+      if (!plugin->IsThreadSafe())
+         // Import() must try this one, before any others that follow
+         return nullptr;
+      wxLogMessage(wxT("Opening with %s"),plugin->GetPluginStringID());
+      auto inFile = plugin->Open(fName, pProject);
+      if (inFile && inFile->GetStreamCount() > 0)
+         return inFile;
+   }
+   return nullptr;
+}
+
+bool Importer::Import(
+   AudacityProject& project, const FilePath& fName,
+   ImportProgressListener* importProgressListener,
+   WaveTrackFactory* trackFactory, TrackHolders& tracks, Tags* tags,
+   std::optional<LibFileFormats::AcidizerTags>& outAcidTags,
+   TranslatableString& errorMessage)
+{
+   AudacityProject *pProj = &project;
+   auto cleanup = valueRestorer( pProj->mbBusyImporting, true );
+
+   const FileExtension extension{ fName.AfterLast(wxT('.')) };
+
+   // Bug #2647: Peter has a Word 2000 .doc file that is recognized and imported by FFmpeg.
+   if (wxFileName(fName).GetExt() == wxT("doc")) {
+      errorMessage =
+         XO("\"%s\" \nis a not an audio file. \nAudacity cannot open this type of file.")
+         .Format( fName );
+      return false;
+   }
+
+   // This list is used to call plugins in correct order
+   const auto importPlugins = GetImportPlugins(fName);
+
+   // This list is used to remember plugins that should have been compatible with the file.
+   ImportPluginPtrs compatiblePlugins;
+
    ImportProgressResultProxy importResultProxy(importProgressListener);
 
    // Try the import plugins, in the permuted sequences just determined
@@ -13,6 +13,7 @@
 
 #include "ImportForwards.h"
 #include "Identifier.h"
+#include <memory>
 #include <vector>
 #include <wx/tokenzr.h> // for enum wxStringTokenizerMode
 
@@ -26,6 +27,7 @@ class Tags;
 class WaveTrackFactory;
 class Track;
 class TrackList;
+class ImportFileHandle;
 class ImportPlugin;
 class ImportProgressListener;
 class UnusableImportPlugin;
@@ -182,7 +184,22 @@ public:
        std::optional<LibFileFormats::AcidizerTags>& outAcidTags,
        TranslatableString& errorMessage);
 
+   //! Open a file on the main thread, to import it on another
+   /*!
+    Reads preferences, and tries importers in the same order as Import(),
+    stopping at the first that is not thread-safe.
+    @return null if the file must be imported by Import() instead, on the
+    main thread; else an open file, whose Import() may be called on another
+    thread
+    */
+   std::unique_ptr<ImportFileHandle> OpenForWorkerThread(
+      AudacityProject *pProject, const FilePath &fName);
+
  private:
+   using ImportPluginPtrs = std::vector<ImportPlugin*>;
+   //! Importers to try for a file, in order; reads preferences
+   ImportPluginPtrs GetImportPlugins(const FilePath &fName);
+
     struct Traits : Registry::DefaultTraits
     {
        using LeafTypes = List<ImporterItem>;
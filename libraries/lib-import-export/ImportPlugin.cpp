@@ -35,6 +35,11 @@ TranslatableString ImportPlugin::FailureHint() const
    return {};
 }
 
+bool ImportPlugin::IsThreadSafe() const
+{
+   return false;
+}
+
 
 ImportFileHandle::~ImportFileHandle() = default;
 
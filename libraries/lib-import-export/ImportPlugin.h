@@ -88,6 +88,14 @@ public:
 
    bool SupportsExtension(const FileExtension &extension);
 
+   //! Whether files it opens may be imported on a thread other than the main
+   /*!
+    If so, ImportFileHandle::Import must read no preferences, which Open()
+    should read instead, and may show messages only with
+    ImportUtils::ShowMessageBox.  Default false.
+    */
+   virtual bool IsThreadSafe() const;
+
    // Open the given file, returning true if it is in a recognized
    // format, false otherwise.  This puts the importer into the open
    // state.
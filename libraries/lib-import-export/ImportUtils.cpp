@@ -42,6 +42,11 @@ ImportUtils::NewWaveTrack(WaveTrackFactory &trackFactory,
 
 void ImportUtils::ShowMessageBox(const TranslatableString &message, const TranslatableString& caption)
 {
+   if (!BasicUI::IsUiThread()) {
+      // Importing on a worker thread; show it when the main thread is idle
+      BasicUI::CallAfter([=]{ ShowMessageBox(message, caption); });
+      return;
+   }
    BasicUI::ShowMessageBox(message,
                            BasicUI::MessageBoxOptions().Caption(caption));
 }
@@ -40,6 +40,8 @@ public:
    NewWaveTrack(WaveTrackFactory &trackFactory, unsigned nChannels,
       sampleFormat effectiveFormat, double rate);
    
+   //! May be called on any thread; if not the main thread, the message box
+   //! is shown later, on the main thread
    static void ShowMessageBox(const TranslatableString& message, const TranslatableString& caption = XO("Import Project"));
 
    //! Iterates over channels in each wave track from the list
@@ -0,0 +1,144 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ImportWorkerThreadTests.cpp
+
+**********************************************************************/
+#include "Import.h"
+#include "ImportPlugin.h"
+#include "ImportProgressListener.h"
+
+#include "MockedPrefs.h"
+
+#include <catch2/catch.hpp>
+#include <future>
+#include <thread>
+
+namespace {
+
+//! Counts the characters of the file name, as if that were the import
+class MockFileHandle final : public ImportFileHandleEx
+{
+public:
+   using ImportFileHandleEx::ImportFileHandleEx;
+
+   TranslatableString GetFileDescription() override { return {}; }
+   ByteCount GetFileUncompressedBytes() override { return 0; }
+   wxInt32 GetStreamCount() override { return 1; }
+   const TranslatableStrings &GetStreamInfo() override
+   {
+      static TranslatableStrings empty;
+      return empty;
+   }
+   void SetStreamUsage(wxInt32, bool) override {}
+
+   void Import(ImportProgressListener &progressListener, WaveTrackFactory*,
+      TrackHolders&, Tags*, std::optional<LibFileFormats::AcidizerTags>&)
+      override
+   {
+      BeginImport();
+      for (size_t ii = 0, nn = GetFilename().length(); ii < nn; ++ii) {
+         progressListener.OnImportProgress(double(ii) / nn);
+         ++length;
+      }
+      importThread = std::this_thread::get_id();
+      progressListener.OnImportResult(
+         ImportProgressListener::ImportResult::Success);
+   }
+
+   size_t length{ 0 };
+   std::thread::id importThread;
+};
+
+class MockImportPlugin final : public ImportPlugin
+{
+public:
+   MockImportPlugin(const FileExtension &extension, bool threadSafe)
+      : ImportPlugin{ FileExtensions{ extension } }
+      , mThreadSafe{ threadSafe }
+   {}
+
+   wxString GetPluginStringID() override { return mExtensions[0]; }
+   TranslatableString GetPluginFormatDescription() override
+   {
+      return Verbatim(mExtensions[0]);
+   }
+   bool IsThreadSafe() const override { return mThreadSafe; }
+
+   std::unique_ptr<ImportFileHandle> Open(
+      const FilePath &fileName, AudacityProject*) override
+   {
+      if (!fileName.EndsWith(wxT(".") + mExtensions[0]))
+         return nullptr;
+      return std::make_unique<MockFileHandle>(fileName);
+   }
+
+private:
+   const bool mThreadSafe;
+};
+
+Importer::RegisteredImportPlugin registeredSafe{ "MockSafe",
+   std::make_unique<MockImportPlugin>(wxT("safe"), true)
+};
+Importer::RegisteredImportPlugin registeredUnsafe{ "MockUnsafe",
+   std::make_unique<MockImportPlugin>(wxT("unsafe"), false)
+};
+
+//! Records the result, as a worker thread would
+class ResultListener final : public ImportProgressListener
+{
+public:
+   bool OnImportFileOpened(ImportFileHandle &) override { return true; }
+   void OnImportProgress(double) override {}
+   void OnImportResult(ImportResult result) override { mResult = result; }
+   ImportResult mResult{ ImportResult::Error };
+};
+
+}
+
+TEST_CASE("Importer::OpenForWorkerThread", "")
+{
+   MockedPrefs mockedPrefs;
+   auto &importer = Importer::Get();
+   REQUIRE(importer.Initialize());
+
+   SECTION("Declines files that an unsafe importer must try first")
+   {
+      REQUIRE(!importer.OpenForWorkerThread(nullptr, wxT("a.unsafe")));
+   }
+
+   SECTION("Imports files opened on the main thread concurrently")
+   {
+      const std::vector<FilePath> names{
+         wxT("a.safe"), wxT("bb.safe"), wxT("ccc.safe"), wxT("dddd.safe") };
+      std::vector<std::unique_ptr<ImportFileHandle>> files;
+      for (const auto &name : names) {
+         auto pFile = importer.OpenForWorkerThread(nullptr, name);
+         REQUIRE(pFile);
+         REQUIRE(dynamic_cast<MockFileHandle*>(pFile.get()));
+         files.push_back(std::move(pFile));
+      }
+
+      std::vector<std::future<ImportProgressListener::ImportResult>> futures;
+      for (auto &pFile : files)
+         futures.push_back(std::async(std::launch::async, [&file = *pFile]{
+            ResultListener listener;
+            TrackHolders tracks;
+            std::optional<LibFileFormats::AcidizerTags> acidTags;
+            file.Import(listener, nullptr, tracks, nullptr, acidTags);
+            return listener.mResult;
+         }));
+
+      for (size_t ii = 0; ii < names.size(); ++ii) {
+         REQUIRE(futures[ii].get() ==
+            ImportProgressListener::ImportResult::Success);
+         auto &file = static_cast<MockFileHandle&>(*files[ii]);
+         REQUIRE(file.length == names[ii].length());
+         REQUIRE(file.importThread != std::this_thread::get_id());
+      }
+   }
+
+   importer.Terminate();
+}
@@ -13,9 +13,11 @@
 #include "IPCServer.h"
 #include "IPCChannel.h"
 
+#include <cstring>
 #include <thread>
 #include <mutex>
 #include <stdexcept>
+#include <string>
 
 #include "internal/ipc-types.h"
 #include "internal/socket_guard.h"
@@ -28,6 +30,7 @@ class IPCServer::Impl
    std::unique_ptr<BufferedIPCChannel> mChannel;
    std::unique_ptr<std::thread> mConnectionRoutine;
    int mConnectPort{0};
+   std::string mSocketPath;
 
    socket_guard mListenSocket;
 public:
@@ -60,6 +63,39 @@ public:
 
       mConnectPort = ntohs(addr.sin_port);
 
+      StartConnectionRoutine(callback);
+   }
+
+#ifndef _WIN32
+   Impl(const std::string& socketPath, IPCChannelStatusCallback& callback)
+      : mSocketPath { socketPath }
+   {
+      sockaddr_un addr{};
+      addr.sun_family = AF_UNIX;
+      if(socketPath.empty() || socketPath.size() >= sizeof(addr.sun_path))
+         throw std::runtime_error("invalid socket path");
+      std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+      mListenSocket = socket_guard { socket(AF_UNIX, SOCK_STREAM, 0) };
+      if(!mListenSocket)
+         throw std::runtime_error("cannot create socket");
+
+      //replace the socket left by a previous server, if any
+      unlink(socketPath.c_str());
+      if(bind(*mListenSocket, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR)
+         throw std::runtime_error("socket bind error");
+      //connections from the same user only
+      chmod(socketPath.c_str(), S_IRUSR | S_IWUSR);
+
+      if(listen(*mListenSocket, 1) == SOCKET_ERROR)
+         throw std::runtime_error("socket listen error");
+
+      StartConnectionRoutine(callback);
+   }
+#endif
+
+   void StartConnectionRoutine(IPCChannelStatusCallback& callback)
+   {
       mChannel = std::make_unique<BufferedIPCChannel>();
       mConnectionRoutine = std::make_unique<std::thread>([this, &callback]
       {
@@ -129,6 +165,10 @@ public:
       }
       if(mConnectionRoutine)
          mConnectionRoutine->join();
+#ifndef _WIN32
+      if(!mSocketPath.empty())
+         unlink(mSocketPath.c_str());
+#endif
    }
 
 };
@@ -144,6 +184,13 @@ IPCServer::IPCServer(IPCChannelStatusCallback& callback)
    mImpl = std::make_unique<Impl>(callback);
 }
 
+#ifndef _WIN32
+IPCServer::IPCServer(const std::string& socketPath, IPCChannelStatusCallback& callback)
+   : mImpl { std::make_unique<Impl>(socketPath, callback) }
+{
+}
+#endif
+
 IPCServer::~IPCServer() = default;
 
 int IPCServer::GetConnectPort() const noexcept
@@ -13,6 +13,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 class IPCChannel;
 class IPCChannelStatusCallback;
@@ -35,12 +36,20 @@ public:
     * \param callback Channel status callback. May be accessed from working threads.
     */
    IPCServer(IPCChannelStatusCallback& callback);
+#ifndef _WIN32
+   /**
+    * \brief Same as above, but listens on a Unix domain socket, which
+    * is created at socketPath (replacing any file there) and is
+    * accessible to the current user only. The file is removed on destruction.
+    */
+   IPCServer(const std::string& socketPath, IPCChannelStatusCallback& callback);
+#endif
    /**
     * \brief Closes connection if any.
     */
    ~IPCServer();
 
-   ///Returns port number to connect to.
+   ///Returns port number to connect to, or zero for a Unix domain socket.
    ///Valid until connection is established.
    int GetConnectPort() const noexcept;
 };
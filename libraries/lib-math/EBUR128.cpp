@@ -9,13 +9,14 @@ Max Maisel
 ***********************************************************************/
 
 #include "EBUR128.h"
+#include <cassert>
 #include <cstring>
 
 EBUR128::EBUR128(double rate, size_t channels)
    : mChannelCount{ channels }
    , mRate{ rate }
-   , mBlockSize( ceil(0.4 * mRate) ) // 400 ms blocks
-   , mBlockOverlap( ceil(0.1 * mRate) ) // 100 ms overlap
+   , mBlockSize( BlockSize(mRate) ) // 400 ms blocks
+   , mBlockOverlap( BlockOverlap(mRate) ) // 100 ms overlap
 {
    mLoudnessHist.reinit(HIST_BIN_COUNT, false);
    mBlockRingBuffer.reinit(mBlockSize);
@@ -145,6 +146,18 @@ double EBUR128::IntegrativeLoudness()
    return 0.8529037031 * sum_v / sum_c;
 }
 
+void EBUR128::MergeHistogram(const EBUR128 &other)
+{
+   assert(other.mRate == mRate && other.mChannelCount == mChannelCount);
+   for(size_t i = 0; i < HIST_BIN_COUNT; ++i)
+      mLoudnessHist[i] += other.mLoudnessHist[i];
+}
+
+void EBUR128::ResetHistogram()
+{
+   memset(mLoudnessHist.get(), 0, HIST_BIN_COUNT*sizeof(long int));
+}
+
 void
 EBUR128::HistogramSums(size_t start_idx, double& sum_v, long int& sum_c) const
 {
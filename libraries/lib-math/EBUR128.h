@@ -18,7 +18,7 @@ Max Maisel
 #include <cmath>
 
 /// \brief Implements EBU-R128 loudness measurement.
-class EBUR128
+class MATH_API EBUR128
 {
 public:
    EBUR128(double rate, size_t channels);
@@ -33,6 +33,21 @@ public:
    inline double IntegrativeLoudnessToLUFS(double loudness)
       { return 10 * log10(loudness); }
 
+   /// Adds the gating block histogram of another analyser. Both must have
+   /// been constructed with the same rate and channel count.
+   /// This allows to analyse block aligned segments of one signal
+   /// independently and to combine the results afterwards.
+   void MergeHistogram(const EBUR128 &other);
+   /// Discards all gating blocks counted so far, but keeps the filter and
+   /// block ring state, so that samples processed before can serve as
+   /// warm-up for the following ones.
+   void ResetHistogram();
+
+   /// Length of the 400 ms gating blocks in samples
+   static size_t BlockSize(double rate) { return ceil(0.4 * rate); }
+   /// Distance between the starts of consecutive gating blocks in samples
+   static size_t BlockOverlap(double rate) { return ceil(0.1 * rate); }
+
 private:
    void HistogramSums(size_t start_idx, double& sum_v, long int& sum_c) const;
    void AddBlockToHistogram(size_t validLen);
@@ -0,0 +1,200 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file LoudnessAnalysis.cpp
+
+**********************************************************************/
+#include "LoudnessAnalysis.h"
+#include "EBUR128.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+//! Chunks shorter than this are not worth a task of their own
+constexpr double MinChunkSeconds = 30.0;
+//! Samples preceding a chunk that are processed but not counted, so that the
+//! weighting filters settle and the block ring is full
+constexpr double WarmUpSeconds = 1.0;
+constexpr size_t BufferSize = 65536;
+
+struct Chunk
+{
+   size_t iJob;
+   //! Zero for the first chunk of a job
+   size_t iChunk;
+   sampleCount warmUpStart;
+   sampleCount start;
+   sampleCount end;
+};
+
+struct JobResult
+{
+   std::mutex mutex;
+   //! Analyser of the first chunk, which also handles short signals
+   std::unique_ptr<EBUR128> first;
+   //! Merged histograms of all other chunks
+   std::unique_ptr<EBUR128> rest;
+};
+
+sampleCount RoundUp(sampleCount value, size_t multiple)
+{
+   return ((value + multiple - 1) / multiple) * multiple;
+}
+
+std::vector<Chunk> MakeChunks(
+   const std::vector<LoudnessAnalysisJob> &jobs, size_t nThreads)
+{
+   std::vector<Chunk> chunks;
+   for (size_t iJob = 0; iJob < jobs.size(); ++iJob) {
+      const auto &job = jobs[iJob];
+      const auto len = std::max<sampleCount>(0, job.end - job.start);
+      const auto hop = EBUR128::BlockOverlap(job.rate);
+      const auto blockSize = EBUR128::BlockSize(job.rate);
+
+      // Chunks start on multiples of the hop, so that the gating blocks seen
+      // by each chunk coincide with those of a serial analysis.  That works
+      // only if whole blocks consist of whole hops.
+      auto nChunks = sampleCount{ 1 };
+      if (hop > 0 && blockSize % hop == 0) {
+         const auto minChunk =
+            RoundUp(sampleCount(MinChunkSeconds * job.rate), hop);
+         nChunks = std::clamp<sampleCount>(
+            len / minChunk, 1, sampleCount(nThreads));
+      }
+      const auto chunkLen = (nChunks == 1)
+         ? len
+         : RoundUp((len + nChunks - 1) / nChunks, hop);
+      const auto warmUp = std::max<sampleCount>(
+         RoundUp(sampleCount(WarmUpSeconds * job.rate), hop), blockSize);
+
+      size_t iChunk = 0;
+      auto start = job.start;
+      do {
+         const auto end = std::min(job.end, start + chunkLen);
+         const auto warmUpStart =
+            (iChunk == 0) ? start : std::max(job.start, start - warmUp);
+         chunks.push_back({ iJob, iChunk, warmUpStart, start, end });
+         start = end;
+         ++iChunk;
+      } while (start < job.end);
+   }
+   return chunks;
+}
+}
+
+std::vector<double> AnalyseIntegrativeLoudness(
+   const std::vector<LoudnessAnalysisJob> &jobs,
+   const LoudnessProgressCallback &progress, size_t nThreads)
+{
+   if (nThreads == 0)
+      nThreads = std::max(1u, std::thread::hardware_concurrency());
+
+   const auto chunks = MakeChunks(jobs, nThreads);
+   std::vector<JobResult> results(jobs.size());
+
+   double totalLen = 0;
+   for (const auto &job : jobs)
+      totalLen += std::max<sampleCount>(0, job.end - job.start).as_double();
+
+   std::atomic<size_t> nextChunk{ 0 };
+   std::atomic<long long> doneLen{ 0 };
+   std::atomic<bool> cancelled{ false };
+
+   const auto analyseChunk = [&](const Chunk &chunk,
+      std::vector<std::vector<float>> &buffers)
+   {
+      const auto &job = jobs[chunk.iJob];
+      buffers.resize(job.nChannels);
+      for (auto &buffer : buffers)
+         buffer.resize(BufferSize);
+
+      auto pAnalyser = std::make_unique<EBUR128>(job.rate, job.nChannels);
+      auto &analyser = *pAnalyser;
+      const auto feed = [&](sampleCount from, sampleCount to, bool count) {
+         while (from < to) {
+            if (cancelled.load(std::memory_order_relaxed))
+               return false;
+            const auto len = limitSampleBufferSize(BufferSize, to - from);
+            for (size_t iChannel = 0; iChannel < job.nChannels; ++iChannel)
+               job.reader(iChannel, from, len, buffers[iChannel].data());
+            for (size_t i = 0; i < len; ++i) {
+               for (size_t iChannel = 0; iChannel < job.nChannels; ++iChannel)
+                  analyser.ProcessSampleFromChannel(
+                     buffers[iChannel][i], iChannel);
+               analyser.NextSample();
+            }
+            from += len;
+            if (count)
+               doneLen += len;
+         }
+         return true;
+      };
+
+      if (!feed(chunk.warmUpStart, chunk.start, false))
+         return;
+      // Blocks ending in the warm-up were counted by the preceding chunk
+      analyser.ResetHistogram();
+      if (!feed(chunk.start, chunk.end, true))
+         return;
+
+      auto &result = results[chunk.iJob];
+      std::lock_guard<std::mutex> lock{ result.mutex };
+      if (chunk.iChunk == 0)
+         result.first = std::move(pAnalyser);
+      else if (!result.rest)
+         result.rest = std::move(pAnalyser);
+      else
+         result.rest->MergeHistogram(analyser);
+   };
+
+   const auto worker = [&]{
+      std::vector<std::vector<float>> buffers;
+      try {
+         size_t iChunk;
+         while (!cancelled.load(std::memory_order_relaxed) &&
+            (iChunk = nextChunk++) < chunks.size())
+            analyseChunk(chunks[iChunk], buffers);
+      }
+      catch (...) {
+         // Stop the other workers too, then let the caller rethrow
+         cancelled = true;
+         throw;
+      }
+   };
+
+   std::vector<std::future<void>> workers;
+   const auto nWorkers = std::min(nThreads, chunks.size());
+   workers.reserve(nWorkers);
+   for (size_t i = 0; i < nWorkers; ++i)
+      workers.emplace_back(std::async(std::launch::async, worker));
+
+   using namespace std::chrono_literals;
+   for (auto &future : workers)
+      while (future.wait_for(50ms) != std::future_status::ready)
+         if (progress && !cancelled &&
+             !progress(totalLen > 0 ? doneLen / totalLen : 1.0))
+            cancelled = true;
+   // All workers are finished now; this rethrows the first exception
+   for (auto &future : workers)
+      future.get();
+
+   if (cancelled)
+      return {};
+
+   std::vector<double> loudness;
+   loudness.reserve(results.size());
+   for (auto &result : results) {
+      if (result.rest)
+         result.first->MergeHistogram(*result.rest);
+      loudness.push_back(result.first->IntegrativeLoudness());
+   }
+   return loudness;
+}
@@ -0,0 +1,58 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file LoudnessAnalysis.h
+
+  @brief Concurrent EBU R128 integrative loudness measurement of many and
+  long signals
+
+**********************************************************************/
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "SampleCount.h"
+
+//! Reads `len` samples of channel `iChannel`, beginning at `start`, into
+//! `buffer`
+/*!
+ It is called concurrently from worker threads, so it must be safe to do so.
+ It may throw; the exception is then rethrown by AnalyseIntegrativeLoudness.
+ */
+using LoudnessSampleReader = std::function<
+   void(size_t iChannel, sampleCount start, size_t len, float *buffer)>;
+
+//! Called on the thread of AnalyseIntegrativeLoudness with the fraction of
+//! work done so far
+/*! @return false to cancel the analysis */
+using LoudnessProgressCallback = std::function<bool(double fraction)>;
+
+//! Describes one signal, possibly of several channels, to measure
+struct LoudnessAnalysisJob
+{
+   double rate;
+   //! Channels whose power is summed, as in EBUR128
+   size_t nChannels;
+   sampleCount start;
+   sampleCount end;
+   LoudnessSampleReader reader;
+};
+
+//! Computes EBUR128::IntegrativeLoudness for each of the jobs
+/*!
+ Jobs are analysed concurrently.  A long signal is also split into chunks
+ aligned to the gating blocks, which are analysed concurrently, each after a
+ short warm-up with the preceding samples; the histograms of the chunks are
+ then merged.
+
+ @param nThreads number of worker threads, or zero to use as many as there
+ are hardware threads
+ @return one value per job, in the order of the jobs, or an empty vector if
+ the analysis was cancelled
+ */
+MATH_API std::vector<double> AnalyseIntegrativeLoudness(
+   const std::vector<LoudnessAnalysisJob> &jobs,
+   const LoudnessProgressCallback &progress = {}, size_t nThreads = 0);
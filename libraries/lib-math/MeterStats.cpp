@@ -0,0 +1,131 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MeterStats.cpp
+
+**********************************************************************/
+#include "MeterStats.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+//! Number of accumulators, a multiple of the widest vector of floats
+constexpr size_t Width = 32;
+
+//! Rows accumulated before the float sums are added into the totals, few
+//! enough that counts of clipped samples stay exact
+constexpr size_t ChunkRows = 4096;
+
+//! Accumulates `nRows` rows of `width` contiguous samples, `stride` apart
+void Accumulate(const float * __restrict samples,
+   size_t stride, size_t width, size_t nRows,
+   float * __restrict peak, float * __restrict sum,
+   float * __restrict count, float clipLevel)
+{
+   for (size_t row = 0; row < nRows; ++row, samples += stride)
+      for (size_t k = 0; k < width; ++k) {
+         const auto x = samples[k];
+         const auto a = std::fabs(x);
+         peak[k] = a > peak[k] ? a : peak[k];
+         sum[k] += x * x;
+         count[k] += a >= clipLevel ? 1.0f : 0.0f;
+      }
+}
+
+//! Accumulates `nRows` rows, and adds lane `k` into the statistics of channel
+//! `firstChannel + k % period`; sums of squares are left in the rms fields
+void AccumulateRows(const float *samples,
+   size_t stride, size_t width, size_t nRows,
+   size_t firstChannel, size_t period,
+   size_t nStats, MeterStats *stats, float clipLevel)
+{
+   if (nRows == 0)
+      return;
+   float peak[Width]{};
+   double total[Width]{};
+   size_t counts[Width]{};
+   for (size_t row = 0; row < nRows; row += ChunkRows) {
+      float sum[Width]{};
+      float count[Width]{};
+      Accumulate(samples + row * stride, stride, width,
+         std::min(ChunkRows, nRows - row), peak, sum, count, clipLevel);
+      for (size_t k = 0; k < width; ++k) {
+         total[k] += sum[k];
+         counts[k] += static_cast<size_t>(count[k]);
+      }
+   }
+   for (size_t k = 0; k < width; ++k) {
+      const auto iChannel = firstChannel + k % period;
+      if (iChannel >= nStats)
+         continue;
+      auto &channelStats = stats[iChannel];
+      channelStats.peak = std::max(channelStats.peak, peak[k]);
+      channelStats.rms += total[k];
+      channelStats.peakCount += counts[k];
+   }
+}
+
+void FindPeakRuns(const float *samples, size_t nChannels, size_t nFrames,
+   MeterStats &stats, float clipLevel)
+{
+   if (stats.peakCount == nFrames) {
+      stats.headPeakCount = stats.tailPeakCount = stats.longestPeakRun =
+         nFrames;
+      return;
+   }
+   size_t run = 0;
+   bool inHead = true;
+   for (size_t ii = 0; ii < nFrames; ++ii, samples += nChannels) {
+      if (std::fabs(*samples) >= clipLevel) {
+         ++run;
+         stats.longestPeakRun = std::max(stats.longestPeakRun, run);
+      }
+      else {
+         if (inHead)
+            stats.headPeakCount = run;
+         inHead = false;
+         run = 0;
+      }
+   }
+   stats.tailPeakCount = run;
+}
+}
+
+void ComputeMeterStats(const float *samples,
+   size_t nChannels, size_t nFrames,
+   size_t nStats, MeterStats *stats, float clipLevel)
+{
+   std::fill(stats, stats + nStats, MeterStats{});
+   if (nStats == 0 || nFrames == 0)
+      return;
+
+   if (nChannels <= Width) {
+      // Rows of several whole frames, so that all lanes are used even when
+      // there are few channels, then the remaining frames one at a time
+      const auto framesPerRow = Width / nChannels;
+      const auto width = framesPerRow * nChannels;
+      const auto nRows = nFrames / framesPerRow;
+      AccumulateRows(samples, width, width, nRows,
+         0, nChannels, nStats, stats, clipLevel);
+      AccumulateRows(samples + nRows * width, nChannels, nChannels,
+         nFrames - nRows * framesPerRow,
+         0, nChannels, nStats, stats, clipLevel);
+   }
+   else
+      // One frame per row, in groups of channels
+      for (size_t iChannel = 0; iChannel < nStats; iChannel += Width)
+         AccumulateRows(samples + iChannel, nChannels,
+            std::min(Width, nStats - iChannel), nFrames,
+            iChannel, Width, nStats, stats, clipLevel);
+
+   for (size_t iChannel = 0; iChannel < nStats; ++iChannel) {
+      auto &channelStats = stats[iChannel];
+      channelStats.rms = std::sqrt(channelStats.rms / nFrames);
+      if (channelStats.peakCount > 0)
+         FindPeakRuns(samples + iChannel, nChannels, nFrames,
+            channelStats, clipLevel);
+   }
+}
@@ -0,0 +1,43 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MeterStats.h
+
+  @brief Peak, RMS and clipping of blocks of interleaved samples, for meters
+
+**********************************************************************/
+#pragma once
+
+#include <cstddef>
+
+//! Statistics of one channel of a block of samples
+struct MeterStats
+{
+   //! Largest absolute value
+   float peak{};
+   float rms{};
+   //! Number of samples whose absolute value reached the clipping level
+   size_t peakCount{};
+   //! Length of the run of such samples at the start of the block
+   size_t headPeakCount{};
+   //! Length of the run of such samples at the end of the block
+   size_t tailPeakCount{};
+   //! Length of the longest run of such samples within the block
+   size_t longestPeakRun{};
+};
+
+//! Computes statistics of the first `nStats` of `nChannels` interleaved
+//! channels of `nFrames` frames
+/*!
+ The peak, sum of squares and count of clipped samples are accumulated in
+ branch-free loops over contiguous samples, which the compiler vectorizes.
+ Runs of clipped samples are found by a scalar pass only over the channels
+ that have any.
+
+ @pre `nStats <= nChannels`
+ */
+MATH_API void ComputeMeterStats(const float *samples,
+   size_t nChannels, size_t nFrames,
+   size_t nStats, MeterStats *stats, float clipLevel);
@@ -0,0 +1,99 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  LoudnessAnalysisTests.cpp
+
+**********************************************************************/
+#include "EBUR128.h"
+#include "LoudnessAnalysis.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+constexpr auto rate = 8000.0;
+
+std::vector<float> MakeSignal(size_t len, unsigned seed)
+{
+   std::mt19937 gen{ seed };
+   std::uniform_real_distribution<float> noise{ -0.1f, 0.1f };
+   std::vector<float> signal(len);
+   for (size_t i = 0; i < len; ++i)
+      // Slowly varying level, so that the gating matters
+      signal[i] = (0.5 + 0.4 * std::sin(i / (7.3 * rate))) *
+         std::sin(2 * M_PI * 440 * i / rate) + noise(gen);
+   return signal;
+}
+
+double SerialLoudness(const std::vector<std::vector<float>> &channels)
+{
+   EBUR128 analyser{ rate, channels.size() };
+   for (size_t i = 0; i < channels[0].size(); ++i) {
+      for (size_t iChannel = 0; iChannel < channels.size(); ++iChannel)
+         analyser.ProcessSampleFromChannel(channels[iChannel][i], iChannel);
+      analyser.NextSample();
+   }
+   return analyser.IntegrativeLoudness();
+}
+
+LoudnessAnalysisJob MakeJob(const std::vector<std::vector<float>> &channels)
+{
+   return { rate, channels.size(), 0, channels[0].size(),
+      [&](size_t iChannel, sampleCount start, size_t len, float *buffer) {
+         std::copy_n(
+            channels[iChannel].begin() + start.as_long_long(), len, buffer);
+      }
+   };
+}
+}
+
+TEST_CASE("AnalyseIntegrativeLoudness")
+{
+   const std::vector<std::vector<float>> mono{ MakeSignal(200 * rate, 1) };
+   const std::vector<std::vector<float>> stereo{
+      MakeSignal(95 * rate, 2), MakeSignal(95 * rate, 3) };
+   const std::vector<std::vector<float>> shortMono{ MakeSignal(rate / 4, 4) };
+
+   const auto expected = std::vector<double>{
+      SerialLoudness(mono), SerialLoudness(stereo), SerialLoudness(shortMono) };
+
+   SECTION("chunked analysis agrees with serial analysis")
+   {
+      for (const auto nThreads : { 1, 2, 4, 16 }) {
+         const auto result = AnalyseIntegrativeLoudness(
+            { MakeJob(mono), MakeJob(stereo), MakeJob(shortMono) }, {},
+            nThreads);
+         REQUIRE(result.size() == expected.size());
+         for (size_t i = 0; i < expected.size(); ++i)
+            REQUIRE(result[i] == Approx(expected[i]).epsilon(1e-6));
+      }
+   }
+
+   SECTION("cancellation yields no result")
+   {
+      auto job = MakeJob(mono);
+      job.reader = [](size_t, sampleCount, size_t, float *) {
+         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      };
+      const auto result = AnalyseIntegrativeLoudness(
+         { job }, [](double) { return false; }, 2);
+      REQUIRE(result.empty());
+   }
+
+   SECTION("exceptions of the reader propagate")
+   {
+      auto job = MakeJob(mono);
+      job.reader = [](size_t, sampleCount, size_t, float *) {
+         throw std::runtime_error{ "read error" };
+      };
+      REQUIRE_THROWS_AS(
+         AnalyseIntegrativeLoudness({ job }, {}, 4), std::runtime_error);
+   }
+}
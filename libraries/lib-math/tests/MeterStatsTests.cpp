@@ -0,0 +1,116 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MeterStatsTests.cpp
+
+**********************************************************************/
+#include "MeterStats.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+constexpr float clipLevel = 1.0f - 1.0f / (1 << 15);
+
+//! The per-sample loop that MeterPanel used
+std::vector<MeterStats> ReferenceStats(const std::vector<float> &samples,
+   size_t nChannels, size_t nStats)
+{
+   const auto nFrames = samples.size() / nChannels;
+   std::vector<MeterStats> stats(nStats);
+   std::vector<double> sums(nStats);
+   for (size_t i = 0; i < nFrames; ++i)
+      for (size_t j = 0; j < nStats; ++j) {
+         const auto x = samples[i * nChannels + j];
+         auto &s = stats[j];
+         s.peak = std::max(s.peak, std::fabs(x));
+         sums[j] += x * x;
+         if (std::fabs(x) >= clipLevel) {
+            ++s.peakCount;
+            if (s.headPeakCount == i)
+               ++s.headPeakCount;
+            ++s.tailPeakCount;
+            s.longestPeakRun = std::max(s.longestPeakRun, s.tailPeakCount);
+         }
+         else
+            s.tailPeakCount = 0;
+      }
+   for (size_t j = 0; j < nStats; ++j)
+      stats[j].rms = nFrames ? std::sqrt(sums[j] / nFrames) : 0;
+   return stats;
+}
+
+std::vector<float> MakeSamples(size_t nChannels, size_t nFrames, unsigned seed)
+{
+   std::mt19937 gen{ seed };
+   std::uniform_real_distribution<float> level{ -1.2f, 1.2f };
+   std::uniform_int_distribution<int> clip{ 0, 9 };
+   std::vector<float> samples(nChannels * nFrames);
+   for (auto &sample : samples)
+      // Clip in runs, sometimes
+      sample = clip(gen) < 3 ? 1.0f : level(gen) * 0.8f;
+   return samples;
+}
+
+void Check(const std::vector<float> &samples, size_t nChannels, size_t nStats)
+{
+   const auto nFrames = samples.size() / nChannels;
+   const auto expected = ReferenceStats(samples, nChannels, nStats);
+   std::vector<MeterStats> stats(nStats);
+   ComputeMeterStats(samples.data(), nChannels, nFrames,
+      nStats, stats.data(), clipLevel);
+   for (size_t j = 0; j < nStats; ++j) {
+      REQUIRE(stats[j].peak == expected[j].peak);
+      REQUIRE(stats[j].rms == Approx(expected[j].rms).epsilon(1e-5));
+      REQUIRE(stats[j].peakCount == expected[j].peakCount);
+      REQUIRE(stats[j].headPeakCount == expected[j].headPeakCount);
+      REQUIRE(stats[j].tailPeakCount == expected[j].tailPeakCount);
+      REQUIRE(stats[j].longestPeakRun == expected[j].longestPeakRun);
+   }
+}
+}
+
+TEST_CASE("ComputeMeterStats")
+{
+   SECTION("matches the per-sample loop for any layout")
+   {
+      for (const size_t nChannels : { 1, 2, 3, 7, 32, 64, 65, 100 })
+         for (const size_t nFrames : { 0, 1, 5, 32, 513, 10000 })
+            Check(MakeSamples(nChannels, nFrames, nChannels + nFrames),
+               nChannels, nChannels);
+   }
+
+   SECTION("analyses only the first channels when asked")
+   {
+      Check(MakeSamples(32, 32, 7), 32, 2);
+      Check(MakeSamples(100, 50, 8), 100, 70);
+   }
+
+   SECTION("finds runs of clipped samples")
+   {
+      std::vector<float> samples(100, 0.5f);
+      std::fill(samples.begin(), samples.begin() + 3, -1.0f);
+      std::fill(samples.begin() + 40, samples.begin() + 50, 1.0f);
+      std::fill(samples.end() - 4, samples.end(), 1.0f);
+      MeterStats stats;
+      ComputeMeterStats(samples.data(), 1, samples.size(), 1, &stats,
+         clipLevel);
+      REQUIRE(stats.peak == 1.0f);
+      REQUIRE(stats.peakCount == 17);
+      REQUIRE(stats.headPeakCount == 3);
+      REQUIRE(stats.tailPeakCount == 4);
+      REQUIRE(stats.longestPeakRun == 10);
+
+      std::fill(samples.begin(), samples.end(), 1.0f);
+      ComputeMeterStats(samples.data(), 1, samples.size(), 1, &stats,
+         clipLevel);
+      REQUIRE(stats.headPeakCount == 100);
+      REQUIRE(stats.tailPeakCount == 100);
+      REQUIRE(stats.longestPeakRun == 100);
+   }
+}
@@ -30,6 +30,7 @@ a draggable point type.
 #include "Envelope.h"
 
 #include <float.h>
+#include <limits>
 #include <math.h>
 
 #include <wx/wxcrtvararg.h>
@@ -1305,6 +1306,157 @@ double Envelope::IntegralOfInverse( double t0, double t1 ) const
    }
 }
 
+EnvelopeInverseIntegrals::EnvelopeInverseIntegrals(const Envelope &envelope)
+   : mOffset{ envelope.GetOffset() }
+   // An empty envelope has this value everywhere
+   , mDefaultValue{ envelope.GetValue(envelope.GetOffset()) }
+   , mDB{ envelope.GetExponential() }
+{
+   const auto count = envelope.GetNumberOfPoints();
+   mTimes.reserve(count);
+   mValues.reserve(count);
+   mIntegrals.reserve(count);
+   for (size_t i = 0; i < count; ++i) {
+      mTimes.push_back(envelope[i].GetT());
+      mValues.push_back(envelope[i].GetVal());
+      mIntegrals.push_back(i == 0 ? 0.0
+         : mIntegrals[i - 1] + IntegrateInverseInterpolated(
+            mValues[i - 1], mValues[i], mTimes[i] - mTimes[i - 1], mDB));
+   }
+
+   // Find constant spans, forward for the starts, backward for the ends
+   const int nSegments = count + 1;
+   const auto infinity = std::numeric_limits<double>::infinity();
+   mSpanStarts.resize(nSegments, infinity);
+   mSpanEnds.resize(nSegments, -infinity);
+   for (int iSegment = -1; iSegment < nSegments - 1; ++iSegment)
+      if (IsConstant(iSegment))
+         mSpanStarts[iSegment + 1] =
+            (iSegment >= 0 && IsConstant(iSegment - 1))
+               ? mSpanStarts[iSegment]
+               : (iSegment < 0 ? -infinity : mTimes[iSegment]);
+   for (int iSegment = nSegments - 2; iSegment >= -1; --iSegment)
+      if (IsConstant(iSegment))
+         mSpanEnds[iSegment + 1] =
+            (iSegment + 1 < nSegments - 1 && IsConstant(iSegment + 1))
+               ? mSpanEnds[iSegment + 2]
+               : (iSegment + 1 < nSegments - 1
+                  ? mTimes[iSegment + 1] : infinity);
+}
+
+bool EnvelopeInverseIntegrals::IsConstant(int iSegment) const
+{
+   // Before the first point and after the last, the value is constant
+   return iSegment < 0 || iSegment + 1 >= (int)mTimes.size() ||
+      mValues[iSegment] == mValues[iSegment + 1];
+}
+
+int EnvelopeInverseIntegrals::SegmentAt(double t) const
+{
+   return std::upper_bound(mTimes.begin(), mTimes.end(), t)
+      - mTimes.begin() - 1;
+}
+
+int EnvelopeInverseIntegrals::SegmentBefore(double t) const
+{
+   return std::lower_bound(mTimes.begin(), mTimes.end(), t)
+      - mTimes.begin() - 1;
+}
+
+double EnvelopeInverseIntegrals::ValueAt(int iSegment, double t) const
+{
+   const auto t0 = mTimes[iSegment], t1 = mTimes[iSegment + 1];
+   return InterpolatePoints(mValues[iSegment], mValues[iSegment + 1],
+      (t - t0) / (t1 - t0), mDB);
+}
+
+double EnvelopeInverseIntegrals::IntegralTo(double t) const
+{
+   const auto iSegment = SegmentAt(t);
+   if (iSegment < 0)
+      return (t - mTimes[0]) / mValues[0];
+   const auto t0 = mTimes[iSegment];
+   if (iSegment + 1 == (int)mTimes.size())
+      return mIntegrals[iSegment] + (t - t0) / mValues[iSegment];
+   return mIntegrals[iSegment] + IntegrateInverseInterpolated(
+      mValues[iSegment], ValueAt(iSegment, t), t - t0, mDB);
+}
+
+double EnvelopeInverseIntegrals::IntegralOfInverse(double t0, double t1) const
+{
+   if (t0 == t1)
+      return 0.0;
+   if (t0 > t1)
+      return -IntegralOfInverse(t1, t0);
+   if (mTimes.empty())
+      return (t1 - t0) / mDefaultValue;
+
+   t0 -= mOffset;
+   t1 -= mOffset;
+
+   // Within one segment, integrate directly, for best precision
+   const auto iSegment = SegmentAt(t0);
+   if (iSegment == SegmentAt(t1)) {
+      if (iSegment < 0)
+         return (t1 - t0) / mValues[0];
+      if (iSegment + 1 == (int)mTimes.size())
+         return (t1 - t0) / mValues[iSegment];
+      return IntegrateInverseInterpolated(
+         ValueAt(iSegment, t0), ValueAt(iSegment, t1), t1 - t0, mDB);
+   }
+   return IntegralTo(t1) - IntegralTo(t0);
+}
+
+double EnvelopeInverseIntegrals::AverageOfInverse(double t0, double t1) const
+{
+   if (t0 == t1) {
+      if (mTimes.empty())
+         return 1.0 / mDefaultValue;
+      const auto t = t0 - mOffset;
+      const auto iSegment = SegmentAt(t);
+      return 1.0 / (iSegment < 0 ? mValues[0]
+         : iSegment + 1 == (int)mTimes.size() ? mValues[iSegment]
+         : ValueAt(iSegment, t));
+   }
+   return IntegralOfInverse(t0, t1) / (t1 - t0);
+}
+
+std::optional<double> EnvelopeInverseIntegrals::ConstantValue() const
+{
+   return ConstantValue(
+      -std::numeric_limits<double>::infinity(),
+      std::numeric_limits<double>::infinity());
+}
+
+std::optional<double>
+EnvelopeInverseIntegrals::ConstantValue(double t0, double t1) const
+{
+   if (t0 > t1)
+      std::swap(t0, t1);
+   if (mTimes.empty())
+      return mDefaultValue;
+   const auto iSegment = SegmentAt(t0 - mOffset);
+   if (IsConstant(iSegment) && mSpanEnds[iSegment + 1] >= t1 - mOffset)
+      return mValues[std::max(0, iSegment)];
+   return {};
+}
+
+double EnvelopeInverseIntegrals::ConstantUntil(double t) const
+{
+   if (mTimes.empty())
+      return std::numeric_limits<double>::infinity();
+   const auto iSegment = SegmentAt(t - mOffset);
+   return IsConstant(iSegment) ? mSpanEnds[iSegment + 1] + mOffset : t;
+}
+
+double EnvelopeInverseIntegrals::ConstantSince(double t) const
+{
+   if (mTimes.empty())
+      return -std::numeric_limits<double>::infinity();
+   const auto iSegment = SegmentBefore(t - mOffset);
+   return IsConstant(iSegment) ? mSpanStarts[iSegment + 1] + mOffset : t;
+}
+
 double Envelope::SolveIntegralOfInverse( double t0, double area ) const
 {
    if(area == 0.0)
@@ -13,6 +13,7 @@
 
 #include <stdlib.h>
 #include <algorithm>
+#include <optional>
 #include <vector>
 
 #include "XMLTagHandler.h"
@@ -259,6 +260,68 @@ private:
    mutable int mSearchGuess { -2 };
 };
 
+//! A snapshot of an Envelope, with prefix sums of the integral of its inverse
+//! at the control points
+/*!
+ This computes Envelope::IntegralOfInverse in time logarithmic, not linear, in
+ the number of points; and finds the spans where the envelope is constant, as
+ a time warp often is for long stretches.
+
+ It does not follow later changes in the envelope.  Results may differ from
+ those of Envelope in the last bits, because of different order of summation.
+ */
+class MIXER_API EnvelopeInverseIntegrals final {
+public:
+   explicit EnvelopeInverseIntegrals(const Envelope &envelope);
+
+   //! Same as Envelope::IntegralOfInverse
+   double IntegralOfInverse(double t0, double t1) const;
+   //! Same as Envelope::AverageOfInverse
+   double AverageOfInverse(double t0, double t1) const;
+
+   //! The value of the envelope, if it is constant between t0 and t1,
+   //! inclusive; they may be given in either order
+   std::optional<double> ConstantValue(double t0, double t1) const;
+   //! The value of the envelope, if it is constant everywhere
+   std::optional<double> ConstantValue() const;
+
+   //! End of the span beginning at t, in which the envelope is constant
+   /*! @return t if the envelope is not constant just after t; may be infinite
+    */
+   double ConstantUntil(double t) const;
+   //! Start of the span ending at t, in which the envelope is constant
+   /*! @return t if the envelope is not constant just before t; may be
+    infinite */
+   double ConstantSince(double t) const;
+
+private:
+   // All times below are relative to the offset of the envelope
+
+   //! Index of the last point not after t, or -1
+   int SegmentAt(double t) const;
+   //! Index of the last point before t, or -1
+   int SegmentBefore(double t) const;
+   //! Whether the envelope is constant from point iSegment to the next,
+   //! or before the first point if iSegment is -1
+   bool IsConstant(int iSegment) const;
+   //! @pre `0 <= iSegment && iSegment + 1 < mTimes.size()`
+   double ValueAt(int iSegment, double t) const;
+   //! Integral from the first point to t
+   double IntegralTo(double t) const;
+
+   std::vector<double> mTimes;
+   std::vector<double> mValues;
+   //! Integral of the inverse from the first point to each point
+   std::vector<double> mIntegrals;
+   //! For each segment from -1, the bounds of the constant span containing
+   //! it, if it is constant; shifted by one in the array
+   std::vector<double> mSpanStarts;
+   std::vector<double> mSpanEnds;
+   const double mOffset;
+   const double mDefaultValue;
+   const bool mDB;
+};
+
 inline void EnvPoint::SetVal( Envelope *pEnvelope, double val )
 {
    if ( pEnvelope )
@@ -195,7 +195,7 @@ Mixer::NeedsDither(bool needsDither, double rate) const
    // needsDither may already be given as true.
    // There are many other possible disqualifiers for the avoidance of dither.
    if (std::any_of(mSources.begin(), mSources.end(),
-      std::mem_fn(&MixerSource::VariableRates))
+      std::mem_fn(&MixerSource::Resamples))
    )
       // We will call MixVariableRates(), so we need nontrivial resampling
       needsDither = true;
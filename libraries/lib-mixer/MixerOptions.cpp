@@ -39,7 +39,9 @@ MixerOptions::ResampleParameters::ResampleParameters(bool highQuality,
 )  : mHighQuality{ highQuality }
 {
    double factor = (outRate / inRate);
-   if (const auto envelope = options.envelope) {
+   if (const auto envelope = options.envelope;
+      envelope && !EnvelopeInverseIntegrals{ *envelope }.ConstantValue()
+   ) {
       // variable rate resampling
       mVariableRates = true;
       mMinFactor = factor / envelope->GetRangeUpper();
@@ -52,7 +54,9 @@ MixerOptions::ResampleParameters::ResampleParameters(bool highQuality,
       mMaxFactor = factor / options.minSpeed;
    }
    else {
-      // constant rate resampling
+      // constant rate resampling, possibly with a time warp that is constant
+      if (envelope)
+         factor /= envelope->GetValue(envelope->GetOffset());
       mVariableRates = false;
       mMinFactor = factor;
       mMaxFactor = factor;
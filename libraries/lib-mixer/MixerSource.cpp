@@ -58,7 +58,8 @@ namespace {
     * @param t1 The ending time to calculate to
     * @return The relative length increase of the chosen segment from the original sound.
     */
-double ComputeWarpFactor(const Envelope &env, double t0, double t1)
+double ComputeWarpFactor(
+   const EnvelopeInverseIntegrals &env, double t0, double t1)
 {
    return env.AverageOfInverse(t0, t1);
 }
@@ -157,9 +158,19 @@ size_t MixerSource::MixVariableRates(
       if (last) {
          thisProcessLen = queueLen;
       }
+      else if (mpWarp) {
+         // Where the warp is constant, the factor is too; then resample all
+         // of the queue that is within the constant span at once
+         const auto bound = backwards
+            ? (t + tstep - mpWarp->ConstantSince(t + tstep)) * sequenceRate
+            : (mpWarp->ConstantUntil(t) - t) * sequenceRate;
+         if (bound > thisProcessLen)
+            thisProcessLen = static_cast<size_t>(
+               std::min<double>(queueLen, bound));
+      }
 
       double factor = initialWarp;
-      if (mEnvelope)
+      if (mpWarp)
       {
          //TODO-MB: The end time is wrong when the resampler doesn't use all input samples,
          //         as a result of this the warp factor may be slightly wrong, so AudioIO will stop too soon
@@ -167,10 +178,10 @@ size_t MixerSource::MixVariableRates(
          //         without changing the way the resampler works, because the number of input samples that will be used
          //         is unpredictable. Maybe it can be compensated later though.
          if (backwards)
-            factor *= ComputeWarpFactor( *mEnvelope,
+            factor *= ComputeWarpFactor( *mpWarp,
                t - (double)thisProcessLen / sequenceRate + tstep, t + tstep);
          else
-            factor *= ComputeWarpFactor( *mEnvelope,
+            factor *= ComputeWarpFactor( *mpWarp,
                t, t + (double)thisProcessLen / sequenceRate);
       }
 
@@ -295,6 +306,8 @@ MixerSource::MixerSource(
    , mnChannels{ mpSeq->NChannels() }
    , mRate{ rate }
    , mEnvelope{ options.envelope }
+   , mpWarp{ mEnvelope
+      ? std::make_shared<EnvelopeInverseIntegrals>(*mEnvelope) : nullptr }
    , mMayThrow{ mayThrow }
    , mTimesAndSpeed{ move(pTimesAndSpeed) }
    , mSampleQueue{ initVector<float>(mnChannels, sQueueMaxLen) }
@@ -313,6 +326,13 @@ MixerSource::MixerSource(
 
 MixerSource::~MixerSource() = default;
 
+bool MixerSource::Resamples() const
+{
+   // Factors include the ratio of sample rates
+   return mResampleParameters.mVariableRates ||
+      mResampleParameters.mMinFactor != 1.0;
+}
+
 const WideSampleSequence &MixerSource::GetSequence() const
 {
    return *mpSeq;
@@ -353,7 +373,7 @@ std::optional<size_t> MixerSource::Acquire(Buffers &data, size_t bound)
    for (size_t j = 0; j < limit; ++j)
       pFloats[j] = &data.GetWritePosition(j);
    const auto rate = GetSequence().GetRate();
-   auto result = (mResampleParameters.mVariableRates || rate != mRate)
+   auto result = Resamples()
       ? MixVariableRates(limit, bound, pFloats)
       : MixSameRate(limit, bound, pFloats);
    maxTrack = std::max(maxTrack, result);
@@ -19,6 +19,7 @@
 #include "SampleCount.h"
 #include <memory>
 
+class EnvelopeInverseIntegrals;
 class Resample;
 class SampleTrack;
 class WideSampleSequence;
@@ -63,6 +64,9 @@ public:
    void Reposition(double time, bool skipping);
 
    bool VariableRates() const { return mResampleParameters.mVariableRates; }
+   //! Whether samples are resampled, at constant or variable rate, which
+   //! happens also for a time warp that is constant but not 1
+   bool Resamples() const;
 
 private:
    void MakeResamplers();
@@ -70,6 +74,9 @@ private:
    //! Cut the queue into blocks of this finer size
    //! for variable rate resampling.  Each block is resampled at some
    //! constant rate.
+   /*!
+    Where the time warp is constant, longer blocks are resampled.
+    */
    static constexpr size_t sProcessLen = 1024;
 
    //! This is the number of samples grabbed in one go from a track
@@ -105,6 +112,8 @@ private:
 
    //! Resampling, as needed, after gain envelope
    const BoundedEnvelope *const mEnvelope; // for time warp which also resamples
+   //! Snapshot of mEnvelope for quick computation of warp factors
+   std::shared_ptr<const EnvelopeInverseIntegrals> mpWarp;
    const bool mMayThrow;
 
    const std::shared_ptr<TimesAndSpeed> mTimesAndSpeed;
@@ -0,0 +1,85 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  EnvelopeInverseIntegralsTests.cpp
+
+**********************************************************************/
+#include "Envelope.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <limits>
+
+namespace {
+Envelope MakeEnvelope(bool exponential)
+{
+   Envelope envelope{ exponential, 0.1, 10.0, 1.0 };
+   envelope.SetOffset(2.0);
+   envelope.SetTrackLen(10.0);
+   // Constant, rising, constant, a jump, falling, constant
+   envelope.InsertOrReplace(3.0, 0.5);
+   envelope.InsertOrReplace(4.0, 0.5);
+   envelope.InsertOrReplace(5.0, 2.0);
+   envelope.InsertOrReplace(6.0, 2.0);
+   envelope.InsertOrReplace(7.0, 2.0);
+   // Relative time
+   envelope.Insert(5.0, 3.0);
+   envelope.InsertOrReplace(9.0, 1.5);
+   return envelope;
+}
+}
+
+TEST_CASE("EnvelopeInverseIntegrals agrees with Envelope")
+{
+   for (const auto exponential : { false, true }) {
+      const auto envelope = MakeEnvelope(exponential);
+      const EnvelopeInverseIntegrals integrals{ envelope };
+      for (double t0 = 0.0; t0 < 12.0; t0 += 0.37)
+         for (double t1 = 0.0; t1 < 12.0; t1 += 0.53) {
+            REQUIRE(integrals.IntegralOfInverse(t0, t1) ==
+               Approx(envelope.IntegralOfInverse(t0, t1)).margin(1e-12));
+            REQUIRE(integrals.AverageOfInverse(t0, t1) ==
+               Approx(envelope.AverageOfInverse(t0, t1)).margin(1e-12));
+         }
+   }
+}
+
+TEST_CASE("EnvelopeInverseIntegrals finds constant spans")
+{
+   const auto envelope = MakeEnvelope(false);
+   const EnvelopeInverseIntegrals integrals{ envelope };
+   const auto infinity = std::numeric_limits<double>::infinity();
+
+   REQUIRE(!integrals.ConstantValue());
+   REQUIRE(integrals.ConstantValue(0.0, 4.0) == 0.5);
+   REQUIRE(integrals.ConstantValue(4.0, 0.0) == 0.5);
+   REQUIRE(!integrals.ConstantValue(3.5, 4.5));
+   REQUIRE(integrals.ConstantValue(5.5, 6.5) == 2.0);
+   REQUIRE(!integrals.ConstantValue(6.5, 7.5));
+   REQUIRE(integrals.ConstantValue(12.0, 20.0) == 1.5);
+
+   REQUIRE(integrals.ConstantUntil(0.0) == 4.0);
+   REQUIRE(integrals.ConstantUntil(4.5) == 4.5);
+   REQUIRE(integrals.ConstantUntil(5.0) == 7.0);
+   REQUIRE(integrals.ConstantUntil(7.0) == 7.0);
+   REQUIRE(integrals.ConstantUntil(11.5) == infinity);
+   REQUIRE(integrals.ConstantSince(4.0) == -infinity);
+   REQUIRE(integrals.ConstantSince(4.5) == 4.5);
+   REQUIRE(integrals.ConstantSince(7.0) == 5.0);
+   REQUIRE(integrals.ConstantSince(9.0) == 9.0);
+   REQUIRE(integrals.ConstantSince(11.5) == 9.0);
+}
+
+TEST_CASE("EnvelopeInverseIntegrals of a flat envelope")
+{
+   Envelope envelope{ false, 0.1, 10.0, 4.0 };
+   const EnvelopeInverseIntegrals integrals{ envelope };
+   REQUIRE(integrals.ConstantValue() == 4.0);
+   REQUIRE(integrals.IntegralOfInverse(1.0, 3.0) == 0.5);
+   REQUIRE(integrals.IntegralOfInverse(3.0, 1.0) == -0.5);
+   REQUIRE(integrals.ConstantUntil(1.0) ==
+      std::numeric_limits<double>::infinity());
+}
@@ -0,0 +1,79 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BufferedMirAudioReader.cpp
+
+**********************************************************************/
+#include "BufferedMirAudioReader.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace MIR
+{
+namespace
+{
+// 64-bit FNV-1a
+constexpr uint64_t fnvOffsetBasis = 14695981039346656037ull;
+constexpr uint64_t fnvPrime = 1099511628211ull;
+
+uint64_t Hash(uint64_t hash, const void* data, size_t size)
+{
+   const auto bytes = static_cast<const unsigned char*>(data);
+   for (size_t i = 0; i < size; ++i)
+      hash = (hash ^ bytes[i]) * fnvPrime;
+   return hash;
+}
+} // namespace
+
+BufferedMirAudioReader::BufferedMirAudioReader(
+   const MirAudioReader& source, double maxDuration)
+    : mSampleRate { source.GetSampleRate() }
+    , mNumSamples { source.GetNumSamples() }
+{
+   if (source.GetDuration() > maxDuration)
+      return;
+   mSamples.resize(mNumSamples);
+   constexpr auto blockSize = 65536ll;
+   for (long long start = 0; start < mNumSamples; start += blockSize)
+      source.ReadFloats(
+         mSamples.data() + start, start,
+         std::min(blockSize, mNumSamples - start));
+   mContentHash = Hash(fnvOffsetBasis, &mSampleRate, sizeof(mSampleRate));
+   mContentHash =
+      Hash(mContentHash, mSamples.data(), mSamples.size() * sizeof(float));
+}
+
+double BufferedMirAudioReader::GetSampleRate() const
+{
+   return mSampleRate;
+}
+
+long long BufferedMirAudioReader::GetNumSamples() const
+{
+   return mNumSamples;
+}
+
+void BufferedMirAudioReader::ReadFloats(
+   float* buffer, long long start, size_t numFrames) const
+{
+   assert(HasSamples());
+   assert(start >= 0);
+   assert(start + numFrames <= mSamples.size());
+   std::copy(
+      mSamples.begin() + start, mSamples.begin() + start + numFrames, buffer);
+}
+
+bool BufferedMirAudioReader::HasSamples() const
+{
+   return static_cast<long long>(mSamples.size()) == mNumSamples;
+}
+
+uint64_t BufferedMirAudioReader::GetContentHash() const
+{
+   assert(HasSamples());
+   return mContentHash;
+}
+} // namespace MIR
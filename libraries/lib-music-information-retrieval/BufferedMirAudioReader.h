@@ -0,0 +1,52 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BufferedMirAudioReader.h
+
+**********************************************************************/
+#pragma once
+
+#include "MirTypes.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace MIR
+{
+/*!
+ * @brief A copy of the samples of another reader, which may then be read from
+ * any thread, whatever happens to the original
+ */
+class MUSIC_INFORMATION_RETRIEVAL_API BufferedMirAudioReader final :
+    public MirAudioReader
+{
+public:
+   /*!
+    * @param maxDuration if `source` is longer than this, in seconds, its
+    * samples are not copied, and `ReadFloats` must not be called
+    */
+   BufferedMirAudioReader(const MirAudioReader& source, double maxDuration);
+
+   double GetSampleRate() const override;
+   long long GetNumSamples() const override;
+   void
+   ReadFloats(float* buffer, long long start, size_t numFrames) const override;
+
+   //! Whether the samples were copied
+   bool HasSamples() const;
+
+   /*!
+    * @brief Hash of the sample rate and samples, identifying the audio
+    * @pre `HasSamples()`
+    */
+   uint64_t GetContentHash() const;
+
+private:
+   const double mSampleRate;
+   const long long mNumSamples;
+   std::vector<float> mSamples;
+   uint64_t mContentHash = 0;
+};
+} // namespace MIR
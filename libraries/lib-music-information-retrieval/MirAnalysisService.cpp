@@ -0,0 +1,212 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MirAnalysisService.cpp
+
+**********************************************************************/
+#include "MirAnalysisService.h"
+#include "MusicInformationRetrieval.h"
+
+#include <algorithm>
+
+namespace MIR
+{
+namespace
+{
+//! Thrown from progress callbacks to abandon an analysis
+struct Cancelled
+{
+};
+
+//! Results of signal analysis to keep, for the most recently analyzed audio
+constexpr size_t maxCachedResults = 1000;
+} // namespace
+
+struct AnalysisService::Batch
+{
+   Batch(std::vector<Request> requests, Completion completion)
+       : requests { std::move(requests) }
+       , results(this->requests.size())
+       , numRemaining { this->requests.size() }
+       , completion { std::move(completion) }
+   {
+   }
+
+   const std::vector<Request> requests;
+   //! Each element is written by one worker only
+   Results results;
+   std::atomic<size_t> numRemaining;
+   const Completion completion;
+};
+
+AnalysisService& AnalysisService::Get()
+{
+   // Never destroyed: joining threads while static objects are destroyed,
+   // after the process began to exit, may deadlock
+   static const auto instance = new AnalysisService;
+   return *instance;
+}
+
+AnalysisService::AnalysisService(size_t numThreads)
+    : mNumThreads { numThreads > 0 ?
+                       numThreads :
+                       std::max(1u, std::thread::hardware_concurrency() / 2) }
+{
+}
+
+AnalysisService::~AnalysisService()
+{
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      mStopping = true;
+      mNumPending -= mTasks.size();
+      mTasks.clear();
+   }
+   mTaskAdded.notify_all();
+   mTaskDone.notify_all();
+   for (auto& thread : mThreads)
+      thread.join();
+}
+
+void AnalysisService::Analyze(
+   std::vector<Request> requests, Completion completion)
+{
+   if (requests.empty())
+   {
+      if (completion)
+         completion({});
+      return;
+   }
+   const auto batch =
+      std::make_shared<Batch>(std::move(requests), std::move(completion));
+   const auto numTasks = batch->requests.size();
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      for (size_t i = 0; i < numTasks; ++i)
+         mTasks.push_back({ batch, i });
+      mNumPending += numTasks;
+      // Start threads only when first needed
+      while (mThreads.size() < std::min(mNumThreads, mNumPending))
+         mThreads.emplace_back([this] { Work(); });
+   }
+   mTaskAdded.notify_all();
+}
+
+void AnalysisService::Wait()
+{
+   std::unique_lock<std::mutex> lock { mMutex };
+   mTaskDone.wait(lock, [this] { return mNumPending == 0; });
+}
+
+size_t AnalysisService::GetNumCachedResults() const
+{
+   std::lock_guard<std::mutex> lock { mCacheMutex };
+   return mCache.size();
+}
+
+void AnalysisService::Work()
+{
+   while (true)
+   {
+      Task task;
+      {
+         std::unique_lock<std::mutex> lock { mMutex };
+         mTaskAdded.wait(
+            lock, [this] { return mStopping || !mTasks.empty(); });
+         if (mStopping)
+            return;
+         task = std::move(mTasks.front());
+         mTasks.pop_front();
+      }
+
+      Run(*task.batch, task.index);
+      if (!mStopping && --task.batch->numRemaining == 0 &&
+          task.batch->completion)
+      {
+         try
+         {
+            task.batch->completion(std::move(task.batch->results));
+         }
+         catch (...)
+         {
+            // Don't let the thread, and with it the process, die
+         }
+      }
+
+      {
+         std::lock_guard<std::mutex> lock { mMutex };
+         --mNumPending;
+      }
+      mTaskDone.notify_all();
+   }
+}
+
+void AnalysisService::Run(Batch& batch, size_t index)
+{
+   const auto& request = batch.requests[index];
+   if (!request.source)
+      return;
+   try
+   {
+      ProjectSyncInfoInput input {
+         *request.source,
+         request.filename,
+         request.tags,
+         [this](double) {
+            if (mStopping)
+               throw Cancelled {};
+         },
+         request.projectTempo,
+         request.projectWasEmpty,
+         request.viewIsBeatsAndMeasures,
+      };
+      if (request.contentHash.has_value())
+         input.getMeterFromSignal = [&](FalsePositiveTolerance tolerance) {
+            return GetMeter(request, tolerance);
+         };
+      if (auto syncInfo = GetProjectSyncInfo(input))
+         batch.results[index].emplace(*syncInfo);
+   }
+   catch (const Cancelled&)
+   {
+   }
+   catch (...)
+   {
+      // Such as failure to allocate or to read; report no result, as for
+      // audio that has none
+      batch.results[index].reset();
+   }
+}
+
+std::optional<MusicalMeter> AnalysisService::GetMeter(
+   const Request& request, FalsePositiveTolerance tolerance)
+{
+   const CacheKey key { *request.contentHash, tolerance };
+   {
+      std::lock_guard<std::mutex> lock { mCacheMutex };
+      if (const auto iter = mCache.find(key); iter != mCache.end())
+         return iter->second;
+   }
+   // Not holding the lock, so that other analyses proceed.  The same audio in
+   // two requests of one batch may be analyzed twice, with equal results.
+   auto meter = GetMusicalMeterFromSignal(
+      *request.source, tolerance, [this](double) {
+         if (mStopping)
+            throw Cancelled {};
+      });
+   std::lock_guard<std::mutex> lock { mCacheMutex };
+   if (mCache.emplace(key, meter).second)
+   {
+      mCacheOrder.push_back(key);
+      // Forget the oldest
+      while (mCacheOrder.size() > maxCachedResults)
+      {
+         mCache.erase(mCacheOrder.front());
+         mCacheOrder.pop_front();
+      }
+   }
+   return meter;
+}
+} // namespace MIR
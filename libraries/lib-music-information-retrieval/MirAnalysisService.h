@@ -0,0 +1,111 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MirAnalysisService.h
+
+**********************************************************************/
+#pragma once
+
+#include "AcidizerTags.h"
+#include "MirTypes.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace MIR
+{
+/*!
+ * @brief Runs `GetProjectSyncInfo` for many audio files at once, on a pool of
+ * worker threads, so that importing many loops does not wait for their
+ * analysis
+ *
+ * Results of signal analysis are kept, keyed by content hash, so that the same
+ * audio is analyzed only once; only those of the most recent analyses are
+ * kept.  A request whose analysis throws gets no result.
+ */
+class MUSIC_INFORMATION_RETRIEVAL_API AnalysisService final
+{
+public:
+   struct Request
+   {
+      //! Read on a worker thread, so it must not share state with anything
+      //! that other threads may change, e.g. a `BufferedMirAudioReader`
+      std::shared_ptr<const MirAudioReader> source;
+      std::string filename;
+      std::optional<LibFileFormats::AcidizerTags> tags;
+      double projectTempo = 120.;
+      bool projectWasEmpty = false;
+      bool viewIsBeatsAndMeasures = false;
+      //! If given, identifies the audio of `source` for the cache
+      std::optional<uint64_t> contentHash;
+   };
+
+   //! One per request, in the same order
+   using Results = std::vector<std::optional<ProjectSyncInfo>>;
+
+   //! Called once, on a worker thread, when all requests of a batch are done
+   using Completion = std::function<void(Results)>;
+
+   //! The instance used by the application
+   static AnalysisService& Get();
+
+   /*!
+    * @param numThreads zero means half as many as there are hardware threads,
+    * but at least one
+    */
+   explicit AnalysisService(size_t numThreads = 0);
+
+   //! Abandons batches not yet complete, without calling their completions
+   ~AnalysisService();
+
+   //! Queues a batch of requests and returns at once
+   void Analyze(std::vector<Request> requests, Completion completion);
+
+   //! Blocks until all batches queued so far are complete
+   void Wait();
+
+   size_t GetNumCachedResults() const;
+
+private:
+   struct Batch;
+   struct Task
+   {
+      std::shared_ptr<Batch> batch;
+      size_t index;
+   };
+   using CacheKey = std::pair<uint64_t, FalsePositiveTolerance>;
+
+   void Work();
+   void Run(Batch& batch, size_t index);
+   std::optional<MusicalMeter> GetMeter(
+      const Request& request, FalsePositiveTolerance tolerance);
+
+   const size_t mNumThreads;
+
+   mutable std::mutex mMutex;
+   std::condition_variable mTaskAdded;
+   std::condition_variable mTaskDone;
+   std::deque<Task> mTasks;
+   //! Tasks queued or running
+   size_t mNumPending = 0;
+   std::vector<std::thread> mThreads;
+   std::atomic<bool> mStopping { false };
+
+   mutable std::mutex mCacheMutex;
+   std::map<CacheKey, std::optional<MusicalMeter>> mCache;
+   //! Keys of mCache, oldest first
+   std::deque<CacheKey> mCacheOrder;
+};
+} // namespace MIR
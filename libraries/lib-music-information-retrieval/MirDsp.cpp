@@ -26,11 +26,11 @@ namespace MIR
 namespace
 {
 float GetNoveltyMeasure(
-   const PffftFloatVector& prevPowSpec, const PffftFloatVector& powSpec)
+   const PffftFloatVector& prevPowSpec, const float* powSpec, size_t size)
 {
    auto k = 0;
    return std::accumulate(
-      powSpec.begin(), powSpec.end(), 0.f, [&](float a, float mag) {
+      powSpec, powSpec + size, 0.f, [&](float a, float mag) {
          // Half-wave-rectified stuff
          return a + std::max(0.f, mag - prevPowSpec[k++]);
       });
@@ -76,11 +76,11 @@ GetNormalizedCircularAutocorr(const std::vector<float>& ux /* unaligned x*/)
       return ux;
    const auto N = ux.size();
    assert(IsPowOfTwo(N));
-   PffftSetupHolder setup { pffft_new_setup(N, PFFFT_REAL) };
+   const auto setup = GetRealPffftSetup(N);
    PffftFloatVector x { ux.begin(), ux.end() };
    PffftFloatVector work(N);
    pffft_transform_ordered(
-      setup.get(), x.data(), x.data(), work.data(), PFFFT_FORWARD);
+      setup, x.data(), x.data(), work.data(), PFFFT_FORWARD);
 
    // Transform to a power spectrum, but preserving the layout expected by PFFFT
    // in preparation for the inverse transform.
@@ -93,7 +93,7 @@ GetNormalizedCircularAutocorr(const std::vector<float>& ux /* unaligned x*/)
    }
 
    pffft_transform_ordered(
-      setup.get(), x.data(), x.data(), work.data(), PFFFT_BACKWARD);
+      setup, x.data(), x.data(), work.data(), PFFFT_BACKWARD);
 
    // The second half of the circular autocorrelation is the mirror of the first
    // half. We are economic and only keep the first half.
@@ -115,46 +115,63 @@ std::vector<float> GetOnsetDetectionFunction(
    const auto sampleRate = frameProvider.GetSampleRate();
    const auto numFrames = frameProvider.GetNumFrames();
    const auto frameSize = frameProvider.GetFftSize();
-   PffftFloatVector buffer(frameSize);
    std::vector<float> odf;
    odf.reserve(numFrames);
    const auto powSpecSize = frameSize / 2 + 1;
-   PffftFloatVector powSpec(powSpecSize);
+   const auto powSpecStride = PffftAlignedCount(powSpecSize);
    PffftFloatVector prevPowSpec(powSpecSize);
    PffftFloatVector firstPowSpec;
    std::fill(prevPowSpec.begin(), prevPowSpec.end(), 0.f);
 
+   // Frames are read and transformed in batches.  The transforms run on this
+   // thread only:  analyses already run on a pool of threads, see
+   // AnalysisService, which more threads per batch would oversubscribe.
+   constexpr auto batchSize = 256;
+   PffftFloatVector frames;
+   PffftFloatVector powSpecs(batchSize * powSpecStride);
    PowerSpectrumGetter getPowerSpectrum { frameSize };
 
    auto frameCounter = 0;
-   while (frameProvider.GetNextFrame(buffer))
+   while (frameCounter < numFrames)
    {
-      getPowerSpectrum(buffer.aligned(), powSpec.aligned());
+      const auto numBatchFrames =
+         frameProvider.GetFrames(frames, frameCounter, batchSize);
+      getPowerSpectrum(
+         frames.aligned(), powSpecs.aligned(), numBatchFrames, 1);
 
       // Compress the frame as per section (6.5) in Müller, Meinard.
       // Fundamentals of music processing: Audio, analysis, algorithms,
       // applications. Vol. 5. Cham: Springer, 2015.
       constexpr auto gamma = 100.f;
       std::transform(
-         powSpec.begin(), powSpec.end(), powSpec.begin(),
+         powSpecs.begin(), powSpecs.begin() + numBatchFrames * powSpecStride,
+         powSpecs.begin(),
          [gamma](float x) { return FastLog2(1 + gamma * std::sqrt(x)); });
 
-      if (firstPowSpec.empty())
-         firstPowSpec = powSpec;
-      else
-         odf.push_back(GetNoveltyMeasure(prevPowSpec, powSpec));
+      for (auto i = 0; i < numBatchFrames; ++i)
+      {
+         const auto powSpec = powSpecs.begin() + i * powSpecStride;
+         if (firstPowSpec.empty())
+            firstPowSpec.assign(powSpec, powSpec + powSpecSize);
+         else
+            odf.push_back(
+               GetNoveltyMeasure(prevPowSpec, &*powSpec, powSpecSize));
 
-      if (debugOutput)
-         debugOutput->postProcessedStft.push_back(powSpec);
+         if (debugOutput)
+            debugOutput->postProcessedStft.emplace_back(
+               powSpec, powSpec + powSpecSize);
 
-      std::swap(prevPowSpec, powSpec);
+         std::copy(powSpec, powSpec + powSpecSize, prevPowSpec.begin());
+      }
 
+      frameCounter += numBatchFrames;
       if (progressCallback)
-         progressCallback(1. * ++frameCounter / numFrames);
+         progressCallback(1. * frameCounter / numFrames);
    }
 
    // Close the loop.
-   odf.push_back(GetNoveltyMeasure(prevPowSpec, firstPowSpec));
+   odf.push_back(GetNoveltyMeasure(
+      prevPowSpec, firstPowSpec.data(), firstPowSpec.size()));
    assert(IsPowOfTwo(odf.size()));
 
    const auto movingAverage =
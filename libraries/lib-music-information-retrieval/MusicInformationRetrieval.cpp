@@ -64,11 +64,15 @@ GetProjectSyncInfo(const ProjectSyncInfoInput& in)
    else if (bpm = GetBpmFromFilename(in.filename))
       usedMethod = TempoObtainedFrom::Title;
    else if (
-      const auto meter = GetMusicalMeterFromSignal(
-         in.source,
-         in.viewIsBeatsAndMeasures ? FalsePositiveTolerance::Lenient :
-                                     FalsePositiveTolerance::Strict,
-         in.progressCallback))
+      const auto meter = [&] {
+         const auto tolerance = in.viewIsBeatsAndMeasures ?
+                                   FalsePositiveTolerance::Lenient :
+                                   FalsePositiveTolerance::Strict;
+         return in.getMeterFromSignal ?
+                   in.getMeterFromSignal(tolerance) :
+                   GetMusicalMeterFromSignal(
+                      in.source, tolerance, in.progressCallback);
+      }())
    {
       bpm = meter->bpm;
       timeSignature = meter->timeSignature;
@@ -137,9 +141,7 @@ std::optional<MusicalMeter> GetMusicalMeterFromSignal(
    if (audio.GetSampleRate() <= 0)
       return {};
    const auto duration = 1. * audio.GetNumSamples() / audio.GetSampleRate();
-   if (duration > 60)
-      // A file longer than 1 minute is most likely not a loop, and processing
-      // it would be costly.
+   if (duration > maxAnalyzedSignalDuration)
       return {};
    DecimatingMirAudioReader decimatedAudio { audio };
    return GetMeterUsingTatumQuantizationFit(
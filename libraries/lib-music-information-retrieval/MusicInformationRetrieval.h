@@ -51,6 +51,12 @@ static const std::unordered_map<FalsePositiveTolerance, LoopClassifierSettings>
       { FalsePositiveTolerance::Lenient, { .1, 0.7129778875046098 } },
    };
 
+/*!
+ * Signals longer than this, in seconds, are not analyzed: they are most likely
+ * not loops, and processing them would be costly.
+ */
+constexpr auto maxAnalyzedSignalDuration = 60.;
+
 struct ProjectSyncInfoInput
 {
    const MirAudioReader& source;
@@ -60,6 +66,12 @@ struct ProjectSyncInfoInput
    double projectTempo = 120.;
    bool projectWasEmpty = false;
    bool viewIsBeatsAndMeasures = false;
+   /*!
+    * If not null, called instead of `GetMusicalMeterFromSignal` on `source`,
+    * e.g. to reuse an earlier result for the same audio.
+    */
+   std::function<std::optional<MusicalMeter>(FalsePositiveTolerance)>
+      getMeterFromSignal;
 };
 
 std::optional<ProjectSyncInfo> MUSIC_INFORMATION_RETRIEVAL_API
@@ -61,25 +61,47 @@ bool StftFrameProvider::GetNextFrame(PffftFloatVector& frame)
    if (mNumFramesProvided >= mNumFrames)
       return false;
    frame.resize(mFftSize, 0.f);
+   ReadFrame(mNumFramesProvided++, frame.data());
+   return true;
+}
+
+int StftFrameProvider::GetFrames(
+   PffftFloatVector& frames, int firstFrame, int numFrames) const
+{
+   numFrames = std::max(0, std::min(numFrames, mNumFrames - firstFrame));
+   const size_t stride = GetFrameStride();
+   if (frames.size() < numFrames * stride)
+      frames.resize(numFrames * stride);
+   for (auto i = 0; i < numFrames; ++i)
+      ReadFrame(firstFrame + i, frames.data() + i * stride);
+   return numFrames;
+}
+
+PffftAlignedCount StftFrameProvider::GetFrameStride() const
+{
+   return PffftAlignedCount(mFftSize);
+}
+
+void StftFrameProvider::ReadFrame(int index, float* frame) const
+{
    const int firstReadPosition = mHopSize - mFftSize;
-   int start = std::round(firstReadPosition + mNumFramesProvided * mHopSize);
+   int start = std::round(firstReadPosition + index * mHopSize);
    while (start < 0)
       start += mNumSamples;
    const auto end = std::min<long long>(start + mFftSize, mNumSamples);
    const auto numToRead = end - start;
-   mAudio.ReadFloats(frame.data(), start, numToRead);
+   mAudio.ReadFloats(frame, start, numToRead);
    // It's not impossible that some user drops a file so short that `mFftSize >
    // mNumSamples`. In that case we won't be returning a meaningful
    // STFT, but that's a use case we're not interested in. We just need to make
    // sure we don't crash.
    const auto numRemaining = std::min(mFftSize - numToRead, mNumSamples);
    if (numRemaining > 0)
-      mAudio.ReadFloats(frame.data() + numToRead, 0, numRemaining);
+      mAudio.ReadFloats(frame + numToRead, 0, numRemaining);
+   std::fill(frame + numToRead + numRemaining, frame + mFftSize, 0.f);
    std::transform(
-      frame.begin(), frame.end(), mWindow.begin(), frame.begin(),
+      frame, frame + mFftSize, mWindow.begin(), frame,
       std::multiplies<float>());
-   ++mNumFramesProvided;
-   return true;
 }
 
 int StftFrameProvider::GetNumFrames() const
@@ -30,12 +30,28 @@ class MUSIC_INFORMATION_RETRIEVAL_API StftFrameProvider
 public:
    StftFrameProvider(const MirAudioReader& source);
    bool GetNextFrame(PffftFloatVector& frame);
+
+   /*!
+    * @brief Get frames `firstFrame` to `firstFrame + numFrames - 1` at once,
+    * independently of `GetNextFrame`
+    * @param frames resized as needed, receives one frame every
+    * `GetFrameStride()` floats
+    * @return the number of frames written, fewer than `numFrames` at the end
+    */
+   int GetFrames(PffftFloatVector& frames, int firstFrame, int numFrames) const;
+
+   //! Distance between the beginnings of the frames given by `GetFrames`,
+   //! keeping each frame aligned for pffft
+   PffftAlignedCount GetFrameStride() const;
+
    int GetNumFrames() const;
    int GetSampleRate() const;
    double GetFrameRate() const;
    int GetFftSize() const;
 
 private:
+   void ReadFrame(int index, float* frame) const;
+
    const MirAudioReader& mAudio;
    const int mFftSize;
    const double mHopSize;
@@ -0,0 +1,188 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MirAnalysisServiceTests.cpp
+
+**********************************************************************/
+#include "BufferedMirAudioReader.h"
+#include "MirAnalysisService.h"
+#include "MirFakes.h"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <stdexcept>
+
+namespace MIR
+{
+namespace
+{
+//! Clicks at 120 bpm, counting how many times it is read
+class ClickTrackMirAudioReader : public MirAudioReader
+{
+public:
+   explicit ClickTrackMirAudioReader(int phase = 0)
+       : mPhase { phase }
+   {
+   }
+
+   double GetSampleRate() const override
+   {
+      return 8000;
+   }
+   long long GetNumSamples() const override
+   {
+      return 8 * 8000;
+   }
+   void
+   ReadFloats(float* buffer, long long where, size_t numFrames) const override
+   {
+      ++numReads;
+      for (size_t i = 0; i < numFrames; ++i)
+         buffer[i] = (where + i + mPhase) % 4000 < 40 ? 1.f : 0.f;
+   }
+
+   mutable std::atomic<int> numReads { 0 };
+
+private:
+   const int mPhase;
+};
+
+class ThrowingMirAudioReader : public ClickTrackMirAudioReader
+{
+public:
+   void
+   ReadFloats(float*, long long, size_t) const override
+   {
+      throw std::runtime_error { "read failure" };
+   }
+};
+} // namespace
+
+TEST_CASE("BufferedMirAudioReader")
+{
+   const ClickTrackMirAudioReader source;
+   const BufferedMirAudioReader sut { source, 60. };
+   REQUIRE(sut.HasSamples());
+   REQUIRE(sut.GetSampleRate() == source.GetSampleRate());
+   REQUIRE(sut.GetNumSamples() == source.GetNumSamples());
+
+   const auto numSamples = source.GetNumSamples();
+   std::vector<float> expected(numSamples), actual(numSamples);
+   source.ReadFloats(expected.data(), 0, numSamples);
+   sut.ReadFloats(actual.data(), 0, numSamples);
+   REQUIRE(actual == expected);
+
+   SECTION("equal audio has equal hashes")
+   {
+      const BufferedMirAudioReader other { ClickTrackMirAudioReader {}, 60. };
+      REQUIRE(other.GetContentHash() == sut.GetContentHash());
+   }
+
+   SECTION("different audio has different hashes")
+   {
+      const BufferedMirAudioReader other { ClickTrackMirAudioReader { 1 },
+                                           60. };
+      REQUIRE(other.GetContentHash() != sut.GetContentHash());
+   }
+
+   SECTION("audio longer than the limit is not copied")
+   {
+      const BufferedMirAudioReader other { source, 1. };
+      REQUIRE(!other.HasSamples());
+      REQUIRE(other.GetNumSamples() == source.GetNumSamples());
+   }
+}
+
+TEST_CASE("AnalysisService")
+{
+   AnalysisService sut { 4 };
+
+   SECTION("results come once, in the order of requests")
+   {
+      std::vector<AnalysisService::Request> requests;
+      requests.push_back(
+         { std::make_shared<EmptyMirAudioReader>(), "foo_100BPM.wav" });
+      requests.push_back({ std::make_shared<EmptyMirAudioReader>(), "foo" });
+      requests.push_back(
+         { std::make_shared<EmptyMirAudioReader>(), "foo 90 bpm.wav" });
+      std::atomic<int> numCompletions { 0 };
+      AnalysisService::Results results;
+      sut.Analyze(
+         std::move(requests), [&](AnalysisService::Results r) {
+            ++numCompletions;
+            results = std::move(r);
+         });
+      sut.Wait();
+      REQUIRE(numCompletions == 1);
+      REQUIRE(results.size() == 3);
+      REQUIRE(results[0].has_value());
+      REQUIRE(results[0]->rawAudioTempo == 100);
+      REQUIRE(!results[1].has_value());
+      REQUIRE(results[2].has_value());
+      REQUIRE(results[2]->rawAudioTempo == 90);
+   }
+
+   SECTION("signal analysis of the same audio is done once")
+   {
+      const auto source = std::make_shared<ClickTrackMirAudioReader>();
+      const auto analyze = [&] {
+         AnalysisService::Request request { source, "foo" };
+         request.contentHash = 1234;
+         std::optional<double> tempo;
+         sut.Analyze({ request }, [&](AnalysisService::Results r) {
+            if (r[0].has_value())
+               tempo = r[0]->rawAudioTempo;
+         });
+         sut.Wait();
+         return tempo;
+      };
+      const auto first = analyze();
+      const auto numReads = source->numReads.load();
+      REQUIRE(numReads > 0);
+      REQUIRE(sut.GetNumCachedResults() == 1);
+      const auto second = analyze();
+      REQUIRE(source->numReads == numReads);
+      REQUIRE(first == second);
+   }
+
+   SECTION("a failing analysis gives no result, and others complete")
+   {
+      std::vector<AnalysisService::Request> requests;
+      requests.push_back(
+         { std::make_shared<ThrowingMirAudioReader>(), "foo" });
+      requests.push_back(
+         { std::make_shared<EmptyMirAudioReader>(), "foo_100BPM.wav" });
+      std::atomic<int> numCompletions { 0 };
+      AnalysisService::Results results;
+      sut.Analyze(
+         std::move(requests), [&](AnalysisService::Results r) {
+            ++numCompletions;
+            results = std::move(r);
+         });
+      sut.Wait();
+      REQUIRE(numCompletions == 1);
+      REQUIRE(results.size() == 2);
+      REQUIRE(!results[0].has_value());
+      REQUIRE(results[1].has_value());
+   }
+
+   SECTION("destruction abandons incomplete batches")
+   {
+      std::atomic<bool> completed { false };
+      {
+         AnalysisService service { 1 };
+         std::vector<AnalysisService::Request> requests;
+         for (auto i = 0; i < 16; ++i)
+            requests.push_back(
+               { std::make_shared<ClickTrackMirAudioReader>(), "foo" });
+         service.Analyze(
+            std::move(requests),
+            [&](AnalysisService::Results) { completed = true; });
+      }
+      REQUIRE(!completed);
+   }
+}
+} // namespace MIR
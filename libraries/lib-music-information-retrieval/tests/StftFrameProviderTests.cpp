@@ -42,6 +42,19 @@ public:
       REQUIRE(where + numFrames <= numSamples);
    };
 };
+
+class RampMirAudioReader : public TestMirAudioReader
+{
+public:
+   using TestMirAudioReader::TestMirAudioReader;
+   void
+   ReadFloats(float* buffer, long long where, size_t numFrames) const override
+   {
+      TestMirAudioReader::ReadFloats(buffer, where, numFrames);
+      for (size_t i = 0; i < numFrames; ++i)
+         buffer[i] = (where + i) / 1000.f;
+   }
+};
 } // namespace
 TEST_CASE("StftFrameProvider")
 {
@@ -70,5 +83,29 @@ TEST_CASE("StftFrameProvider")
       while (sut.GetNextFrame(frame))
          ;
    }
+   SECTION("GetFrames gives the frames of GetNextFrame")
+   {
+      RampMirAudioReader reader { 123456 };
+      StftFrameProvider sut { reader };
+      const auto numFrames = sut.GetNumFrames();
+      const size_t stride = sut.GetFrameStride();
+      PffftFloatVector frames;
+      constexpr auto batchSize = 100;
+      REQUIRE(sut.GetFrames(frames, numFrames - 10, batchSize) == 10);
+      REQUIRE(sut.GetFrames(frames, numFrames, batchSize) == 0);
+      PffftFloatVector frame;
+      for (auto first = 0; first < numFrames; first += batchSize)
+      {
+         const auto numBatchFrames = sut.GetFrames(frames, first, batchSize);
+         REQUIRE(numBatchFrames == std::min(batchSize, numFrames - first));
+         for (auto i = 0; i < numBatchFrames; ++i)
+         {
+            REQUIRE(sut.GetNextFrame(frame));
+            REQUIRE(std::equal(
+               frame.begin(), frame.end(), frames.begin() + i * stride));
+         }
+      }
+      REQUIRE(!sut.GetNextFrame(frame));
+   }
 }
 } // namespace MIR
@@ -203,11 +203,13 @@ TEST_CASE("TatumQuantizationFitBenchmarking")
    const auto numFiles = audioFiles.size();
    auto count = 0;
    std::chrono::milliseconds computationTime { 0 };
+   auto totalAudioDuration = 0.;
    std::transform(
       audioFiles.begin(), audioFiles.begin() + numFiles,
       std::back_inserter(samples), [&](const std::string& wavFile) {
          const WavMirAudioReader audio { wavFile };
          checksum += GetChecksum(audio);
+         totalAudioDuration += audio.GetDuration();
          QuantizationFitDebugOutput debugOutput;
          std::function<void(double)> progressCb;
          const auto now = std::chrono::steady_clock::now();
@@ -238,6 +240,12 @@ TEST_CASE("TatumQuantizationFitBenchmarking")
    {
       std::ofstream timeMeasurementFile { "./timeMeasurement.txt" };
       timeMeasurementFile << computationTime.count() << "ms\n";
+      // Throughput, so that runs on datasets of different sizes compare
+      const auto seconds = computationTime.count() / 1000.;
+      if (seconds > 0)
+         timeMeasurementFile << numFiles / seconds << " files/s, "
+                             << totalAudioDuration / seconds
+                             << " s of audio/s\n";
    }
 
    // AUC of ROC curve. Tells how good our loop/not-loop clasifier is.
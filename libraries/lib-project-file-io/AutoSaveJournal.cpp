@@ -0,0 +1,189 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AutoSaveJournal.cpp
+
+**********************************************************************/
+#include "AutoSaveJournal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+namespace {
+//! The journal is compacted when it grows larger than the base document, but
+//! not while it is smaller than this
+constexpr size_t MinCompactionSize = 1024 * 1024;
+
+using Bytes = AutoSaveJournal::Bytes;
+
+//! Layouts are pairs of 64 bit key and length, in native byte order like the
+//! rest of the document
+constexpr size_t LayoutPairSize = 2 * sizeof(int64_t);
+
+bool DecodeLayout(const Bytes &bytes, AutoSaveJournal::Parts &parts)
+{
+   if (bytes.size() % LayoutPairSize != 0)
+      return false;
+   parts.clear();
+   for (size_t offset = 0; offset < bytes.size(); offset += LayoutPairSize) {
+      int64_t key, length;
+      memcpy(&key, bytes.data() + offset, sizeof(key));
+      memcpy(&length, bytes.data() + offset + sizeof(key), sizeof(length));
+      if (key < 0 || length < 0)
+         return false;
+      parts.push_back({ key, static_cast<size_t>(length) });
+   }
+   return true;
+}
+}
+
+AutoSaveJournal::AutoSaveJournal() = default;
+AutoSaveJournal::~AutoSaveJournal() = default;
+
+void AutoSaveJournal::Reset()
+{
+   mParts.clear();
+   mLayout.clear();
+   mDictSize = mBaseSize = mJournalSize = 0;
+   mValid = false;
+}
+
+auto AutoSaveJournal::EncodeLayout(const Parts &parts) -> Bytes
+{
+   Bytes result(parts.size() * LayoutPairSize);
+   auto pByte = result.data();
+   for (const auto &part : parts) {
+      const int64_t key = part.key, length = part.length;
+      memcpy(pByte, &key, sizeof(key));
+      memcpy(pByte + sizeof(key), &length, sizeof(length));
+      pByte += LayoutPairSize;
+   }
+   return result;
+}
+
+auto AutoSaveJournal::Record(const Parts &parts,
+   const void *data, size_t dataSize, const void *dict, size_t dictSize)
+   -> std::optional<Entries>
+{
+   if (!mValid)
+      return {};
+
+   Entries entries;
+   std::vector<PartKey> layout;
+   layout.reserve(parts.size());
+   const auto bytes = static_cast<const uint8_t *>(data);
+   size_t offset = 0;
+   for (const auto &part : parts) {
+      if (part.key < 0 || offset + part.length > dataSize)
+         return {};
+      const auto begin = bytes + offset, end = begin + part.length;
+      offset += part.length;
+      layout.push_back(part.key);
+
+      auto &old = mParts[part.key];
+      if (old.size() != part.length || !std::equal(begin, end, old.begin())) {
+         old.assign(begin, end);
+         entries.push_back({ part.key, old });
+      }
+   }
+   if (offset != dataSize)
+      return {};
+
+   // The dictionary of ProjectSerializer only ever grows
+   if (dictSize != mDictSize) {
+      const auto pDict = static_cast<const uint8_t *>(dict);
+      entries.push_back({ DictionaryKey, { pDict, pDict + dictSize } });
+      mDictSize = dictSize;
+   }
+
+   // Content entries precede the layout that refers to them
+   if (layout != mLayout) {
+      entries.push_back({ LayoutKey, EncodeLayout(parts) });
+      // Forget parts no longer used
+      std::unordered_set<PartKey> used{ layout.begin(), layout.end() };
+      for (auto iter = mParts.begin(); iter != mParts.end();)
+         if (used.count(iter->first))
+            ++iter;
+         else
+            iter = mParts.erase(iter);
+      mLayout = move(layout);
+   }
+
+   for (const auto &entry : entries)
+      mJournalSize += entry.bytes.size();
+   if (mJournalSize > std::max(mBaseSize, MinCompactionSize))
+      return {};
+
+   return { move(entries) };
+}
+
+auto AutoSaveJournal::Rebase(const Parts &parts,
+   const void *data, size_t dataSize, size_t dictSize) -> Entry
+{
+   Reset();
+   const auto bytes = static_cast<const uint8_t *>(data);
+   size_t offset = 0;
+   for (const auto &part : parts) {
+      const auto length = std::min(part.length, dataSize - offset);
+      mParts[part.key].assign(bytes + offset, bytes + offset + length);
+      mLayout.push_back(part.key);
+      offset += length;
+   }
+   mDictSize = dictSize;
+   mBaseSize = dataSize;
+   mValid = (offset == dataSize);
+   return { LayoutKey, EncodeLayout(parts) };
+}
+
+bool AutoSaveJournal::Replay(Bytes &dict, Bytes &data, const Entries &entries)
+{
+   if (entries.empty())
+      return true;
+
+   // The first entry splits the base
+   Parts parts;
+   if (entries[0].key != LayoutKey || !DecodeLayout(entries[0].bytes, parts))
+      return false;
+   std::unordered_map<PartKey, Bytes> contents;
+   size_t offset = 0;
+   for (const auto &part : parts) {
+      if (offset + part.length > data.size())
+         return false;
+      const auto begin = data.begin() + offset;
+      contents[part.key].assign(begin, begin + part.length);
+      offset += part.length;
+   }
+   if (offset != data.size())
+      return false;
+
+   const Bytes *pDict = &dict;
+   for (size_t ii = 1; ii < entries.size(); ++ii) {
+      const auto &entry = entries[ii];
+      if (entry.key == LayoutKey) {
+         if (!DecodeLayout(entry.bytes, parts))
+            return false;
+      }
+      else if (entry.key == DictionaryKey)
+         pDict = &entry.bytes;
+      else if (entry.key >= 0)
+         contents[entry.key] = entry.bytes;
+      else
+         return false;
+   }
+
+   Bytes result;
+   for (const auto &part : parts) {
+      const auto iter = contents.find(part.key);
+      if (iter == contents.end())
+         return false;
+      result.insert(result.end(), iter->second.begin(), iter->second.end());
+   }
+
+   if (pDict != &dict)
+      dict = *pDict;
+   data.swap(result);
+   return true;
+}
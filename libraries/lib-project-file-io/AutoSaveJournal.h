@@ -0,0 +1,100 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AutoSaveJournal.h
+
+  @brief Incremental autosave of the project document, as a full document
+  followed by a log of the parts that changed since
+
+**********************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+//! Tracks which parts of successive autosaved documents changed
+/*!
+ A document, as encoded by ProjectSerializer, is a dictionary and data.  The
+ data are cut into parts, such as one for each track, identified by keys that
+ are stable from one autosave to the next.  After one document is written
+ whole as the base, later documents are journaled as the entries for the
+ parts that differ, a new dictionary if it grew, and a new layout of the
+ parts if it changed.
+
+ No database access happens here.
+ */
+class PROJECT_FILE_IO_API AutoSaveJournal final
+{
+public:
+   using PartKey = long long;
+   using Bytes = std::vector<uint8_t>;
+
+   //! Key of entries giving keys and lengths of the parts, in order
+   static constexpr PartKey LayoutKey = -1;
+   //! Key of entries giving the whole dictionary
+   static constexpr PartKey DictionaryKey = -2;
+
+   //! One of the consecutive parts of the data of a document
+   struct Part
+   {
+      //! Nonnegative, and unique in the document
+      PartKey key;
+      size_t length;
+   };
+   using Parts = std::vector<Part>;
+
+   struct Entry
+   {
+      PartKey key;
+      Bytes bytes;
+   };
+   using Entries = std::vector<Entry>;
+
+   AutoSaveJournal();
+   ~AutoSaveJournal();
+
+   //! Forget the base, so that the next document must be written whole
+   void Reset();
+
+   //! Compare a document with the last one recorded
+   /*!
+    @param parts must partition the data
+    @return entries to append to the journal, possibly none; or nullopt if
+    the document should be written whole instead, and then Rebase() called
+    */
+   std::optional<Entries> Record(const Parts &parts,
+      const void *data, size_t dataSize, const void *dict, size_t dictSize);
+
+   //! Make a document written whole the base of the journal
+   /*!
+    @return the entry that must begin the journal for this base
+    */
+   Entry Rebase(const Parts &parts,
+      const void *data, size_t dataSize, size_t dictSize);
+
+   //! Reconstruct a document from its base and the entries of the journal
+   /*!
+    @param dict the dictionary of the base, replaced with the result
+    @param data the data of the base, replaced with the result
+    @param entries in the order they were written
+    @return false if the journal is not consistent; then `dict` and `data`
+    are unchanged
+    */
+   static bool Replay(Bytes &dict, Bytes &data, const Entries &entries);
+
+private:
+   static Bytes EncodeLayout(const Parts &parts);
+
+   std::unordered_map<PartKey, Bytes> mParts;
+   std::vector<PartKey> mLayout;
+   size_t mDictSize{ 0 };
+   //! Size of the data of the base document
+   size_t mBaseSize{ 0 };
+   //! Total size of entries written since the base
+   size_t mJournalSize{ 0 };
+   bool mValid{ false };
+};
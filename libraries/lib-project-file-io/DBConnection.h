@@ -80,7 +80,8 @@ public:
       InsertSampleBlock,
       DeleteSampleBlock,
       GetSampleBlockSize,
-      GetAllSampleBlocksSize
+      GetAllSampleBlocksSize,
+      LoadAllSampleBlocks
    };
    sqlite3_stmt *Prepare(enum StatementID id, const char *sql);
 
@@ -10,8 +10,11 @@ Paul Licameli split from AudacityProject.cpp
 
 #include "ProjectFileIO.h"
 
+#include <array>
 #include <atomic>
+#include <future>
 #include <sqlite3.h>
+#include <map>
 #include <optional>
 #include <cstring>
 
@@ -44,7 +47,6 @@ Paul Licameli split from AudacityProject.cpp
 #include "ProjectFileIOExtension.h"
 #include "ProjectFormatExtensionsRegistry.h"
 
-#include "BufferedStreamReader.h"
 #include "FromChars.h"
 
 #include "sqlite/SQLiteUtils.h"
@@ -281,6 +283,11 @@ public:
       return mOffset == mBlobSize;
    }
 
+   size_t GetSize() const noexcept
+   {
+      return mBlobSize;
+   }
+
 private:
    sqlite3_blob* mBlob { nullptr };
    size_t mBlobSize { 0 };
@@ -290,87 +297,134 @@ private:
    bool mIsReadOnly { false };
 };
 
-class BufferedProjectBlobStream : public BufferedStreamReader
+//! Reads the dictionary and then the data of a document into one buffer on
+//! another thread, so that decoding can overlap reading
+/*!
+ @param[out] reading finishes when all is read, or reading fails, giving
+ whether all was read
+ @return null if the blobs can't be opened
+ */
+static std::unique_ptr<ProjectDocumentBuffer> StartReadingDocument(
+   sqlite3* db, const char* table, int64_t rowID, std::future<bool>& reading)
 {
-public:
-   static constexpr std::array<const char*, 2> Columns = { "dict", "doc" };
-
-   BufferedProjectBlobStream(
-      sqlite3* db, const char* schema, const char* table,
-      int64_t rowID)
-       // Despite we use 64k pages in SQLite - it is impossible to guarantee
-       // that read is satisfied from a single page.
-       // Reading 64k proved to be slower, (64k - 8) gives no measurable difference
-       // to reading 32k.
-       // Reading 4k is slower than reading 32k.
-       : BufferedStreamReader(32 * 1024)
-       , mDB(db)
-       , mSchema(schema)
-       , mTable(table)
-       , mRowID(rowID)
-   {
-   }
+   auto dict = SQLiteBlobStream::Open(db, "main", table, "dict", rowID, true);
+   auto doc = SQLiteBlobStream::Open(db, "main", table, "doc", rowID, true);
+   if (!dict || !doc)
+      return {};
 
-private:
-   bool OpenBlob(size_t index)
-   {
-      if (index >= Columns.size())
+   auto pBuffer = std::make_unique<ProjectDocumentBuffer>(
+      dict->GetSize() + doc->GetSize());
+   reading = std::async(std::launch::async,
+      [pBuffer = pBuffer.get(),
+         blobs = std::array<SQLiteBlobStream, 2>{
+            std::move(*dict), std::move(*doc) }]() mutable
+   {
+      // Make the bytes ready in pieces, so that decoding starts soon.
+      // Despite we use 64k pages in SQLite - it is impossible to guarantee
+      // that read is satisfied from a single page.  Reading 32k was found
+      // best.
+      constexpr int ChunkSize = 32 * 1024;
+      auto cleanup = finally([&]{ pBuffer->Finish(); });
+      size_t offset = 0;
+      for (auto& blob : blobs)
       {
-         mBlobStream.reset();
-         return false;
+         while (!blob.IsEof())
+         {
+            int bytesRead = ChunkSize;
+            if (SQLITE_OK != blob.Read(pBuffer->GetData() + offset, bytesRead))
+               // The decoder will find the document truncated
+               return false;
+            offset += bytesRead;
+            pBuffer->SetReady(offset);
+         }
+         blob.Close();
       }
+      return true;
+   });
+   return pBuffer;
+}
+
+// autosavejournal holds the changes of the document since the one in the
+// autosave table, which is the base.  It is made when first needed, so that
+// project files that never had it are unchanged, and dropped with the
+// autosave.
+// part is a key, or else -1 for a layout of the parts or -2 for a new
+// dictionary; see AutoSaveJournal.
+// seq orders the rows as they were written.
+static const char *AutoSaveJournalSchema =
+   "CREATE TABLE IF NOT EXISTS main.autosavejournal"
+   "("
+   "  seq                  INTEGER PRIMARY KEY,"
+   "  part                 INTEGER,"
+   "  doc                  BLOB"
+   ");";
 
-      mBlobStream = SQLiteBlobStream::Open(
-         mDB, mSchema, mTable, Columns[index], mRowID, true);
-
-      return mBlobStream.has_value();
+namespace {
+bool ReadBlob(sqlite3 *db, const char *table, const char *column,
+   int64_t rowID, AutoSaveJournal::Bytes &bytes)
+{
+   auto blobStream =
+      SQLiteBlobStream::Open(db, "main", table, column, rowID, true);
+   if (!blobStream)
+      return false;
+   bytes.clear();
+   constexpr int ChunkSize = 64 * 1024;
+   while (!blobStream->IsEof())
+   {
+      const auto size = bytes.size();
+      bytes.resize(size + ChunkSize);
+      int bytesRead = ChunkSize;
+      if (SQLITE_OK != blobStream->Read(bytes.data() + size, bytesRead))
+         return false;
+      bytes.resize(size + bytesRead);
    }
+   return true;
+}
 
-   std::optional<SQLiteBlobStream> mBlobStream;
-   size_t mNextBlobIndex { 0 };
+//! @return whether any entries could be read
+bool ReadAutoSaveJournal(sqlite3 *db, AutoSaveJournal::Entries &entries)
+{
+   entries.clear();
 
-   sqlite3* mDB;
-   const char* mSchema;
-   const char* mTable;
-   const int64_t mRowID;
+   sqlite3_stmt *stmt = nullptr;
+   auto cleanup = finally([&]{ sqlite3_finalize(stmt); });
 
-protected:
-   bool HasMoreData() const override
-   {
-      return mBlobStream.has_value() || mNextBlobIndex < Columns.size();
-   }
+   // Fails if the table does not exist, which is not an error
+   if (sqlite3_prepare_v2(db,
+         "SELECT part, doc FROM main.autosavejournal ORDER BY seq;",
+         -1, &stmt, nullptr) != SQLITE_OK)
+      return false;
 
-   size_t ReadData(void* buffer, size_t maxBytes) override
+   int rc;
+   while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
    {
-      if (!mBlobStream || mBlobStream->IsEof())
-      {
-         if (!OpenBlob(mNextBlobIndex++))
-            return {};
-      }
-
-      // Do not allow reading more then 2GB at a time (O_o)
-      maxBytes = std::min<size_t>(maxBytes, std::numeric_limits<int>::max());
-      auto bytesRead = static_cast<int>(maxBytes);
-
-      if (SQLITE_OK != mBlobStream->Read(buffer, bytesRead))
-      {
-         // Reading has failed, close the stream and do not allow opening
-         // the next one
-         mBlobStream = {};
-         mNextBlobIndex = Columns.size();
-
-         return 0;
-      }
-      else if (bytesRead == 0)
-      {
-         mBlobStream = {};
-      }
-
-      return static_cast<size_t>(bytesRead);
+      const auto bytes =
+         static_cast<const uint8_t *>(sqlite3_column_blob(stmt, 1));
+      const auto size = sqlite3_column_bytes(stmt, 1);
+      entries.push_back({ sqlite3_column_int64(stmt, 0),
+         bytes ? AutoSaveJournal::Bytes(bytes, bytes + size)
+               : AutoSaveJournal::Bytes{} });
    }
+   return rc == SQLITE_DONE && !entries.empty();
+}
+
+//! Keys of parts of autosaved documents, other than tracks
+enum : AutoSaveJournal::PartKey {
+   //! Everything before the first track
+   HeadPartKey,
+   //! Everything after the last track
+   TailPartKey,
+   FirstTrackPartKey,
 };
+}
 
-constexpr std::array<const char*, 2> BufferedProjectBlobStream::Columns;
+struct ProjectFileIO::AutoSaveState
+{
+   AutoSaveJournal journal;
+   //! Keys of parts of the document for tracks, stable across autosaves
+   std::map<TrackId, AutoSaveJournal::PartKey> trackKeys;
+   AutoSaveJournal::PartKey nextTrackKey{ FirstTrackPartKey };
+};
 
 bool ProjectFileIO::InitializeSQL()
 {
@@ -407,6 +461,7 @@ const ProjectFileIO &ProjectFileIO::Get( const AudacityProject &project )
 ProjectFileIO::ProjectFileIO(AudacityProject &project)
    : mProject{ project }
    , mpErrors{ std::make_shared<DBConnectionErrors>() }
+   , mpAutoSaveState{ std::make_unique<AutoSaveState>() }
 {
    mPrevConn = nullptr;
 
@@ -480,12 +535,29 @@ sqlite3 *ProjectFileIO::DB()
    return GetConnection().DB();
 }
 
+ProjectFileIO::ConnectionChange::ConnectionChange(
+   ProjectFileIO &projectFileIO
+)  : mProjectFileIO{ projectFileIO }
+{
+   mProjectFileIO.Publish(ProjectFileIOMessage::ConnectionChanging);
+}
+
+ProjectFileIO::ConnectionChange::~ConnectionChange()
+{
+   mProjectFileIO.Publish(ProjectFileIOMessage::ConnectionChanged);
+}
+
 /*!
  @pre *CurConn() does not exist
  @post *CurConn() exists or return value is false
  */
 bool ProjectFileIO::OpenConnection(FilePath fileName /* = {}  */)
 {
+   const ConnectionChange change{ *this };
+
+   // The journal of changes does not carry over to another connection
+   ResetAutoSaveJournal();
+
    auto &curConn = CurrConn();
    wxASSERT(!curConn);
    bool isTemp = false;
@@ -544,6 +616,11 @@ bool ProjectFileIO::OpenConnection(FilePath fileName /* = {}  */)
 
 bool ProjectFileIO::CloseConnection()
 {
+   const ConnectionChange change{ *this };
+
+   // The journal of changes does not carry over to another connection
+   ResetAutoSaveJournal();
+
    auto &curConn = CurrConn();
    if (!curConn)
       return false;
@@ -563,6 +640,11 @@ bool ProjectFileIO::CloseConnection()
 // another may be opened with OpenConnection()
 void ProjectFileIO::SaveConnection()
 {
+   const ConnectionChange change{ *this };
+
+   // The journal of changes does not carry over to another connection
+   ResetAutoSaveJournal();
+
    // Should do nothing in proper usage, but be sure not to leak a connection:
    DiscardConnection();
 
@@ -576,6 +658,8 @@ void ProjectFileIO::SaveConnection()
 // Close any set-aside connection
 void ProjectFileIO::DiscardConnection()
 {
+   const ConnectionChange change{ *this };
+
    if (mPrevConn)
    {
       if (!mPrevConn->Close())
@@ -610,6 +694,11 @@ void ProjectFileIO::DiscardConnection()
 // Close any current connection and switch back to using the saved
 void ProjectFileIO::RestoreConnection()
 {
+   const ConnectionChange change{ *this };
+
+   // The journal of changes does not carry over to another connection
+   ResetAutoSaveJournal();
+
    auto &curConn = CurrConn();
    if (curConn)
    {
@@ -631,6 +720,11 @@ void ProjectFileIO::RestoreConnection()
 
 void ProjectFileIO::UseConnection(Connection &&conn, const FilePath &filePath)
 {
+   const ConnectionChange change{ *this };
+
+   // The journal of changes does not carry over to another connection
+   ResetAutoSaveJournal();
+
    auto &curConn = CurrConn();
    wxASSERT(!curConn);
 
@@ -1744,7 +1838,8 @@ void ProjectFileIO::WriteXMLHeader(XMLWriter &xmlFile) const
 
 void ProjectFileIO::WriteXML(XMLWriter &xmlFile,
                              bool recording /* = false */,
-                             const TrackList *tracks /* = nullptr */)
+                             const TrackList *tracks /* = nullptr */,
+                             const PartCallback &partCallback /* = {} */)
 // may throw
 {
    auto &proj = mProject;
@@ -1759,6 +1854,8 @@ void ProjectFileIO::WriteXML(XMLWriter &xmlFile,
    xmlFile.WriteAttr(wxT("audacityversion"), AUDACITY_VERSION_STRING);
 
    ProjectFileIORegistry::Get().CallWriters(proj, xmlFile);
+   if (partCallback)
+      partCallback(nullptr);
 
    auto &pendingTracks = PendingTracks::Get(proj);
    tracklist.Any().Visit([&](const Track &t) {
@@ -1778,6 +1875,8 @@ void ProjectFileIO::WriteXML(XMLWriter &xmlFile,
          return;
       }
       useTrack->WriteXML(xmlFile);
+      if (partCallback)
+         partCallback(useTrack);
    });
 
    xmlFile.EndTag(wxT("project"));
@@ -1787,17 +1886,140 @@ void ProjectFileIO::WriteXML(XMLWriter &xmlFile,
 
 bool ProjectFileIO::AutoSave(bool recording)
 {
+   auto &state = *mpAutoSaveState;
    ProjectSerializer autosave;
+
+   // Cut the document into parts, for the project and for each track, so
+   // that only those that changed since the last autosave are written
+   AutoSaveJournal::Parts parts;
+   size_t partStart = 0;
+   const auto endPart = [&](AutoSaveJournal::PartKey key) {
+      const auto partEnd = autosave.GetData().GetSize();
+      parts.push_back({ key, partEnd - partStart });
+      partStart = partEnd;
+   };
+   std::map<TrackId, AutoSaveJournal::PartKey> trackKeys;
    WriteXMLHeader(autosave);
-   WriteXML(autosave, recording);
+   WriteXML(autosave, recording, nullptr, [&](const Track *pTrack) {
+      if (!pTrack)
+         return endPart(HeadPartKey);
+      const auto id = pTrack->GetId();
+      auto iter = state.trackKeys.find(id);
+      auto [newIter, inserted] = trackKeys.emplace(id,
+         iter == state.trackKeys.end() ? state.nextTrackKey++ : iter->second);
+      // Keys must be unique in a document, even if ids are not
+      endPart(inserted ? newIter->second : state.nextTrackKey++);
+   });
+   endPart(TailPartKey);
+   state.trackKeys.swap(trackKeys);
 
-   if (WriteDoc("autosave", autosave))
+   const auto &dict = autosave.GetDict();
+   const auto &data = autosave.GetData();
+
+   TransactionScope transaction(mProject, "AutoSave");
+
+   // Another may have deleted the autosave; then write it whole
+   int64_t rowId = -1;
+   if (!GetValue("SELECT ROWID FROM main.autosave WHERE id = 1;", rowId, true))
+      state.journal.Reset();
+
+   bool success = false;
+   if (auto entries = state.journal.Record(parts,
+      data.GetData(), data.GetSize(), dict.GetData(), dict.GetSize()))
+      success = WriteAutoSaveJournal(*entries, false);
+   else
+      success = WriteDoc("autosave", autosave) &&
+         WriteAutoSaveJournal({ state.journal.Rebase(parts,
+            data.GetData(), data.GetSize(), dict.GetSize()) }, true);
+   success = success && transaction.Commit();
+
+   if (!success)
    {
-      mModified = true;
+      // Recorded changes were not written
+      ResetAutoSaveJournal();
+      return false;
+   }
+
+   mModified = true;
+   return true;
+}
+
+bool ProjectFileIO::WriteAutoSaveJournal(
+   const AutoSaveJournal::Entries &entries, bool restart)
+{
+   auto db = DB();
+
+   if (restart)
+   {
+      // Make the table if needed, and forget changes of a previous base
+      wxString sql = AutoSaveJournalSchema;
+      sql += "DELETE FROM main.autosavejournal;";
+      if (sqlite3_exec(db, sql, nullptr, nullptr, nullptr) != SQLITE_OK)
+      {
+         ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(sqlite3_errcode(db)));
+         ADD_EXCEPTION_CONTEXT("sqlite3.context", "ProjectGileIO::WriteAutoSaveJournal::restart");
+
+         SetDBError(
+            XO("Failed to update the project file.\nThe following command failed:\n\n%s")
+               .Format(sql));
+         return false;
+      }
+   }
+
+   if (entries.empty())
       return true;
+
+   const char *sql =
+      "INSERT INTO main.autosavejournal(part, doc) VALUES(?1, ?2);";
+
+   sqlite3_stmt *stmt = nullptr;
+   auto cleanup = finally([&]
+   {
+      if (stmt)
+      {
+         sqlite3_finalize(stmt);
+      }
+   });
+
+   if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.query", sql);
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(sqlite3_errcode(db)));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "ProjectGileIO::WriteAutoSaveJournal::prepare");
+
+      SetDBError(
+         XO("Unable to prepare project file command:\n\n%s").Format(sql)
+      );
+      return false;
+   }
+
+   for (const auto &entry : entries)
+   {
+      int rc = SQLITE_OK;
+      if (sqlite3_bind_int64(stmt, 1, entry.key) ||
+          sqlite3_bind_blob64(stmt, 2, entry.bytes.data(), entry.bytes.size(),
+             SQLITE_STATIC) ||
+          (rc = sqlite3_step(stmt)) != SQLITE_DONE)
+      {
+         ADD_EXCEPTION_CONTEXT("sqlite3.query", sql);
+         ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+         ADD_EXCEPTION_CONTEXT("sqlite3.context", "ProjectGileIO::WriteAutoSaveJournal::step");
+
+         SetDBError(
+            XO("Failed to update the project file.\nThe following command failed:\n\n%s")
+               .Format(sql));
+         return false;
+      }
+      sqlite3_reset(stmt);
    }
 
-   return false;
+   return true;
+}
+
+void ProjectFileIO::ResetAutoSaveJournal()
+{
+   if (mpAutoSaveState)
+      mpAutoSaveState->journal.Reset();
 }
 
 bool ProjectFileIO::AutoSaveDelete(sqlite3 *db /* = nullptr */)
@@ -1809,7 +2031,12 @@ bool ProjectFileIO::AutoSaveDelete(sqlite3 *db /* = nullptr */)
       db = DB();
    }
 
-   rc = sqlite3_exec(db, "DELETE FROM autosave;", nullptr, nullptr, nullptr);
+   // The journal of changes goes too, and is made again when needed
+   rc = sqlite3_exec(db,
+      "DELETE FROM autosave;"
+      "DROP TABLE IF EXISTS autosavejournal;",
+      nullptr, nullptr, nullptr);
+   ResetAutoSaveJournal();
    if (rc != SQLITE_OK)
    {
       ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
@@ -2065,11 +2292,53 @@ auto ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
       return {};
    else
    {
+      // Apply any journal of changes to the autosave
+      AutoSaveJournal::Bytes dict, data;
+      bool replayed = false;
+      if (useAutosave)
+      {
+         AutoSaveJournal::Entries entries;
+         replayed = ReadAutoSaveJournal(DB(), entries) &&
+            ReadBlob(DB(), "autosave", "dict", rowId, dict) &&
+            ReadBlob(DB(), "autosave", "doc", rowId, data) &&
+            AutoSaveJournal::Replay(dict, data, entries);
+         if (!replayed && !entries.empty())
+            wxLogMessage(wxT("Autosave journal not applied; "
+               "recovering from the last whole autosave"));
+      }
+
       // Load 'er up
-      BufferedProjectBlobStream stream(
-         DB(), "main", useAutosave ? "autosave" : "project", rowId);
+      std::unique_ptr<ProjectDocumentBuffer> pDocument;
+      // Destroyed first, which waits for the thread that writes the buffer
+      std::future<bool> reading;
+      if (replayed)
+      {
+         pDocument =
+            std::make_unique<ProjectDocumentBuffer>(dict.size() + data.size());
+         std::copy(dict.begin(), dict.end(), pDocument->GetData());
+         std::copy(data.begin(), data.end(),
+            pDocument->GetData() + dict.size());
+         pDocument->SetReady(pDocument->GetSize());
+         pDocument->Finish();
+      }
+      else
+         pDocument = StartReadingDocument(
+            DB(), useAutosave ? "autosave" : "project", rowId, reading);
 
-      success = ProjectSerializer::Decode(stream, this);
+      // Let the factory fetch metadata of all the blocks at once
+      const auto pSampleBlockFactory =
+         WaveTrackFactory::Get(mProject).GetSampleBlockFactory();
+      pSampleBlockFactory->BeginBulkLoad();
+      {
+         auto cleanup =
+            finally([&]{ pSampleBlockFactory->EndBulkLoad(); });
+         success = pDocument && ProjectSerializer::Decode(*pDocument, this);
+      }
+      // Let the reading thread release its blobs before anything else.
+      // Never go on to delete orphan blocks after reading only part of the
+      // document: the blocks of the rest would look orphaned.
+      if (reading.valid() && !reading.get())
+         success = false;
 
       if (!success)
       {
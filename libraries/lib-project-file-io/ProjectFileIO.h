@@ -11,12 +11,14 @@ Paul Licameli split from AudacityProject.h
 #ifndef __AUDACITY_PROJECT_FILE_IO__
 #define __AUDACITY_PROJECT_FILE_IO__
 
+#include <functional>
 #include <memory>
 #include <optional>
 #include <unordered_set>
 
 #include <wx/event.h>
 
+#include "AutoSaveJournal.h"
 #include "ClientData.h" // to inherit
 #include "Observer.h"
 #include "Prefs.h" // to inherit
@@ -32,6 +34,7 @@ class DBConnection;
 struct DBConnectionErrors;
 class ProjectSerializer;
 class SqliteSampleBlock;
+class Track;
 class TrackList;
 class WaveTrack;
 
@@ -53,6 +56,9 @@ enum class ProjectFileIOMessage : int {
       after temporary close and attempted file movement */
    ProjectTitleChange,  //!< A normal occurrence
    ProjectFilePathChange,  //!< A normal occurrence
+   ConnectionChanging, /*!< The database connection is about to be closed or
+      replaced; other threads must stop using it until ConnectionChanged */
+   ConnectionChanged,   //!< Follows each ConnectionChanging
 };
 
 ///\brief Object associated with a project that manages reading and writing
@@ -232,8 +238,18 @@ private:
    void OnCheckpointFailure();
 
    void WriteXMLHeader(XMLWriter &xmlFile) const;
+   //! Called after the elements preceding the tracks, with null, and then
+   //! after each track, with the track
+   using PartCallback = std::function<void(const Track *)>;
    void WriteXML(XMLWriter &xmlFile, bool recording = false,
-      const TrackList *tracks = nullptr) /* not override */;
+      const TrackList *tracks = nullptr,
+      const PartCallback &partCallback = {}) /* not override */;
+
+   //! Append to the table of autosave changes, creating it as needed
+   bool WriteAutoSaveJournal(const AutoSaveJournal::Entries &entries,
+      bool restart);
+   //! Forget what was autosaved, so that the next autosave is whole
+   void ResetAutoSaveJournal();
 
    // XMLTagHandler callback methods
    bool HandleXMLTag(const std::string_view& tag, const AttributesList &attrs) override;
@@ -304,6 +320,13 @@ private:
 private:
    Connection &CurrConn();
 
+   //! Publishes ConnectionChanging, then ConnectionChanged when destroyed
+   struct ConnectionChange {
+      explicit ConnectionChange(ProjectFileIO &projectFileIO);
+      ~ConnectionChange();
+      ProjectFileIO &mProjectFileIO;
+   };
+
    // non-static data members
    AudacityProject &mProject;
 
@@ -332,6 +355,9 @@ private:
    Connection mPrevConn;
    FilePath mPrevFileName;
    bool mPrevTemporary;
+
+   struct AutoSaveState;
+   std::unique_ptr<AutoSaveState> mpAutoSaveState;
 };
 
 //! Makes a temporary project that doesn't display on the screen
@@ -17,7 +17,9 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <mutex>
+#include <optional>
 #include <wx/ustring.h>
 #include <codecvt>
 #include <locale>
@@ -142,7 +144,8 @@ template <typename Number> void WriteBigEndian(MemoryStream& out, Number value)
 }
 
 // Read little-endian file format to native little-endian
-template <typename Number> Number ReadLittleEndian(BufferedStreamReader& in)
+template <typename Number, typename Reader>
+Number ReadLittleEndian(Reader& in)
 {
    Number result;
    in.ReadValue(result);
@@ -150,7 +153,8 @@ template <typename Number> Number ReadLittleEndian(BufferedStreamReader& in)
 }
 
 // Read little-endian file format to native big-endian
-template <typename Number> Number ReadBigEndian(BufferedStreamReader& in)
+template <typename Number, typename Reader>
+Number ReadBigEndian(Reader& in)
 {
    Number result;
    in.ReadValue(result);
@@ -171,27 +175,21 @@ static const auto WriteULong =
 static const auto WriteLongLong =
    IsLittleEndian() ? &WriteLittleEndian<LongLong> : &WriteBigEndian<LongLong>;
 
-static const auto ReadUShort =
-   IsLittleEndian() ? &ReadLittleEndian<UShort> : &ReadBigEndian<UShort>;
-static const auto ReadInt =
-   IsLittleEndian() ? &ReadLittleEndian<Int> : &ReadBigEndian<Int>;
-static const auto ReadLong =
-   IsLittleEndian() ? &ReadLittleEndian<Long> : &ReadBigEndian<Long>;
-static const auto ReadULong =
-   IsLittleEndian() ? &ReadLittleEndian<ULong> : &ReadBigEndian<ULong>;
-static const auto ReadLongLong =
-   IsLittleEndian() ? &ReadLittleEndian<LongLong> : &ReadBigEndian<LongLong>;
+// Reading is generic in the source of the bytes
+template <typename Number, typename Reader> Number ReadNumber(Reader& in)
+{
+   return IsLittleEndian()
+      ? ReadLittleEndian<Number>(in) : ReadBigEndian<Number>(in);
+}
 
 // Functions to read and write certain lengths -- maybe we will change
 // our choices for widths or signedness?
 
 using Length = Int; // Instead, as wide as size_t?
 static const auto WriteLength = WriteInt;
-static const auto ReadLength = ReadInt;
 
 using Digits = Int; // Instead, just an unsigned char?
 static const auto WriteDigits = WriteInt;
-static const auto ReadDigits = ReadInt;
 
 class XMLTagHandlerAdapter final
 {
@@ -221,14 +219,15 @@ public:
       mHandlers.pop_back();
    }
 
-   void WriteAttr(const std::string_view& name, std::string value)
+   //! @param value must remain valid until the tag is emitted
+   void WriteAttr(const std::string_view& name, std::string_view value)
    {
       assert(mInTag);
 
       if (!mInTag)
          return;
 
-      mAttributes.emplace_back(name, CacheString(std::move(value)));
+      mAttributes.emplace_back(name, XMLAttributeValueView(value));
    }
 
    template <typename T> void WriteAttr(const std::string_view& name, T value)
@@ -241,16 +240,16 @@ public:
       mAttributes.emplace_back(name, XMLAttributeValueView(value));
    }
 
-   void WriteData(std::string value)
+   void WriteData(std::string_view value)
    {
       if (mInTag)
          EmitStartTag();
 
       if (XMLTagHandler* const handler = mHandlers.back())
-         handler->HandleXMLContent(CacheString(std::move(value)));
+         handler->HandleXMLContent(value);
    }
 
-   void WriteRaw(std::string)
+   void WriteRaw(std::string_view)
    {
       // This method is intentionally left empty.
       // The only data that is serialized by FT_Raw
@@ -295,17 +294,23 @@ private:
          }
       }
 
-      mStringsCache.clear();
+      // Keep the strings for reuse without allocations
+      mStringsUsed = 0;
       mAttributes.clear();
       mInTag = false;
    }
 
-   std::string_view CacheString(std::string string)
+public:
+   //! @return storage for a string that lasts until the tag is emitted
+   std::string& NewString()
    {
-      mStringsCache.emplace_back(std::move(string));
-      return mStringsCache.back();
+      // Elements of a deque don't move when it grows
+      if (mStringsUsed == mStringsCache.size())
+         mStringsCache.emplace_back();
+      return mStringsCache[mStringsUsed++];
    }
 
+private:
    XMLTagHandler* mBaseHandler;
 
    std::vector<XMLTagHandler*> mHandlers;
@@ -313,6 +318,7 @@ private:
    std::string_view mCurrentTagName;
 
    std::deque<std::string> mStringsCache;
+   size_t mStringsUsed { 0 };
    AttributesList mAttributes;
 
    bool mInTag { false };
@@ -324,26 +330,368 @@ private:
 // 
 // }
 
+//! Convert to UTF-8 in reused storage
+/*! The characters need not be aligned */
 template<typename BaseCharType>
-std::string FastStringConvert(const void* bytes, int bytesCount)
+void FastStringConvert(std::string& out, const char* bytes, int bytesCount)
 {
    constexpr int charSize = sizeof(BaseCharType);
 
    assert(bytesCount % charSize == 0);
 
-   const auto begin = static_cast<const BaseCharType*>(bytes);
-   const auto end = begin + bytesCount / charSize;
+   const auto count = bytesCount / charSize;
+   const auto at = [bytes](int i)
+   {
+      BaseCharType c;
+      memcpy(&c, bytes + i * charSize, charSize);
+      return c;
+   };
 
-   const bool isAscii = std::all_of(
-      begin, end,
-      [](BaseCharType c)
-      { return static_cast<std::make_unsigned_t<BaseCharType>>(c) < 0x7f; });
+   bool isAscii = true;
+   for (int i = 0; isAscii && i < count; ++i)
+      isAscii =
+         static_cast<std::make_unsigned_t<BaseCharType>>(at(i)) < 0x7f;
 
    if (isAscii)
-      return std::string(begin, end);
-   
-   return std::wstring_convert<std::codecvt_utf8<BaseCharType>, BaseCharType>()
-      .to_bytes(begin, end);
+   {
+      out.resize(count);
+      for (int i = 0; i < count; ++i)
+         out[i] = static_cast<char>(at(i));
+      return;
+   }
+
+   std::basic_string<BaseCharType> wide(count, BaseCharType{});
+   memcpy(wide.data(), bytes, count * charSize);
+   out = std::wstring_convert<std::codecvt_utf8<BaseCharType>, BaseCharType>()
+      .to_bytes(wide);
+}
+
+// exception type for short-range try/catch
+struct DecodeError {};
+
+//! Reads a document through a BufferedStreamReader
+class StreamDocumentReader final
+{
+public:
+   //! Bytes must be copied before the next read
+   static constexpr bool StableBytes = false;
+
+   explicit StreamDocumentReader(BufferedStreamReader& in) noexcept
+       : mIn { in }
+   {
+   }
+
+   bool Eof() const { return mIn.Eof(); }
+   int GetC() { return mIn.GetC(); }
+
+   template<typename ValueType> void ReadValue(ValueType& value)
+   {
+      mIn.ReadValue(value);
+   }
+
+   //! @return bytes valid until the next call
+   const char* ReadBytes(size_t count)
+   {
+      mBytes.resize(count);
+      mIn.Read(mBytes.data(), count);
+      return mBytes.data();
+   }
+
+private:
+   BufferedStreamReader& mIn;
+   std::vector<char> mBytes;
+};
+
+//! Reads a document in place, as a ProjectDocumentBuffer becomes ready
+class BufferDocumentReader final
+{
+public:
+   //! Bytes remain valid as long as the buffer
+   static constexpr bool StableBytes = true;
+
+   explicit BufferDocumentReader(const ProjectDocumentBuffer& buffer) noexcept
+       : mBuffer { buffer }
+       , mData { buffer.GetData() }
+   {
+   }
+
+   bool Eof() { return !Available(1); }
+   int GetC() { return static_cast<unsigned char>(*ReadBytes(1)); }
+
+   template<typename ValueType> void ReadValue(ValueType& value)
+   {
+      memcpy(&value, ReadBytes(sizeof(value)), sizeof(value));
+   }
+
+   const char* ReadBytes(size_t count)
+   {
+      if (!Available(count))
+         throw DecodeError{};
+      const auto result = mData + mPosition;
+      mPosition += count;
+      return result;
+   }
+
+private:
+   bool Available(size_t count)
+   {
+      // Synchronize with the producer only when the known bytes run out
+      if (mReady - mPosition < count)
+         mReady = mBuffer.WaitUntilReady(mPosition + count);
+      return mReady - mPosition >= count;
+   }
+
+   const ProjectDocumentBuffer& mBuffer;
+   const char* const mData;
+   size_t mPosition { 0 };
+   size_t mReady { 0 };
+};
+
+template<typename Reader>
+bool DecodeDocument(Reader& in, XMLTagHandler* handler)
+{
+   if (handler == nullptr)
+      return false;
+
+   XMLTagHandlerAdapter adapter(handler);
+
+   // Names indexed by id, viewing the document itself or else nameStorage
+   using IdVector = std::vector<std::optional<std::string_view>>;
+   IdVector ids;
+   std::vector<IdVector> idStack;
+   std::deque<std::string> nameStorage;
+   char charSize = 0;
+
+   auto Lookup = [&ids]( UShort id ) -> std::string_view
+   {
+      if (id >= ids.size() || !ids[id])
+      {
+         throw DecodeError{};
+      }
+
+      return *ids[id];
+   };
+
+   int64_t stringsCount = 0;
+   int64_t stringsLength = 0;
+
+   // Strings that need no conversion are not copied, if the reader allows;
+   // otherwise the result is in the string returned by newStorage()
+   auto ReadString = [&charSize, &in, &stringsCount, &stringsLength](
+      int len, auto&& newStorage) -> std::string_view
+   {
+      if (len < 0)
+         throw DecodeError{};
+
+      const auto bytes = in.ReadBytes(len);
+
+      stringsCount++;
+      stringsLength += len;
+
+      switch (charSize)
+      {
+         case 1:
+            if constexpr (Reader::StableBytes)
+               return { bytes, static_cast<size_t>(len) };
+            else
+               return newStorage().assign(bytes, len);
+
+         case 2:
+         {
+            auto& storage = newStorage();
+            FastStringConvert<char16_t>(storage, bytes, len);
+            return storage;
+         }
+
+         case 4:
+         {
+            auto& storage = newStorage();
+            FastStringConvert<char32_t>(storage, bytes, len);
+            return storage;
+         }
+
+         default:
+            wxASSERT_MSG(false, wxT("Characters size not 1, 2, or 4"));
+         break;
+      }
+
+      return {};
+   };
+   const auto TagStorage = [&adapter]() -> std::string&
+   {
+      return adapter.NewString();
+   };
+   const auto NameStorage = [&nameStorage]() -> std::string&
+   {
+      return nameStorage.emplace_back();
+   };
+
+   try
+   {
+      while (!in.Eof())
+      {
+         UShort id;
+
+         switch (in.GetC())
+         {
+            case FT_Push:
+            {
+               idStack.push_back(ids);
+               ids.clear();
+            }
+            break;
+
+            case FT_Pop:
+            {
+               if (idStack.empty())
+                  throw DecodeError{};
+               ids = std::move(idStack.back());
+               idStack.pop_back();
+            }
+            break;
+
+            case FT_Name:
+            {
+               id = ReadNumber<UShort>( in );
+               auto len = ReadNumber<UShort>( in );
+               if (id >= ids.size())
+                  ids.resize(id + 1);
+               ids[id] = ReadString(len, NameStorage);
+            }
+            break;
+
+            case FT_StartTag:
+            {
+               id = ReadNumber<UShort>( in );
+
+               adapter.EmitStartTag(Lookup(id));
+            }
+            break;
+
+            case FT_EndTag:
+            {
+               id = ReadNumber<UShort>( in );
+
+               adapter.EndTag(Lookup(id));
+            }
+            break;
+
+            case FT_String:
+            {
+               id = ReadNumber<UShort>( in );
+               int len = ReadNumber<Length>( in );
+
+               adapter.WriteAttr(Lookup(id), ReadString(len, TagStorage));
+            }
+            break;
+
+            case FT_Float:
+            {
+               float val;
+
+               id = ReadNumber<UShort>( in );
+               in.ReadValue(val);
+               /* int dig = */ReadNumber<Digits>(in);
+
+               adapter.WriteAttr(Lookup(id), val);
+            }
+            break;
+
+            case FT_Double:
+            {
+               double val;
+
+               id = ReadNumber<UShort>( in );
+               in.ReadValue(val);
+               /*int dig = */ReadNumber<Digits>(in);
+
+               adapter.WriteAttr(Lookup(id), val);
+            }
+            break;
+
+            case FT_Int:
+            {
+               id = ReadNumber<UShort>( in );
+               int val = ReadNumber<Int>( in );
+
+               adapter.WriteAttr(Lookup(id), val);
+            }
+            break;
+
+            case FT_Bool:
+            {
+               unsigned char val;
+
+               id = ReadNumber<UShort>( in );
+               in.ReadValue(val);
+
+               adapter.WriteAttr(Lookup(id), val);
+            }
+            break;
+
+            case FT_Long:
+            {
+               id = ReadNumber<UShort>( in );
+               long val = ReadNumber<Long>( in );
+
+               adapter.WriteAttr(Lookup(id), val);
+            }
+            break;
+
+            case FT_LongLong:
+            {
+               id = ReadNumber<UShort>( in );
+               long long val = ReadNumber<LongLong>( in );
+               adapter.WriteAttr(Lookup(id), val);
+            }
+            break;
+
+            case FT_SizeT:
+            {
+               id = ReadNumber<UShort>( in );
+               size_t val = ReadNumber<ULong>( in );
+
+               adapter.WriteAttr(Lookup(id), val);
+            }
+            break;
+
+            case FT_Data:
+            {
+               int len = ReadNumber<Length>( in );
+               adapter.WriteData(ReadString(len, TagStorage));
+            }
+            break;
+
+            case FT_Raw:
+            {
+               int len = ReadNumber<Length>( in );
+               adapter.WriteRaw(ReadString(len, TagStorage));
+            }
+            break;
+
+            case FT_CharSize:
+            {
+               in.ReadValue(charSize);
+            }
+            break;
+
+            default:
+               wxASSERT(true);
+            break;
+         }
+      }
+   }
+   catch( const DecodeError& )
+   {
+      // Document was corrupt, or platform differences in size or endianness
+      // were not well canonicalized
+      return false;
+   }
+
+   wxLogInfo(
+      "Loaded %lld string %f Kb in size", stringsCount, stringsLength / 1024.0);
+
+   return adapter.Finalize();
 }
 } // namespace
 
@@ -522,221 +870,49 @@ bool ProjectSerializer::DictChanged() const
 // See ProjectFileIO::LoadProject() for explanation of the blockids arg
 bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
 {
-   if (handler == nullptr)
-      return false;
-
-   XMLTagHandlerAdapter adapter(handler);
-
-   std::vector<char> bytes;
-   IdMap mIds;
-   std::vector<IdMap> mIdStack;
-   char mCharSize = 0;
-
-   mIds.clear();
-
-   struct Error{}; // exception type for short-range try/catch
-   auto Lookup = [&mIds]( UShort id ) -> std::string_view
-   {
-      auto iter = mIds.find( id );
-      if (iter == mIds.end())
-      {
-         throw Error{};
-      }
-
-      return iter->second;
-   };
-
-   int64_t stringsCount = 0;
-   int64_t stringsLength = 0;
-
-   auto ReadString = [&mCharSize, &in, &bytes, &stringsCount, &stringsLength](int len) -> std::string
-   {
-      bytes.reserve( len );
-      auto data = bytes.data();
-      in.Read( data, len );
-
-      stringsCount++;
-      stringsLength += len;
-      
-      switch (mCharSize)
-      {
-         case 1:
-            return std::string(bytes.data(), len);
-
-         case 2:
-            return FastStringConvert<char16_t>(bytes.data(), len);
+   StreamDocumentReader reader{ in };
+   return DecodeDocument(reader, handler);
+}
 
-         case 4:
-            return FastStringConvert<char32_t>(bytes.data(), len);
+bool ProjectSerializer::Decode(
+   const ProjectDocumentBuffer& in, XMLTagHandler* handler)
+{
+   BufferDocumentReader reader{ in };
+   // A document cut short at the end of a record decodes without error, so
+   // also require that all of it was read
+   return DecodeDocument(reader, handler) &&
+      in.WaitUntilReady(in.GetSize()) == in.GetSize();
+}
 
-         default:
-            wxASSERT_MSG(false, wxT("Characters size not 1, 2, or 4"));
-         break;
-      }
+ProjectDocumentBuffer::ProjectDocumentBuffer(size_t size)
+   : mData{ std::make_unique<char[]>(size) }
+   , mSize{ size }
+{
+}
 
-      return {};
-   };
+ProjectDocumentBuffer::~ProjectDocumentBuffer() = default;
 
-   try
+void ProjectDocumentBuffer::SetReady(size_t count)
+{
    {
-      while (!in.Eof())
-      {
-         UShort id;
-
-         switch (in.GetC())
-         {
-            case FT_Push:
-            {
-               mIdStack.push_back(mIds);
-               mIds.clear();
-            }
-            break;
-
-            case FT_Pop:
-            {
-               mIds = mIdStack.back();
-               mIdStack.pop_back();
-            }
-            break;
-
-            case FT_Name:
-            {
-               id = ReadUShort( in );
-               auto len = ReadUShort( in );
-               mIds[id] = ReadString(len);
-            }
-            break;
-
-            case FT_StartTag:
-            {
-               id = ReadUShort( in );
-
-               adapter.EmitStartTag(Lookup(id));
-            }
-            break;
-
-            case FT_EndTag:
-            {
-               id = ReadUShort( in );
-
-               adapter.EndTag(Lookup(id));
-            }
-            break;
-
-            case FT_String:
-            {
-               id = ReadUShort( in );
-               int len = ReadLength( in );
-               
-               adapter.WriteAttr(Lookup(id), ReadString(len));
-            }
-            break;
-
-            case FT_Float:
-            {
-               float val;
-
-               id = ReadUShort( in );
-               in.Read(&val, sizeof(val));
-               /* int dig = */ReadDigits(in);
-
-               adapter.WriteAttr(Lookup(id), val);
-            }
-            break;
-
-            case FT_Double:
-            {
-               double val;
-
-               id = ReadUShort( in );
-               in.Read(&val, sizeof(val));
-               /*int dig = */ReadDigits(in);
-
-               adapter.WriteAttr(Lookup(id), val);
-            }
-            break;
-
-            case FT_Int:
-            {
-               id = ReadUShort( in );
-               int val = ReadInt( in );
-
-               adapter.WriteAttr(Lookup(id), val);
-            }
-            break;
-
-            case FT_Bool:
-            {
-               unsigned char val;
-
-               id = ReadUShort( in );
-               in.Read(&val, 1);
-
-               adapter.WriteAttr(Lookup(id), val);
-            }
-            break;
-
-            case FT_Long:
-            {
-               id = ReadUShort( in );
-               long val = ReadLong( in );
-
-               adapter.WriteAttr(Lookup(id), val);
-            }
-            break;
-
-            case FT_LongLong:
-            {
-               id = ReadUShort( in );
-               long long val = ReadLongLong( in );
-               adapter.WriteAttr(Lookup(id), val);
-            }
-            break;
-
-            case FT_SizeT:
-            {
-               id = ReadUShort( in );
-               size_t val = ReadULong( in );
-
-               adapter.WriteAttr(Lookup(id), val);
-            }
-            break;
-
-            case FT_Data:
-            {
-               int len = ReadLength( in );
-               adapter.WriteData(ReadString(len));
-            }
-            break;
-
-            case FT_Raw:
-            {
-               int len = ReadLength( in );
-               adapter.WriteRaw(ReadString(len));
-            }
-            break;
-
-            case FT_CharSize:
-            {
-               in.Read(&mCharSize, 1);
-            }
-            break;
-
-            default:
-               wxASSERT(true);
-            break;
-         }
-      }
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mReady = std::min(count, mSize);
    }
-   catch( const Error& )
+   mCondition.notify_all();
+}
+
+void ProjectDocumentBuffer::Finish()
+{
    {
-      // Document was corrupt, or platform differences in size or endianness
-      // were not well canonicalized
-      return false;
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mFinished = true;
    }
+   mCondition.notify_all();
+}
 
-   wxLogInfo(
-      "Loaded %lld string %f Kb in size", stringsCount, stringsLength / 1024.0);
-
-   return adapter.Finalize();
+size_t ProjectDocumentBuffer::WaitUntilReady(size_t count) const
+{
+   std::unique_lock<std::mutex> lock{ mMutex };
+   mCondition.wait(lock, [&]{ return mFinished || mReady >= count; });
+   return mReady;
 }
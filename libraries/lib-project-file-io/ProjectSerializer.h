@@ -16,6 +16,9 @@
 #include "MemoryStream.h" // member variables
 #include <wx/mstream.h>
 
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <unordered_set>
 #include <unordered_map>
 
@@ -32,6 +35,38 @@ class BufferedStreamReader;
 using NameMap = std::unordered_map<wxString, unsigned short>;
 using IdMap = std::unordered_map<unsigned short, std::string>;
 
+//! Contiguous bytes of an encoded document, its dictionary and then its data,
+//! which one thread may still be filling while another decodes them
+class PROJECT_FILE_IO_API ProjectDocumentBuffer final
+{
+public:
+   explicit ProjectDocumentBuffer(size_t size);
+   ~ProjectDocumentBuffer();
+
+   //! The producer writes bytes here, in order
+   char* GetData() { return mData.get(); }
+   const char* GetData() const { return mData.get(); }
+   size_t GetSize() const { return mSize; }
+
+   //! Make the first `count` bytes visible to the consumer
+   void SetReady(size_t count);
+   //! No more bytes will be ready, possibly fewer than GetSize()
+   void Finish();
+
+   //! Block until at least `count` bytes are ready, or Finish() was called
+   //! @return the number of bytes ready
+   size_t WaitUntilReady(size_t count) const;
+
+private:
+   const std::unique_ptr<char[]> mData;
+   const size_t mSize;
+
+   mutable std::mutex mMutex;
+   mutable std::condition_variable mCondition;
+   size_t mReady{ 0 };
+   bool mFinished{ false };
+};
+
 // This class's overrides do NOT throw AudacityException.
 class PROJECT_FILE_IO_API ProjectSerializer final : public XMLWriter
 {
@@ -68,6 +103,15 @@ public:
    // Returns empty string if decoding fails
    static bool Decode(BufferedStreamReader& in, XMLTagHandler* handler);
 
+   //! Decode in place, as the bytes become ready
+   /*!
+    Fails if Finish() was called before all of the buffer was ready
+
+    Attribute values and names that need no conversion of characters are
+    passed to the handler as views of the buffer, without copying
+    */
+   static bool Decode(const ProjectDocumentBuffer& in, XMLTagHandler* handler);
+
 private:
    void WriteName(const wxString& name);
 
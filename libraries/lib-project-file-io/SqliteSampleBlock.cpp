@@ -27,10 +27,25 @@ Paul Licameli -- split from SampleBlock.cpp and SampleBlock.h
 #include "SentryHelper.h"
 #include <wx/log.h>
 
+#include <algorithm>
+#include <chrono>
 #include <mutex>
+#include <optional>
+#include <vector>
 
 class SqliteSampleBlockFactory;
 
+//! Fields of a row of the sampleblocks table, without summaries and samples
+struct SampleBlockMetadata
+{
+   SampleBlockID id;
+   sampleFormat format;
+   double sumMin;
+   double sumMax;
+   double sumRms;
+   size_t sampleBytes;
+};
+
 ///\brief Implementation of @ref SampleBlock using Sqlite database
 class SqliteSampleBlock final : public SampleBlock
 {
@@ -56,6 +71,8 @@ public:
    void Commit(Sizes sizes);
 
    void Delete();
+   //! Delete the row of a block that is not silent
+   static void Delete(DBConnection &connection, SampleBlockID id);
 
    SampleBlockID GetBlockID() const override;
 
@@ -84,6 +101,8 @@ public:
 private:
    bool IsSilent() const { return mBlockID <= 0; }
    void Load(SampleBlockID sbid);
+   //! Initialize from metadata fetched already, without database access
+   void Load(const SampleBlockMetadata &metadata);
    bool GetSummary(float *dest,
                    size_t frameoffset,
                    size_t numframes,
@@ -169,15 +188,31 @@ public:
    SampleBlockPtr DoCreateFromId(
       sampleFormat srcformat, SampleBlockID id) override;
 
+   void BeginBulkLoad() override;
+   void EndBulkLoad() override;
+
 private:
    void OnBeginPurge(size_t begin, size_t end);
+   void OnCommitPurge();
    void OnEndPurge();
 
+   //! Delete the rows of the blocks destroyed while deletions were deferred
+   /*! Called inside the transaction of the purge, so there is one commit */
+   void FlushDeletions();
+
+   //! Fetch metadata of all blocks in one scan of the table
+   /*! @return whether successful */
+   bool Prefetch();
+   //! @return metadata from the last Prefetch(), or null if absent
+   const SampleBlockMetadata *FindPrefetched(SampleBlockID id) const;
+
    friend SqliteSampleBlock;
 
    AudacityProject &mProject;
    Observer::Subscription mUndoSubscription;
    std::optional<SampleBlock::DeletionCallback::Scope> mScope;
+   class PurgeProgress;
+   std::shared_ptr<PurgeProgress> mpPurgeProgress;
    const std::shared_ptr<ConnectionPtr> mppConnection;
 
    // Track all blocks that this factory has created, but don't control
@@ -187,6 +222,18 @@ private:
    using AllBlocksMap =
       std::map< SampleBlockID, std::weak_ptr< SqliteSampleBlock > >;
    AllBlocksMap mAllBlocks;
+
+   //! Nesting depth of BeginBulkLoad() calls
+   int mBulkLoads{ 0 };
+   //! Metadata of all blocks in the database, sorted by id, fetched on
+   //! demand during bulk loads
+   std::optional<std::vector<SampleBlockMetadata>> mPrefetched;
+
+   //! Whether destroyed blocks only queue their ids, while purging undo
+   //! history
+   bool mDeferDeletions{ false };
+   //! Ids of rows for FlushDeletions() to delete
+   std::vector<SampleBlockID> mPendingDeletions;
 };
 
 SqliteSampleBlockFactory::SqliteSampleBlockFactory( AudacityProject &project )
@@ -198,6 +245,8 @@ SqliteSampleBlockFactory::SqliteSampleBlockFactory( AudacityProject &project )
          switch (message.type) {
          case UndoRedoMessage::BeginPurge:
             return OnBeginPurge(message.begin, message.end);
+         case UndoRedoMessage::CommitPurge:
+            return OnCommitPurge();
          case UndoRedoMessage::EndPurge:
             return OnEndPurge();
          default:
@@ -285,13 +334,86 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreateFromId(
    auto ssb           = std::make_shared<SqliteSampleBlock>(shared_from_this());
    wb                 = ssb;
    ssb->mSampleFormat = srcformat;
-   // This may throw database errors
-   // It initializes the rest of the fields
-   ssb->Load(static_cast<SampleBlockID>(id));
+
+   // During bulk loads, avoid a query per block
+   if (mBulkLoads > 0 && !mPrefetched && !Prefetch())
+      // Don't try again
+      mPrefetched.emplace();
+   if (const auto pMetadata = FindPrefetched(id))
+      ssb->Load(*pMetadata);
+   else
+      // This may throw database errors
+      // It initializes the rest of the fields
+      ssb->Load(static_cast<SampleBlockID>(id));
    
    return ssb;
 }
 
+void SqliteSampleBlockFactory::BeginBulkLoad()
+{
+   ++mBulkLoads;
+}
+
+void SqliteSampleBlockFactory::EndBulkLoad()
+{
+   if (mBulkLoads > 0 && --mBulkLoads == 0)
+      // Free the memory, and don't use stale data later
+      mPrefetched.reset();
+}
+
+bool SqliteSampleBlockFactory::Prefetch()
+{
+   auto &pConnection = mppConnection->mpConnection;
+   if (!pConnection)
+      return false;
+
+   // length() of a blob does not read the blob itself
+   sqlite3_stmt *stmt = pConnection->Prepare(
+      DBConnection::LoadAllSampleBlocks,
+      "SELECT blockid, sampleformat, summin, summax, sumrms,"
+      "       length(samples)"
+      "  FROM sampleblocks ORDER BY blockid;");
+
+   std::vector<SampleBlockMetadata> prefetched;
+   int rc;
+   while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+      prefetched.push_back({
+         sqlite3_column_int64(stmt, 0),
+         static_cast<sampleFormat>(sqlite3_column_int(stmt, 1)),
+         sqlite3_column_double(stmt, 2),
+         sqlite3_column_double(stmt, 3),
+         sqlite3_column_double(stmt, 4),
+         static_cast<size_t>(sqlite3_column_int(stmt, 5))
+      });
+
+   // Rewind statement
+   sqlite3_reset(stmt);
+
+   if (rc != SQLITE_DONE) {
+      wxLogDebug(wxT("SqliteSampleBlockFactory::Prefetch - SQLITE error %s"),
+         sqlite3_errmsg(pConnection->DB()));
+      // Fall back to queries for single blocks, which report errors
+      return false;
+   }
+
+   mPrefetched.emplace(move(prefetched));
+   return true;
+}
+
+const SampleBlockMetadata *
+SqliteSampleBlockFactory::FindPrefetched(SampleBlockID id) const
+{
+   if (!mPrefetched)
+      return nullptr;
+   const auto &prefetched = *mPrefetched;
+   const auto iter = std::lower_bound(prefetched.begin(), prefetched.end(), id,
+      [](const SampleBlockMetadata &metadata, SampleBlockID value){
+         return metadata.id < value; });
+   if (iter == prefetched.end() || iter->id != id)
+      return nullptr;
+   return &*iter;
+}
+
 BlockSampleView SqliteSampleBlock::GetFloatSampleView(bool mayThrow)
 {
    assert(mSampleCount > 0);
@@ -361,7 +483,11 @@ SqliteSampleBlock::~SqliteSampleBlock()
          // is presented to the user.
          // The failure in this case may be a less harmful waste of space in the
          // database, which should not cause aborting of the attempted edit.
-         Delete();
+         if (mpFactory->mDeferDeletions)
+            // Many blocks may die at once; delete their rows in batches later
+            mpFactory->mPendingDeletions.push_back(mBlockID);
+         else
+            Delete();
       }
    } );
 }
@@ -759,6 +885,20 @@ void SqliteSampleBlock::Load(SampleBlockID sbid)
    mValid = true;
 }
 
+void SqliteSampleBlock::Load(const SampleBlockMetadata &metadata)
+{
+   wxASSERT(metadata.id > 0);
+
+   mBlockID = metadata.id;
+   mSampleFormat = metadata.format;
+   mSumMin = metadata.sumMin;
+   mSumMax = metadata.sumMax;
+   mSumRms = metadata.sumRms;
+   mSampleBytes = metadata.sampleBytes;
+   mSampleCount = mSampleBytes / SAMPLE_SIZE(mSampleFormat);
+   mValid = true;
+}
+
 void SqliteSampleBlock::Commit(Sizes sizes)
 {
    const auto mSummary256Bytes = sizes.first;
@@ -832,22 +972,27 @@ void SqliteSampleBlock::Commit(Sizes sizes)
 
 void SqliteSampleBlock::Delete()
 {
-   auto db = DB();
-   int rc;
-
    wxASSERT(!IsSilent());
 
+   Delete(*Conn(), mBlockID);
+}
+
+void SqliteSampleBlock::Delete(DBConnection &connection, SampleBlockID id)
+{
+   auto db = connection.DB();
+   int rc;
+
    // Prepare and cache statement...automatically finalized at DB close
-   sqlite3_stmt *stmt = Conn()->Prepare(DBConnection::DeleteSampleBlock,
+   sqlite3_stmt *stmt = connection.Prepare(DBConnection::DeleteSampleBlock,
       "DELETE FROM sampleblocks WHERE blockid = ?1;");
 
    // Bind statement parameters
    // Might return SQLITE_MISUSE which means it's our mistake that we violated
    // preconditions; should return SQL_OK which is 0
-   if (sqlite3_bind_int64(stmt, 1, mBlockID))
+   if (sqlite3_bind_int64(stmt, 1, id))
    {
       ADD_EXCEPTION_CONTEXT(
-         "sqlite3.rc", std::to_string(sqlite3_errcode(Conn()->DB())));
+         "sqlite3.rc", std::to_string(sqlite3_errcode(db)));
       ADD_EXCEPTION_CONTEXT("sqlite3.context", "SqliteSampleBlock::Delete::bind");
 
       wxASSERT_MSG(false, wxT("Binding failed...bug!!!"));
@@ -868,7 +1013,7 @@ void SqliteSampleBlock::Delete()
 
       // Just showing the user a simple message, not the library error too
       // which isn't internationalized
-      Conn()->ThrowException( true );
+      connection.ThrowException( true );
    }
 
    // Clear statement bindings and rewind statement
@@ -1089,38 +1234,104 @@ static size_t EstimateRemovedBlocks(
    return mayDelete.size();
 }
 
-void SqliteSampleBlockFactory::OnBeginPurge(size_t begin, size_t end)
+//! Shows progress of discarding undo history, but only once it has taken a
+//! while
+class SqliteSampleBlockFactory::PurgeProgress
 {
-   // Install a callback function that updates a progress indicator
-   using namespace BasicUI;
-
-   //Avoid showing dialog to the user if purge operation
-   //does not take much time, as it will resign focus from main window
-   //but dialog itself may not be presented to the user at all.
-   //On MacOS 13 (bug #3975) focus isn't restored in that case.
-   constexpr auto ProgressDialogShowDelay = std::chrono::milliseconds (200);
-   const auto nToDelete = EstimateRemovedBlocks(mProject, begin, end);
-   if(nToDelete == 0)
-       return;
-   auto purgeStartTime = std::chrono::system_clock::now();
-   std::shared_ptr<ProgressDialog> progressDialog;
-   mScope.emplace([=, nDeleted = 0](auto&) mutable {
-      ++nDeleted;
-      if(!progressDialog)
+public:
+   //! @param total number of steps
+   explicit PurgeProgress(size_t total)
+      : mTotal{ total }
+      , mStartTime{ std::chrono::steady_clock::now() }
+   {}
+
+   void Advance(size_t steps)
+   {
+      using namespace BasicUI;
+
+      //Avoid showing dialog to the user if purge operation
+      //does not take much time, as it will resign focus from main window
+      //but dialog itself may not be presented to the user at all.
+      //On MacOS 13 (bug #3975) focus isn't restored in that case.
+      constexpr auto ProgressDialogShowDelay = std::chrono::milliseconds (200);
+
+      mDone += steps;
+      if(!mpDialog)
       {
-         auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::system_clock::now() - purgeStartTime);
+         auto elapsed = std::chrono::steady_clock::now() - mStartTime;
          if(elapsed >= ProgressDialogShowDelay)
-            progressDialog = MakeProgress(XO("Progress"), XO("Discarding undo/redo history"), 0);
+            mpDialog = MakeProgress(XO("Progress"), XO("Discarding undo/redo history"), 0);
       }
       else
-         progressDialog->Poll(nDeleted, nToDelete);
-   });
+         mpDialog->Poll(std::min(mDone, mTotal), mTotal);
+   }
+
+private:
+   const size_t mTotal;
+   const std::chrono::steady_clock::time_point mStartTime;
+   size_t mDone{ 0 };
+   std::unique_ptr<BasicUI::ProgressDialog> mpDialog;
+};
+
+void SqliteSampleBlockFactory::OnBeginPurge(size_t begin, size_t end)
+{
+   // Blocks destroyed from now until OnEndPurge() don't touch the database
+   mDeferDeletions = true;
+
+   // An empty range means that ModifyState replaces the current state; don't
+   // visit all of the history for that
+   const auto nToDelete =
+      begin == end ? 0 : EstimateRemovedBlocks(mProject, begin, end);
+   if(nToDelete == 0)
+       return;
+
+   // Install a callback function that updates a progress indicator.
+   // Destruction of each block is one step, and deletion of its row another.
+   auto pProgress = std::make_shared<PurgeProgress>(2 * nToDelete);
+   mpPurgeProgress = pProgress;
+   mScope.emplace([pProgress](auto&) { pProgress->Advance(1); });
+}
+
+void SqliteSampleBlockFactory::OnCommitPurge()
+{
+   // As in the destructor of SqliteSampleBlock, failure only wastes space and
+   // should not abort the operation; but the user is told of it
+   GuardedCall([this]{ FlushDeletions(); });
 }
 
 void SqliteSampleBlockFactory::OnEndPurge()
 {
    mScope.reset();
+   mDeferDeletions = false;
+   // Anything still pending was destroyed in a purge that was rolled back.
+   // Deleting the rows now would not be atomic with it; leave them as
+   // orphans, which the next opening of the project removes.
+   mPendingDeletions.clear();
+   mpPurgeProgress.reset();
+}
+
+void SqliteSampleBlockFactory::FlushDeletions()
+{
+   // Rows deleted between updates of the progress indicator
+   constexpr size_t BatchSize = 4096;
+
+   // Take the ids, so that none is deleted twice if an exception escapes
+   auto ids = std::move(mPendingDeletions);
+   mPendingDeletions.clear();
+   auto &pConnection = mppConnection->mpConnection;
+   if (ids.empty() || !pConnection)
+      return;
+   auto &connection = *pConnection;
+
+   // Ascending ids visit the table in the order it is stored
+   std::sort(ids.begin(), ids.end());
+   for (size_t first = 0; first < ids.size(); first += BatchSize) {
+      const auto last = std::min(ids.size(), first + BatchSize);
+      for (auto ii = first; ii < last; ++ii)
+         SqliteSampleBlock::Delete(connection, ids[ii]);
+      if (mpPurgeProgress)
+         mpPurgeProgress->Advance(last - first);
+   }
 }
 
 // Inject our database implementation at startup
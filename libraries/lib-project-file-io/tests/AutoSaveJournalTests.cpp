@@ -0,0 +1,154 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  AutoSaveJournalTests.cpp
+
+**********************************************************************/
+#include "AutoSaveJournal.h"
+
+#include <catch2/catch.hpp>
+
+#include <string>
+
+namespace {
+using Bytes = AutoSaveJournal::Bytes;
+
+//! A document of named parts, each with its key
+struct Document
+{
+   std::vector<std::pair<AutoSaveJournal::PartKey, std::string>> parts;
+   std::string dict;
+
+   AutoSaveJournal::Parts Parts() const
+   {
+      AutoSaveJournal::Parts result;
+      for (const auto &[key, text] : parts)
+         result.push_back({ key, text.size() });
+      return result;
+   }
+
+   Bytes Data() const
+   {
+      Bytes result;
+      for (const auto &part : parts)
+         result.insert(result.end(), part.second.begin(), part.second.end());
+      return result;
+   }
+
+   Bytes Dict() const { return { dict.begin(), dict.end() }; }
+};
+
+//! Simulates the database: the base, and the journal
+struct Store
+{
+   Bytes dict, data;
+   AutoSaveJournal::Entries entries;
+
+   //! @return whether the document was written whole
+   bool AutoSave(AutoSaveJournal &journal, const Document &document)
+   {
+      const auto data = document.Data(), dict = document.Dict();
+      if (auto newEntries = journal.Record(document.Parts(),
+         data.data(), data.size(), dict.data(), dict.size())
+      ) {
+         entries.insert(entries.end(), newEntries->begin(), newEntries->end());
+         return false;
+      }
+      this->dict = dict;
+      this->data = data;
+      entries = { journal.Rebase(
+         document.Parts(), data.data(), data.size(), dict.size()) };
+      return true;
+   }
+
+   void RequireRecovers(const Document &document) const
+   {
+      auto recoveredDict = dict, recoveredData = data;
+      REQUIRE(AutoSaveJournal::Replay(recoveredDict, recoveredData, entries));
+      REQUIRE(recoveredDict == document.Dict());
+      REQUIRE(recoveredData == document.Data());
+   }
+};
+}
+
+TEST_CASE("AutoSaveJournal")
+{
+   AutoSaveJournal journal;
+   Store store;
+   Document document{
+      { { 0, "head" }, { 2, "track one" }, { 3, "track two" }, { 1, "tail" } },
+      "dictionary"
+   };
+
+   // The first document is written whole
+   REQUIRE(store.AutoSave(journal, document));
+   store.RequireRecovers(document);
+
+   SECTION("Unchanged documents write nothing")
+   {
+      REQUIRE(!store.AutoSave(journal, document));
+      REQUIRE(store.entries.size() == 1);
+      store.RequireRecovers(document);
+   }
+
+   SECTION("Only changed parts are written")
+   {
+      document.parts[2].second = "track two, edited";
+      REQUIRE(!store.AutoSave(journal, document));
+      REQUIRE(store.entries.size() == 2);
+      REQUIRE(store.entries.back().key == 3);
+      store.RequireRecovers(document);
+   }
+
+   SECTION("Parts are added, removed, and reordered; the dictionary grows")
+   {
+      document.parts.insert(document.parts.begin() + 1, { 4, "new track" });
+      document.dict += " more";
+      REQUIRE(!store.AutoSave(journal, document));
+      store.RequireRecovers(document);
+
+      document.parts.erase(document.parts.begin() + 2);
+      std::swap(document.parts[1], document.parts[2]);
+      REQUIRE(!store.AutoSave(journal, document));
+      store.RequireRecovers(document);
+   }
+
+   SECTION("The journal is compacted when it outgrows the base")
+   {
+      const std::string big(600 * 1024, 'x');
+      document.parts[1].second = big + "1";
+      REQUIRE(!store.AutoSave(journal, document));
+      document.parts[1].second = big + "2";
+      REQUIRE(store.AutoSave(journal, document));
+      REQUIRE(store.entries.size() == 1);
+      store.RequireRecovers(document);
+   }
+
+   SECTION("Reset forces a whole write")
+   {
+      journal.Reset();
+      REQUIRE(store.AutoSave(journal, document));
+      store.RequireRecovers(document);
+   }
+
+   SECTION("Inconsistent journals are rejected")
+   {
+      auto dict = store.dict, data = store.data;
+      data.push_back('!');
+      REQUIRE(!AutoSaveJournal::Replay(dict, data, store.entries));
+      REQUIRE(data.back() == '!');
+
+      // A layout naming a part never written
+      data.pop_back();
+      auto entries = store.entries;
+      auto layout = document.Parts();
+      layout.push_back({ 99, 0 });
+      const auto bytes = document.Data();
+      AutoSaveJournal other;
+      entries.push_back(
+         other.Rebase(layout, bytes.data(), bytes.size(), dict.size()));
+      REQUIRE(!AutoSaveJournal::Replay(dict, data, entries));
+   }
+}
@@ -0,0 +1,178 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ProjectSerializerTests.cpp
+
+**********************************************************************/
+#include "ProjectSerializer.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstring>
+#include <thread>
+
+#include "BufferedStreamReader.h"
+
+namespace {
+//! Describes everything it is told in one string
+class Recorder final : public XMLTagHandler
+{
+public:
+   bool HandleXMLTag(
+      const std::string_view& tag, const AttributesList& attrs) override
+   {
+      mLog.append("<").append(tag);
+      for (const auto& [name, value] : attrs) {
+         mLog.append(" ").append(name).append("=");
+         std::string_view string;
+         long long integer;
+         if (value.TryGet(string))
+            mLog.append(string);
+         else if (value.IsDouble() || value.IsFloat())
+            mLog.append(std::to_string(value.Get<double>()));
+         else if (value.TryGet(integer))
+            mLog.append(std::to_string(integer));
+      }
+      mLog.append(">");
+      return true;
+   }
+
+   void HandleXMLEndTag(const std::string_view& tag) override
+   {
+      mLog.append("</").append(tag).append(">");
+   }
+
+   void HandleXMLContent(const std::string_view& content) override
+   {
+      mLog.append("[").append(content).append("]");
+   }
+
+   XMLTagHandler* HandleXMLChild(const std::string_view&) override
+   {
+      return this;
+   }
+
+   const std::string& Log() const { return mLog; }
+
+private:
+   std::string mLog;
+};
+
+class Stream final : public BufferedStreamReader
+{
+public:
+   explicit Stream(std::vector<char> bytes)
+      : BufferedStreamReader(1024), mBytes{ std::move(bytes) }
+   {}
+
+protected:
+   bool HasMoreData() const override { return mOffset < mBytes.size(); }
+
+   size_t ReadData(void* buffer, size_t maxBytes) override
+   {
+      const auto count = std::min(maxBytes, mBytes.size() - mOffset);
+      memcpy(buffer, mBytes.data() + mOffset, count);
+      mOffset += count;
+      return count;
+   }
+
+private:
+   const std::vector<char> mBytes;
+   size_t mOffset{ 0 };
+};
+
+std::vector<char> Encode(int nClips = 500)
+{
+   ProjectSerializer serializer;
+   serializer.StartTag(wxT("project"));
+   serializer.WriteAttr(wxT("name"), wxT("Caf\u00e9"));
+   serializer.WriteAttr(wxT("rate"), 44100);
+   for (int ii = 0; ii < nClips; ++ii) {
+      serializer.StartTag(wxT("clip"));
+      serializer.WriteAttr(wxT("offset"), 0.5 * ii);
+      serializer.WriteAttr(wxT("blockid"), 1000LL + ii);
+      serializer.WriteAttr(wxT("name"), wxString::Format(wxT("clip %d"), ii));
+      serializer.EndTag(wxT("clip"));
+   }
+   serializer.StartTag(wxT("label"));
+   serializer.WriteData(wxT("text"));
+   serializer.EndTag(wxT("label"));
+   serializer.EndTag(wxT("project"));
+
+   std::vector<char> bytes;
+   for (auto stream : { &serializer.GetDict(), &serializer.GetData() }) {
+      const auto data = static_cast<const char*>(stream->GetData());
+      bytes.insert(bytes.end(), data, data + stream->GetSize());
+   }
+   return bytes;
+}
+}
+
+TEST_CASE("ProjectSerializer decodes in place")
+{
+   const auto bytes = Encode();
+
+   Recorder expected;
+   Stream stream{ bytes };
+   REQUIRE(ProjectSerializer::Decode(stream, &expected));
+   REQUIRE(expected.Log().find("<project name=Caf\xc3\xa9 rate=44100>") == 0);
+   REQUIRE(expected.Log().find(
+      "<clip offset=1.000000 blockid=1002 name=clip 2></clip>") !=
+         std::string::npos);
+
+   SECTION("All ready")
+   {
+      ProjectDocumentBuffer buffer(bytes.size());
+      std::copy(bytes.begin(), bytes.end(), buffer.GetData());
+      buffer.SetReady(bytes.size());
+      buffer.Finish();
+      Recorder recorder;
+      REQUIRE(ProjectSerializer::Decode(buffer, &recorder));
+      REQUIRE(recorder.Log() == expected.Log());
+   }
+
+   SECTION("Ready in pieces while decoding")
+   {
+      ProjectDocumentBuffer buffer(bytes.size());
+      std::thread producer{ [&]{
+         for (size_t offset = 0; offset < bytes.size(); offset += 13) {
+            const auto count = std::min<size_t>(13, bytes.size() - offset);
+            std::copy_n(bytes.data() + offset, count, buffer.GetData() + offset);
+            buffer.SetReady(offset + count);
+         }
+         buffer.Finish();
+      } };
+      Recorder recorder;
+      const auto result = ProjectSerializer::Decode(buffer, &recorder);
+      producer.join();
+      REQUIRE(result);
+      REQUIRE(recorder.Log() == expected.Log());
+   }
+
+   SECTION("Truncated")
+   {
+      ProjectDocumentBuffer buffer(bytes.size());
+      std::copy(bytes.begin(), bytes.end(), buffer.GetData());
+      buffer.SetReady(bytes.size() / 2);
+      buffer.Finish();
+      Recorder recorder;
+      REQUIRE(!ProjectSerializer::Decode(buffer, &recorder));
+   }
+}
+
+TEST_CASE("ProjectSerializer fails on documents truncated anywhere")
+{
+   // Some of the cuts fall at the ends of records, where decoding alone finds
+   // nothing wrong
+   const auto bytes = Encode(3);
+   for (size_t size = 0; size < bytes.size(); ++size) {
+      ProjectDocumentBuffer buffer(bytes.size());
+      std::copy(bytes.begin(), bytes.end(), buffer.GetData());
+      buffer.SetReady(size);
+      buffer.Finish();
+      Recorder recorder;
+      REQUIRE(!ProjectSerializer::Decode(buffer, &recorder));
+   }
+}
@@ -145,6 +145,9 @@ void UndoManager::RemoveStates(size_t begin, size_t end)
         --saved;
    }
 
+   // Let the sample block factory delete rows in the savepoint
+   Publish({ UndoRedoMessage::CommitPurge });
+
    // Success, commit the savepoint
    trans.Commit();
    
@@ -198,8 +201,21 @@ void UndoManager::ModifyState()
 //   SonifyBeginModifyState();
    auto &state = stack[current]->state;
 
-   // Re-create all captured project state
-   state.extensions = GetExtensions(mProject);
+   {
+      // Replacing the state may destroy many sample blocks, as when tracks
+      // were deleted; let them be deleted in one transaction, as for a purge
+      Publish({ UndoRedoMessage::BeginPurge,
+         size_t(current), size_t(current) });
+      auto cleanup =
+         finally([&]{ Publish({ UndoRedoMessage::EndPurge }); });
+      TransactionScope trans{mProject, "ModifyingUndoState"};
+
+      // Re-create all captured project state
+      state.extensions = GetExtensions(mProject);
+
+      Publish({ UndoRedoMessage::CommitPurge });
+      trans.Commit();
+   }
 
 //   SonifyEndModifyState();
 
@@ -51,7 +51,8 @@
 #include "Observer.h"
 
 //! Type of message published by UndoManager
-/*! all are published only during idle time, except BeginPurge and EndPurge */
+/*! all are published only during idle time, except BeginPurge, CommitPurge,
+ and EndPurge */
 struct UndoRedoMessage {
    const enum Type {
       Pushed, /*!< Project state did not change, but a new state was copied
@@ -70,10 +71,13 @@ struct UndoRedoMessage {
 
       // Eagerly sent messages (not waiting for idle time)
       BeginPurge, //!< Begin elimination of old undo states
+      CommitPurge, /*!< Elimination of old undo states is about to be
+                    committed to the database; not sent if it fails */
       EndPurge, //!< End elimination of old undo states
    } type;
 
-   //! Only significant for BeginPurge messages
+   //! Only significant for BeginPurge messages; the range is empty when
+   //! ModifyState replaces the current state
    const size_t begin = 0, end = 0;
 };
 
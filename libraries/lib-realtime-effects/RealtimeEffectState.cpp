@@ -15,6 +15,7 @@
 #include "MessageBuffer.h"
 #include "PluginManager.h"
 #include "SampleCount.h"
+#include "Telemetry.h"
 
 #include <chrono>
 #include <thread>
@@ -353,6 +354,8 @@ const EffectInstanceFactory *RealtimeEffectState::GetEffect()
          mMainSettings.settings.extra.SetActive(wasActive);
          mOutputs = mPlugin->MakeOutputs();
          mMovedOutputs = mPlugin->MakeOutputs();
+         mProcessTimer = std::make_unique<Telemetry::Timer>(
+            "RealtimeEffect", mPlugin->GetSymbol().Internal().ToStdString());
       }
    }
    return mPlugin;
@@ -544,6 +547,7 @@ size_t RealtimeEffectState::Process(
          memcpy(outbuf[ii], inbuf[ii], numSamples * sizeof(float));
       return 0;
    }
+   Telemetry::Scope scope{ *mProcessTimer };
    const auto numAudioIn = pInstance->GetAudioInCount();
    const auto numAudioOut = pInstance->GetAudioOutCount();
    const auto clientIn = stackAllocate(const float *, numAudioIn);
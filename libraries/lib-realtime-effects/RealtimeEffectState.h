@@ -24,6 +24,8 @@
 #include "PluginProvider.h" // for PluginID
 #include "XMLTagHandler.h"
 
+namespace Telemetry { class Timer; }
+
 class ChannelGroup;
 class EffectSettingsAccess;
 
@@ -193,6 +195,9 @@ private:
    // Destroy before mWorkerSettings:
    AtomicUniquePointer<AccessState> mpAccessState{ nullptr };
 
+   //! Durations of Process(), made with mPlugin
+   std::unique_ptr<Telemetry::Timer> mProcessTimer;
+
    wxString mParameters;  // Used only during deserialization
    size_t mCurrentProcessor{ 0 };
    bool mInitialized{ false };
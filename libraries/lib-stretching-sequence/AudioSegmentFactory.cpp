@@ -10,6 +10,7 @@
 **********************************************************************/
 
 #include "AudioSegmentFactory.h"
+#include "CachedClipSegment.h"
 #include "ClipInterface.h"
 #include "ClipSegment.h"
 #include "SilenceSegment.h"
@@ -19,6 +20,78 @@
 
 using ClipConstHolder = std::shared_ptr<const ClipInterface>;
 
+namespace
+{
+std::shared_ptr<AudioSegment> CreateClipSegment(
+   const ClipInterface& clip, double durationToDiscard,
+   PlaybackDirection direction)
+{
+   if (direction == PlaybackDirection::forward)
+   {
+      const auto pCache = clip.GetStretchedClipCache();
+      if (const auto rendering = pCache ? pCache->Find(clip) : nullptr)
+         return std::make_shared<CachedClipSegment>(
+            clip, rendering, durationToDiscard);
+   }
+   return std::make_shared<ClipSegment>(clip, durationToDiscard, direction);
+}
+
+//! Creates the segment of a clip only when it is first used, so that moving
+//! the cursor doesn't prime the stretchers of all the clips after it
+class DeferredClipSegment final : public AudioSegment
+{
+public:
+   DeferredClipSegment(
+      ClipConstHolder clip, double durationToDiscard,
+      PlaybackDirection direction)
+       : mClip { std::move(clip) }
+       , mDurationToDiscard { durationToDiscard }
+       , mDirection { direction }
+   {
+   }
+
+   size_t GetFloats(float* const* buffers, size_t numSamples) override
+   {
+      return Get().GetFloats(buffers, numSamples);
+   }
+
+   bool Empty() const override
+   {
+      return Get().Empty();
+   }
+
+   size_t NChannels() const override
+   {
+      return mClip->NChannels();
+   }
+
+private:
+   AudioSegment& Get() const
+   {
+      if (!mSegment)
+         mSegment = CreateClipSegment(*mClip, mDurationToDiscard, mDirection);
+      return *mSegment;
+   }
+
+   const ClipConstHolder mClip;
+   const double mDurationToDiscard;
+   const PlaybackDirection mDirection;
+   mutable std::shared_ptr<AudioSegment> mSegment;
+};
+
+std::shared_ptr<AudioSegment> CreateClipSegmentAfter(
+   const std::vector<std::shared_ptr<AudioSegment>>& previous,
+   const ClipConstHolder& clip, double durationToDiscard,
+   PlaybackDirection direction)
+{
+   // The first segment is used at once
+   if (previous.empty())
+      return CreateClipSegment(*clip, durationToDiscard, direction);
+   return std::make_shared<DeferredClipSegment>(
+      clip, durationToDiscard, direction);
+}
+} // namespace
+
 AudioSegmentFactory::AudioSegmentFactory(
    int sampleRate, int numChannels, ClipConstHolders clips)
     : mClips { std::move(clips) }
@@ -59,8 +132,9 @@ AudioSegmentFactory::CreateAudioSegmentSequenceForward(double t0)
       }
       else if (clip->GetPlayEndTime() <= t0)
          continue;
-      segments.push_back(std::make_shared<ClipSegment>(
-         *clip, t0 - clip->GetPlayStartTime(), PlaybackDirection::forward));
+      segments.push_back(CreateClipSegmentAfter(
+         segments, clip, t0 - clip->GetPlayStartTime(),
+         PlaybackDirection::forward));
       t0 = clip->GetPlayEndTime();
    }
    return segments;
@@ -90,8 +164,9 @@ AudioSegmentFactory::CreateAudioSegmentSequenceBackward(double t0)
       }
       else if (clip->GetPlayStartTime() >= t0)
          continue;
-      segments.push_back(std::make_shared<ClipSegment>(
-         *clip, clip->GetPlayEndTime() - t0, PlaybackDirection::backward));
+      segments.push_back(CreateClipSegmentAfter(
+         segments, clip, clip->GetPlayEndTime() - t0,
+         PlaybackDirection::backward));
       t0 = clip->GetPlayStartTime();
    }
    return segments;
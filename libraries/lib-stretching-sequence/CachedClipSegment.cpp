@@ -0,0 +1,66 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  CachedClipSegment.cpp
+
+**********************************************************************/
+#include "CachedClipSegment.h"
+#include "ClipInterface.h"
+#include "ClipSegment.h"
+
+#include <algorithm>
+#include <cassert>
+
+CachedClipSegment::CachedClipSegment(const ClipInterface& clip,
+   std::shared_ptr<const StretchedClipCache::Rendering> rendering,
+   double durationToDiscard)
+    : mClip { clip }
+    , mRendering { std::move(rendering) }
+    , mOnSemitoneShiftChangeSubscription { clip.SubscribeToCentShiftChange(
+         [this](int) { mChanged = true; }) }
+    , mOnFormantPreservationChangeSubscription {
+       clip.SubscribeToPitchAndSpeedPresetChange(
+          [this](PitchAndSpeedPreset) { mChanged = true; })
+    }
+{
+   assert(mRendering);
+   // Count the samples from the end, exactly as ClipSegment does
+   const auto length = mRendering->Length();
+   const auto remaining = std::clamp<sampleCount>(
+      ClipSegment::GetTotalNumSamplesToProduce(clip, durationToDiscard), 0,
+      length);
+   mPosition = length - remaining.as_size_t();
+}
+
+CachedClipSegment::~CachedClipSegment() = default;
+
+size_t CachedClipSegment::GetFloats(float* const* buffers, size_t numSamples)
+{
+   if (mLiveSegment)
+      return mLiveSegment->GetFloats(buffers, numSamples);
+   if (mChanged.exchange(false) && !Empty())
+   {
+      mLiveSegment = std::make_unique<ClipSegment>(
+         mClip, static_cast<double>(mPosition) / mClip.GetRate(),
+         PlaybackDirection::forward);
+      return mLiveSegment->GetFloats(buffers, numSamples);
+   }
+   const auto numSamplesToProduce =
+      std::min(numSamples, mRendering->Length() - mPosition);
+   mRendering->Read(buffers, mPosition, numSamplesToProduce);
+   mPosition += numSamplesToProduce;
+   return numSamplesToProduce;
+}
+
+bool CachedClipSegment::Empty() const
+{
+   return mLiveSegment ? mLiveSegment->Empty() :
+                         mPosition >= mRendering->Length();
+}
+
+size_t CachedClipSegment::NChannels() const
+{
+   return mRendering->NChannels();
+}
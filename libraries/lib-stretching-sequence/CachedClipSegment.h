@@ -0,0 +1,57 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  CachedClipSegment.h
+
+**********************************************************************/
+#pragma once
+
+#include "AudioSegment.h"
+#include "Observer.h"
+#include "StretchedClipCache.h"
+
+#include <atomic>
+#include <memory>
+
+class ClipInterface;
+class ClipSegment;
+
+/*!
+ * @brief Plays a clip forward from a rendering kept in its StretchedClipCache,
+ * instead of stretching it again.
+ *
+ * If pitch or formant preservation of the clip change meanwhile, the rest is
+ * rendered live by a ClipSegment, as if there were no rendering.
+ *
+ * Like ClipSegment, objects of this class must be instantiated and destroyed
+ * on the same thread, due to the owned Observer::Subscription.
+ */
+class STRETCHING_SEQUENCE_API CachedClipSegment final : public AudioSegment
+{
+public:
+   //! @pre `rendering` is the one that `clip`'s cache finds now
+   CachedClipSegment(const ClipInterface& clip,
+      std::shared_ptr<const StretchedClipCache::Rendering> rendering,
+      double durationToDiscard);
+   ~CachedClipSegment() override;
+
+   // AudioSegment
+   size_t GetFloats(float* const* buffers, size_t numSamples) override;
+   bool Empty() const override;
+   size_t NChannels() const override;
+
+private:
+   const ClipInterface& mClip;
+   const std::shared_ptr<const StretchedClipCache::Rendering> mRendering;
+   //! Position of the next sample in the rendering
+   size_t mPosition;
+
+   std::atomic<bool> mChanged = false;
+   Observer::Subscription mOnSemitoneShiftChangeSubscription;
+   Observer::Subscription mOnFormantPreservationChangeSubscription;
+
+   //! Renders the rest, once the rendering became stale
+   std::unique_ptr<ClipSegment> mLiveSegment;
+};
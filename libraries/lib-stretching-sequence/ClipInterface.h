@@ -15,6 +15,10 @@
 #include "SampleCount.h"
 #include "SampleFormat.h"
 
+#include <memory>
+
+class StretchedClipCache;
+
 class STRETCHING_SEQUENCE_API ClipTimes
 {
 public:
@@ -63,6 +67,13 @@ public:
    [[nodiscard]] virtual Observer::Subscription
    SubscribeToPitchAndSpeedPresetChange(
       std::function<void(PitchAndSpeedPreset)> cb) const = 0;
+
+   //! Where renderings of the stretched clip may be kept between playbacks
+   /*!
+    Default implementation returns null, so that clips are always rendered
+    live
+    */
+   virtual std::shared_ptr<StretchedClipCache> GetStretchedClipCache() const;
 };
 
 using ClipConstHolders = std::vector<std::shared_ptr<const ClipInterface>>;
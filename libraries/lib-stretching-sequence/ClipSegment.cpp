@@ -12,6 +12,7 @@
 #include "ClipInterface.h"
 #include "SampleFormat.h"
 #include "StaffPadTimeAndPitch.h"
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <functional>
@@ -29,27 +30,52 @@ GetStretchingParameters(const ClipInterface& clip)
    return params;
 }
 
-sampleCount
-GetTotalNumSamplesToProduce(const ClipInterface& clip, double durationToDiscard)
+std::shared_ptr<const StretchedClipCache::Checkpoint> FindCheckpoint(
+   const StretchedClipCache* pCache, const ClipInterface& clip,
+   sampleCount position, PlaybackDirection direction)
+{
+   // Checkpoints are made only going forward, where loops and seeks happen
+   if (
+      !pCache || direction != PlaybackDirection::forward ||
+      !StretchedClipCache::Wants(clip))
+      return {};
+   return pCache->FindCheckpoint(clip, position);
+}
+
+std::unique_ptr<TimeAndPitchInterface> CreateStretcher(
+   const ClipInterface& clip, ClipTimeAndPitchSource& source,
+   const StretchedClipCache::Checkpoint* pCheckpoint)
+{
+   if (pCheckpoint)
+      source.SetLastReadSample(pCheckpoint->lastReadSample);
+   return std::make_unique<StaffPadTimeAndPitch>(
+      clip.GetRate(), clip.NChannels(), source, GetStretchingParameters(clip),
+      pCheckpoint ? pCheckpoint->state.get() : nullptr);
+}
+} // namespace
+
+sampleCount ClipSegment::GetTotalNumSamplesToProduce(
+   const ClipInterface& clip, double durationToDiscard)
 {
    return sampleCount { clip.GetVisibleSampleCount().as_double() *
                            clip.GetStretchRatio() -
                         durationToDiscard * clip.GetRate() + .5 };
 }
-} // namespace
 
 ClipSegment::ClipSegment(
    const ClipInterface& clip, double durationToDiscard,
    PlaybackDirection direction)
     : mTotalNumSamplesToProduce { GetTotalNumSamplesToProduce(
          clip, durationToDiscard) }
+    , mpCache { clip.GetStretchedClipCache() }
+    , mCacheGeneration { mpCache ? mpCache->GetGeneration() : 0 }
+    , mpCheckpoint { FindCheckpoint(
+         mpCache.get(), clip, GetStartPosition(clip), direction) }
     , mSource { clip, durationToDiscard, direction }
     , mPreserveFormants { clip.GetPitchAndSpeedPreset() ==
                           PitchAndSpeedPreset::OptimizeForVoice }
     , mCentShift { clip.GetCentShift() }
-    , mStretcher { std::make_unique<StaffPadTimeAndPitch>(
-         clip.GetRate(), clip.NChannels(), mSource,
-         GetStretchingParameters(clip)) }
+    , mStretcher { CreateStretcher(clip, mSource, mpCheckpoint.get()) }
     , mOnSemitoneShiftChangeSubscription { clip.SubscribeToCentShiftChange(
          [this](int cents) {
             mCentShift = cents;
@@ -64,6 +90,30 @@ ClipSegment::ClipSegment(
           })
     }
 {
+   if (
+      !mpCache || direction != PlaybackDirection::forward ||
+      !StretchedClipCache::Wants(clip))
+      return;
+
+   // Save the primed state, for when playback starts here again, as it does
+   // when looping
+   if (!mpCheckpoint)
+      mpCache->StoreCheckpoint(
+         StretchedClipCache::NewCheckpoint(
+            clip, GetStartPosition(clip), mSource.GetLastReadSample(),
+            mStretcher->SaveCheckpoint()),
+         mCacheGeneration);
+   mpCheckpoint.reset();
+
+   // Record only renderings of whole clips
+   if (durationToDiscard <= 0 && mTotalNumSamplesToProduce > 0)
+      mpRendering = StretchedClipCache::NewRendering(
+         clip, mTotalNumSamplesToProduce.as_size_t());
+}
+
+sampleCount ClipSegment::GetStartPosition(const ClipInterface& clip) const
+{
+   return GetTotalNumSamplesToProduce(clip, 0) - mTotalNumSamplesToProduce;
 }
 
 ClipSegment::~ClipSegment()
@@ -82,13 +132,24 @@ size_t ClipSegment::GetFloats(float* const* buffers, size_t numSamples)
    // destruction of this object, so better not do anything too sophisticated
    // there.
    if (mUpdateFormantPreservation.exchange(false))
+   {
       mStretcher->OnFormantPreservationChange(mPreserveFormants);
+      // The rendering would not be all of one setting
+      mpRendering.reset();
+   }
    if (mUpdateCentShift.exchange(false))
+   {
       mStretcher->OnCentShiftChange(mCentShift);
+      mpRendering.reset();
+   }
    const auto numSamplesToProduce = limitSampleBufferSize(
       numSamples, mTotalNumSamplesToProduce - mTotalNumSamplesProduced);
    mStretcher->GetSamples(buffers, numSamplesToProduce);
+   if (mpRendering && !mpRendering->Append(buffers, numSamplesToProduce))
+      mpRendering.reset();
    mTotalNumSamplesProduced += numSamplesToProduce;
+   if (mpRendering && Empty())
+      mpCache->Store(std::move(mpRendering), mCacheGeneration);
    return numSamplesToProduce;
 }
 
@@ -14,6 +14,7 @@
 #include "ClipTimeAndPitchSource.h"
 #include "Observer.h"
 #include "PlaybackDirection.h"
+#include "StretchedClipCache.h"
 #include <atomic>
 #include <memory>
 
@@ -34,14 +35,28 @@ public:
       double durationToDiscard, PlaybackDirection);
    ~ClipSegment() override;
 
+   //! How many samples a segment starting after `durationToDiscard` gives
+   static sampleCount
+   GetTotalNumSamplesToProduce(const ClipInterface&, double durationToDiscard);
+
    // AudioSegment
    size_t GetFloats(float* const* buffers, size_t numSamples) override;
    bool Empty() const override;
    size_t NChannels() const override;
 
 private:
+   //! Index of the first sample of this segment, counted in stretched samples
+   //! from the play start of the clip
+   sampleCount GetStartPosition(const ClipInterface& clip) const;
+
    const sampleCount mTotalNumSamplesToProduce;
    sampleCount mTotalNumSamplesProduced = 0;
+   //! Where renderings and checkpoints of the clip are kept; may be null
+   const std::shared_ptr<StretchedClipCache> mpCache;
+   //! Taken before any samples of the clip are read
+   const unsigned long long mCacheGeneration;
+   //! To restore instead of priming the stretcher; reset after construction
+   std::shared_ptr<const StretchedClipCache::Checkpoint> mpCheckpoint;
    ClipTimeAndPitchSource mSource;
    bool mPreserveFormants;
    int mCentShift;
@@ -53,4 +68,7 @@ private:
    std::unique_ptr<TimeAndPitchInterface> mStretcher;
    Observer::Subscription mOnSemitoneShiftChangeSubscription;
    Observer::Subscription mOnFormantPreservationChangeSubscription;
+
+   //! A whole forward pass is recorded here, for later passes to reuse
+   std::unique_ptr<StretchedClipCache::Rendering> mpRendering;
 };
@@ -17,7 +17,7 @@
 
 namespace
 {
-sampleCount GetLastReadSample(
+sampleCount GetInitialLastReadSample(
    const ClipInterface& clip, double durationToDiscard,
    PlaybackDirection direction)
 {
@@ -36,7 +36,8 @@ ClipTimeAndPitchSource::ClipTimeAndPitchSource(
    const ClipInterface& clip, double durationToDiscard,
    PlaybackDirection direction)
     : mClip { clip }
-    , mLastReadSample { GetLastReadSample(clip, durationToDiscard, direction) }
+    , mLastReadSample { GetInitialLastReadSample(
+         clip, durationToDiscard, direction) }
     , mPlaybackDirection { direction }
 {
 }
@@ -91,3 +92,13 @@ size_t ClipTimeAndPitchSource::NChannels() const
 {
    return mClip.NChannels();
 }
+
+sampleCount ClipTimeAndPitchSource::GetLastReadSample() const
+{
+   return mLastReadSample;
+}
+
+void ClipTimeAndPitchSource::SetLastReadSample(sampleCount sample)
+{
+   mLastReadSample = sample;
+}
@@ -32,6 +32,12 @@ public:
 
    size_t NChannels() const;
 
+   //! Index in the visible samples of the clip of the next sample to pull
+   //! when going forward, or of the last pulled when going backward
+   sampleCount GetLastReadSample() const;
+   //! For restoring a stretcher checkpoint
+   void SetLastReadSample(sampleCount sample);
+
 private:
    const ClipInterface& mClip;
    sampleCount mLastReadSample = 0;
@@ -0,0 +1,268 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  StretchedClipCache.cpp
+
+**********************************************************************/
+#include "StretchedClipCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <iterator>
+#include <new>
+
+namespace
+{
+//! Most memory, in bytes, held by renderings and checkpoints of all clips
+//! together
+constexpr size_t MaxTotalBytes = 512 * 1024 * 1024;
+
+//! Enough for a few loop and cursor positions, and not much memory
+constexpr size_t MaxCheckpointsPerClip = 8;
+
+std::atomic<size_t> sTotalBytes { 0 };
+
+bool Reserve(size_t bytes)
+{
+   auto total = sTotalBytes.load();
+   do
+      if (bytes > MaxTotalBytes || total > MaxTotalBytes - bytes)
+         return false;
+   while (!sTotalBytes.compare_exchange_weak(total, total + bytes));
+   return true;
+}
+} // namespace
+
+StretchedClipCache::Key::Key(const ClipInterface& clip)
+    : visibleSampleCount { clip.GetVisibleSampleCount() }
+    , stretchRatio { clip.GetStretchRatio() }
+    , centShift { clip.GetCentShift() }
+    , preset { clip.GetPitchAndSpeedPreset() }
+    , rate { clip.GetRate() }
+    , nChannels { clip.NChannels() }
+{
+}
+
+bool StretchedClipCache::Key::operator==(const Key& other) const
+{
+   return visibleSampleCount == other.visibleSampleCount &&
+          stretchRatio == other.stretchRatio &&
+          centShift == other.centShift && preset == other.preset &&
+          rate == other.rate && nChannels == other.nChannels;
+}
+
+StretchedClipCache::Rendering::Rendering(const Key& key, size_t length)
+    : key { key }
+    , mChannels(key.nChannels)
+    , mLength { length }
+    , mBytes { key.nChannels * length * sizeof(float) }
+{
+   for (auto& chunks : mChannels)
+      chunks.reserve((length + ChunkSize - 1) / ChunkSize);
+}
+
+StretchedClipCache::Rendering::~Rendering()
+{
+   sTotalBytes -= mBytes;
+}
+
+bool StretchedClipCache::Rendering::Append(
+   const float* const* buffers, size_t numSamples)
+{
+   assert(numSamples <= mLength - mNumAppended);
+   for (size_t iChannel = 0; iChannel < mChannels.size(); ++iChannel)
+   {
+      auto& chunks = mChannels[iChannel];
+      auto source = buffers[iChannel];
+      for (auto position = mNumAppended, end = position + numSamples;
+           position < end;)
+      {
+         const auto iChunk = position / ChunkSize;
+         const auto offset = position % ChunkSize;
+         if (iChunk == chunks.size())
+         {
+            // Not zero-filled, unlike std::vector
+            float* chunk = new (std::nothrow) float[ChunkSize];
+            if (!chunk)
+               return false;
+            chunks.emplace_back(chunk);
+         }
+         const auto count = std::min(ChunkSize - offset, end - position);
+         std::copy(source, source + count, chunks[iChunk].get() + offset);
+         source += count;
+         position += count;
+      }
+   }
+   mNumAppended += numSamples;
+   return true;
+}
+
+void StretchedClipCache::Rendering::Read(
+   float* const* buffers, size_t position, size_t numSamples) const
+{
+   assert(position + numSamples <= mNumAppended);
+   for (size_t iChannel = 0; iChannel < mChannels.size(); ++iChannel)
+   {
+      const auto& chunks = mChannels[iChannel];
+      auto destination = buffers[iChannel];
+      for (auto end = position + numSamples, pos = position; pos < end;)
+      {
+         const auto offset = pos % ChunkSize;
+         const auto count = std::min(ChunkSize - offset, end - pos);
+         const auto source = chunks[pos / ChunkSize].get() + offset;
+         destination = std::copy(source, source + count, destination);
+         pos += count;
+      }
+   }
+}
+
+StretchedClipCache::Checkpoint::Checkpoint(
+   const Key& key, sampleCount position, sampleCount lastReadSample,
+   std::unique_ptr<const TimeAndPitchInterface::Checkpoint> state,
+   size_t bytes)
+    : key { key }
+    , position { position }
+    , lastReadSample { lastReadSample }
+    , state { std::move(state) }
+    , mBytes { bytes }
+{
+}
+
+StretchedClipCache::Checkpoint::~Checkpoint()
+{
+   sTotalBytes -= mBytes;
+}
+
+bool StretchedClipCache::Wants(const ClipInterface& clip)
+{
+   return clip.GetStretchRatio() != 1. || clip.GetCentShift() != 0;
+}
+
+auto StretchedClipCache::NewRendering(const ClipInterface& clip, size_t length)
+   -> std::unique_ptr<Rendering>
+{
+   const auto nChannels = clip.NChannels();
+   if (length == 0 || length > MaxTotalBytes / sizeof(float) / nChannels)
+      return {};
+   if (!Reserve(nChannels * length * sizeof(float)))
+      return {};
+   try
+   {
+      return std::unique_ptr<Rendering>(new Rendering { Key { clip }, length });
+   }
+   catch (const std::bad_alloc&)
+   {
+      // The budget was reserved but the memory not allocated
+      sTotalBytes -= nChannels * length * sizeof(float);
+      return {};
+   }
+}
+
+auto StretchedClipCache::NewCheckpoint(
+   const ClipInterface& clip, sampleCount position, sampleCount lastReadSample,
+   std::unique_ptr<const TimeAndPitchInterface::Checkpoint> state)
+   -> std::unique_ptr<Checkpoint>
+{
+   if (!state)
+      return {};
+   const auto bytes = state->MemorySize();
+   if (!Reserve(bytes))
+      return {};
+   try
+   {
+      return std::unique_ptr<Checkpoint>(new Checkpoint {
+         Key { clip }, position, lastReadSample, std::move(state), bytes });
+   }
+   catch (const std::bad_alloc&)
+   {
+      sTotalBytes -= bytes;
+      return {};
+   }
+}
+
+StretchedClipCache::StretchedClipCache() = default;
+
+StretchedClipCache::~StretchedClipCache() = default;
+
+auto StretchedClipCache::Find(const ClipInterface& clip) const
+   -> std::shared_ptr<const Rendering>
+{
+   std::lock_guard<std::mutex> lock { mMutex };
+   if (mRendering && mRendering->key == Key { clip })
+      return mRendering;
+   return {};
+}
+
+unsigned long long StretchedClipCache::GetGeneration() const
+{
+   std::lock_guard<std::mutex> lock { mMutex };
+   return mGeneration;
+}
+
+void StretchedClipCache::Store(
+   std::unique_ptr<Rendering> rendering, unsigned long long generation)
+{
+   std::shared_ptr<const Rendering> old;
+   std::lock_guard<std::mutex> lock { mMutex };
+   if (generation != mGeneration)
+      return;
+   // Free the old rendering after unlocking
+   old = std::move(mRendering);
+   mRendering = std::move(rendering);
+}
+
+auto StretchedClipCache::FindCheckpoint(
+   const ClipInterface& clip, sampleCount position) const
+   -> std::shared_ptr<const Checkpoint>
+{
+   const Key key { clip };
+   std::lock_guard<std::mutex> lock { mMutex };
+   const auto iter = std::find_if(
+      mCheckpoints.begin(), mCheckpoints.end(), [&](const auto& pCheckpoint) {
+         return pCheckpoint->position == position && pCheckpoint->key == key;
+      });
+   if (iter == mCheckpoints.end())
+      return {};
+   // Move to the back, as most recently used
+   std::rotate(iter, iter + 1, mCheckpoints.end());
+   return mCheckpoints.back();
+}
+
+void StretchedClipCache::StoreCheckpoint(
+   std::unique_ptr<Checkpoint> checkpoint, unsigned long long generation)
+{
+   if (!checkpoint)
+      return;
+   // Free old checkpoints after unlocking
+   Checkpoints old;
+   std::lock_guard<std::mutex> lock { mMutex };
+   if (generation != mGeneration)
+      return;
+   const auto end = std::stable_partition(
+      mCheckpoints.begin(), mCheckpoints.end(), [&](const auto& pCheckpoint) {
+         // Keep only those still valid and not at the same position
+         return pCheckpoint->position != checkpoint->position &&
+                pCheckpoint->key == checkpoint->key;
+      });
+   std::move(end, mCheckpoints.end(), std::back_inserter(old));
+   mCheckpoints.erase(end, mCheckpoints.end());
+   if (mCheckpoints.size() >= MaxCheckpointsPerClip)
+   {
+      old.push_back(std::move(mCheckpoints.front()));
+      mCheckpoints.erase(mCheckpoints.begin());
+   }
+   mCheckpoints.push_back(std::move(checkpoint));
+}
+
+void StretchedClipCache::Invalidate() noexcept
+{
+   std::shared_ptr<const Rendering> old;
+   Checkpoints oldCheckpoints;
+   std::lock_guard<std::mutex> lock { mMutex };
+   ++mGeneration;
+   old = std::move(mRendering);
+   oldCheckpoints.swap(mCheckpoints);
+}
@@ -0,0 +1,169 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  StretchedClipCache.h
+
+**********************************************************************/
+#pragma once
+
+#include "ClipInterface.h"
+#include "TimeAndPitchInterface.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/*!
+ * @brief Keeps the whole time-stretched and pitch-shifted audio of a clip, as
+ * rendered by one playback pass, so that later passes need not render again.
+ * Also keeps the states of stretchers at the last few positions where
+ * playback started, so that starting there again needs no priming.
+ *
+ * It is owned by a clip, which must call Invalidate() whenever its audio or
+ * trimming changes.  Stretch, pitch and the other parameters that a
+ * rendering depends on are compared at each lookup.
+ *
+ * Renderings and checkpoints share a global memory budget; when it is
+ * exhausted, clips are rendered live and primed as before.  Methods may be called from any thread.
+ */
+class STRETCHING_SEQUENCE_API StretchedClipCache final
+{
+public:
+   //! What, other than the audio, a rendering depends on
+   struct STRETCHING_SEQUENCE_API Key
+   {
+      explicit Key(const ClipInterface& clip);
+      bool operator==(const Key& other) const;
+      bool operator!=(const Key& other) const { return !(*this == other); }
+
+      sampleCount visibleSampleCount;
+      double stretchRatio;
+      int centShift;
+      PitchAndSpeedPreset preset;
+      int rate;
+      size_t nChannels;
+   };
+
+   //! Rendered audio, filled by one playback pass and then immutable
+   /*!
+    * Memory is allocated in chunks as the samples are appended, not all at
+    * once when playback starts
+    */
+   struct STRETCHING_SEQUENCE_API Rendering
+   {
+      Rendering(const Rendering&) = delete;
+      Rendering& operator=(const Rendering&) = delete;
+      ~Rendering();
+
+      //! Samples per channel when complete
+      size_t Length() const { return mLength; }
+      size_t NChannels() const { return mChannels.size(); }
+      bool IsComplete() const { return mNumAppended == mLength; }
+
+      //! Append samples to each channel
+      /*!
+       * @pre `numSamples <= Length()` less the number already appended
+       * @return false if out of memory
+       */
+      bool Append(const float* const* buffers, size_t numSamples);
+
+      //! Copy samples `[position, position + numSamples)` of each channel
+      /*! @pre `position + numSamples <= Length()` and IsComplete() */
+      void
+      Read(float* const* buffers, size_t position, size_t numSamples) const;
+
+      const Key key;
+
+   private:
+      friend StretchedClipCache;
+      //! @pre the memory budget was reserved
+      Rendering(const Key& key, size_t length);
+
+      //! Samples per chunk
+      static constexpr size_t ChunkSize = 1 << 16;
+      using Chunks = std::vector<std::unique_ptr<float[]>>;
+
+      std::vector<Chunks> mChannels;
+      const size_t mLength;
+      size_t mNumAppended { 0 };
+      const size_t mBytes;
+   };
+
+   //! State of a stretcher ready to give the sample at `position`, counted in
+   //! stretched samples from the play start of the clip
+   struct STRETCHING_SEQUENCE_API Checkpoint
+   {
+      Checkpoint(const Checkpoint&) = delete;
+      Checkpoint& operator=(const Checkpoint&) = delete;
+      ~Checkpoint();
+
+      const Key key;
+      const sampleCount position;
+      //! Where the stretcher's source was, in samples of the clip
+      const sampleCount lastReadSample;
+      const std::unique_ptr<const TimeAndPitchInterface::Checkpoint> state;
+
+   private:
+      friend StretchedClipCache;
+      //! @pre the memory budget was reserved
+      Checkpoint(
+         const Key& key, sampleCount position, sampleCount lastReadSample,
+         std::unique_ptr<const TimeAndPitchInterface::Checkpoint> state,
+         size_t bytes);
+
+      const size_t mBytes;
+   };
+
+   //! Whether the clip is stretched or shifted, so that rendering it is costly
+   static bool Wants(const ClipInterface& clip);
+
+   //! Reserve memory for a rendering of the clip, if within the budget
+   /*! Samples are allocated later, as they are appended
+    @return null if not within the budget */
+   static std::unique_ptr<Rendering>
+   NewRendering(const ClipInterface& clip, size_t length);
+
+   //! Wrap the state of a stretcher, if not null and within the memory budget
+   /*! @return null if not */
+   static std::unique_ptr<Checkpoint> NewCheckpoint(
+      const ClipInterface& clip, sampleCount position,
+      sampleCount lastReadSample,
+      std::unique_ptr<const TimeAndPitchInterface::Checkpoint> state);
+
+   StretchedClipCache();
+   ~StretchedClipCache();
+
+   //! @return the complete rendering of the clip as it is now, or null
+   std::shared_ptr<const Rendering> Find(const ClipInterface& clip) const;
+
+   //! Take before rendering begins, and pass to Store()
+   unsigned long long GetGeneration() const;
+
+   //! Keep a complete rendering, unless Invalidate() was called since
+   //! `generation` was obtained
+   void Store(std::unique_ptr<Rendering> rendering, unsigned long long generation);
+
+   //! @return a checkpoint at `position` for the clip as it is now, or null
+   std::shared_ptr<const Checkpoint>
+   FindCheckpoint(const ClipInterface& clip, sampleCount position) const;
+
+   //! Keep a checkpoint, replacing any at the same position and forgetting
+   //! the least recently used if there are too many; unless Invalidate() was
+   //! called since `generation` was obtained
+   void StoreCheckpoint(
+      std::unique_ptr<Checkpoint> checkpoint, unsigned long long generation);
+
+   //! Forget any rendering and checkpoints, because the clip has changed
+   void Invalidate() noexcept;
+
+private:
+   using Checkpoints = std::vector<std::shared_ptr<const Checkpoint>>;
+
+   mutable std::mutex mMutex;
+   std::shared_ptr<const Rendering> mRendering;
+   //! Most recently used last
+   mutable Checkpoints mCheckpoints;
+   unsigned long long mGeneration{ 0 };
+};
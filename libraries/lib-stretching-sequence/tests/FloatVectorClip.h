@@ -71,9 +71,15 @@ public:
       return {};
    }
 
+   std::shared_ptr<StretchedClipCache> GetStretchedClipCache() const override
+   {
+      return stretchedClipCache;
+   }
+
 public:
    double stretchRatio = 1.;
    double playStartTime = 0.;
+   std::shared_ptr<StretchedClipCache> stretchedClipCache;
 
 private:
    double GetPlayDuration() const;
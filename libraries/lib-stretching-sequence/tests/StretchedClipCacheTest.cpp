@@ -0,0 +1,174 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  StretchedClipCacheTest.cpp
+
+**********************************************************************/
+#include "StretchedClipCache.h"
+#include "AudioContainer.h"
+#include "AudioSegmentFactory.h"
+#include "CachedClipSegment.h"
+#include "ClipSegment.h"
+#include "FloatVectorClip.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+
+namespace
+{
+constexpr auto sampleRate = 44100;
+
+std::vector<float> Sine(size_t numSamples)
+{
+   std::vector<float> samples(numSamples);
+   for (size_t i = 0; i < numSamples; ++i)
+      samples[i] = std::sin(0.05 * i);
+   return samples;
+}
+
+//! Play the clip forward from `t0`, as StretchingSequence would
+std::vector<std::vector<float>> Play(
+   const std::shared_ptr<FloatVectorClip>& clip, double t0,
+   bool expectCached)
+{
+   AudioSegmentFactory factory { sampleRate, static_cast<int>(
+                                                clip->NChannels()),
+                                 { clip } };
+   const auto segments =
+      factory.CreateAudioSegmentSequence(t0, PlaybackDirection::forward);
+   REQUIRE(segments.size() == 1);
+   auto& segment = *segments[0];
+   REQUIRE(
+      (dynamic_cast<CachedClipSegment*>(&segment) != nullptr) == expectCached);
+
+   std::vector<std::vector<float>> result(clip->NChannels());
+   constexpr auto blockSize = 1000;
+   AudioContainer container(blockSize, clip->NChannels());
+   while (!segment.Empty())
+   {
+      const auto numSamples =
+         segment.GetFloats(container.channelPointers.data(), blockSize);
+      for (size_t i = 0; i < result.size(); ++i)
+         result[i].insert(
+            result[i].end(), container.channelVectors[i].begin(),
+            container.channelVectors[i].begin() + numSamples);
+   }
+   return result;
+}
+} // namespace
+
+TEST_CASE("StretchedClipCache")
+{
+   const auto clip = std::make_shared<FloatVectorClip>(
+      sampleRate, Sine(sampleRate), 2u);
+   clip->stretchRatio = 1.5;
+   clip->stretchedClipCache = std::make_shared<StretchedClipCache>();
+   auto& cache = *clip->stretchedClipCache;
+
+   SECTION("unstretched clips are not cached")
+   {
+      clip->stretchRatio = 1.;
+      Play(clip, 0., false);
+      REQUIRE(cache.Find(*clip) == nullptr);
+      Play(clip, 0., false);
+   }
+
+   SECTION("partial passes are not cached")
+   {
+      Play(clip, 0.5, false);
+      REQUIRE(cache.Find(*clip) == nullptr);
+   }
+
+   SECTION("a whole pass is replayed from the cache")
+   {
+      const auto first = Play(clip, 0., false);
+      const auto rendering = cache.Find(*clip);
+      REQUIRE(rendering != nullptr);
+      REQUIRE(rendering->IsComplete());
+      // Longer than a chunk of the rendering
+      std::vector<std::vector<float>> rendered(
+         rendering->NChannels(), std::vector<float>(rendering->Length()));
+      std::vector<float*> pointers;
+      for (auto& channel : rendered)
+         pointers.push_back(channel.data());
+      rendering->Read(pointers.data(), 0, rendering->Length());
+      REQUIRE(rendered == first);
+      REQUIRE(
+         first[0].size() ==
+         ClipSegment::GetTotalNumSamplesToProduce(*clip, 0.).as_size_t());
+
+      SECTION("from the start")
+      {
+         REQUIRE(Play(clip, 0., true) == first);
+      }
+
+      SECTION("from an offset, as many samples as the live segment gives")
+      {
+         constexpr auto t0 = 0.7;
+         const auto second = Play(clip, t0, true);
+         const auto expectedLength =
+            ClipSegment::GetTotalNumSamplesToProduce(*clip, t0).as_size_t();
+         REQUIRE(second[0].size() == expectedLength);
+         const auto offset = first[0].size() - expectedLength;
+         REQUIRE(std::equal(
+            second[0].begin(), second[0].end(), first[0].begin() + offset));
+      }
+
+      SECTION("not when the stretch changed")
+      {
+         clip->stretchRatio = 2.;
+         REQUIRE(cache.Find(*clip) == nullptr);
+         Play(clip, 0., false);
+      }
+
+      SECTION("not after invalidation")
+      {
+         cache.Invalidate();
+         REQUIRE(cache.Find(*clip) == nullptr);
+         Play(clip, 0., false);
+      }
+   }
+
+   SECTION("starting again where playback started needs no priming")
+   {
+      constexpr auto t0 = 0.3;
+      const auto position =
+         ClipSegment::GetTotalNumSamplesToProduce(*clip, 0.) -
+         ClipSegment::GetTotalNumSamplesToProduce(*clip, t0);
+      REQUIRE(cache.FindCheckpoint(*clip, position) == nullptr);
+
+      constexpr auto numSamples = 5000;
+      const auto play = [&] {
+         ClipSegment segment { *clip, t0, PlaybackDirection::forward };
+         AudioContainer container(numSamples, 2);
+         REQUIRE(
+            segment.GetFloats(container.channelPointers.data(), numSamples) ==
+            numSamples);
+         return container.channelVectors;
+      };
+      const auto first = play();
+      const auto checkpoint = cache.FindCheckpoint(*clip, position);
+      REQUIRE(checkpoint != nullptr);
+      REQUIRE(play() == first);
+      // The same checkpoint was used, not replaced
+      REQUIRE(cache.FindCheckpoint(*clip, position) == checkpoint);
+
+      clip->stretchRatio = 2.;
+      REQUIRE(cache.FindCheckpoint(*clip, position) == nullptr);
+   }
+
+   SECTION("a pass during which the clip changed is not stored")
+   {
+      const auto generation = cache.GetGeneration();
+      ClipSegment segment { *clip, 0., PlaybackDirection::forward };
+      cache.Invalidate();
+      AudioContainer container(sampleRate, 2);
+      while (!segment.Empty())
+         segment.GetFloats(container.channelPointers.data(), sampleRate);
+      REQUIRE(cache.Find(*clip) == nullptr);
+      REQUIRE(cache.GetGeneration() != generation);
+   }
+}
@@ -54,6 +54,16 @@ public:
     return _allocatedSize;
   }
 
+  /// copy size, contents and position of another buffer
+  void assign(const CircularSampleBuffer& other)
+  {
+    setSize(other._allocatedSize);
+    assert(_allocatedSize == other._allocatedSize);
+    if (_allocatedSize > 0)
+      memcpy(_buffer, other._buffer, sizeof(SampleT) * _allocatedSize);
+    _position0 = other._position0;
+  }
+
   void reset()
   {
     if (_buffer && _allocatedSize > 0)
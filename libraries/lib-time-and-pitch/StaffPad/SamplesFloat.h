@@ -40,7 +40,7 @@ public:
     return num_samples;
   }
 
-  float** getPtrs()
+  T** getPtrs()
   {
     return data.data();
   }
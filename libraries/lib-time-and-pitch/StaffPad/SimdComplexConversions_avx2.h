@@ -0,0 +1,263 @@
+/* SPDX-License-Identifier: zlib */
+/*
+ * Eight-wide versions of the functions in SimdComplexConversions_sse2.h.
+ * Include only in translation units compiled for AVX2 and FMA, and call only
+ * when the processor supports them.
+ */
+
+#pragma once
+
+#include "SimdComplexConversions_sse2.h"
+
+#include <immintrin.h>
+
+namespace simd_complex_conversions::avx2
+{
+inline __m256 atan_ps(__m256 x)
+{
+   using namespace details;
+
+   __m256 sign_bit, y;
+
+   sign_bit = x;
+   /* take the absolute value */
+   x = _mm256_and_ps(x, _mm256_set1_ps(inv_sign_mask));
+   /* extract the sign bit (upper one) */
+   sign_bit = _mm256_and_ps(sign_bit, _mm256_set1_ps(sign_mask));
+
+   /* range reduction, init x and y depending on range */
+   /* x > 2.414213562373095 */
+   __m256 cmp0 =
+      _mm256_cmp_ps(x, _mm256_set1_ps(2.414213562373095f), _CMP_GT_OS);
+   /* x > 0.4142135623730950 */
+   __m256 cmp1 =
+      _mm256_cmp_ps(x, _mm256_set1_ps(0.4142135623730950f), _CMP_GT_OS);
+
+   /* x > 0.4142135623730950 && !( x > 2.414213562373095 ) */
+   __m256 cmp2 = _mm256_andnot_ps(cmp0, cmp1);
+
+   /* -( 1.0/x ) */
+   __m256 y0 = _mm256_and_ps(cmp0, _mm256_set1_ps(cephes_PIO2F));
+   __m256 x0 = _mm256_div_ps(_mm256_set1_ps(1.0f), x);
+   x0 = _mm256_xor_ps(x0, _mm256_set1_ps(sign_mask));
+
+   __m256 y1 = _mm256_and_ps(cmp2, _mm256_set1_ps(cephes_PIO4F));
+   /* (x-1.0)/(x+1.0) */
+   __m256 x1_o = _mm256_sub_ps(x, _mm256_set1_ps(1.0f));
+   __m256 x1_u = _mm256_add_ps(x, _mm256_set1_ps(1.0f));
+   __m256 x1 = _mm256_div_ps(x1_o, x1_u);
+
+   __m256 x2 = _mm256_and_ps(cmp2, x1);
+   x0 = _mm256_and_ps(cmp0, x0);
+   x2 = _mm256_or_ps(x2, x0);
+   cmp1 = _mm256_or_ps(cmp0, cmp2);
+   x2 = _mm256_and_ps(cmp1, x2);
+   x = _mm256_andnot_ps(cmp1, x);
+   x = _mm256_or_ps(x2, x);
+
+   y = _mm256_or_ps(y0, y1);
+
+   __m256 zz = _mm256_mul_ps(x, x);
+   __m256 acc = _mm256_set1_ps(atancof_p0);
+   acc = _mm256_fmsub_ps(acc, zz, _mm256_set1_ps(atancof_p1));
+   acc = _mm256_fmadd_ps(acc, zz, _mm256_set1_ps(atancof_p2));
+   acc = _mm256_fmsub_ps(acc, zz, _mm256_set1_ps(atancof_p3));
+   acc = _mm256_mul_ps(acc, zz);
+   acc = _mm256_fmadd_ps(acc, x, x);
+   y = _mm256_add_ps(y, acc);
+
+   /* update the sign */
+   y = _mm256_xor_ps(y, sign_bit);
+
+   return y;
+}
+
+inline __m256 atan2_ps(__m256 y, __m256 x)
+{
+   using namespace details;
+
+   __m256 zero = _mm256_setzero_ps();
+   __m256 x_eq_0 = _mm256_cmp_ps(x, zero, _CMP_EQ_OQ);
+   __m256 x_gt_0 = _mm256_cmp_ps(x, zero, _CMP_GT_OS);
+   __m256 y_eq_0 = _mm256_cmp_ps(y, zero, _CMP_EQ_OQ);
+   __m256 x_lt_0 = _mm256_cmp_ps(x, zero, _CMP_LT_OS);
+   __m256 y_lt_0 = _mm256_cmp_ps(y, zero, _CMP_LT_OS);
+
+   __m256 zero_mask = _mm256_and_ps(x_eq_0, y_eq_0);
+   __m256 zero_mask_other_case = _mm256_and_ps(y_eq_0, x_gt_0);
+   zero_mask = _mm256_or_ps(zero_mask, zero_mask_other_case);
+
+   __m256 pio2_mask = _mm256_andnot_ps(y_eq_0, x_eq_0);
+   __m256 pio2_mask_sign = _mm256_and_ps(y_lt_0, _mm256_set1_ps(sign_mask));
+   __m256 pio2_result = _mm256_set1_ps(cephes_PIO2F);
+   pio2_result = _mm256_xor_ps(pio2_result, pio2_mask_sign);
+   pio2_result = _mm256_and_ps(pio2_mask, pio2_result);
+
+   __m256 pi_mask = _mm256_and_ps(y_eq_0, x_lt_0);
+   __m256 pi = _mm256_set1_ps(cephes_PIF);
+   __m256 pi_result = _mm256_and_ps(pi_mask, pi);
+
+   __m256 swap_sign_mask_offset = _mm256_and_ps(x_lt_0, y_lt_0);
+   swap_sign_mask_offset =
+      _mm256_and_ps(swap_sign_mask_offset, _mm256_set1_ps(sign_mask));
+
+   __m256 offset1 = _mm256_set1_ps(cephes_PIF);
+   offset1 = _mm256_xor_ps(offset1, swap_sign_mask_offset);
+
+   __m256 offset = _mm256_and_ps(x_lt_0, offset1);
+
+   __m256 arg = _mm256_div_ps(y, x);
+   __m256 atan_result = atan_ps(arg);
+   atan_result = _mm256_add_ps(atan_result, offset);
+
+   /* select between zero_result, pio2_result and atan_result */
+
+   __m256 result = _mm256_andnot_ps(zero_mask, pio2_result);
+   atan_result = _mm256_andnot_ps(zero_mask, atan_result);
+   atan_result = _mm256_andnot_ps(pio2_mask, atan_result);
+   result = _mm256_or_ps(result, atan_result);
+   result = _mm256_or_ps(result, pi_result);
+
+   return result;
+}
+
+struct SinCos
+{
+   __m256 sin;
+   __m256 cos;
+};
+
+inline SinCos sincos_ps(__m256 x)
+{
+   using namespace details;
+   __m256 xmm1, xmm2, xmm3, sign_bit_sin, y;
+   __m256i emm0, emm2, emm4;
+
+   sign_bit_sin = x;
+   /* take the absolute value */
+   x = _mm256_and_ps(x, _mm256_set1_ps(inv_sign_mask));
+   /* extract the sign bit (upper one) */
+   sign_bit_sin = _mm256_and_ps(sign_bit_sin, _mm256_set1_ps(sign_mask));
+
+   /* scale by 4/Pi */
+   y = _mm256_mul_ps(x, _mm256_set1_ps(cephes_FOPI));
+
+   /* store the integer part of y in emm2 */
+   emm2 = _mm256_cvttps_epi32(y);
+
+   /* j=(j+1) & (~1) (see the cephes sources) */
+   emm2 = _mm256_add_epi32(emm2, _mm256_set1_epi32(1));
+   emm2 = _mm256_and_si256(emm2, _mm256_set1_epi32(~1));
+   y = _mm256_cvtepi32_ps(emm2);
+
+   emm4 = emm2;
+
+   /* get the swap sign flag for the sine */
+   emm0 = _mm256_and_si256(emm2, _mm256_set1_epi32(4));
+   emm0 = _mm256_slli_epi32(emm0, 29);
+   __m256 swap_sign_bit_sin = _mm256_castsi256_ps(emm0);
+
+   /* get the polynom selection mask for the sine*/
+   emm2 = _mm256_and_si256(emm2, _mm256_set1_epi32(2));
+   emm2 = _mm256_cmpeq_epi32(emm2, _mm256_setzero_si256());
+   __m256 poly_mask = _mm256_castsi256_ps(emm2);
+
+   /* The magic pass: "Extended precision modular arithmetic"
+      x = ((x - y * DP1) - y * DP2) - y * DP3; */
+   x = _mm256_fmadd_ps(y, _mm256_set1_ps(minus_cephes_DP1), x);
+   x = _mm256_fmadd_ps(y, _mm256_set1_ps(minus_cephes_DP2), x);
+   x = _mm256_fmadd_ps(y, _mm256_set1_ps(minus_cephes_DP3), x);
+
+   emm4 = _mm256_sub_epi32(emm4, _mm256_set1_epi32(2));
+   emm4 = _mm256_andnot_si256(emm4, _mm256_set1_epi32(4));
+   emm4 = _mm256_slli_epi32(emm4, 29);
+   __m256 sign_bit_cos = _mm256_castsi256_ps(emm4);
+
+   sign_bit_sin = _mm256_xor_ps(sign_bit_sin, swap_sign_bit_sin);
+
+   /* Evaluate the first polynom  (0 <= x <= Pi/4) */
+   __m256 z = _mm256_mul_ps(x, x);
+   y = _mm256_set1_ps(coscof_p0);
+
+   y = _mm256_fmadd_ps(y, z, _mm256_set1_ps(coscof_p1));
+   y = _mm256_fmadd_ps(y, z, _mm256_set1_ps(coscof_p2));
+   y = _mm256_mul_ps(y, z);
+   y = _mm256_mul_ps(y, z);
+   y = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), y);
+   y = _mm256_add_ps(y, _mm256_set1_ps(1));
+
+   /* Evaluate the second polynom  (Pi/4 <= x <= 0) */
+
+   __m256 y2 = _mm256_set1_ps(sincof_p0);
+   y2 = _mm256_fmadd_ps(y2, z, _mm256_set1_ps(sincof_p1));
+   y2 = _mm256_fmadd_ps(y2, z, _mm256_set1_ps(sincof_p2));
+   y2 = _mm256_mul_ps(y2, z);
+   y2 = _mm256_fmadd_ps(y2, x, x);
+
+   /* select the correct result from the two polynoms */
+   xmm3 = poly_mask;
+   __m256 ysin2 = _mm256_and_ps(xmm3, y2);
+   __m256 ysin1 = _mm256_andnot_ps(xmm3, y);
+   y2 = _mm256_sub_ps(y2, ysin2);
+   y = _mm256_sub_ps(y, ysin1);
+
+   xmm1 = _mm256_add_ps(ysin1, ysin2);
+   xmm2 = _mm256_add_ps(y, y2);
+
+   /* update the sign */
+   return { _mm256_xor_ps(xmm1, sign_bit_sin),
+            _mm256_xor_ps(xmm2, sign_bit_cos) };
+}
+
+inline __m256 norm(__m256 x, __m256 y)
+{
+   return _mm256_fmadd_ps(x, x, _mm256_mul_ps(y, y));
+}
+
+//! Load 8 complex numbers, and separate real and imaginary parts, in order
+inline void load_complex(const std::complex<float>* input, __m256& rp, __m256& ip)
+{
+   // Safe according to C++ standard
+   auto p1 = _mm256_load_ps(reinterpret_cast<const float*>(input));
+   auto p2 = _mm256_load_ps(reinterpret_cast<const float*>(input + 4));
+   // The shuffles work within 128 bit lanes; restore the order after
+   const auto r = _mm256_shuffle_ps(p1, p2, _MM_SHUFFLE(2, 0, 2, 0));
+   const auto i = _mm256_shuffle_ps(p1, p2, _MM_SHUFFLE(3, 1, 3, 1));
+   rp = _mm256_castpd_ps(
+      _mm256_permute4x64_pd(_mm256_castps_pd(r), _MM_SHUFFLE(3, 1, 2, 0)));
+   ip = _mm256_castpd_ps(
+      _mm256_permute4x64_pd(_mm256_castps_pd(i), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+//! Inverse of load_complex
+inline void store_complex(__m256 rp, __m256 ip, std::complex<float>* output)
+{
+   const auto lo = _mm256_unpacklo_ps(rp, ip);
+   const auto hi = _mm256_unpackhi_ps(rp, ip);
+   _mm256_store_ps(
+      reinterpret_cast<float*>(output), _mm256_permute2f128_ps(lo, hi, 0x20));
+   _mm256_store_ps(
+      reinterpret_cast<float*>(output + 4),
+      _mm256_permute2f128_ps(lo, hi, 0x31));
+}
+
+//! Multiply complex numbers by unit phasors of angles theta
+inline void rotate(__m256 theta, __m256& rp, __m256& ip)
+{
+   auto [sin, cos] = sincos_ps(theta);
+   // (rp, ip) * (cos, sin) -> (rp*cos - ip*sin, rp*sin + ip*cos)
+   const auto out_rp = _mm256_fmsub_ps(rp, cos, _mm256_mul_ps(ip, sin));
+   const auto out_ip = _mm256_fmadd_ps(rp, sin, _mm256_mul_ps(ip, cos));
+   rp = out_rp;
+   ip = out_ip;
+}
+
+//! Wrap phases into -pi..pi
+inline __m256 unwrap(__m256 a)
+{
+   const auto turns = _mm256_round_ps(
+      _mm256_mul_ps(a, _mm256_set1_ps(0.15915494309f)),
+      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+   return _mm256_fnmadd_ps(turns, _mm256_set1_ps(6.283185307f), a);
+}
+} // namespace simd_complex_conversions::avx2
@@ -10,12 +10,24 @@
 
 #include <array>
 #include <complex>
+#include <cstring>
 #include <type_traits>
 #include <memory>
 #include <utility>
 
+// Each instruction set gets its own copies of these inline functions.  Else
+// the linker might keep the copies emitted in a translation unit compiled for
+// AVX2, such as VectorOps_avx2.cpp, and use them on processors without it.
+#if defined(__AVX2__)
+#   define SIMD_COMPLEX_CONVERSIONS_ISA isa_avx2
+#else
+#   define SIMD_COMPLEX_CONVERSIONS_ISA isa_baseline
+#endif
+
 namespace simd_complex_conversions
 {
+inline namespace SIMD_COMPLEX_CONVERSIONS_ISA
+{
 // Before C++20 there is no standard and correct way to implement bit_cast.
 // It was verified that MSVC generates the correct code for the current use
 // cases
@@ -133,7 +145,6 @@ inline __m128 atan2_ps(__m128 y, __m128 x)
    __m128 zero = _mm_setzero_ps();
    __m128 x_eq_0 = _mm_cmpeq_ps(x, zero);
    __m128 x_gt_0 = _mm_cmpgt_ps(x, zero);
-   __m128 x_le_0 = _mm_cmple_ps(x, zero);
    __m128 y_eq_0 = _mm_cmpeq_ps(y, zero);
    __m128 x_lt_0 = _mm_cmplt_ps(x, zero);
    __m128 y_lt_0 = _mm_cmplt_ps(y, zero);
@@ -178,7 +189,15 @@ inline __m128 atan2_ps(__m128 y, __m128 x)
    return result;
 }
 
-inline std::pair<__m128, __m128> sincos_ps(__m128 x)
+//! Not std::pair, whose template argument would lose the alignment
+//! attribute of __m128
+struct SinCos
+{
+   __m128 sin;
+   __m128 cos;
+};
+
+inline SinCos sincos_ps(__m128 x)
 {
    using namespace details;
    __m128 xmm1, xmm2, xmm3 = _mm_setzero_ps(), sign_bit_sin, y;
@@ -268,8 +287,7 @@ inline std::pair<__m128, __m128> sincos_ps(__m128 x)
    xmm2 = _mm_add_ps(y, y2);
 
    /* update the sign */
-   return std::make_pair(
-      _mm_xor_ps(xmm1, sign_bit_sin), _mm_xor_ps(xmm2, sign_bit_cos));
+   return { _mm_xor_ps(xmm1, sign_bit_sin), _mm_xor_ps(xmm2, sign_bit_cos) };
 }
 
 inline float atan2_ss(float y, float x)
@@ -280,7 +298,7 @@ inline float atan2_ss(float y, float x)
 inline std::pair<float, float> sincos_ss(float angle)
 {
    auto res = sincos_ps(_mm_set_ss(angle));
-   return std::make_pair(_mm_cvtss_f32(res.first), _mm_cvtss_f32(res.second));
+   return std::make_pair(_mm_cvtss_f32(res.sin), _mm_cvtss_f32(res.cos));
 }
 
 inline __m128 norm(__m128 x, __m128 y)
@@ -366,4 +384,44 @@ inline void rotate_parallel_simd_aligned(
    }
 }
 
+//! Wraps `newPhase` into -pi..pi in place, then does as
+//! rotate_parallel_simd_aligned, in one pass
+inline void unwrap_and_rotate_parallel_simd_aligned(
+   const float* oldPhase, float* newPhase, std::complex<float>* output, int n)
+{
+   const auto unwrap = [](__m128 a) {
+      const auto turns = _mm_cvtepi32_ps(
+         _mm_cvtps_epi32(_mm_mul_ps(a, _mm_set1_ps(0.15915494309f))));
+      return _mm_sub_ps(a, _mm_mul_ps(turns, _mm_set1_ps(6.283185307f)));
+   };
+   for (int i = 0; i <= n - 4; i += 4)
+   {
+      const auto phase = unwrap(_mm_load_ps(newPhase + i));
+      _mm_store_ps(newPhase + i, phase);
+      auto [sin, cos] = sincos_ps(_mm_sub_ps(phase, _mm_load_ps(oldPhase + i)));
+
+      auto p1 = _mm_load_ps(reinterpret_cast<float*>(output + i));
+      auto p2 = _mm_load_ps(reinterpret_cast<float*>(output + i + 2));
+      auto rp = _mm_shuffle_ps(p1, p2, _MM_SHUFFLE(2, 0, 2, 0));
+      auto ip = _mm_shuffle_ps(p1, p2, _MM_SHUFFLE(3, 1, 3, 1));
+
+      auto out_rp = _mm_sub_ps(_mm_mul_ps(rp, cos), _mm_mul_ps(ip, sin));
+      auto out_ip = _mm_add_ps(_mm_mul_ps(rp, sin), _mm_mul_ps(ip, cos));
+
+      _mm_store_ps(
+         reinterpret_cast<float*>(output + i), _mm_unpacklo_ps(out_rp, out_ip));
+      _mm_store_ps(
+         reinterpret_cast<float*>(output + i + 2),
+         _mm_unpackhi_ps(out_rp, out_ip));
+   }
+   // deal with last partial packet
+   for (int i = n & (~3); i < n; ++i)
+   {
+      newPhase[i] = _mm_cvtss_f32(unwrap(_mm_set_ss(newPhase[i])));
+      const auto theta = newPhase[i] - oldPhase[i];
+      output[i] *= std::complex<float>(cosf(theta), sinf(theta));
+   }
+}
+
+} // namespace SIMD_COMPLEX_CONVERSIONS_ISA
 } // namespace simd_complex_conversions
@@ -187,6 +187,44 @@ void TimeAndPitch::reset()
   _resampleReadPos = 0.0;
 }
 
+void TimeAndPitch::copyStateFrom(const TimeAndPitch& other)
+{
+  assert(fftSize == other.fftSize);
+  assert(_numChannels == other._numChannels);
+  assert(_maxBlockSize == other._maxBlockSize);
+  assert(d && other.d);
+
+  const auto& od = *other.d;
+  d->randomGenerator = od.randomGenerator;
+  for (int ch = 0; ch < _numChannels; ++ch)
+  {
+    d->inResampleInputBuffer[ch].assign(od.inResampleInputBuffer[ch]);
+    d->inCircularBuffer[ch].assign(od.inCircularBuffer[ch]);
+    d->outCircularBuffer[ch].assign(od.outCircularBuffer[ch]);
+  }
+  d->normalizationBuffer.assign(od.normalizationBuffer);
+  d->norm.assignSamples(od.norm);
+  d->last_norm.assignSamples(od.last_norm);
+  d->phase.assignSamples(od.phase);
+  d->last_phase.assignSamples(od.last_phase);
+  d->phase_accum.assignSamples(od.phase_accum);
+  d->random_phases.assignSamples(od.random_phases);
+  d->exact_hop_a = od.exact_hop_a;
+  d->hop_a_err = od.hop_a_err;
+  d->exact_hop_s = od.exact_hop_s;
+  d->next_exact_hop_s = od.next_exact_hop_s;
+  d->hop_s_err = od.hop_s_err;
+
+  _resampleReadPos = other._resampleReadPos;
+  _availableOutputSamples = other._availableOutputSamples;
+  _overlap_a = other._overlap_a;
+  _analysis_hop_counter = other._analysis_hop_counter;
+  _expectedPhaseChangePerBinPerSample = other._expectedPhaseChangePerBinPerSample;
+  _timeStretch = other._timeStretch;
+  _pitchFactor = other._pitchFactor;
+  _outBufferWriteOffset = other._outBufferWriteOffset;
+}
+
 namespace {
 
 // wrap a phase value into -PI..PI
@@ -196,11 +234,6 @@ inline float _unwrapPhase(float arg)
   return arg - rint(arg * 0.15915494309f) * 6.283185307f;
 }
 
-void _unwrapPhaseVec(float* v, int n)
-{
-  audio::simd::perform_parallel_simd_aligned(v, n, [](auto& a) { a = a - rint(a * 0.15915494309f) * 6.283185307f; });
-}
-
 /// rotate even-sized array by half its size to align fft phase at the center
 void _fft_shift(float* v, int n)
 {
@@ -386,8 +419,7 @@ void TimeAndPitch::_process_hop(int hop_a, int hop_s)
     // norms of the mid channel only (or sole channel) are needed in
     // _time_stretch
     vo::calcNorms(d->spectrum.getPtr(0), d->norm.getPtr(0), d->spectrum.getNumSamples());
-    for (int ch = 0; ch < _numChannels; ++ch)
-      vo::calcPhases(d->spectrum.getPtr(ch), d->phase.getPtr(ch), d->spectrum.getNumSamples());
+    vo::calcPhases(d->spectrum.getPtrs(), d->phase.getPtrs(), _numChannels, d->spectrum.getNumSamples());
 
     if (_shiftTimbreCb)
        _shiftTimbreCb(
@@ -401,12 +433,10 @@ void TimeAndPitch::_process_hop(int hop_a, int hop_s)
     else if (_numChannels == 2)
       _time_stretch<2>((float)hop_a, (float)hop_s);
 
-    for (int ch = 0; ch < _numChannels; ++ch)
-      _unwrapPhaseVec(d->phase_accum.getPtr(ch), _numBins);
-
-    for (int ch = 0; ch < _numChannels; ++ch)
-      vo::rotate(d->phase.getPtr(ch), d->phase_accum.getPtr(ch), d->spectrum.getPtr(ch),
-                                  d->spectrum.getNumSamples());
+    // wrap the accumulated phases and apply their differences from the
+    // analysed phases, for all channels in one pass
+    vo::unwrapAndRotate(d->phase.getPtrs(), d->phase_accum.getPtrs(), d->spectrum.getPtrs(), _numChannels,
+                        d->spectrum.getNumSamples());
     d->fft.inverseReal(d->spectrum, d->fft_timeseries);
 
     for (int ch = 0; ch < _numChannels; ++ch)
@@ -68,6 +68,11 @@ public:
    */
   void processPitchShift(float* const* smp, int numSamples, double pitchFactor);
 
+  int getFftSize() const
+  {
+    return fftSize;
+  }
+
   /**
     Latency in input samples
   */
@@ -83,6 +88,13 @@ public:
   */
   void reset();
 
+  /**
+    Copies the processing state of another instance, so that this one continues
+    exactly as the other would. Both must have the same FFT size and have been
+    setup with the same number of channels and maximum block size.
+  */
+  void copyStateFrom(const TimeAndPitch& other);
+
 private:
   const int fftSize;
   static constexpr int overlap = 4;
@@ -0,0 +1,45 @@
+#include "VectorOps.h"
+
+#if USE_SSE2_COMPLEX
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+namespace staffpad::vo::avx2 {
+
+// Defined in VectorOps_avx2.cpp
+extern const bool kernelsBuilt;
+
+namespace {
+bool detectAvx2AndFma()
+{
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+  __cpuid(info, 1);
+  const bool fma = (info[2] & (1 << 12)) != 0;
+  // The OS must also save the ymm registers
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  if (!fma || !osxsave || (_xgetbv(0) & 6) != 6)
+    return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+} // namespace
+
+bool isSupported()
+{
+  static const bool result = kernelsBuilt && detectAvx2AndFma();
+  return result;
+}
+
+} // namespace staffpad::vo::avx2
+
+#endif
@@ -10,12 +10,14 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
+#include <cmath>
 #include <complex>
 #include <cstdint>
 #include <cstring>
 
-#if defined(_MSC_VER) && (defined(_M_AMD64) || defined(_M_X64) || \
-                          (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64) || \
+   (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
 #define USE_SSE2_COMPLEX 1
 #endif
 
@@ -101,8 +103,26 @@ inline void findMaxElement(const T* src, int32_t n, int32_t& maxIndex, T& maxVal
 
 #if USE_SSE2_COMPLEX
 
+// Eight-wide kernels, defined in VectorOps_avx2.cpp, and used only when the
+// processor supports AVX2 and FMA
+namespace avx2 {
+TIME_AND_PITCH_API bool isSupported();
+TIME_AND_PITCH_API void
+calcPhases(const std::complex<float>* src, float* dst, int32_t n);
+TIME_AND_PITCH_API void
+calcNorms(const std::complex<float>* src, float* dst, int32_t n);
+TIME_AND_PITCH_API void rotate(
+   const float* oldPhase, const float* newPhase, std::complex<float>* dst,
+   int32_t n);
+TIME_AND_PITCH_API void unwrapAndRotate(
+   const float* oldPhase, float* newPhase, std::complex<float>* dst,
+   int32_t n);
+} // namespace avx2
+
 inline void calcPhases(const std::complex<float>* src, float* dst, int32_t n)
 {
+  if (avx2::isSupported())
+    return avx2::calcPhases(src, dst, n);
   simd_complex_conversions::perform_parallel_simd_aligned(
      src, dst, n,
      [](const __m128 rp, const __m128 ip, __m128& out)
@@ -111,6 +131,8 @@ inline void calcPhases(const std::complex<float>* src, float* dst, int32_t n)
 
 inline void calcNorms(const std::complex<float>* src, float* dst, int32_t n)
 {
+  if (avx2::isSupported())
+    return avx2::calcNorms(src, dst, n);
   simd_complex_conversions::perform_parallel_simd_aligned(
      src, dst, n,
      [](const __m128 rp, const __m128 ip, __m128& out)
@@ -121,9 +143,21 @@ inline void rotate(
    const float* oldPhase, const float* newPhase, std::complex<float>* dst,
    int32_t n)
 {
+  if (avx2::isSupported())
+    return avx2::rotate(oldPhase, newPhase, dst, n);
   simd_complex_conversions::rotate_parallel_simd_aligned(
      oldPhase, newPhase, dst, n);
 }
+
+inline void unwrapAndRotate(
+   const float* oldPhase, float* newPhase, std::complex<float>* dst,
+   int32_t n)
+{
+  if (avx2::isSupported())
+    return avx2::unwrapAndRotate(oldPhase, newPhase, dst, n);
+  simd_complex_conversions::unwrap_and_rotate_parallel_simd_aligned(
+     oldPhase, newPhase, dst, n);
+}
 #else
 inline void calcPhases(const std::complex<float>* src, float* dst, int32_t n)
 {
@@ -144,7 +178,44 @@ inline void rotate(const float* oldPhase, const float* newPhase, std::complex<fl
     dst[i] *= std::complex<float>(cosf(theta), sinf(theta));
   }
 }
+
+inline void unwrapAndRotate(const float* oldPhase, float* newPhase, std::complex<float>* dst, int32_t n)
+{
+  for (int32_t i = 0; i < n; i++) {
+    newPhase[i] -= std::nearbyint(newPhase[i] * 0.15915494309f) * 6.283185307f;
+    const auto theta = newPhase[i] - oldPhase[i];
+    dst[i] *= std::complex<float>(cosf(theta), sinf(theta));
+  }
+}
 #endif
 
+// The following process all channels in one pass, a block of bins at a time,
+// so that the bins of all channels stay in cache together.  Blocks begin at
+// multiples of 64 bytes, preserving the alignment that the kernels require.
+constexpr int32_t binBlockSize = 256;
+
+inline void calcPhases(const std::complex<float>* const* src, float* const* dst, int32_t numChannels, int32_t n)
+{
+  for (int32_t i = 0; i < n; i += binBlockSize)
+  {
+    const auto count = std::min(binBlockSize, n - i);
+    for (int32_t ch = 0; ch < numChannels; ch++)
+      calcPhases(src[ch] + i, dst[ch] + i, count);
+  }
+}
+
+/// Wrap each of `newPhase` into -pi..pi in place, then multiply each of `dst`
+/// by unit phasors of the angles `newPhase - oldPhase`
+inline void unwrapAndRotate(const float* const* oldPhase, float* const* newPhase, std::complex<float>* const* dst,
+                            int32_t numChannels, int32_t n)
+{
+  for (int32_t i = 0; i < n; i += binBlockSize)
+  {
+    const auto count = std::min(binBlockSize, n - i);
+    for (int32_t ch = 0; ch < numChannels; ch++)
+      unwrapAndRotate(oldPhase[ch] + i, newPhase[ch] + i, dst[ch] + i, count);
+  }
+}
+
 } // namespace vo
 } // namespace staffpad
@@ -0,0 +1,177 @@
+/*
+  Eight-wide versions of the complex kernels of VectorOps.h.
+
+  This file must be compiled with AVX2 and FMA enabled, and nothing in it may
+  run unless vo::avx2::isSupported().  Without those compiler options, the
+  kernels are not built, and isSupported() is false.
+ */
+
+#include "VectorOps.h"
+
+#if USE_SSE2_COMPLEX
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#   define BUILD_AVX2_KERNELS 1
+#   include "SimdComplexConversions_avx2.h"
+#endif
+
+namespace staffpad::vo::avx2 {
+
+#if BUILD_AVX2_KERNELS
+
+namespace scc = simd_complex_conversions;
+
+// Tested in VectorOps.cpp, which is not compiled for AVX2
+extern const bool kernelsBuilt = true;
+
+namespace {
+// The last partial vector is copied into zero-padded buffers and given to the
+// same eight-wide code.  The four-wide helpers of
+// SimdComplexConversions_sse2.h are not used here, nor anything else inline
+// from std, so that the linker has no copies of them compiled for AVX2.
+
+void calcPhases8(const std::complex<float>* src, float* dst)
+{
+  __m256 rp, ip;
+  scc::avx2::load_complex(src, rp, ip);
+  _mm256_store_ps(dst, scc::avx2::atan2_ps(ip, rp));
+}
+
+void calcNorms8(const std::complex<float>* src, float* dst)
+{
+  __m256 rp, ip;
+  scc::avx2::load_complex(src, rp, ip);
+  _mm256_store_ps(dst, scc::avx2::norm(rp, ip));
+}
+
+void rotate8(
+   const float* oldPhase, const float* newPhase, std::complex<float>* dst)
+{
+  auto theta = _mm256_load_ps(newPhase);
+  if (oldPhase)
+    theta = _mm256_sub_ps(theta, _mm256_load_ps(oldPhase));
+  __m256 rp, ip;
+  scc::avx2::load_complex(dst, rp, ip);
+  scc::avx2::rotate(theta, rp, ip);
+  scc::avx2::store_complex(rp, ip, dst);
+}
+
+void unwrapAndRotate8(
+   const float* oldPhase, float* newPhase, std::complex<float>* dst)
+{
+  const auto phase = scc::avx2::unwrap(_mm256_load_ps(newPhase));
+  _mm256_store_ps(newPhase, phase);
+  __m256 rp, ip;
+  scc::avx2::load_complex(dst, rp, ip);
+  scc::avx2::rotate(_mm256_sub_ps(phase, _mm256_load_ps(oldPhase)), rp, ip);
+  scc::avx2::store_complex(rp, ip, dst);
+}
+
+//! Zero-padded copies of fewer than eight elements
+struct Tail
+{
+  alignas(32) float complexes[16] {};
+  alignas(32) float phases[8] {};
+  alignas(32) float otherPhases[8] {};
+
+  std::complex<float>* Complexes()
+  {
+    return reinterpret_cast<std::complex<float>*>(complexes);
+  }
+};
+} // namespace
+
+void calcPhases(const std::complex<float>* src, float* dst, int32_t n)
+{
+  const auto n8 = n & ~7;
+  for (int32_t i = 0; i < n8; i += 8)
+    calcPhases8(src + i, dst + i);
+  if (const auto rest = n - n8; rest > 0)
+  {
+    Tail tail;
+    std::memcpy(tail.complexes, src + n8, rest * sizeof(*src));
+    calcPhases8(tail.Complexes(), tail.phases);
+    std::memcpy(dst + n8, tail.phases, rest * sizeof(*dst));
+  }
+}
+
+void calcNorms(const std::complex<float>* src, float* dst, int32_t n)
+{
+  const auto n8 = n & ~7;
+  for (int32_t i = 0; i < n8; i += 8)
+    calcNorms8(src + i, dst + i);
+  if (const auto rest = n - n8; rest > 0)
+  {
+    Tail tail;
+    std::memcpy(tail.complexes, src + n8, rest * sizeof(*src));
+    calcNorms8(tail.Complexes(), tail.phases);
+    std::memcpy(dst + n8, tail.phases, rest * sizeof(*dst));
+  }
+}
+
+void rotate(
+   const float* oldPhase, const float* newPhase, std::complex<float>* dst,
+   int32_t n)
+{
+  const auto n8 = n & ~7;
+  for (int32_t i = 0; i < n8; i += 8)
+    rotate8(oldPhase ? oldPhase + i : nullptr, newPhase + i, dst + i);
+  if (const auto rest = n - n8; rest > 0)
+  {
+    Tail tail;
+    std::memcpy(tail.complexes, dst + n8, rest * sizeof(*dst));
+    std::memcpy(tail.phases, newPhase + n8, rest * sizeof(*newPhase));
+    if (oldPhase)
+      std::memcpy(tail.otherPhases, oldPhase + n8, rest * sizeof(*oldPhase));
+    rotate8(
+       oldPhase ? tail.otherPhases : nullptr, tail.phases, tail.Complexes());
+    std::memcpy(dst + n8, tail.complexes, rest * sizeof(*dst));
+  }
+}
+
+void unwrapAndRotate(
+   const float* oldPhase, float* newPhase, std::complex<float>* dst,
+   int32_t n)
+{
+  const auto n8 = n & ~7;
+  for (int32_t i = 0; i < n8; i += 8)
+    unwrapAndRotate8(oldPhase + i, newPhase + i, dst + i);
+  if (const auto rest = n - n8; rest > 0)
+  {
+    Tail tail;
+    std::memcpy(tail.complexes, dst + n8, rest * sizeof(*dst));
+    std::memcpy(tail.phases, newPhase + n8, rest * sizeof(*newPhase));
+    std::memcpy(tail.otherPhases, oldPhase + n8, rest * sizeof(*oldPhase));
+    unwrapAndRotate8(tail.otherPhases, tail.phases, tail.Complexes());
+    std::memcpy(newPhase + n8, tail.phases, rest * sizeof(*newPhase));
+    std::memcpy(dst + n8, tail.complexes, rest * sizeof(*dst));
+  }
+}
+
+#else
+
+extern const bool kernelsBuilt = false;
+
+// Never called, but defined for the linker
+
+void calcPhases(const std::complex<float>*, float*, int32_t)
+{
+}
+
+void calcNorms(const std::complex<float>*, float*, int32_t)
+{
+}
+
+void rotate(const float*, const float*, std::complex<float>*, int32_t)
+{
+}
+
+void unwrapAndRotate(const float*, float*, std::complex<float>*, int32_t)
+{
+}
+
+#endif
+
+} // namespace staffpad::vo::avx2
+
+#endif
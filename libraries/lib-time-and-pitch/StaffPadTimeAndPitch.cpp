@@ -77,9 +77,45 @@ GetFormantShifterLogger(int sampleRate)
 }
 } // namespace
 
+struct StaffPadTimeAndPitch::StaffPadCheckpoint final : Checkpoint
+{
+   StaffPadCheckpoint(
+      int sampleRate, size_t numChannels, const Parameters& parameters,
+      const staffpad::TimeAndPitch* pTimeAndPitch)
+       : sampleRate { sampleRate }
+       , numChannels { numChannels }
+       , parameters { parameters }
+       , fftSize { pTimeAndPitch ? pTimeAndPitch->getFftSize() : 0 }
+   {
+      if (pTimeAndPitch)
+      {
+         // Only the state is used, so no timbre callback is needed
+         state = std::make_unique<staffpad::TimeAndPitch>(fftSize);
+         state->setup(static_cast<int>(numChannels), maxBlockSize);
+         state->copyStateFrom(*pTimeAndPitch);
+      }
+   }
+
+   size_t MemorySize() const override
+   {
+      if (!state)
+         return sizeof(*this);
+      // Circular and spectral buffers, as allocated by TimeAndPitch::setup
+      return sizeof(*this) +
+             (7 * numChannels + 6) * fftSize * sizeof(float);
+   }
+
+   const int sampleRate;
+   const size_t numChannels;
+   const Parameters parameters;
+   const int fftSize;
+   //! Null in pass-through mode
+   std::unique_ptr<staffpad::TimeAndPitch> state;
+};
+
 StaffPadTimeAndPitch::StaffPadTimeAndPitch(
    int sampleRate, size_t numChannels, TimeAndPitchSource& audioSource,
-   const Parameters& parameters)
+   const Parameters& parameters, const Checkpoint* checkpoint)
     : mSampleRate(sampleRate)
     , mParameters(parameters)
     , mFormantShifterLogger(GetFormantShifterLogger(sampleRate))
@@ -95,6 +131,8 @@ StaffPadTimeAndPitch::StaffPadTimeAndPitch(
    if (mParameters.preserveFormants)
       mFormantShifter.Reset(
          GetFftSize(sampleRate, parameters.preserveFormants));
+   if (checkpoint && RestoreCheckpoint(*checkpoint))
+      return;
    if (
       !TimeAndPitchInterface::IsPassThroughMode(mParameters.timeRatio) ||
       // No need for sophisticated comparison for pitch ratio, as our UI doesn't
@@ -210,6 +248,39 @@ void StaffPadTimeAndPitch::InitializeStretcher()
    }
 }
 
+auto StaffPadTimeAndPitch::SaveCheckpoint() const
+   -> std::unique_ptr<Checkpoint>
+{
+   return std::make_unique<StaffPadCheckpoint>(
+      mSampleRate, mNumChannels, mParameters, mTimeAndPitch.get());
+}
+
+bool StaffPadTimeAndPitch::RestoreCheckpoint(const Checkpoint& checkpoint)
+{
+   const auto pCheckpoint =
+      dynamic_cast<const StaffPadCheckpoint*>(&checkpoint);
+   assert(pCheckpoint);
+   if (
+      !pCheckpoint || pCheckpoint->sampleRate != mSampleRate ||
+      pCheckpoint->numChannels != mNumChannels ||
+      pCheckpoint->parameters.timeRatio != mParameters.timeRatio ||
+      pCheckpoint->parameters.pitchRatio != mParameters.pitchRatio ||
+      pCheckpoint->parameters.preserveFormants !=
+         mParameters.preserveFormants ||
+      // The size might be overridden by experimental settings meanwhile
+      (pCheckpoint->state &&
+       pCheckpoint->fftSize !=
+          GetFftSize(mSampleRate, mParameters.preserveFormants)))
+      return false;
+   if (pCheckpoint->state)
+   {
+      mTimeAndPitch = CreateTimeAndPitch(
+         mSampleRate, mNumChannels, mParameters, mFormantShifter);
+      mTimeAndPitch->copyStateFrom(*pCheckpoint->state);
+   }
+   return true;
+}
+
 bool StaffPadTimeAndPitch::IllState() const
 {
    // It doesn't require samples, yet it doesn't have output samples available.
@@ -8,16 +8,27 @@ class TIME_AND_PITCH_API StaffPadTimeAndPitch final :
     public TimeAndPitchInterface
 {
 public:
+   /*!
+    * @param checkpoint if not null, the state is restored from it instead of
+    * primed with samples of the source
+    * @pre `checkpoint` was saved by a StaffPadTimeAndPitch with the same
+    * sample rate, number of channels and parameters, and the source is where
+    * that one's was then
+    */
    StaffPadTimeAndPitch(
       int sampleRate, size_t numChannels, TimeAndPitchSource&,
-      const Parameters&);
+      const Parameters&, const Checkpoint* checkpoint = nullptr);
    void GetSamples(float* const*, size_t) override;
    void OnCentShiftChange(int cents) override;
    void OnFormantPreservationChange(bool preserve) override;
+   std::unique_ptr<Checkpoint> SaveCheckpoint() const override;
 
 private:
+   struct StaffPadCheckpoint;
+
    bool IllState() const;
    void InitializeStretcher();
+   bool RestoreCheckpoint(const Checkpoint& checkpoint);
 
    const int mSampleRate;
    const std::unique_ptr<FormantShifterLoggerInterface> mFormantShifterLogger;
@@ -4,8 +4,16 @@
 
 TimeAndPitchSource::~TimeAndPitchSource() = default;
 
+TimeAndPitchInterface::Checkpoint::~Checkpoint() = default;
+
 TimeAndPitchInterface::~TimeAndPitchInterface() = default;
 
+auto TimeAndPitchInterface::SaveCheckpoint() const
+   -> std::unique_ptr<Checkpoint>
+{
+   return {};
+}
+
 bool TimeAndPitchInterface::IsPassThroughMode(double stretchRatio)
 {
    return std::fabs(stretchRatio - 1.) < 1e-6;
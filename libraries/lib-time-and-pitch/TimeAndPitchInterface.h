@@ -40,9 +40,25 @@ public:
       bool preserveFormants = false;
    };
 
+   //! Opaque copy of the processing state of a stretcher
+   class TIME_AND_PITCH_API Checkpoint
+   {
+   public:
+      virtual ~Checkpoint();
+      //! Approximate memory held, in bytes
+      virtual size_t MemorySize() const = 0;
+   };
+
    virtual void GetSamples(float* const*, size_t) = 0;
    virtual void OnCentShiftChange(int cents) = 0;
    virtual void OnFormantPreservationChange(bool preserve) = 0;
 
+   //! Save the state, so that another stretcher with the same parameters and a
+   //! source at the same position may continue from there without priming
+   /*!
+    Default implementation returns null, meaning it's not supported
+    */
+   virtual std::unique_ptr<Checkpoint> SaveCheckpoint() const;
+
    virtual ~TimeAndPitchInterface();
 };
@@ -17,6 +17,9 @@
 
 #include <catch2/catch.hpp>
 
+#include <chrono>
+#include <random>
+
 using namespace std::literals::string_literals;
 using namespace std::literals::chrono_literals;
 
@@ -135,3 +138,51 @@ TEST_CASE("StaffPadTimeAndPitch")
          requestedNumSamples); // This is just not supposed to hang.
    }
 }
+
+namespace
+{
+struct NoiseSource final : public TimeAndPitchSource
+{
+   void Pull(float* const* buffer, size_t numSamples) override
+   {
+      std::uniform_real_distribution<float> dis { -1.f, 1.f };
+      for (auto ch = 0u; ch < numChannels; ++ch)
+         for (auto i = 0u; i < numSamples; ++i)
+            buffer[ch][i] = dis(gen);
+   }
+   size_t numChannels = 1;
+   std::mt19937 gen { 0 };
+};
+} // namespace
+
+// Hidden: run with the "[benchmark]" tag to measure
+TEST_CASE("StaffPadTimeAndPitch throughput", "[.benchmark]")
+{
+   MockedPrefs mockedPrefs;
+   constexpr auto sampleRate = 44100;
+   constexpr auto numOutputFrames = size_t { 30 * sampleRate };
+   constexpr auto blockSize = size_t { 1024 };
+   const auto numChannels = GENERATE(1u, 2u);
+   const auto timeRatio = GENERATE(0.8, 1.25);
+
+   NoiseSource src;
+   src.numChannels = numChannels;
+   AudioContainer container(blockSize, numChannels);
+   TimeAndPitchInterface::Parameters params;
+   params.timeRatio = timeRatio;
+   StaffPadTimeAndPitch sut(sampleRate, numChannels, src, std::move(params));
+
+   const auto start = std::chrono::steady_clock::now();
+   for (size_t offset = 0; offset < numOutputFrames; offset += blockSize)
+      sut.GetSamples(container.Get(), blockSize);
+   const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+   const auto realTimeFactor =
+      numOutputFrames / (elapsed.count() * sampleRate);
+   WARN(
+      numChannels << " channel(s), time ratio " << timeRatio << ": "
+                  << realTimeFactor << " times real time, "
+                  << realTimeFactor * numChannels
+                  << " times real time per channel");
+}
@@ -0,0 +1,129 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  VectorOpsTest.cpp
+
+**********************************************************************/
+#include "StaffPad/SamplesFloat.h"
+#include "StaffPad/VectorOps.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <random>
+
+using namespace staffpad;
+
+namespace
+{
+// Like the number of bins of a spectrum, so that the kernels have a tail
+constexpr int32_t numBins = 1025;
+constexpr int32_t numChannels = 2;
+constexpr float pi = 3.14159265358979323846f;
+
+void FillRandom(SamplesComplex& spectrum, SamplesReal& phase, std::mt19937& gen)
+{
+   std::uniform_real_distribution<float> dis { -1.f, 1.f };
+   for (int32_t ch = 0; ch < numChannels; ++ch)
+   {
+      const auto pSpectrum = spectrum.getPtr(ch);
+      const auto pPhase = phase.getPtr(ch);
+      for (int32_t i = 0; i < numBins; ++i)
+      {
+         pSpectrum[i] = { dis(gen), dis(gen) };
+         // Accumulated phases stray far from -pi..pi
+         pPhase[i] = 20 * pi * dis(gen);
+      }
+   }
+}
+
+// Distance between angles, modulo 2 pi
+float AngleDistance(float a, float b)
+{
+   return std::abs(std::remainder(a - b, 2 * pi));
+}
+} // namespace
+
+TEST_CASE("VectorOps")
+{
+   std::mt19937 gen { 0 };
+   SamplesComplex spectrum;
+   spectrum.setSize(numChannels, numBins);
+   SamplesReal phase, accum, result;
+   phase.setSize(numChannels, numBins);
+   accum.setSize(numChannels, numBins);
+   result.setSize(numChannels, numBins);
+   FillRandom(spectrum, phase, gen);
+   FillRandom(spectrum, accum, gen);
+
+   SECTION("calcPhases agrees with std::arg")
+   {
+      vo::calcPhases(
+         spectrum.getPtrs(), result.getPtrs(), numChannels, numBins);
+      for (int32_t ch = 0; ch < numChannels; ++ch)
+         for (int32_t i = 0; i < numBins; ++i)
+            REQUIRE(
+               AngleDistance(
+                  result.getPtr(ch)[i], std::arg(spectrum.getPtr(ch)[i])) <
+               1e-5f);
+   }
+
+   SECTION("calcNorms agrees with std::norm")
+   {
+      vo::calcNorms(spectrum.getPtr(0), result.getPtr(0), numBins);
+      for (int32_t i = 0; i < numBins; ++i)
+         REQUIRE(
+            result.getPtr(0)[i] ==
+            Approx(std::norm(spectrum.getPtr(0)[i])).epsilon(1e-5));
+   }
+
+   SECTION("rotate agrees with multiplication by std::polar")
+   {
+      SamplesComplex expected;
+      expected.setSize(1, numBins);
+      expected.assignSamples(0, spectrum.getPtr(0));
+      for (int32_t i = 0; i < numBins; ++i)
+      {
+         const auto theta =
+            std::remainder(accum.getPtr(0)[i] - phase.getPtr(0)[i], 2 * pi);
+         expected.getPtr(0)[i] *= std::polar(1.f, theta);
+      }
+      vo::rotate(
+         phase.getPtr(0), accum.getPtr(0), spectrum.getPtr(0), numBins);
+      for (int32_t i = 0; i < numBins; ++i)
+         REQUIRE(
+            std::abs(spectrum.getPtr(0)[i] - expected.getPtr(0)[i]) < 1e-4f);
+   }
+
+   SECTION("unwrapAndRotate does as wrapping, then rotate")
+   {
+      SamplesComplex expected;
+      expected.setSize(numChannels, numBins);
+      expected.assignSamples(spectrum);
+      SamplesReal wrapped;
+      wrapped.setSize(numChannels, numBins);
+      for (int32_t ch = 0; ch < numChannels; ++ch)
+         for (int32_t i = 0; i < numBins; ++i)
+         {
+            const auto a = std::remainder(accum.getPtr(ch)[i], 2 * pi);
+            wrapped.getPtr(ch)[i] = a;
+            expected.getPtr(ch)[i] *=
+               std::polar(1.f, std::remainder(a - phase.getPtr(ch)[i], 2 * pi));
+         }
+      vo::unwrapAndRotate(
+         phase.getPtrs(), accum.getPtrs(), spectrum.getPtrs(), numChannels,
+         numBins);
+      for (int32_t ch = 0; ch < numChannels; ++ch)
+         for (int32_t i = 0; i < numBins; ++i)
+         {
+            const auto a = accum.getPtr(ch)[i];
+            REQUIRE(std::abs(a) <= pi + 1e-4f);
+            REQUIRE(AngleDistance(a, wrapped.getPtr(ch)[i]) < 1e-4f);
+            REQUIRE(
+               std::abs(spectrum.getPtr(ch)[i] - expected.getPtr(ch)[i]) <
+               1e-4f);
+         }
+   }
+}
@@ -0,0 +1,513 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file Telemetry.cpp
+
+**********************************************************************/
+#include "Telemetry.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <tuple>
+
+namespace Telemetry {
+namespace {
+
+size_t BucketOf(uint64_t value)
+{
+   size_t bucket = 0;
+   for (; value; value >>= 1)
+      ++bucket;
+   return std::min(bucket, NBuckets - 1);
+}
+
+enum class Phase : uint8_t {
+   Complete, //!< A span of time
+   Counter, //!< A value at a time
+};
+
+//! Events of one thread; written only by that thread, read by any
+class ThreadBuffer final
+{
+public:
+   //! Most recent events kept, about a minute of callbacks of 128 frames
+   static constexpr size_t Capacity = 1 << 15;
+
+   struct Event {
+      uint32_t nameId;
+      Phase phase;
+      int64_t time;
+      int64_t value;
+   };
+
+   explicit ThreadBuffer(uint32_t tid)
+      : mSlots{ std::make_unique<Slot[]>(Capacity) }
+      , mTid{ tid }
+   {}
+
+   uint32_t GetTid() const { return mTid; }
+
+   //! @return whether the calling thread may now write to this buffer
+   bool TryClaim() noexcept
+   {
+      bool expected = false;
+      if (!mClaimed.compare_exchange_strong(expected, true))
+         return false;
+      // Earlier events, of a thread that exited, remain until overwritten
+      mName.store(nullptr);
+      return true;
+   }
+   //! Let another thread reuse the buffer
+   void Release() noexcept { mClaimed.store(false); }
+   bool IsClaimed() const noexcept { return mClaimed.load(); }
+
+   const char *GetName() const { return mName.load(); }
+   void SetName(const char *name) noexcept
+   {
+      const char *expected = nullptr;
+      mName.compare_exchange_strong(expected, name);
+   }
+
+   void Push(uint32_t nameId, Phase phase, int64_t time, int64_t value)
+      noexcept
+   {
+      const auto written = mWritten.load(std::memory_order_relaxed);
+      // Let readers know that a slot may be changing
+      mStarted.store(written + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      auto &slot = mSlots[written % Capacity];
+      slot.header.store(nameId | (uint64_t(phase) << 32),
+         std::memory_order_relaxed);
+      slot.time.store(time, std::memory_order_relaxed);
+      slot.value.store(value, std::memory_order_relaxed);
+      mWritten.store(written + 1, std::memory_order_release);
+   }
+
+   //! Append the events still held, oldest first
+   void Read(std::vector<Event> &events) const
+   {
+      const auto written = mWritten.load(std::memory_order_acquire);
+      auto first = std::max(mFloor.load(),
+         written > Capacity ? written - Capacity : 0);
+      const auto start = events.size();
+      for (auto ii = first; ii < written; ++ii) {
+         const auto &slot = mSlots[ii % Capacity];
+         const auto header = slot.header.load(std::memory_order_relaxed);
+         events.push_back({ static_cast<uint32_t>(header),
+            static_cast<Phase>(header >> 32),
+            slot.time.load(std::memory_order_relaxed),
+            slot.value.load(std::memory_order_relaxed) });
+      }
+      // Discard events that the writer may have overwritten meanwhile
+      std::atomic_thread_fence(std::memory_order_acquire);
+      const auto after = mStarted.load(std::memory_order_relaxed);
+      if (after > Capacity && after - Capacity > first)
+         events.erase(events.begin() + start, events.begin() + start +
+            std::min<size_t>(after - Capacity - first, events.size() - start));
+   }
+
+   //! Forget the events so far
+   void Clear() noexcept
+   {
+      mFloor.store(mWritten.load());
+   }
+
+private:
+   struct Slot {
+      std::atomic<uint64_t> header{};
+      std::atomic<int64_t> time{};
+      std::atomic<int64_t> value{};
+   };
+
+   const std::unique_ptr<Slot[]> mSlots;
+   //! Count of events completely written
+   std::atomic<uint64_t> mWritten{ 0 };
+   //! Count of events begun
+   std::atomic<uint64_t> mStarted{ 0 };
+   std::atomic<uint64_t> mFloor{ 0 };
+   std::atomic<const char *> mName{ nullptr };
+   std::atomic<bool> mClaimed{ false };
+   const uint32_t mTid;
+};
+
+struct Name {
+   Kind kind;
+   std::string category;
+   std::string name;
+};
+
+struct Registry {
+   std::mutex mutex;
+   //! Never shrinks, so that trace events outlive their series
+   std::vector<Name> names;
+   std::map<std::tuple<Kind, std::string, std::string>, uint32_t> ids;
+   struct Entry {
+      const Series *pSeries;
+      Histogram *pHistogram;
+      uint32_t nameId;
+   };
+   std::vector<Entry> series;
+   std::vector<std::shared_ptr<ThreadBuffer>> threads;
+
+   //! Buffers for trace events are never freed, and at most so many are made
+   static constexpr size_t MaxBuffers = 64;
+   //! Unclaimed buffers that enabling tracing makes sure of
+   static constexpr size_t SpareBuffers = 4;
+   //! The first nBuffers hold the same as threads; read without the mutex
+   std::array<ThreadBuffer *, MaxBuffers> buffers{};
+   std::atomic<size_t> nBuffers{ 0 };
+
+   //! Allocate buffers, so that threads starting to trace need not
+   void Reserve()
+   {
+      std::lock_guard<std::mutex> lock{ mutex };
+      size_t nSpare = std::count_if(threads.begin(), threads.end(),
+         [](const auto &pBuffer){ return !pBuffer->IsClaimed(); });
+      for (; nSpare < SpareBuffers && threads.size() < MaxBuffers; ++nSpare) {
+         const auto tid = static_cast<uint32_t>(threads.size() + 1);
+         threads.push_back(std::make_shared<ThreadBuffer>(tid));
+         buffers[threads.size() - 1] = threads.back().get();
+         nBuffers.store(threads.size(), std::memory_order_release);
+      }
+   }
+
+   //! Lock-free, and without allocation
+   /*! @return null if all buffers are in use */
+   ThreadBuffer *Claim() noexcept
+   {
+      const auto n = nBuffers.load(std::memory_order_acquire);
+      for (size_t ii = 0; ii < n; ++ii)
+         if (buffers[ii]->TryClaim())
+            return buffers[ii];
+      return nullptr;
+   }
+
+   uint32_t Add(const Series *pSeries, Histogram &histogram,
+      Kind kind, std::string category, std::string name)
+   {
+      std::lock_guard<std::mutex> lock{ mutex };
+      auto key = std::make_tuple(kind, category, name);
+      auto found = ids.find(key);
+      if (found == ids.end()) {
+         const auto id = static_cast<uint32_t>(names.size());
+         names.push_back({ kind, std::move(category), std::move(name) });
+         found = ids.emplace(std::move(key), id).first;
+      }
+      series.push_back({ pSeries, &histogram, found->second });
+      return found->second;
+   }
+
+   void Remove(const Series *pSeries)
+   {
+      std::lock_guard<std::mutex> lock{ mutex };
+      series.erase(std::remove_if(series.begin(), series.end(),
+         [&](const Entry &entry){ return entry.pSeries == pSeries; }),
+         series.end());
+   }
+};
+
+Registry &GetRegistry()
+{
+   static Registry registry;
+   return registry;
+}
+
+std::atomic<bool> sTracing{ false };
+
+//! Gives the buffer of the thread back for reuse when the thread exits, as
+//! when each audio stream has a new callback thread
+struct ThreadBufferHolder {
+   ~ThreadBufferHolder() { if (pBuffer) pBuffer->Release(); }
+   ThreadBuffer *pBuffer = nullptr;
+};
+thread_local ThreadBufferHolder tBuffer;
+
+//! May be called in an audio callback:  neither locks nor allocates a buffer
+/*! @return null if all buffers that EnableTracing() made are in use */
+ThreadBuffer *GetThreadBuffer() noexcept
+{
+   auto &pBuffer = tBuffer.pBuffer;
+   if (!pBuffer)
+      pBuffer = GetRegistry().Claim();
+   return pBuffer;
+}
+
+int64_t Nanoseconds(Clock::time_point time)
+{
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      time.time_since_epoch()).count();
+}
+
+void WriteJSONString(std::ostream &out, const std::string &string)
+{
+   out << '"';
+   for (const unsigned char c : string) {
+      if (c == '"' || c == '\\')
+         out << '\\' << c;
+      else if (c < 0x20) {
+         char escape[8];
+         snprintf(escape, sizeof(escape), "\\u%04x", c);
+         out << escape;
+      }
+      else
+         out << c;
+   }
+   out << '"';
+}
+
+void WriteMicroseconds(std::ostream &out, int64_t nanoseconds)
+{
+   char buffer[32];
+   snprintf(buffer, sizeof(buffer), "%.3f", nanoseconds / 1000.0);
+   out << buffer;
+}
+}
+
+double Histogram::Summary::Mean() const
+{
+   return count ? static_cast<double>(total) / count : 0.0;
+}
+
+uint64_t Histogram::Summary::Percentile(double fraction) const
+{
+   const auto target = static_cast<uint64_t>(std::ceil(
+      std::clamp(fraction, 0.0, 1.0) * count));
+   uint64_t sum = 0;
+   for (size_t bucket = 0; bucket < NBuckets; ++bucket) {
+      sum += buckets[bucket];
+      if (sum >= target && sum > 0)
+         return bucket == 0 ? 0
+            : std::min(max, (uint64_t{ 1 } << bucket) - 1);
+   }
+   return max;
+}
+
+Histogram::Histogram()
+{
+   Reset();
+}
+
+void Histogram::Add(uint64_t value) noexcept
+{
+   mBuckets[BucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+   mCount.fetch_add(1, std::memory_order_relaxed);
+   mTotal.fetch_add(value, std::memory_order_relaxed);
+   mLast.store(value, std::memory_order_relaxed);
+   auto min = mMin.load(std::memory_order_relaxed);
+   while (value < min &&
+      !mMin.compare_exchange_weak(min, value, std::memory_order_relaxed))
+      ;
+   auto max = mMax.load(std::memory_order_relaxed);
+   while (value > max &&
+      !mMax.compare_exchange_weak(max, value, std::memory_order_relaxed))
+      ;
+}
+
+void Histogram::Reset() noexcept
+{
+   for (auto &bucket : mBuckets)
+      bucket.store(0, std::memory_order_relaxed);
+   mCount.store(0, std::memory_order_relaxed);
+   mTotal.store(0, std::memory_order_relaxed);
+   mMin.store(std::numeric_limits<uint64_t>::max(),
+      std::memory_order_relaxed);
+   mMax.store(0, std::memory_order_relaxed);
+   mLast.store(0, std::memory_order_relaxed);
+}
+
+uint64_t Histogram::GetTotal() const noexcept
+{
+   return mTotal.load(std::memory_order_relaxed);
+}
+
+auto Histogram::Get() const noexcept -> Summary
+{
+   Summary summary;
+   for (size_t bucket = 0; bucket < NBuckets; ++bucket)
+      summary.buckets[bucket] =
+         mBuckets[bucket].load(std::memory_order_relaxed);
+   summary.count = mCount.load(std::memory_order_relaxed);
+   summary.total = mTotal.load(std::memory_order_relaxed);
+   summary.min = summary.count ? mMin.load(std::memory_order_relaxed) : 0;
+   summary.max = mMax.load(std::memory_order_relaxed);
+   summary.last = mLast.load(std::memory_order_relaxed);
+   return summary;
+}
+
+Series::Series(Kind kind, std::string category, std::string name)
+   : mKind{ kind }
+   , mNameId{ GetRegistry().Add(
+      this, mHistogram, kind, move(category), move(name)) }
+{
+}
+
+Series::~Series()
+{
+   GetRegistry().Remove(this);
+}
+
+void Series::Record(uint64_t value) noexcept
+{
+   mHistogram.Add(value);
+}
+
+void Series::Trace(Clock::time_point time, int64_t value) noexcept
+{
+   if (!sTracing.load(std::memory_order_relaxed))
+      return;
+   if (const auto pBuffer = GetThreadBuffer())
+      pBuffer->Push(mNameId,
+         mKind == Kind::Timer ? Phase::Complete : Phase::Counter,
+         Nanoseconds(time), value);
+}
+
+Timer::Timer(std::string category, std::string name)
+   : Series{ Kind::Timer, move(category), move(name) }
+{
+}
+
+Timer::~Timer() = default;
+
+void Timer::Record(Clock::time_point start, Clock::time_point end) noexcept
+{
+   const auto duration =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+         .count();
+   Series::Record(std::max<int64_t>(0, duration));
+   Trace(start, duration);
+}
+
+Gauge::Gauge(std::string category, std::string name)
+   : Series{ Kind::Gauge, move(category), move(name) }
+{
+}
+
+Gauge::~Gauge() = default;
+
+void Gauge::Record(uint64_t value) noexcept
+{
+   Series::Record(value);
+   if (IsTracing())
+      Trace(Clock::now(), static_cast<int64_t>(value));
+}
+
+Counter::Counter(std::string category, std::string name)
+   : Series{ Kind::Counter, move(category), move(name) }
+{
+}
+
+Counter::~Counter() = default;
+
+void Counter::Add(uint64_t amount) noexcept
+{
+   Series::Record(amount);
+   if (IsTracing())
+      // Show the running total
+      Trace(Clock::now(), static_cast<int64_t>(GetHistogram().GetTotal()));
+}
+
+std::vector<SeriesSnapshot> Snapshot()
+{
+   auto &registry = GetRegistry();
+   std::lock_guard<std::mutex> lock{ registry.mutex };
+   std::vector<SeriesSnapshot> result;
+   result.reserve(registry.series.size());
+   for (const auto &entry : registry.series) {
+      const auto &name = registry.names[entry.nameId];
+      result.push_back({ name.kind, name.category, name.name,
+         entry.pHistogram->Get() });
+   }
+   return result;
+}
+
+void Reset()
+{
+   auto &registry = GetRegistry();
+   std::lock_guard<std::mutex> lock{ registry.mutex };
+   for (const auto &entry : registry.series)
+      entry.pHistogram->Reset();
+   for (const auto &pBuffer : registry.threads)
+      pBuffer->Clear();
+}
+
+void EnableTracing(bool enable)
+{
+   if (enable)
+      GetRegistry().Reserve();
+   sTracing.store(enable, std::memory_order_relaxed);
+}
+
+bool IsTracing() noexcept
+{
+   return sTracing.load(std::memory_order_relaxed);
+}
+
+void SetThreadName(const char *name) noexcept
+{
+   if (!IsTracing())
+      return;
+   if (const auto pBuffer = GetThreadBuffer())
+      pBuffer->SetName(name);
+}
+
+void WriteChromeTrace(std::ostream &out)
+{
+   std::vector<Name> names;
+   std::vector<std::shared_ptr<ThreadBuffer>> threads;
+   {
+      auto &registry = GetRegistry();
+      std::lock_guard<std::mutex> lock{ registry.mutex };
+      names = registry.names;
+      threads = registry.threads;
+   }
+
+   std::vector<std::vector<ThreadBuffer::Event>> events(threads.size());
+   auto origin = std::numeric_limits<int64_t>::max();
+   for (size_t ii = 0; ii < threads.size(); ++ii) {
+      threads[ii]->Read(events[ii]);
+      for (const auto &event : events[ii])
+         origin = std::min(origin, event.time);
+   }
+
+   out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+   const char *separator = "\n";
+   for (size_t ii = 0; ii < threads.size(); ++ii) {
+      const auto tid = threads[ii]->GetTid();
+      if (const auto name = threads[ii]->GetName()) {
+         out << separator
+            << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << tid
+            << R"(,"args":{"name":)";
+         WriteJSONString(out, name);
+         out << "}}";
+         separator = ",\n";
+      }
+      for (const auto &event : events[ii]) {
+         const auto &name = names[event.nameId];
+         out << separator << "{\"name\":";
+         WriteJSONString(out, name.name);
+         out << ",\"cat\":";
+         WriteJSONString(out, name.category);
+         out << ",\"pid\":1,\"tid\":" << tid << ",\"ts\":";
+         WriteMicroseconds(out, event.time - origin);
+         if (event.phase == Phase::Complete) {
+            out << ",\"ph\":\"X\",\"dur\":";
+            WriteMicroseconds(out, event.value);
+            out << "}";
+         }
+         else
+            out << ",\"ph\":\"C\",\"args\":{\"value\":" << event.value << "}}";
+         separator = ",\n";
+      }
+   }
+   out << "\n]}\n";
+}
+}
@@ -0,0 +1,176 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file Telemetry.h
+
+  @brief Always-on timings, levels and counts for real-time code, with
+  optional tracing to Chrome's trace event format
+
+**********************************************************************/
+#ifndef __AUDACITY_TELEMETRY__
+#define __AUDACITY_TELEMETRY__
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/*!
+ Recording into a series never locks or allocates:  histograms are updated
+ with atomic operations from any thread.  Only constructing and destroying a
+ series, taking a snapshot, and enabling tracing lock a mutex.
+
+ While tracing is enabled, each thread also appends events to a ring buffer of
+ its own, which keeps the most recent events for WriteChromeTrace().  Enabling
+ tracing allocates spare buffers, which threads claim without locking at their
+ first trace event, and give back when they exit.  A thread finding no spare
+ buffer records no trace events.
+ */
+namespace Telemetry {
+
+using Clock = std::chrono::steady_clock;
+
+enum class Kind : unsigned char {
+   Timer, //!< Durations, in nanoseconds
+   Gauge, //!< Levels, such as the fill of a buffer
+   Counter, //!< Occurrences, such as underruns
+};
+
+//! Buckets of values by powers of two:  bucket 0 holds 0, and bucket n > 0
+//! holds values from 2^(n-1) up to 2^n - 1
+constexpr size_t NBuckets = 40;
+
+//! Lock-free accumulation of values; any thread may add or read
+class UTILITY_API Histogram final
+{
+public:
+   struct Summary {
+      uint64_t count{};
+      uint64_t total{};
+      uint64_t min{};
+      uint64_t max{};
+      uint64_t last{};
+      std::array<uint64_t, NBuckets> buckets{};
+
+      double Mean() const;
+      //! Upper bound of the bucket holding the given fraction of the values
+      uint64_t Percentile(double fraction) const;
+   };
+
+   Histogram();
+
+   void Add(uint64_t value) noexcept;
+   void Reset() noexcept;
+   Summary Get() const noexcept;
+   uint64_t GetTotal() const noexcept;
+
+private:
+   std::atomic<uint64_t> mBuckets[NBuckets];
+   std::atomic<uint64_t> mCount;
+   std::atomic<uint64_t> mTotal;
+   std::atomic<uint64_t> mMin;
+   std::atomic<uint64_t> mMax;
+   std::atomic<uint64_t> mLast;
+};
+
+//! A named histogram, listed by Snapshot() while it exists
+class UTILITY_API Series /* not final */
+{
+public:
+   Series(Kind kind, std::string category, std::string name);
+   Series(const Series &) = delete;
+   Series &operator=(const Series &) = delete;
+   virtual ~Series();
+
+   Kind GetKind() const { return mKind; }
+   const Histogram &GetHistogram() const { return mHistogram; }
+
+protected:
+   void Record(uint64_t value) noexcept;
+   //! Adds a trace event if tracing is enabled
+   void Trace(Clock::time_point time, int64_t value) noexcept;
+
+private:
+   Histogram mHistogram;
+   const Kind mKind;
+   //! Index into the table of names, shared by series of the same name
+   const uint32_t mNameId;
+};
+
+//! Durations of a section of code
+class UTILITY_API Timer final : public Series
+{
+public:
+   Timer(std::string category, std::string name);
+   ~Timer() override;
+   void Record(Clock::time_point start, Clock::time_point end) noexcept;
+};
+
+//! Measures the lifetime of a scope into a Timer
+class Scope final
+{
+public:
+   explicit Scope(Timer &timer) noexcept
+      : mTimer{ timer }
+      , mStart{ Clock::now() }
+   {}
+   ~Scope() { mTimer.Record(mStart, Clock::now()); }
+   Scope(const Scope &) = delete;
+   Scope &operator=(const Scope &) = delete;
+
+private:
+   Timer &mTimer;
+   const Clock::time_point mStart;
+};
+
+//! Sampled levels
+class UTILITY_API Gauge final : public Series
+{
+public:
+   Gauge(std::string category, std::string name);
+   ~Gauge() override;
+   void Record(uint64_t value) noexcept;
+};
+
+//! Occurrences; the histogram holds the amounts added at once
+class UTILITY_API Counter final : public Series
+{
+public:
+   Counter(std::string category, std::string name);
+   ~Counter() override;
+   void Add(uint64_t amount = 1) noexcept;
+};
+
+struct SeriesSnapshot {
+   Kind kind;
+   std::string category;
+   std::string name;
+   Histogram::Summary summary;
+};
+
+//! Summaries of all existing series, in order of construction
+UTILITY_API std::vector<SeriesSnapshot> Snapshot();
+
+//! Reset all histograms and forget all trace events
+UTILITY_API void Reset();
+
+//! Start or stop recording trace events
+/*! Histograms are always recorded */
+UTILITY_API void EnableTracing(bool enable);
+UTILITY_API bool IsTracing() noexcept;
+
+//! Name the calling thread in traces, if tracing is enabled
+/*! @param name must have static lifetime */
+UTILITY_API void SetThreadName(const char *name) noexcept;
+
+//! Write the recorded trace events as JSON, in Chrome's trace event format,
+//! which chrome://tracing and Perfetto can display
+UTILITY_API void WriteChromeTrace(std::ostream &out);
+}
+
+#endif
@@ -0,0 +1,163 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  TelemetryTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+#include "Telemetry.h"
+
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
+using namespace Telemetry;
+
+namespace {
+const SeriesSnapshot *Find(
+   const std::vector<SeriesSnapshot> &snapshot, const std::string &name)
+{
+   const auto found = std::find_if(snapshot.begin(), snapshot.end(),
+      [&](const SeriesSnapshot &series){ return series.name == name; });
+   return found == snapshot.end() ? nullptr : &*found;
+}
+}
+
+TEST_CASE("Telemetry histograms", "[Telemetry]")
+{
+   Histogram histogram;
+   auto summary = histogram.Get();
+   REQUIRE(summary.count == 0);
+   REQUIRE(summary.min == 0);
+   REQUIRE(summary.Mean() == 0.0);
+
+   for (uint64_t value = 1; value <= 100; ++value)
+      histogram.Add(value);
+   summary = histogram.Get();
+   REQUIRE(summary.count == 100);
+   REQUIRE(summary.total == 5050);
+   REQUIRE(summary.min == 1);
+   REQUIRE(summary.max == 100);
+   REQUIRE(summary.last == 100);
+   REQUIRE(summary.Mean() == 50.5);
+
+   // Percentiles are upper bounds of power-of-two buckets
+   REQUIRE(summary.Percentile(0.0) == 1);
+   REQUIRE(summary.Percentile(0.5) == 63);
+   REQUIRE(summary.Percentile(0.99) == 100);
+   REQUIRE(summary.Percentile(1.0) == 100);
+
+   histogram.Add(0);
+   REQUIRE(histogram.Get().buckets[0] == 1);
+
+   histogram.Reset();
+   REQUIRE(histogram.Get().count == 0);
+   REQUIRE(histogram.Get().max == 0);
+}
+
+TEST_CASE("Telemetry series", "[Telemetry]")
+{
+   Reset();
+   {
+      Timer timer{ "Test", "timer" };
+      Gauge gauge{ "Test", "gauge" };
+      Counter counter{ "Test", "counter" };
+
+      timer.Record(Clock::time_point{}, Clock::time_point{} +
+         std::chrono::microseconds(3));
+      { Scope scope{ timer }; }
+      gauge.Record(7);
+      gauge.Record(9);
+      counter.Add();
+      counter.Add(4);
+
+      const auto snapshot = Snapshot();
+      const auto pTimer = Find(snapshot, "timer");
+      REQUIRE(pTimer);
+      REQUIRE(pTimer->kind == Kind::Timer);
+      REQUIRE(pTimer->category == "Test");
+      REQUIRE(pTimer->summary.count == 2);
+      REQUIRE(pTimer->summary.max >= 3000);
+
+      const auto pGauge = Find(snapshot, "gauge");
+      REQUIRE(pGauge);
+      REQUIRE(pGauge->kind == Kind::Gauge);
+      REQUIRE(pGauge->summary.last == 9);
+      REQUIRE(pGauge->summary.min == 7);
+
+      const auto pCounter = Find(snapshot, "counter");
+      REQUIRE(pCounter);
+      REQUIRE(pCounter->kind == Kind::Counter);
+      REQUIRE(pCounter->summary.total == 5);
+
+      Reset();
+      REQUIRE(Find(Snapshot(), "counter")->summary.total == 0);
+   }
+   // Destroyed series are no longer listed
+   REQUIRE(!Find(Snapshot(), "timer"));
+}
+
+TEST_CASE("Telemetry Chrome trace", "[Telemetry]")
+{
+   Reset();
+   Timer timer{ "Test", "traced \"timer\"" };
+   Counter counter{ "Test", "traced counter" };
+
+   // Nothing is traced until enabled
+   { Scope scope{ timer }; }
+   {
+      std::ostringstream out;
+      WriteChromeTrace(out);
+      REQUIRE(out.str().find("traced") == std::string::npos);
+   }
+
+   EnableTracing(true);
+   REQUIRE(IsTracing());
+   std::thread{ [&]{
+      SetThreadName("Worker");
+      { Scope scope{ timer }; }
+      counter.Add(2);
+   } }.join();
+   EnableTracing(false);
+   // Nor after disabled
+   counter.Add(3);
+
+   std::ostringstream out;
+   WriteChromeTrace(out);
+   const auto json = out.str();
+   REQUIRE(json.find(R"("name":"thread_name")") != std::string::npos);
+   REQUIRE(json.find(R"("name":"Worker")") != std::string::npos);
+   REQUIRE(json.find(R"("name":"traced \"timer\"","cat":"Test")")
+      != std::string::npos);
+   REQUIRE(json.find(R"("ph":"X")") != std::string::npos);
+   REQUIRE(json.find(R"("ph":"C","args":{"value":2})") != std::string::npos);
+   REQUIRE(json.find(R"({"value":5})") == std::string::npos);
+
+   Reset();
+   std::ostringstream empty;
+   WriteChromeTrace(empty);
+   REQUIRE(empty.str().find("traced") == std::string::npos);
+}
+
+TEST_CASE("Telemetry reuses buffers of exited threads", "[Telemetry]")
+{
+   Reset();
+   Timer timer{ "Test", "reused" };
+   EnableTracing(true);
+   // More threads, one after another, than there are buffers
+   for (int ii = 0; ii < 100; ++ii)
+      std::thread{ [&]{ Scope scope{ timer }; } }.join();
+   EnableTracing(false);
+
+   std::ostringstream out;
+   WriteChromeTrace(out);
+   const auto json = out.str();
+   size_t count = 0;
+   for (auto pos = json.find(R"("name":"reused")"); pos != std::string::npos;
+      pos = json.find(R"("name":"reused")", pos + 1))
+      ++count;
+   REQUIRE(count == 100);
+   Reset();
+}
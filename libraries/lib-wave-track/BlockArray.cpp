@@ -0,0 +1,353 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file BlockArray.cpp
+
+**********************************************************************/
+#include "BlockArray.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "SampleBlock.h"
+
+//! An AVL tree node, holding one block between two subtrees
+struct BlockArray::Node {
+   Node(NodePtr left_, const SampleBlockPtr &sb_, NodePtr right_)
+      : left{ move(left_) }, right{ move(right_) }, sb{ sb_ }
+      , length{ sb ? sb->GetSampleCount() : 0 }
+   {
+      const auto pLeft = left.get(), pRight = right.get();
+      count = 1;
+      samples = length;
+      maxLength = length;
+      hasNull = !sb;
+      height = 1;
+      for (auto pChild : { pLeft, pRight })
+         if (pChild) {
+            count += pChild->count;
+            samples += pChild->samples;
+            maxLength = std::max(maxLength, pChild->maxLength);
+            hasNull = hasNull || pChild->hasNull;
+            height = std::max(height, pChild->height + 1);
+         }
+   }
+
+   const NodePtr left, right;
+   const SampleBlockPtr sb;
+   //! Of sb
+   const size_t length;
+
+   // Totals for the subtree
+   size_t count;
+   sampleCount samples;
+   size_t maxLength;
+   bool hasNull;
+   unsigned height;
+};
+
+//! Persistent operations on trees, which make new nodes instead of changing
+struct BlockArray::Tree {
+   static size_t Count(const NodePtr &p) { return p ? p->count : 0; }
+   static sampleCount Samples(const NodePtr &p)
+   { return p ? p->samples : sampleCount{ 0 }; }
+   static unsigned Height(const NodePtr &p) { return p ? p->height : 0; }
+
+   static NodePtr Make(
+      const NodePtr &left, const SampleBlockPtr &sb, const NodePtr &right)
+   {
+      return std::make_shared<const Node>(left, sb, right);
+   }
+
+   static NodePtr RotateLeft(const Node &node)
+   {
+      const auto &right = *node.right;
+      return Make(Make(node.left, node.sb, right.left), right.sb, right.right);
+   }
+
+   static NodePtr RotateRight(const Node &node)
+   {
+      const auto &left = *node.left;
+      return Make(left.left, left.sb, Make(left.right, node.sb, node.right));
+   }
+
+   //! @pre `Height(left) > Height(right) + 1`
+   static NodePtr JoinRight(
+      const NodePtr &left, const SampleBlockPtr &sb, const NodePtr &right)
+   {
+      const auto &outer = left->left, &inner = left->right;
+      if (Height(inner) <= Height(right) + 1) {
+         auto middle = Make(inner, sb, right);
+         if (Height(middle) <= Height(outer) + 1)
+            return Make(outer, left->sb, middle);
+         return RotateLeft(*Make(outer, left->sb, RotateRight(*middle)));
+      }
+      auto middle = JoinRight(inner, sb, right);
+      auto result = Make(outer, left->sb, middle);
+      if (Height(middle) <= Height(outer) + 1)
+         return result;
+      return RotateLeft(*result);
+   }
+
+   //! @pre `Height(right) > Height(left) + 1`
+   static NodePtr JoinLeft(
+      const NodePtr &left, const SampleBlockPtr &sb, const NodePtr &right)
+   {
+      const auto &outer = right->right, &inner = right->left;
+      if (Height(inner) <= Height(left) + 1) {
+         auto middle = Make(left, sb, inner);
+         if (Height(middle) <= Height(outer) + 1)
+            return Make(middle, right->sb, outer);
+         return RotateRight(*Make(RotateLeft(*middle), right->sb, outer));
+      }
+      auto middle = JoinLeft(left, sb, inner);
+      auto result = Make(middle, right->sb, outer);
+      if (Height(middle) <= Height(outer) + 1)
+         return result;
+      return RotateRight(*result);
+   }
+
+   //! Balanced tree with the blocks of `left`, then `sb`, then `right`
+   /*! Time is proportional to the difference of heights */
+   static NodePtr Join(
+      const NodePtr &left, const SampleBlockPtr &sb, const NodePtr &right)
+   {
+      if (Height(left) > Height(right) + 1)
+         return JoinRight(left, sb, right);
+      if (Height(right) > Height(left) + 1)
+         return JoinLeft(left, sb, right);
+      return Make(left, sb, right);
+   }
+
+   //! @return the first `index` blocks, and the rest
+   static std::pair<NodePtr, NodePtr> Split(const NodePtr &p, size_t index)
+   {
+      if (!p)
+         return {};
+      const auto nLeft = Count(p->left);
+      if (index <= nLeft) {
+         auto [left, right] = Split(p->left, index);
+         return { move(left), Join(right, p->sb, p->right) };
+      }
+      auto [left, right] = Split(p->right, index - nLeft - 1);
+      return { Join(p->left, p->sb, left), move(right) };
+   }
+
+   //! @pre `p`
+   //! @return all blocks but the last, and the last
+   static std::pair<NodePtr, SampleBlockPtr> SplitLast(const NodePtr &p)
+   {
+      if (!p->right)
+         return { p->left, p->sb };
+      auto [rest, last] = SplitLast(p->right);
+      return { Join(p->left, p->sb, rest), move(last) };
+   }
+
+   static NodePtr Concatenate(const NodePtr &left, const NodePtr &right)
+   {
+      if (!left)
+         return right;
+      if (!right)
+         return left;
+      auto [rest, last] = SplitLast(left);
+      return Join(rest, last, right);
+   }
+
+   //! @pre `index < Count(p)`
+   static NodePtr Replace(
+      const NodePtr &p, size_t index, const SampleBlockPtr &sb)
+   {
+      const auto nLeft = Count(p->left);
+      if (index < nLeft)
+         return Make(Replace(p->left, index, sb), p->sb, p->right);
+      if (index > nLeft)
+         return Make(p->left, p->sb, Replace(p->right, index - nLeft - 1, sb));
+      return Make(p->left, sb, p->right);
+   }
+
+   //! Visit the nodes and right subtrees that hold blocks at `first` or later
+   template<typename Visitor>
+   static void VisitFrom(const Node *pNode, size_t first, const Visitor &visit)
+   {
+      while (pNode) {
+         const auto nLeft = Count(pNode->left);
+         if (first <= nLeft) {
+            visit(*pNode, pNode->right.get());
+            pNode = pNode->left.get();
+         }
+         else {
+            first -= nLeft + 1;
+            pNode = pNode->right.get();
+         }
+      }
+   }
+};
+
+BlockArray::const_iterator::const_iterator() = default;
+
+void BlockArray::const_iterator::Descend(const Node *pNode)
+{
+   for (; pNode; pNode = pNode->left.get())
+      mStack.push_back(pNode);
+   if (!mStack.empty())
+      mBlock.sb = mStack.back()->sb;
+}
+
+auto BlockArray::const_iterator::operator ++() -> const_iterator &
+{
+   assert(!mStack.empty());
+   const auto pNode = mStack.back();
+   mStack.pop_back();
+   mBlock.start += pNode->length;
+   ++mIndex;
+   mBlock.sb.reset();
+   if (pNode->right)
+      Descend(pNode->right.get());
+   else if (!mStack.empty())
+      mBlock.sb = mStack.back()->sb;
+   return *this;
+}
+
+BlockArray::BlockArray() = default;
+BlockArray::BlockArray(const BlockArray &) = default;
+BlockArray::BlockArray(BlockArray &&) noexcept = default;
+BlockArray &BlockArray::operator =(const BlockArray &) = default;
+BlockArray &BlockArray::operator =(BlockArray &&) noexcept = default;
+BlockArray::~BlockArray() = default;
+
+BlockArray::BlockArray(NodePtr root)
+   : mRoot{ move(root) }
+{
+}
+
+size_t BlockArray::size() const
+{
+   return Tree::Count(mRoot);
+}
+
+sampleCount BlockArray::GetNumSamples() const
+{
+   return Tree::Samples(mRoot);
+}
+
+SeqBlock BlockArray::operator [](size_t index) const
+{
+   assert(index < size());
+   sampleCount start = 0;
+   auto pNode = mRoot.get();
+   while (pNode) {
+      const auto nLeft = Tree::Count(pNode->left);
+      if (index < nLeft)
+         pNode = pNode->left.get();
+      else {
+         start += Tree::Samples(pNode->left);
+         if (index == nLeft)
+            return { pNode->sb, start };
+         start += pNode->length;
+         index -= nLeft + 1;
+         pNode = pNode->right.get();
+      }
+   }
+   return {};
+}
+
+SeqBlock BlockArray::back() const
+{
+   assert(!empty());
+   auto pNode = mRoot.get();
+   while (pNode->right)
+      pNode = pNode->right.get();
+   return { pNode->sb, GetNumSamples() - pNode->length };
+}
+
+auto BlockArray::begin() const -> const_iterator
+{
+   const_iterator result;
+   result.Descend(mRoot.get());
+   return result;
+}
+
+auto BlockArray::end() const -> const_iterator
+{
+   const_iterator result;
+   result.mIndex = size();
+   return result;
+}
+
+size_t BlockArray::FindBlock(sampleCount pos) const
+{
+   assert(pos >= 0 && pos < GetNumSamples());
+   size_t index = 0;
+   auto pNode = mRoot.get();
+   while (pNode) {
+      const auto leftSamples = Tree::Samples(pNode->left);
+      if (pos < leftSamples)
+         pNode = pNode->left.get();
+      else {
+         index += Tree::Count(pNode->left);
+         pos -= leftSamples;
+         if (pos < pNode->length)
+            return index;
+         pos -= pNode->length;
+         ++index;
+         pNode = pNode->right.get();
+      }
+   }
+   // Out of range
+   return std::max<size_t>(1, index) - 1;
+}
+
+size_t BlockArray::GetMaxBlockLength(size_t first) const
+{
+   size_t result = 0;
+   Tree::VisitFrom(mRoot.get(), first,
+      [&](const Node &node, const Node *pRight) {
+         result = std::max(result, node.length);
+         if (pRight)
+            result = std::max(result, pRight->maxLength);
+      });
+   return result;
+}
+
+bool BlockArray::HasNullBlock(size_t first) const
+{
+   bool result = false;
+   Tree::VisitFrom(mRoot.get(), first,
+      [&](const Node &node, const Node *pRight) {
+         result = result || !node.sb || (pRight && pRight->hasNull);
+      });
+   return result;
+}
+
+void BlockArray::push_back(const SampleBlockPtr &sb)
+{
+   mRoot = Tree::Join(mRoot, sb, nullptr);
+}
+
+void BlockArray::pop_back()
+{
+   assert(!empty());
+   mRoot = Tree::SplitLast(mRoot).first;
+}
+
+void BlockArray::Replace(size_t index, const SampleBlockPtr &sb)
+{
+   assert(index < size());
+   mRoot = Tree::Replace(mRoot, index, sb);
+}
+
+void BlockArray::Append(const BlockArray &other)
+{
+   mRoot = Tree::Concatenate(mRoot, other.mRoot);
+}
+
+BlockArray BlockArray::Slice(size_t first, size_t last) const
+{
+   last = std::min(last, size());
+   if (first >= last)
+      return {};
+   auto rest = Tree::Split(mRoot, last).first;
+   return BlockArray{ Tree::Split(rest, first).second };
+}
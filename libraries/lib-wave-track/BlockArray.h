@@ -0,0 +1,148 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file BlockArray.h
+  @brief The sequence of sample blocks of a Sequence
+
+**********************************************************************/
+#ifndef __AUDACITY_BLOCK_ARRAY__
+#define __AUDACITY_BLOCK_ARRAY__
+
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "SampleCount.h"
+
+class SampleBlock;
+
+// This is an internal data structure!  For advanced use only.
+class SeqBlock {
+ public:
+   using SampleBlockPtr = std::shared_ptr<SampleBlock>;
+   SampleBlockPtr sb;
+   ///the sample in the global wavetrack that this block starts at.
+   sampleCount start;
+
+   SeqBlock()
+      : sb{}, start(0)
+   {}
+
+   SeqBlock(const SampleBlockPtr &sb_, sampleCount start_)
+      : sb(sb_), start(start_)
+   {}
+};
+
+//! Sequence of sample blocks, each starting where the previous one ends
+/*!
+ The blocks are the leaves of a balanced tree, whose nodes record only counts
+ of blocks and samples below them.  Starts are not stored but found while
+ descending, so that insertion or removal anywhere does not move the rest.
+
+ Lookup by index or by sample, insertion and removal of one block, and
+ splitting and concatenation of whole arrays all take logarithmic time.
+
+ Nodes are immutable and shared, so a copy costs constant time, and changes
+ to the copy leave the original as it was.  This makes it cheap to build the
+ new contents of a Sequence aside, and then swap them in, for a strong
+ exception safety guarantee.
+ */
+class WAVE_TRACK_API BlockArray
+{
+   struct Node;
+   using NodePtr = std::shared_ptr<const Node>;
+   struct Tree;
+
+public:
+   using SampleBlockPtr = SeqBlock::SampleBlockPtr;
+   using size_type = size_t;
+   using value_type = SeqBlock;
+
+   //! Visits the blocks in order; invalidated by changes of the array
+   class WAVE_TRACK_API const_iterator {
+   public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = SeqBlock;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const SeqBlock *;
+      using reference = const SeqBlock &;
+
+      const_iterator();
+      reference operator *() const { return mBlock; }
+      pointer operator ->() const { return &mBlock; }
+      const_iterator &operator ++();
+      const_iterator operator ++(int)
+      { auto result = *this; ++*this; return result; }
+
+      friend bool operator ==(const const_iterator &a, const const_iterator &b)
+      { return a.mIndex == b.mIndex; }
+      friend bool operator !=(const const_iterator &a, const const_iterator &b)
+      { return !(a == b); }
+
+   private:
+      friend BlockArray;
+      void Descend(const Node *pNode);
+
+      //! Nodes whose blocks and right subtrees are not yet visited
+      std::vector<const Node *> mStack;
+      SeqBlock mBlock;
+      size_t mIndex{ 0 };
+   };
+   using iterator = const_iterator;
+
+   BlockArray();
+   BlockArray(const BlockArray &);
+   BlockArray(BlockArray &&) noexcept;
+   BlockArray &operator =(const BlockArray &);
+   BlockArray &operator =(BlockArray &&) noexcept;
+   ~BlockArray();
+
+   size_t size() const;
+   bool empty() const { return !mRoot; }
+
+   //! Total length of the blocks
+   sampleCount GetNumSamples() const;
+
+   //! @pre `index < size()`
+   SeqBlock operator [](size_t index) const;
+   //! @pre `!empty()`
+   SeqBlock back() const;
+
+   const_iterator begin() const;
+   const_iterator end() const;
+
+   //! Index of the block containing sample `pos`
+   /*! @pre `0 <= pos && pos < GetNumSamples()` */
+   size_t FindBlock(sampleCount pos) const;
+
+   //! Longest block among those at `first` or later
+   size_t GetMaxBlockLength(size_t first = 0) const;
+   //! Whether any block at `first` or later is null
+   bool HasNullBlock(size_t first = 0) const;
+
+   /*! @excsafety{Strong} */
+   void push_back(const SampleBlockPtr &sb);
+   /*! @pre `!empty()` */
+   /*! @excsafety{Strong} */
+   void pop_back();
+   //! Replace the block at `index`, which may change length
+   /*! @pre `index < size()` */
+   /*! @excsafety{Strong} */
+   void Replace(size_t index, const SampleBlockPtr &sb);
+   //! Append all blocks of another array
+   /*! @excsafety{Strong} */
+   void Append(const BlockArray &other);
+   //! @return the blocks with indices in [first, last), clamped to size()
+   BlockArray Slice(size_t first, size_t last) const;
+
+   void swap(BlockArray &other) noexcept { mRoot.swap(other.mRoot); }
+
+private:
+   explicit BlockArray(NodePtr root);
+
+   NodePtr mRoot;
+};
+
+#endif
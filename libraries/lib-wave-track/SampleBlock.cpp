@@ -66,6 +66,14 @@ SampleBlockPtr SampleBlockFactory::CreateFromId(
    return result;
 }
 
+void SampleBlockFactory::BeginBulkLoad()
+{
+}
+
+void SampleBlockFactory::EndBulkLoad()
+{
+}
+
 SampleBlock::~SampleBlock() = default;
 
 size_t SampleBlock::GetSamples(samplePtr dest,
@@ -151,6 +151,16 @@ public:
    /*! @return ids of all sample blocks created by this factory and still extant */
    virtual SampleBlockIDs GetActiveBlockIDs() = 0;
 
+   //! Hint that many blocks will be made by CreateFromXML or CreateFromId,
+   //! as when a project is opened, until EndBulkLoad()
+   /*!
+    An override may then fetch what it needs for all blocks at once.  Default
+    does nothing.
+    */
+   virtual void BeginBulkLoad();
+   //! Ends the hint given by BeginBulkLoad()
+   virtual void EndBulkLoad();
+
 protected:
    // The override should throw more informative exceptions on error than the
    // default InconsistencyException thrown by Create
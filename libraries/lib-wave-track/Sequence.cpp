@@ -89,8 +89,8 @@ size_t Sequence::GetIdealBlockSize() const
 
 bool Sequence::CloseLock() noexcept
 {
-   for (unsigned int i = 0; i < mBlock.size(); i++)
-      mBlock[i].sb->CloseLock();
+   for (const auto &block : mBlock)
+      block.sb->CloseLock();
 
    return true;
 }
@@ -174,10 +174,6 @@ bool Sequence::ConvertToSampleFormat(sampleFormat format,
    } );
 
    BlockArray newBlockArray;
-   // Use the ratio of old to NEW mMaxSamples to make a reasonable guess
-   // at allocation.
-   newBlockArray.reserve
-      (1 + mBlock.size() * ((float)oldMaxSamples / (float)mMaxSamples));
 
    {
       size_t oldSize = oldMaxSamples;
@@ -185,9 +181,8 @@ bool Sequence::ConvertToSampleFormat(sampleFormat format,
       size_t newSize = oldMaxSamples;
       SampleBuffer bufferNew(newSize, format);
 
-      for (size_t i = 0, nn = mBlock.size(); i < nn; i++)
+      for (const auto &oldSeqBlock : mBlock)
       {
-         SeqBlock &oldSeqBlock = mBlock[i];
          const auto &oldBlockFile = oldSeqBlock.sb;
          const auto len = oldBlockFile->GetSampleCount();
          ensureSampleBufferSize(bufferOld, oldFormats.Stored(), oldSize, len);
@@ -216,9 +211,8 @@ bool Sequence::ConvertToSampleFormat(sampleFormat format,
          //    from the old blocks... Oh no!
 
          // Using Blockify will handle the cases where len > the NEW mMaxSamples. Previous code did not.
-         const auto blockstart = oldSeqBlock.start;
          Blockify(*mpFactory, mMaxSamples, format,
-                  newBlockArray, blockstart, bufferNew.ptr(), len);
+                  newBlockArray, bufferNew.ptr(), len);
 
          if (progressReport)
             progressReport(len);
@@ -412,8 +406,6 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
    wxUnusedVar(numBlocks);
    wxASSERT(b0 <= b1);
 
-   dest->mBlock.reserve(b1 - b0 + 1);
-
    auto bufferSize = mMaxSamples;
    const auto format = mSampleFormats.Stored();
    SampleBuffer buffer(bufferSize, format);
@@ -440,10 +432,17 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
       --b0;
 
    // If there are blocks in the middle, use the blocks whole
-   for (int bb = b0 + 1; bb < b1; ++bb)
-      AppendBlock(pUseFactory, format,
-         dest->mBlock, dest->mNumSamples, mBlock[bb]);
-      // Increase ref count or duplicate file
+   if (!pUseFactory && b0 + 1 < b1) {
+      // Share a whole subrange of the array
+      const auto middle = mBlock.Slice(b0 + 1, b1);
+      dest->mBlock.Append(middle);
+      dest->mNumSamples += middle.GetNumSamples();
+   }
+   else
+      for (int bb = b0 + 1; bb < b1; ++bb)
+         AppendBlock(pUseFactory, format,
+            dest->mBlock, dest->mNumSamples, mBlock[bb]);
+         // Duplicate file
 
    // Do the last block
    if (b1 > b0) {
@@ -551,13 +550,19 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
       // minimum size
 
       // Build and swap a copy so there is a strong exception safety guarantee
+      // (copying the array is cheap, because nodes are shared)
       BlockArray newBlock{ mBlock };
       sampleCount samples = mNumSamples;
-      for (unsigned int i = 0; i < srcNumBlocks; i++)
-         // AppendBlock may throw for limited disk space, if pasting from
-         // one project into another.
-         AppendBlock(pUseFactory, format,
-            newBlock, samples, srcBlock[i]);
+      if (!pUseFactory) {
+         newBlock.Append(srcBlock);
+         samples += addedLen;
+      }
+      else
+         for (const auto &block : srcBlock)
+            // AppendBlock may throw for limited disk space, if pasting from
+            // one project into another.
+            AppendBlock(pUseFactory, format,
+               newBlock, samples, block);
 
       CommitChangesIfConsistent
          (newBlock, samples, wxT("Paste branch one"));
@@ -567,8 +572,8 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
 
    const int b = (s == mNumSamples) ? mBlock.size() - 1 : FindBlock(s);
    wxASSERT((b >= 0) && (b < (int)numBlocks));
-   SeqBlock *const pBlock = &mBlock[b];
-   const auto length = pBlock->sb->GetSampleCount();
+   const SeqBlock block = mBlock[b];
+   const auto length = block.sb->GetSampleCount();
    const auto largerBlockLen = addedLen + length;
    // PRL: when insertion point is the first sample of a block,
    // and the following test fails, perhaps we could test
@@ -577,7 +582,6 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
       // Special case: we can fit all of the NEW samples inside of
       // one block!
 
-      SeqBlock &block = *pBlock;
       // largerBlockLen is not more than mMaxSamples...
       SampleBuffer buffer(largerBlockLen.as_size_t(), format);
 
@@ -593,18 +597,16 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
            splitPoint, length - splitPoint, true);
 
       // largerBlockLen is not more than mMaxSamples...
-      block.sb = mpFactory->Create(
+      const auto sb = mpFactory->Create(
          buffer.ptr(),
          largerBlockLen.as_size_t(),
          format);
 
-      // Don't make a duplicate array.  We can still give Strong-guarantee
-      // if we modify only one block in place.
+      // Replacement of one block gives Strong-guarantee; following blocks
+      // move implicitly
+      mBlock.Replace(b, sb);
 
       // use No-fail-guarantee in remaining steps
-      for (unsigned int i = b + 1; i < numBlocks; i++)
-         mBlock[i].start += addedLen;
-
       mNumSamples += addedLen;
 
       // This consistency check won't throw, it asserts.
@@ -618,11 +620,9 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
    // it's simplest to just lump all the data together
    // into one big block along with the split block,
    // then resplit it all
-   BlockArray newBlock;
-   newBlock.reserve(numBlocks + srcNumBlocks + 2);
-   newBlock.insert(newBlock.end(), mBlock.begin(), mBlock.begin() + b);
+   BlockArray newBlock = mBlock.Slice(0, b);
 
-   SeqBlock &splitBlock = mBlock[b];
+   const SeqBlock &splitBlock = block;
    auto splitLen = splitBlock.sb->GetSampleCount();
    // s lies within splitBlock
    auto splitPoint = ( s - splitBlock.start ).as_size_t();
@@ -644,7 +644,7 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
            splitLen - splitPoint, true);
 
       Blockify(*mpFactory, mMaxSamples, format,
-               newBlock, splitBlock.start, sumBuffer.ptr(), sum);
+               newBlock, sumBuffer.ptr(), sum);
    } else {
 
       // The final case is that we're inserting at least five blocks.
@@ -671,14 +671,16 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
                format, 0, srcFirstTwoLen, true);
 
       Blockify(*mpFactory, mMaxSamples, format,
-               newBlock, splitBlock.start, sampleBuffer.ptr(), leftLen);
+               newBlock, sampleBuffer.ptr(), leftLen);
 
-      for (i = 2; i < srcNumBlocks - 2; i++) {
-         const SeqBlock &block = srcBlock[i];
-         auto sb = ShareOrCopySampleBlock(
-            pUseFactory, format, block.sb );
-         newBlock.push_back(SeqBlock(sb, block.start + s));
-      }
+      if (!pUseFactory)
+         newBlock.Append(srcBlock.Slice(2, srcNumBlocks - 2));
+      else
+         for (i = 2; i < srcNumBlocks - 2; i++) {
+            auto sb = ShareOrCopySampleBlock(
+               pUseFactory, format, srcBlock[i].sb );
+            newBlock.push_back(sb);
+         }
 
       auto lastStart = penultimate.start;
       src->Get(srcNumBlocks - 2, sampleBuffer.ptr(), format,
@@ -687,13 +689,12 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
            splitBlock, splitPoint, rightSplit, true);
 
       Blockify(*mpFactory, mMaxSamples, format,
-               newBlock, s + lastStart, sampleBuffer.ptr(), rightLen);
+               newBlock, sampleBuffer.ptr(), rightLen);
    }
 
-   // Copy remaining blocks to NEW block array and
+   // Append remaining blocks to NEW block array and
    // swap the NEW block array in for the old
-   for (i = b + 1; i < numBlocks; i++)
-      newBlock.push_back(mBlock[i].Plus(addedLen));
+   newBlock.Append(mBlock.Slice(b + 1, numBlocks));
 
    CommitChangesIfConsistent
       (newBlock, mNumSamples + addedLen, wxT("Paste branch three"));
@@ -729,18 +730,13 @@ void Sequence::InsertSilence(sampleCount s0, sampleCount len)
 
    sampleCount pos = 0;
 
-   // Could nBlocks overflow a size_t?  Not very likely.  You need perhaps
-   // 2 ^ 52 samples which is over 3000 years at 44.1 kHz.
-   auto nBlocks = (len + idealSamples - 1) / idealSamples;
-   sTrack.mBlock.reserve(nBlocks.as_size_t());
-
    const auto format = mSampleFormats.Stored();
    if (len >= idealSamples) {
       auto silentFile = factory.CreateSilent(
          idealSamples,
          format);
       while (len >= idealSamples) {
-         sTrack.mBlock.push_back(SeqBlock(silentFile, pos));
+         sTrack.mBlock.push_back(silentFile);
 
          pos += idealSamples;
          len -= idealSamples;
@@ -748,8 +744,8 @@ void Sequence::InsertSilence(sampleCount s0, sampleCount len)
    }
    if (len != 0) {
       // len is not more than idealSamples:
-      sTrack.mBlock.push_back(SeqBlock(
-         factory.CreateSilent(len.as_size_t(), format), pos));
+      sTrack.mBlock.push_back(
+         factory.CreateSilent(len.as_size_t(), format));
       pos += len;
    }
 
@@ -767,12 +763,11 @@ void Sequence::AppendBlock( SampleBlockFactory *pFactory, sampleFormat format,
       THROW_INCONSISTENCY_EXCEPTION;
 
    auto sb = ShareOrCopySampleBlock( pFactory, format, b.sb );
-   SeqBlock newBlock(sb, mNumSamples);
 
-   // We can assume newBlock.sb is not null
+   // We can assume sb is not null
 
-   mBlock.push_back(newBlock);
-   mNumSamples += newBlock.sb->GetSampleCount();
+   mBlock.push_back(sb);
+   mNumSamples += sb->GetSampleCount();
 
    // Don't do a consistency check here because this
    // function gets called in an inner loop.
@@ -857,7 +852,23 @@ bool Sequence::HandleXMLTag(const std::string_view& tag, const AttributesList &a
          }
       }
 
-      mBlock.push_back(wb);
+      // Make sure that start times and lengths are consistent
+      const auto numSamples = mBlock.GetNumSamples();
+      if (wb.start != numSamples)
+      {
+         wxLogWarning(
+            wxT("Gap detected in project file.\n")
+            wxT("   Start (%s) for block file %lld is not one sample past end of previous block (%s).\n")
+            wxT("   Moving start so blocks are contiguous."),
+            // PRL:  Why bother with Internat when the above is just wxT?
+            Internat::ToString(wb.start.as_double(), 0),
+            wb.sb->GetBlockID(),
+            Internat::ToString(numSamples.as_double(), 0));
+         mErrorOpening = true;
+      }
+
+      // The start is implied by the blocks before
+      mBlock.push_back(wb.sb);
 
       return true;
    }
@@ -956,28 +967,8 @@ void Sequence::HandleXMLEndTag(const std::string_view& tag)
    }
 
    // Make sure that the sequence is valid.
-
-   // Make sure that start times and lengths are consistent
-   sampleCount numSamples = 0;
-   for (unsigned b = 0, nn = mBlock.size(); b < nn;  b++)
-   {
-      SeqBlock &block = mBlock[b];
-      if (block.start != numSamples)
-      {
-         wxLogWarning(
-            wxT("Gap detected in project file.\n")
-            wxT("   Start (%s) for block file %lld is not one sample past end of previous block (%s).\n")
-            wxT("   Moving start so blocks are contiguous."),
-            // PRL:  Why bother with Internat when the above is just wxT?
-            Internat::ToString(block.start.as_double(), 0),
-            block.sb->GetBlockID(),
-            Internat::ToString(numSamples.as_double(), 0));
-         block.start = numSamples;
-         mErrorOpening = true;
-      }
-      numSamples += block.sb->GetSampleCount();
-   }
-
+   // Starts of blocks were checked as they were added.
+   const auto numSamples = mBlock.GetNumSamples();
    if (mNumSamples != numSamples)
    {
       wxLogWarning(
@@ -1004,8 +995,6 @@ XMLTagHandler *Sequence::HandleXMLChild(const std::string_view& tag)
 void Sequence::WriteXML(XMLWriter &xmlFile) const
 // may throw
 {
-   unsigned int b;
-
    xmlFile.StartTag(Sequence_tag);
 
    xmlFile.WriteAttr(MaxSamples_attr, mMaxSamples);
@@ -1016,8 +1005,7 @@ void Sequence::WriteXML(XMLWriter &xmlFile) const
       static_cast<size_t>( mSampleFormats.Effective() ));
    xmlFile.WriteAttr(NumSamples_attr, mNumSamples.as_long_long() );
 
-   for (b = 0; b < mBlock.size(); b++) {
-      const SeqBlock &bb = mBlock[b];
+   for (const auto &bb : mBlock) {
 
       // See http://bugzilla.audacityteam.org/show_bug.cgi?id=451.
       if (bb.sb->GetSampleCount() > mMaxSamples)
@@ -1056,45 +1044,8 @@ int Sequence::FindBlock(sampleCount pos) const
 {
    wxASSERT(pos >= 0 && pos < mNumSamples);
 
-   if (pos == 0)
-      return 0;
-
-   int numBlocks = mBlock.size();
-
-   size_t lo = 0, hi = numBlocks, guess;
-   sampleCount loSamples = 0, hiSamples = mNumSamples;
-
-   while (true) {
-      //this is not a binary search, but a
-      //dictionary search where we guess something smarter than the binary division
-      //of the unsearched area, since samples are usually proportional to block file number.
-      const double frac = (pos - loSamples).as_double() /
-         (hiSamples - loSamples).as_double();
-      guess = std::min(hi - 1, lo + size_t(frac * (hi - lo)));
-      const SeqBlock &block = mBlock[guess];
-
-      wxASSERT(block.sb->GetSampleCount() > 0);
-      wxASSERT(lo <= guess && guess < hi && lo < hi);
-
-      if (pos < block.start) {
-         wxASSERT(lo != guess);
-         hi = guess;
-         hiSamples = block.start;
-      }
-      else {
-         const sampleCount nextStart = block.start + block.sb->GetSampleCount();
-         if (pos < nextStart)
-            break;
-         else {
-            wxASSERT(guess < hi - 1);
-            lo = guess + 1;
-            loSamples = nextStart;
-         }
-      }
-   }
-
-   const int rval = guess;
-   wxASSERT(rval >= 0 && rval < numBlocks &&
+   const int rval = mBlock.FindBlock(pos);
+   wxASSERT(rval >= 0 && rval < (int)mBlock.size() &&
             pos >= mBlock[rval].start &&
             pos < mBlock[rval].start + mBlock[rval].sb->GetSampleCount());
 
@@ -1228,8 +1179,7 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
    }
 
    int b = FindBlock(start);
-   BlockArray newBlock;
-   std::copy( mBlock.begin(), mBlock.begin() + b, std::back_inserter(newBlock) );
+   BlockArray newBlock = mBlock.Slice(0, b);
 
    while (len > 0
       // Redundant termination condition,
@@ -1238,8 +1188,7 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
       // that cause the loop to make no progress because blen == 0
       && b < (int)size
    ) {
-      newBlock.push_back( mBlock[b] );
-      SeqBlock &block = newBlock.back();
+      SeqBlock block = mBlock[b];
       // start is within block
       const auto bstart = ( start - block.start ).as_size_t();
       const auto fileLength = block.sb->GetSampleCount();
@@ -1304,6 +1253,8 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
             block.sb = factory.CreateSilent(fileLength, dstFormat);
       }
 
+      newBlock.push_back( block.sb );
+
       // blen might be zero for inconsistent Sequence...
       if( buffer )
          buffer += (blen * SAMPLE_SIZE(format));
@@ -1315,7 +1266,7 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
       b++;
    }
 
-   std::copy( mBlock.begin() + b, mBlock.end(), std::back_inserter(newBlock) );
+   newBlock.Append( mBlock.Slice(b, size) );
 
    CommitChangesIfConsistent( newBlock, mNumSamples, wxT("SetSamples") );
 
@@ -1358,7 +1309,7 @@ void Sequence::AppendSharedBlock(const SeqBlock::SampleBlockPtr &pBlock)
       THROW_INCONSISTENCY_EXCEPTION;
 
    BlockArray newBlock;
-   newBlock.emplace_back( pBlock, mNumSamples );
+   newBlock.push_back( pBlock );
    auto newNumSamples = mNumSamples + len;
 
    AppendBlocksIfConsistent(newBlock, false,
@@ -1447,8 +1398,8 @@ SeqBlock::SampleBlockPtr Sequence::DoAppend(
 
    // If the last block is not full, we need to add samples to it
    int numBlocks = mBlock.size();
-   SeqBlock *pLastBlock;
-   decltype(pLastBlock->sb->GetSampleCount()) length;
+   SeqBlock lastBlock;
+   decltype(lastBlock.sb->GetSampleCount()) length;
    size_t bufferSize = mMaxSamples;
    const auto dstFormat = mSampleFormats.Stored();
    SampleBuffer buffer2(bufferSize, dstFormat);
@@ -1456,9 +1407,8 @@ SeqBlock::SampleBlockPtr Sequence::DoAppend(
    if (coalesce &&
        numBlocks > 0 &&
        (length =
-        (pLastBlock = &mBlock.back())->sb->GetSampleCount()) < mMinSamples) {
+        (lastBlock = mBlock.back()).sb->GetSampleCount()) < mMinSamples) {
       // Enlarge a sub-minimum block at the end
-      const SeqBlock &lastBlock = *pLastBlock;
       const auto addLen = std::min(mMaxSamples - length, len);
 
       // Reading same format as was saved before causes no dithering
@@ -1475,9 +1425,7 @@ SeqBlock::SampleBlockPtr Sequence::DoAppend(
          buffer2.ptr(),
          newLastBlockLen,
          dstFormat);
-      SeqBlock newLastBlock(pBlock, lastBlock.start);
-
-      newBlock.push_back( newLastBlock );
+      newBlock.push_back( pBlock );
 
       len -= addLen;
       newNumSamples += addLen;
@@ -1503,7 +1451,7 @@ SeqBlock::SampleBlockPtr Sequence::DoAppend(
          pBlock = factory.Create(buffer2.ptr(), addedLen, dstFormat);
       }
 
-      newBlock.push_back(SeqBlock(pBlock, newNumSamples));
+      newBlock.push_back(pBlock);
 
       buffer += addedLen * SAMPLE_SIZE(format);
       newNumSamples += addedLen;
@@ -1552,26 +1500,20 @@ void Sequence::Flush()
 
 void Sequence::Blockify(SampleBlockFactory &factory,
                         size_t mMaxSamples, sampleFormat mSampleFormat,
-                        BlockArray &list, sampleCount start,
+                        BlockArray &list,
                         constSamplePtr buffer, size_t len)
 {
    if (len <= 0)
       return;
 
    auto num = (len + (mMaxSamples - 1)) / mMaxSamples;
-   list.reserve(list.size() + num);
 
    for (decltype(num) i = 0; i < num; i++) {
-      SeqBlock b;
-
       const auto offset = i * len / num;
-      b.start = start + offset;
       int newLen = ((i + 1) * len / num) - offset;
       auto bufStart = buffer + (offset * SAMPLE_SIZE(mSampleFormat));
 
-      b.sb = factory.Create(bufStart, newLen, mSampleFormat);
-
-      list.push_back(b);
+      list.push_back(factory.Create(bufStart, newLen, mSampleFormat));
    }
 }
 
@@ -1594,8 +1536,8 @@ void Sequence::Delete(sampleCount start, sampleCount len)
    const auto format = mSampleFormats.Stored();
    auto sampleSize = SAMPLE_SIZE(format);
 
-   SeqBlock *pBlock;
-   decltype(pBlock->sb->GetSampleCount()) length;
+   SeqBlock block0;
+   decltype(block0.sb->GetSampleCount()) length;
 
    // One buffer for reuse in various branches here
    SampleBuffer scratch;
@@ -1606,8 +1548,8 @@ void Sequence::Delete(sampleCount start, sampleCount len)
    // block and the resulting length is not too small, perform the
    // deletion within this block:
    if (b0 == b1 &&
-       (length = (pBlock = &mBlock[b0])->sb->GetSampleCount()) - len >= mMinSamples) {
-      SeqBlock &b = *pBlock;
+       (length = (block0 = mBlock[b0]).sb->GetSampleCount()) - len >= mMinSamples) {
+      const SeqBlock &b = block0;
       // start is within block
       auto pos = ( start - b.start ).as_size_t();
 
@@ -1628,16 +1570,13 @@ void Sequence::Delete(sampleCount start, sampleCount len)
            // is not more than the length of the block
            ( pos + len ).as_size_t(), newLen - pos, true);
 
-      b.sb = factory.Create(scratch.ptr(), newLen, format);
+      const auto sb = factory.Create(scratch.ptr(), newLen, format);
 
-      // Don't make a duplicate array.  We can still give Strong-guarantee
-      // if we modify only one block in place.
+      // Replacement of one block gives Strong-guarantee; following blocks
+      // move implicitly
+      mBlock.Replace(b0, sb);
 
       // use No-fail-guarantee in remaining steps
-
-      for (unsigned int j = b0 + 1; j < numBlocks; j++)
-         mBlock[j].start -= len;
-
       mNumSamples -= len;
 
       // This consistency check won't throw, it asserts.
@@ -1646,14 +1585,9 @@ void Sequence::Delete(sampleCount start, sampleCount len)
       return;
    }
 
-   // Create a NEW array of blocks
-   BlockArray newBlock;
-   newBlock.reserve(numBlocks - (b1 - b0) + 2);
-
-   // Copy the blocks before the deletion point over to
-   // the NEW array
-   newBlock.insert(newBlock.end(), mBlock.begin(), mBlock.begin() + b0);
-   unsigned int i;
+   // Create a NEW array of blocks, sharing the blocks before the
+   // deletion point
+   BlockArray newBlock = mBlock.Slice(0, b0);
 
    // First grab the samples in block b0 before the deletion point
    // into preBuffer.  If this is enough samples for its own block,
@@ -1672,7 +1606,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
          auto pFile =
             factory.Create(scratch.ptr(), preBufferLen, format);
 
-         newBlock.push_back(SeqBlock(pFile, preBlock.start));
+         newBlock.push_back(pFile);
       } else {
          const SeqBlock &prepreBlock = mBlock[b0 - 1];
          const auto prepreLen = prepreBlock.sb->GetSampleCount();
@@ -1689,7 +1623,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
 
          newBlock.pop_back();
          Blockify(*mpFactory, mMaxSamples, format,
-                  newBlock, prepreBlock.start, scratch.ptr(), sum);
+                  newBlock, scratch.ptr(), sum);
       }
    }
    else {
@@ -1718,9 +1652,9 @@ void Sequence::Delete(sampleCount start, sampleCount len)
          auto file =
             factory.Create(scratch.ptr(), postBufferLen, format);
 
-         newBlock.push_back(SeqBlock(file, start));
+         newBlock.push_back(file);
       } else {
-         SeqBlock &postpostBlock = mBlock[b1 + 1];
+         const SeqBlock &postpostBlock = mBlock[b1 + 1];
          const auto postpostLen = postpostBlock.sb->GetSampleCount();
          const auto sum = postpostLen + postBufferLen;
 
@@ -1734,7 +1668,7 @@ void Sequence::Delete(sampleCount start, sampleCount len)
               postpostBlock, 0, postpostLen, true);
 
          Blockify(*mpFactory, mMaxSamples, format,
-                  newBlock, start, scratch.ptr(), sum);
+                  newBlock, scratch.ptr(), sum);
          b1++;
       }
    }
@@ -1743,9 +1677,8 @@ void Sequence::Delete(sampleCount start, sampleCount len)
       // right on the end of a block.
    }
 
-   // Copy the remaining blocks over from the old array
-   for (i = b1 + 1; i < numBlocks; i++)
-      newBlock.push_back(mBlock[i].Plus(-len));
+   // Share the remaining blocks of the old array
+   newBlock.Append(mBlock.Slice(b1 + 1, numBlocks));
 
    CommitChangesIfConsistent
       (newBlock, mNumSamples - len, wxT("Delete - branch two"));
@@ -1765,28 +1698,14 @@ void Sequence::ConsistencyCheck
    // gives a little more discrimination
    std::optional<InconsistencyException> ex;
 
-   unsigned int numBlocks = mBlock.size();
-
-   unsigned int i;
-   sampleCount pos = from < numBlocks ? mBlock[from].start : mNumSamples;
-   if ( from == 0 && pos != 0 )
+   // Each block starts where the previous one ends, by construction of
+   // BlockArray; the rest is found from totals kept in the array, without
+   // visiting all blocks
+   if ( mBlock.HasNullBlock(from) )
       ex.emplace( CONSTRUCT_INCONSISTENCY_EXCEPTION );
-
-   for (i = from; !ex && i < numBlocks; i++) {
-      const SeqBlock &seqBlock = mBlock[i];
-      if (pos != seqBlock.start)
-         ex.emplace( CONSTRUCT_INCONSISTENCY_EXCEPTION );
-
-      if ( seqBlock.sb ) {
-         const auto length = seqBlock.sb->GetSampleCount();
-         if (length > maxSamples)
-            ex.emplace( CONSTRUCT_INCONSISTENCY_EXCEPTION );
-         pos += length;
-      }
-      else
-         ex.emplace( CONSTRUCT_INCONSISTENCY_EXCEPTION );
-   }
-   if ( !ex && pos != mNumSamples )
+   else if ( mBlock.GetMaxBlockLength(from) > maxSamples )
+      ex.emplace( CONSTRUCT_INCONSISTENCY_EXCEPTION );
+   else if ( mBlock.GetNumSamples() != mNumSamples )
       ex.emplace( CONSTRUCT_INCONSISTENCY_EXCEPTION );
 
    if ( ex )
@@ -1829,47 +1748,32 @@ void Sequence::AppendBlocksIfConsistent
    if (additionalBlocks.empty())
       return;
 
-   bool tmpValid = false;
-   SeqBlock tmp;
+   // Build and swap a copy so there is a strong exception safety guarantee
+   // (copying the array is cheap, because nodes are shared)
+   auto newBlock = mBlock;
+   if ( replaceLast && ! newBlock.empty() )
+      newBlock.pop_back();
 
-   if ( replaceLast && ! mBlock.empty() ) {
-      tmp = mBlock.back(), tmpValid = true;
-      mBlock.pop_back();
-   }
-
-   auto prevSize = mBlock.size();
+   const auto prevSize = newBlock.size();
+   newBlock.Append( additionalBlocks );
 
-   bool consistent = false;
-   auto cleanup = finally( [&] {
-      if ( !consistent ) {
-         mBlock.resize( prevSize );
-         if ( tmpValid )
-            mBlock.push_back( tmp );
-      }
-   } );
-
-   std::copy( additionalBlocks.begin(), additionalBlocks.end(),
-              std::back_inserter( mBlock ) );
-
-   // Check consistency only of the blocks that were added,
-   // avoiding quadratic time for repeated checking of repeating appends
-   ConsistencyCheck( mBlock, mMaxSamples, prevSize, numSamples, whereStr ); // may throw
+   // Check consistency only of the blocks that were added
+   ConsistencyCheck( newBlock, mMaxSamples, prevSize, numSamples, whereStr ); // may throw
 
    // now commit
    // use No-fail-guarantee
 
+   mBlock.swap(newBlock);
    mNumSamples = numSamples;
-   consistent = true;
 }
 
 void Sequence::DebugPrintf
    (const BlockArray &mBlock, sampleCount mNumSamples, wxString *dest)
 {
-   unsigned int i;
+   unsigned int i = 0;
    decltype(mNumSamples) pos = 0;
 
-   for (i = 0; i < mBlock.size(); i++) {
-      const SeqBlock &seqBlock = mBlock[i];
+   for (const auto &seqBlock : mBlock) {
       *dest += wxString::Format
          (wxT("   Block %3u: start %8lld, len %8lld, refs %ld, id %lld"),
           i,
@@ -1885,6 +1789,7 @@ void Sequence::DebugPrintf
 
       if (seqBlock.sb)
          pos += seqBlock.sb->GetSampleCount();
+      ++i;
    }
    if (pos != mNumSamples)
       *dest += wxString::Format
@@ -15,6 +15,7 @@
 #include <vector>
 #include <functional>
 
+#include "BlockArray.h"
 #include "SampleFormat.h"
 #include "XMLTagHandler.h"
 
@@ -25,31 +26,6 @@ class SampleBlock;
 class SampleBlockFactory;
 using SampleBlockFactoryPtr = std::shared_ptr<SampleBlockFactory>;
 
-// This is an internal data structure!  For advanced use only.
-class SeqBlock {
- public:
-   using SampleBlockPtr = std::shared_ptr<SampleBlock>;
-   SampleBlockPtr sb;
-   ///the sample in the global wavetrack that this block starts at.
-   sampleCount start;
-
-   SeqBlock()
-      : sb{}, start(0)
-   {}
-
-   SeqBlock(const SampleBlockPtr &sb_, sampleCount start_)
-      : sb(sb_), start(start_)
-   {}
-
-   // Construct a SeqBlock with changed start, same file
-   SeqBlock Plus(sampleCount delta) const
-   {
-      return SeqBlock(sb, start + delta);
-   }
-};
-class BlockArray : public std::vector<SeqBlock> {};
-using BlockPtrArray = std::vector<SeqBlock*>; // non-owning pointers
-
 class WAVE_TRACK_API Sequence final : public XMLTagHandler{
  public:
 
@@ -229,7 +205,6 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
    // you're doing!
    //
 
-   BlockArray &GetBlockArray() { return mBlock; }
    const BlockArray &GetBlockArray() const { return mBlock; }
 
    size_t GetAppendBufferLen() const { return mAppendBufferLen; }
@@ -288,7 +263,6 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
                         size_t maxSamples,
                         sampleFormat format,
                         BlockArray &list,
-                        sampleCount start,
                         constSamplePtr buffer,
                         size_t len);
 
@@ -445,6 +445,7 @@ void WaveClip::SwapChannels()
       attachment.SwapChannels();
    });
    std::swap(mSequences[0], mSequences[1]);
+   InvalidateStretchedClipCache();
    for (auto &pCutline : mCutLines)
       pCutline->SwapChannels();
    assert(CheckInvariants());
@@ -734,9 +735,20 @@ constSamplePtr WaveClip::GetAppendBuffer(size_t ii) const
 
 void WaveClip::MarkChanged() noexcept // NOFAIL-GUARANTEE
 {
+   InvalidateStretchedClipCache();
    Attachments::ForEach(std::mem_fn(&WaveClipListener::MarkChanged));
 }
 
+void WaveClip::InvalidateStretchedClipCache() noexcept // NOFAIL-GUARANTEE
+{
+   mStretchedClipCache->Invalidate();
+}
+
+std::shared_ptr<StretchedClipCache> WaveClip::GetStretchedClipCache() const
+{
+   return mStretchedClipCache;
+}
+
 std::pair<float, float> WaveClip::GetMinMax(size_t ii,
    double t0, double t1, bool mayThrow) const
 {
@@ -1801,6 +1813,7 @@ sampleCount WaveClip::GetVisibleSampleCount() const
 void WaveClip::SetTrimLeft(double trim)
 {
     mTrimLeft = std::max(.0, trim);
+    InvalidateStretchedClipCache();
 }
 
 double WaveClip::GetTrimLeft() const noexcept
@@ -1811,6 +1824,7 @@ double WaveClip::GetTrimLeft() const noexcept
 void WaveClip::SetTrimRight(double trim)
 {
     mTrimRight = std::max(.0, trim);
+    InvalidateStretchedClipCache();
 }
 
 double WaveClip::GetTrimRight() const noexcept
@@ -1852,12 +1866,14 @@ void WaveClip::TrimLeftTo(double to)
    mTrimLeft =
       std::clamp(to, SnapToTrackSample(mSequenceOffset), GetPlayEndTime()) -
       mSequenceOffset;
+   InvalidateStretchedClipCache();
 }
 
 void WaveClip::TrimRightTo(double to)
 {
    const auto endTime = SnapToTrackSample(GetSequenceEndTime());
    mTrimRight = endTime - std::clamp(to, GetPlayStartTime(), endTime);
+   InvalidateStretchedClipCache();
 }
 
 double WaveClip::GetSequenceStartTime() const noexcept
@@ -2058,5 +2074,6 @@ WaveClip::Transaction::~Transaction()
       clip.mSequences.swap(sequences);
       clip.mTrimLeft = mTrimLeft;
       clip.mTrimRight = mTrimRight;
+      clip.InvalidateStretchedClipCache();
    }
 }
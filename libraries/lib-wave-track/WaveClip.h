@@ -16,6 +16,7 @@
 #include "CRTPBase.h"
 #include "SampleFormat.h"
 #include "ClipInterface.h"
+#include "StretchedClipCache.h"
 #include "XMLTagHandler.h"
 #include "SampleCount.h"
 #include "AudioSegmentSampleView.h"
@@ -373,6 +374,8 @@ public:
    SubscribeToPitchAndSpeedPresetChange(
       std::function<void(PitchAndSpeedPreset)> cb) const override;
 
+   std::shared_ptr<StretchedClipCache> GetStretchedClipCache() const override;
+
    // Resample clip. This also will set the rate, but without changing
    // the length of the clip
    void Resample(int rate, BasicUI::ProgressDialog *progress = nullptr);
@@ -873,6 +876,10 @@ private:
    /*! @excsafety{No-fail} */
    void MarkChanged() noexcept;
 
+   //! Called when audio or trimming changes, even if listeners are not told
+   /*! @excsafety{No-fail} */
+   void InvalidateStretchedClipCache() noexcept;
+
    // Always gives non-negative answer, not more than sample sequence length
    // even if t0 really falls outside that range
    sampleCount TimeToSequenceSamples(double t) const;
@@ -976,6 +983,11 @@ private:
    bool mIsPlaceholder { false };
 
    wxString mName;
+
+   //! Not copied with the clip
+   const std::shared_ptr<StretchedClipCache> mStretchedClipCache {
+      std::make_shared<StretchedClipCache>()
+   };
 };
 
 #endif
@@ -0,0 +1,250 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  BlockArrayTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "BlockArray.h"
+#include "SampleBlock.h"
+#include "Sequence.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+namespace {
+class MemoryBlock final : public SampleBlock
+{
+public:
+   MemoryBlock(long long id, const float *src, size_t numsamples)
+      : mId{ id }, mData(src, src + numsamples)
+   {}
+   explicit MemoryBlock(size_t numsamples) : mData(numsamples) {}
+
+   void CloseLock() noexcept override {}
+   SampleBlockID GetBlockID() const override { return mId; }
+   sampleFormat GetSampleFormat() const override { return floatSample; }
+   size_t GetSampleCount() const override { return mData.size(); }
+   bool GetSummary256(float *, size_t, size_t) override { return false; }
+   bool GetSummary64k(float *, size_t, size_t) override { return false; }
+   size_t GetSpaceUsage() const override { return 0; }
+   void SaveXML(XMLWriter &) override {}
+   BlockSampleView GetFloatSampleView(bool) override
+   {
+      return std::make_shared<std::vector<float>>(mData);
+   }
+
+protected:
+   size_t DoGetSamples(samplePtr dest, sampleFormat destformat,
+      size_t sampleoffset, size_t numsamples) override
+   {
+      CopySamples(reinterpret_cast<constSamplePtr>(mData.data() + sampleoffset),
+         floatSample, dest, destformat, numsamples);
+      return numsamples;
+   }
+   MinMaxRMS DoGetMinMaxRMS(size_t, size_t) override { return {}; }
+   MinMaxRMS DoGetMinMaxRMS() const override { return {}; }
+
+private:
+   const long long mId{ 0 };
+   const std::vector<float> mData;
+};
+
+class MemoryBlockFactory final : public SampleBlockFactory
+{
+public:
+   SampleBlockIDs GetActiveBlockIDs() override { return {}; }
+
+protected:
+   SampleBlockPtr DoCreate(
+      constSamplePtr src, size_t numsamples, sampleFormat srcformat) override
+   {
+      std::vector<float> floats(numsamples);
+      CopySamples(src, srcformat,
+         reinterpret_cast<samplePtr>(floats.data()), floatSample, numsamples);
+      return std::make_shared<MemoryBlock>(
+         ++mLastId, floats.data(), numsamples);
+   }
+   SampleBlockPtr DoCreateSilent(
+      size_t numsamples, sampleFormat) override
+   {
+      return std::make_shared<MemoryBlock>(numsamples);
+   }
+   SampleBlockPtr DoCreateFromXML(sampleFormat, const AttributesList &) override
+   {
+      return nullptr;
+   }
+   SampleBlockPtr DoCreateFromId(sampleFormat, SampleBlockID) override
+   {
+      return nullptr;
+   }
+
+private:
+   long long mLastId{ 0 };
+};
+
+using Blocks = std::vector<SampleBlockPtr>;
+
+void RequireSame(const BlockArray &array, const Blocks &blocks)
+{
+   REQUIRE(array.size() == blocks.size());
+   sampleCount start = 0;
+   size_t ii = 0;
+   for (const auto &block : array) {
+      REQUIRE(block.sb == blocks[ii]);
+      REQUIRE(block.start == start);
+      REQUIRE(array[ii].start == start);
+      const auto length = block.sb->GetSampleCount();
+      REQUIRE(array.FindBlock(start) == ii);
+      REQUIRE(array.FindBlock(start + length - 1) == ii);
+      start += length;
+      ++ii;
+   }
+   REQUIRE(ii == blocks.size());
+   REQUIRE(array.GetNumSamples() == start);
+}
+}
+
+TEST_CASE("BlockArray")
+{
+   std::mt19937 engine{ 1234 };
+   const auto newBlock = [&]{
+      return std::make_shared<MemoryBlock>(1 + engine() % 1000);
+   };
+
+   BlockArray array;
+   Blocks blocks;
+   for (int ii = 0; ii < 500; ++ii) {
+      const auto sb = newBlock();
+      array.push_back(sb);
+      blocks.push_back(sb);
+   }
+   RequireSame(array, blocks);
+
+   SECTION("Slices and concatenations")
+   {
+      for (int ii = 0; ii < 100; ++ii) {
+         const size_t first = engine() % (blocks.size() + 1);
+         const size_t last = first + engine() % (blocks.size() + 1 - first);
+         const auto saved = array;
+         auto slice = array.Slice(first, last);
+         RequireSame(slice,
+            { blocks.begin() + first, blocks.begin() + last });
+         // Remove the slice, then put it back
+         auto rest = array.Slice(0, first);
+         rest.Append(array.Slice(last, blocks.size()));
+         Blocks restBlocks{ blocks.begin(), blocks.begin() + first };
+         restBlocks.insert(restBlocks.end(),
+            blocks.begin() + last, blocks.end());
+         RequireSame(rest, restBlocks);
+         array = rest.Slice(0, first);
+         array.Append(slice);
+         array.Append(rest.Slice(first, restBlocks.size()));
+         RequireSame(array, blocks);
+         // Copies are not changed
+         RequireSame(saved, blocks);
+      }
+   }
+
+   SECTION("Replacement, removal, and summaries")
+   {
+      const auto copy = array;
+      for (int ii = 0; ii < 100; ++ii) {
+         const auto index = engine() % blocks.size();
+         const auto sb = newBlock();
+         array.Replace(index, sb);
+         blocks[index] = sb;
+      }
+      array.pop_back();
+      blocks.pop_back();
+      RequireSame(array, blocks);
+      REQUIRE(copy.size() == blocks.size() + 1);
+
+      REQUIRE(!array.HasNullBlock());
+      array.Replace(100, nullptr);
+      REQUIRE(array.HasNullBlock(100));
+      REQUIRE(!array.HasNullBlock(101));
+
+      const auto longest = [&](size_t first) {
+         size_t result = 0;
+         for (auto ii = first; ii < blocks.size(); ++ii)
+            result = std::max(result, blocks[ii]->GetSampleCount());
+         return result;
+      };
+      for (size_t first : { 0, 101, 250, 498, 499 })
+         REQUIRE(array.GetMaxBlockLength(first) == longest(first));
+   }
+
+   SECTION("Long arrays stay shallow")
+   {
+      // Doubling shares the same subtrees many times
+      for (int ii = 0; ii < 10; ++ii)
+         array.Append(array);
+      REQUIRE(array.size() == 500 << 10);
+      const auto index = array.FindBlock(array.GetNumSamples() / 3);
+      const auto block = array[index];
+      REQUIRE(block.start <= array.GetNumSamples() / 3);
+      REQUIRE(array.GetNumSamples() / 3 <
+         block.start + block.sb->GetSampleCount());
+   }
+}
+
+TEST_CASE("Sequence edits near the start of long sequences")
+{
+   // Make small blocks
+   const auto maxDiskBlockSize = Sequence::GetMaxDiskBlockSize();
+   Sequence::SetMaxDiskBlockSize(1024 * sizeof(float));
+   auto cleanup = finally([&]{
+      Sequence::SetMaxDiskBlockSize(maxDiskBlockSize);
+   });
+
+   const auto factory = std::make_shared<MemoryBlockFactory>();
+   Sequence sequence{ factory, SampleFormats{ floatSample, floatSample } };
+   const auto maxSamples = sequence.GetMaxBlockSize();
+
+   std::vector<float> expected(1000 * maxSamples);
+   for (size_t ii = 0; ii < expected.size(); ++ii)
+      expected[ii] = ii;
+   for (size_t ii = 0; ii < expected.size(); ii += maxSamples)
+      sequence.AppendNewBlock(reinterpret_cast<constSamplePtr>(&expected[ii]),
+         floatSample, maxSamples);
+
+   const auto requireContents = [&]{
+      REQUIRE(sequence.GetNumSamples() == expected.size());
+      std::vector<float> actual(expected.size());
+      REQUIRE(sequence.Get(reinterpret_cast<samplePtr>(actual.data()),
+         floatSample, 0, actual.size(), true));
+      REQUIRE(actual == expected);
+      sequence.ConsistencyCheck(wxT("test"));
+   };
+
+   SECTION("Delete")
+   {
+      sequence.Delete(10, 100);
+      expected.erase(expected.begin() + 10, expected.begin() + 110);
+      requireContents();
+      sequence.Delete(maxSamples / 2, 3 * maxSamples);
+      expected.erase(expected.begin() + maxSamples / 2,
+         expected.begin() + maxSamples / 2 + 3 * maxSamples);
+      requireContents();
+   }
+
+   SECTION("InsertSilence and Paste")
+   {
+      sequence.InsertSilence(7, 2 * maxSamples + 3);
+      expected.insert(expected.begin() + 7, 2 * maxSamples + 3, 0.0f);
+      requireContents();
+
+      const auto copy = sequence.Copy(factory, 5, 5 + 6 * maxSamples);
+      std::vector<float> copied(
+         expected.begin() + 5, expected.begin() + 5 + 6 * maxSamples);
+      sequence.Paste(maxSamples + 1, copy.get());
+      expected.insert(
+         expected.begin() + maxSamples + 1, copied.begin(), copied.end());
+      requireContents();
+   }
+}
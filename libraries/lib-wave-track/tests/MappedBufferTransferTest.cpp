@@ -0,0 +1,103 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MappedBufferTransferTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "MappedBuffer.h"
+#include "MockSampleBlockFactory.h"
+#include "WaveTrack.h"
+
+#include <wx/string.h>
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace {
+constexpr size_t trackLength = 1000;
+constexpr size_t bufferLength = 256;
+
+//! A file of floats, such as a script makes in /dev/shm
+struct BufferFile
+{
+   explicit BufferFile(size_t nFloats)
+   {
+      const std::vector<float> zeroes(nFloats);
+      std::ofstream{ path, std::ios::binary }.write(
+         reinterpret_cast<const char*>(zeroes.data()),
+         zeroes.size() * sizeof(float));
+   }
+   ~BufferFile() { std::filesystem::remove(path); }
+
+   wxString Name() const { return wxString{ path.string() }; }
+
+   const std::filesystem::path path = std::filesystem::temp_directory_path()
+      / "audacity-mapped-buffer-test.raw";
+};
+
+std::vector<float> Samples(const WaveChannel &channel)
+{
+   std::vector<float> samples(trackLength);
+   channel.GetFloats(samples.data(), 0, samples.size());
+   return samples;
+}
+}
+
+TEST_CASE("Samples go through a mapped buffer and back, as with Get Samples "
+   "and Set Samples")
+{
+   const auto factory = std::make_shared<MockSampleBlockFactory>();
+   const auto track = WaveTrack::Create(factory, floatSample, 44100);
+   std::vector<float> ramp(trackLength);
+   for (size_t i = 0; i < ramp.size(); ++i)
+      ramp[i] = static_cast<float>(i) / trackLength;
+   const auto pChannel = track->GetChannel(0);
+   auto &channel = *pChannel;
+   channel.Append(reinterpret_cast<constSamplePtr>(ramp.data()), floatSample,
+      ramp.size());
+   track->Flush();
+
+   BufferFile file{ bufferLength };
+   const sampleCount start{ 100 };
+   {
+      // Get Samples
+      MappedBuffer buffer{ file.Name(), true };
+      REQUIRE(buffer.Floats() != nullptr);
+      REQUIRE(buffer.NFloats() == bufferLength);
+      REQUIRE(channel.GetFloats(buffer.Floats(), start, buffer.NFloats(),
+         FillFormat::fillZero, false));
+      for (size_t i = 0; i < bufferLength; ++i)
+         REQUIRE(buffer.Floats()[i] == ramp[start.as_size_t() + i]);
+
+      // The script changes the samples in place
+      for (size_t i = 0; i < bufferLength; ++i)
+         buffer.Floats()[i] = -buffer.Floats()[i];
+   }
+   {
+      // Set Samples, which maps the file again, read-only
+      const MappedBuffer buffer{ file.Name(), false };
+      REQUIRE(buffer.NFloats() == bufferLength);
+      REQUIRE(channel.SetFloats(buffer.Floats(), start, buffer.NFloats()));
+   }
+
+   auto expected = ramp;
+   for (size_t i = 0; i < bufferLength; ++i)
+      expected[start.as_size_t() + i] = -ramp[start.as_size_t() + i];
+   REQUIRE(Samples(channel) == expected);
+}
+
+TEST_CASE("MappedBuffer fails on missing and empty files")
+{
+   {
+      const MappedBuffer buffer{ wxString{ "no-such-file.raw" }, false };
+      REQUIRE(buffer.Floats() == nullptr);
+   }
+   BufferFile file{ 0 };
+   const MappedBuffer buffer{ file.Name(), false };
+   REQUIRE(buffer.Floats() == nullptr);
+}
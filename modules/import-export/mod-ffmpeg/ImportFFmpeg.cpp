@@ -164,6 +164,8 @@ public:
    wxString GetPluginStringID() override { return wxT("libav"); }
    TranslatableString GetPluginFormatDescription() override;
 
+   bool IsThreadSafe() const override { return true; }
+
    TranslatableString FailureHint() const override
    {
       return !FFmpegFunctions::Load()
@@ -183,6 +185,8 @@ struct StreamContext final
 
    int InitialChannels { 0 };
    sampleFormat SampleFormat { floatSample };
+   //! Chosen by Init(), according to preferences
+   sampleFormat TrackFormat { floatSample };
 
    bool Use { true };
 };
@@ -398,7 +402,8 @@ bool FFmpegImportFileHandle::InitCodecs()
 
          mStreamContexts.emplace_back(
             StreamContext { stream->GetIndex(), std::move(codecContextPtr),
-                            channels, preferredFormat, true });
+                            channels, preferredFormat,
+                            ImportUtils::ChooseFormat(preferredFormat), true });
 
          // Stream is decodeable and it is audio. Add it and its description to the arrays
          int duration = 0;
@@ -466,10 +471,10 @@ void FFmpegImportFileHandle::Import(
    {
       const StreamContext& sc = mStreamContexts[s];
 
-      auto stream = ImportUtils::NewWaveTrack(
-         *trackFactory,
+      // sc.TrackFormat was already chosen by Init(), according to preferences
+      auto stream = trackFactory->Create(
          sc.InitialChannels,
-         sc.SampleFormat,
+         sc.TrackFormat,
          sc.CodecContext->GetSampleRate()
       );
 
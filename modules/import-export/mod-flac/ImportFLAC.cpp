@@ -107,6 +107,7 @@ class FLACImportPlugin final : public ImportPlugin
 
    wxString GetPluginStringID() override { return wxT("libflac"); }
    TranslatableString GetPluginFormatDescription() override;
+   bool IsThreadSafe() const override { return true; }
    std::unique_ptr<ImportFileHandle> Open(
       const FilePath &Filename, AudacityProject*)  override;
 };
@@ -141,6 +142,8 @@ public:
 
 private:
    sampleFormat          mFormat;
+   //! Chosen by Init(), according to preferences
+   sampleFormat          mTrackFormat;
    std::unique_ptr<MyFLACFile> mFile;
    wxFFile               mHandle;
    unsigned long         mSampleRate;
@@ -377,6 +380,7 @@ bool FLACImportFileHandle::Init()
       // This probably is not a FLAC file at all
       return false;
    }
+   mTrackFormat = ImportUtils::ChooseFormat(mFormat);
    return true;
 }
 
@@ -405,7 +409,8 @@ void FLACImportFileHandle::Import(
 
    wxASSERT(mStreamInfoDone);
 
-   mTrack = ImportUtils::NewWaveTrack(*trackFactory, mNumChannels, mFormat, mSampleRate);
+   // mTrackFormat was already chosen by Init(), according to preferences
+   mTrack = trackFactory->Create(mNumChannels, mTrackFormat, mSampleRate);
 
    mFile->mImportProgressListener = &progressListener;
 
@@ -117,6 +117,8 @@ public:
       return DESC;
    }
 
+   bool IsThreadSafe() const override { return true; }
+
    std::unique_ptr<ImportFileHandle> Open(const FilePath &Filename, AudacityProject*) override;
 }; // class MP3ImportPlugin
 
@@ -366,8 +368,8 @@ bool MP3ImportFileHandle::SetupOutputFormat()
 
    mFloat64Output = encoding == MPG123_ENC_FLOAT_64;
 
-   mTrack = ImportUtils::NewWaveTrack(
-      *mTrackFactory,
+   // No preference can choose a format wider than float
+   mTrack = mTrackFactory->Create(
       mNumChannels,
       floatSample,
       rate);
@@ -65,6 +65,7 @@ public:
 
    wxString GetPluginStringID() override { return wxT("liboggvorbis"); }
    TranslatableString GetPluginFormatDescription() override;
+   bool IsThreadSafe() const override { return true; }
    std::unique_ptr<ImportFileHandle> Open(
       const FilePath &Filename, AudacityProject*) override;
 };
@@ -80,6 +81,8 @@ public:
       mFile(std::move(file)),
       mVorbisFile(std::move(vorbisFile))
       , mStreamUsage{ static_cast<size_t>(mVorbisFile->links) }
+      // The format agrees with what is always passed to Append() in Import()
+      , mFormat{ ImportUtils::ChooseFormat(int16Sample) }
    {
       for (int i = 0; i < mVorbisFile->links; i++)
       {
@@ -130,6 +133,7 @@ private:
    std::unique_ptr<OggVorbis_File> mVorbisFile;
 
    ArrayOf<int> mStreamUsage;
+   const sampleFormat mFormat;
    TranslatableStrings mStreamInfo;
    std::vector<WaveTrack::Holder> mStreams;
 };
@@ -230,11 +234,11 @@ void OggImportFileHandle::Import(
 
       vorbis_info *vi = ov_info(mVorbisFile.get(), i);
 
-      // The format agrees with what is always passed to Append() below
-      mStreams.push_back(ImportUtils::NewWaveTrack(
-         *trackFactory,
+      // mFormat was already chosen by the constructor, according to
+      // preferences
+      mStreams.push_back(trackFactory->Create(
          vi->channels,
-         int16Sample,
+         mFormat,
          vi->rate));
    }
 
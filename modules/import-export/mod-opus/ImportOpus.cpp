@@ -42,6 +42,7 @@ public:
 
    wxString GetPluginStringID() override;
    TranslatableString GetPluginFormatDescription() override;
+   bool IsThreadSafe() const override { return true; }
    std::unique_ptr<ImportFileHandle> Open(
      const FilePath &Filename, AudacityProject*) override;
 };
@@ -180,8 +181,8 @@ void OpusImportFileHandle::Import(
 
    outTracks.clear();
 
-   auto track = ImportUtils::NewWaveTrack(
-      *trackFactory,
+   // No preference can choose a format wider than float
+   auto track = trackFactory->Create(
       mNumChannels,
       mFormat,
       mSampleRate);
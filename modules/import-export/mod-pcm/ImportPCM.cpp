@@ -70,6 +70,8 @@ public:
    TranslatableString GetPluginFormatDescription() override;
    std::unique_ptr<ImportFileHandle> Open(
       const FilePath &Filename, AudacityProject*) override;
+   //! Preferences are read by Open(), not Import()
+   bool IsThreadSafe() const override { return true; }
 };
 
 
@@ -289,8 +291,8 @@ void PCMImportFileHandle::Import(
 
    wxASSERT(mFile.get());
 
-   auto track = ImportUtils::NewWaveTrack(
-      *trackFactory,
+   // mFormat was already chosen by the constructor, according to preferences
+   auto track = trackFactory->Create(
       mInfo.channels,
       mFormat,
       mInfo.samplerate);
@@ -48,6 +48,7 @@ public:
 
    wxString GetPluginStringID() override;
    TranslatableString GetPluginFormatDescription() override;
+   bool IsThreadSafe() const override { return true; }
    std::unique_ptr<ImportFileHandle> Open(
      const FilePath &Filename, AudacityProject*) override;
 };
@@ -78,6 +79,8 @@ private:
    int mBytesPerSample;
    int64_t mNumSamples;
    sampleFormat mFormat;
+   //! Chosen by the constructor, according to preferences
+   sampleFormat mTrackFormat;
 };
 
 // ============================================================================
@@ -145,6 +148,7 @@ WavPackImportFileHandle::WavPackImportFileHandle(const FilePath &filename,
    } else {
       mFormat = floatSample;
    }
+   mTrackFormat = ImportUtils::ChooseFormat(mFormat);
 }
 
 TranslatableString WavPackImportFileHandle::GetFileDescription()
@@ -168,10 +172,11 @@ void WavPackImportFileHandle::Import(
 
    outTracks.clear();
 
-   auto track = ImportUtils::NewWaveTrack(
-      *trackFactory,
+   // mTrackFormat was already chosen by the constructor, according to
+   // preferences
+   auto track = trackFactory->Create(
       mNumChannels,
-      mFormat,
+      mTrackFormat,
       mSampleRate);
 
    /* The number of samples to read in each loop */
@@ -14,6 +14,7 @@
 // security risk.  Use at your own risk.
 
 #include <wx/wx.h>
+#include <thread>
 #include "ScripterCallback.h"
 #include "commands/ScriptCommandRelay.h"
 
@@ -25,6 +26,9 @@ See the example in this file.  It has several cases/options in it.
 #include "ModuleConstants.h"
 
 extern void PipeServer();
+#if !defined(WIN32)
+extern void SocketServer();
+#endif
 typedef DLL_IMPORT int (*tpExecScriptServerFunc)( wxString * pIn, wxString * pOut);
 static tpExecScriptServerFunc pScriptServerFn=NULL;
 
@@ -49,6 +53,9 @@ extern "C" DLL_API int ModuleDispatch(ModuleDispatchTypes type)
    switch (type) {
    case ModuleInitialize:
       ScriptCommandRelay::StartScriptServer(RegScriptServerFunc);
+#if !defined(WIN32)
+      std::thread(SocketServer).detach();
+#endif
       break;
    default:
       break;
@@ -0,0 +1,255 @@
+// SocketServer.cpp :
+//
+// Serves scripts over a Unix domain socket, accessible only to the user
+// running Audacity, at /tmp/audacity_script_socket.<uid>
+//
+// Unlike the pipes, which carry one command and then one response, the
+// socket lets a script send many commands before it reads any response.
+//
+// Every message, in either direction, is a frame: a byte count as a 32 bit
+// little-endian number, then that many bytes.
+//
+// A request frame holds a request id chosen by the script, as a 32 bit
+// little-endian number, then one or more commands in UTF-8, separated by
+// newlines.  All commands of a request are queued for the main thread at
+// once, after the commands of earlier requests.
+//
+// Each command, in order, gets a response frame holding one line of JSON:
+//    {"id":7,"index":0,"count":3,"response":"..."}
+// where "id" is that of the request, "index" counts the commands of the
+// request, and "response" is the text that the pipes would send.
+
+#if !defined(WIN32)
+
+#include <wx/arrstr.h>
+#include <wx/string.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "IPCChannel.h"
+#include "IPCServer.h"
+#include "commands/ScriptCommandRelay.h"
+
+namespace {
+
+const char sockettmpl[] = "/tmp/audacity_script_socket.%d";
+
+uint32_t ReadUInt32(const char *bytes)
+{
+   const auto p = reinterpret_cast<const unsigned char *>(bytes);
+   return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24);
+}
+
+void AppendUInt32(std::string &bytes, uint32_t value)
+{
+   for (int ii = 0; ii < 4; ++ii, value >>= 8)
+      bytes += static_cast<char>(value & 0xff);
+}
+
+void AppendJSONString(std::string &json, const std::string &utf8)
+{
+   json += '"';
+   for (const unsigned char c : utf8) {
+      switch (c) {
+      case '"': json += "\\\""; break;
+      case '\\': json += "\\\\"; break;
+      case '\n': json += "\\n"; break;
+      case '\r': json += "\\r"; break;
+      case '\t': json += "\\t"; break;
+      default:
+         if (c < 0x20) {
+            char escape[8];
+            snprintf(escape, sizeof(escape), "\\u%04x", c);
+            json += escape;
+         }
+         else
+            json += c;
+      }
+   }
+   json += '"';
+}
+
+//! One connected script
+class ScriptConnection final : public IPCChannelStatusCallback
+{
+public:
+   ScriptConnection()
+      : mResponder{ [this]{ Respond(); } }
+   {}
+
+   ~ScriptConnection() override
+   {
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mStopping = true;
+      }
+      mCondition.notify_all();
+      mResponder.join();
+   }
+
+   //! Block until the script disconnects
+   void Wait()
+   {
+      std::unique_lock<std::mutex> lock{ mMutex };
+      mCondition.wait(lock, [this]{ return mFinished; });
+   }
+
+   void OnConnectionError() noexcept override
+   {
+      Finish();
+   }
+
+   void OnConnect(IPCChannel &channel) noexcept override
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mChannel = &channel;
+   }
+
+   void OnDisconnect() noexcept override
+   {
+      Finish();
+   }
+
+   //! Called on the receiving thread
+   void OnDataAvailable(const void *data, size_t size) noexcept override
+   {
+      try {
+         mInput.append(static_cast<const char *>(data), size);
+         size_t offset = 0;
+         while (mInput.size() - offset >= 4) {
+            const auto length = ReadUInt32(mInput.data() + offset);
+            if (mInput.size() - offset - 4 < length)
+               break;
+            if (length >= 4)
+               Submit(ReadUInt32(mInput.data() + offset + 4),
+                  mInput.substr(offset + 8, length - 4));
+            offset += 4 + length;
+         }
+         mInput.erase(0, offset);
+      }
+      catch (...) {
+         // Out of memory; drop the rest of the input
+         mInput.clear();
+      }
+   }
+
+private:
+   struct Pending {
+      uint32_t id;
+      uint32_t index;
+      uint32_t count;
+      std::unique_ptr<PendingScriptCommand> command;
+   };
+
+   void Finish()
+   {
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mChannel = nullptr;
+         mFinished = true;
+      }
+      mCondition.notify_all();
+   }
+
+   //! Queue all commands of a request for the main thread at once
+   void Submit(uint32_t id, const std::string &request)
+   {
+      wxArrayString commands;
+      for (auto &line : wxSplit(wxString::FromUTF8(request), '\n')) {
+         line.Replace(wxT("\r"), wxT(""));
+         if (!line.empty())
+            commands.push_back(line);
+      }
+
+      std::deque<Pending> pending;
+      const auto count = static_cast<uint32_t>(commands.size());
+      for (uint32_t index = 0; index < count; ++index)
+         pending.push_back({ id, index, count,
+            ScriptCommandRelay::PostCommand(commands[index]) });
+
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         for (auto &item : pending)
+            mPending.push_back(std::move(item));
+      }
+      mCondition.notify_all();
+   }
+
+   //! Send responses in the order of the commands, as they complete
+   void Respond()
+   {
+      while (true) {
+         Pending pending;
+         {
+            std::unique_lock<std::mutex> lock{ mMutex };
+            mCondition.wait(lock,
+               [this]{ return mStopping || !mPending.empty(); });
+            // Commands already queued still run, so wait for all of them
+            if (mPending.empty())
+               return;
+            pending = std::move(mPending.front());
+            mPending.pop_front();
+         }
+
+         const auto response = pending.command->GetResponse();
+         std::string json = "{\"id\":" + std::to_string(pending.id)
+            + ",\"index\":" + std::to_string(pending.index)
+            + ",\"count\":" + std::to_string(pending.count)
+            + ",\"response\":";
+         AppendJSONString(json, response.ToStdString(wxConvUTF8));
+         json += "}\n";
+
+         std::string frame;
+         AppendUInt32(frame, static_cast<uint32_t>(json.size()));
+         frame += json;
+
+         std::lock_guard<std::mutex> lock{ mMutex };
+         if (mChannel)
+            mChannel->Send(frame.data(), frame.size());
+      }
+   }
+
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   IPCChannel *mChannel{};
+   std::deque<Pending> mPending;
+   bool mFinished{ false };
+   bool mStopping{ false };
+
+   //! Used only on the receiving thread
+   std::string mInput;
+
+   //! Constructed last
+   std::thread mResponder;
+};
+}
+
+void SocketServer()
+{
+   char socketName[108];
+   snprintf(socketName, sizeof(socketName), sockettmpl, getuid());
+
+   while (true)
+   {
+      // One script at a time
+      ScriptConnection connection;
+      try {
+         IPCServer server{ socketName, connection };
+         connection.Wait();
+      }
+      catch (const std::exception &e) {
+         printf("Unable to serve script socket: %s\n", e.what());
+         return;
+      }
+   }
+}
+
+#endif
@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+"""Tests the audacity script socket, which accepts pipelined requests.
+
+Make sure Audacity is running first and that mod-script-pipe is enabled
+before running this script.  The socket is not available on Windows.
+
+Each frame is a 32 bit little-endian byte count followed by that many bytes.
+A request holds a 32 bit little-endian id, then commands separated by
+newlines.  Each command gets its own response, a line of JSON that repeats
+the id of the request.
+
+Requires Python 3.
+
+"""
+
+import json
+import os
+import socket
+import struct
+import sys
+
+SOCKETNAME = '/tmp/audacity_script_socket.' + str(os.getuid())
+
+
+def send_request(sock, request_id, commands):
+    """Send several commands at once, without waiting for responses."""
+    payload = struct.pack('<I', request_id) + '\n'.join(commands).encode('utf-8')
+    sock.sendall(struct.pack('<I', len(payload)) + payload)
+
+
+def read_exactly(sock, length):
+    """Return length bytes from the socket."""
+    data = b''
+    while len(data) < length:
+        chunk = sock.recv(length - len(data))
+        if not chunk:
+            sys.exit('Audacity closed the socket')
+        data += chunk
+    return data
+
+
+def get_response(sock):
+    """Return the next response as a dictionary."""
+    length, = struct.unpack('<I', read_exactly(sock, 4))
+    return json.loads(read_exactly(sock, length).decode('utf-8'))
+
+
+def main():
+    if not os.path.exists(SOCKETNAME):
+        sys.exit(SOCKETNAME + ' does not exist.  '
+                 'Ensure Audacity is running with mod-script-pipe.')
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.connect(SOCKETNAME)
+
+    # Send both requests before reading anything
+    send_request(sock, 1, ['Help: Command=Help', 'Help: Command=Select'])
+    send_request(sock, 2, ['GetInfo: Type=Project Format=JSON'])
+    for _ in range(3):
+        response = get_response(sock)
+        print('Request %d, command %d of %d:' % (
+            response['id'], response['index'] + 1, response['count']))
+        print(response['response'])
+    sock.close()
+
+
+if __name__ == '__main__':
+    main()
@@ -132,6 +132,9 @@ It handles initialization and termination by subclassing wxApp.
 
 #include "ModuleManager.h"
 #include "PluginHost.h"
+#if USE_NYQUIST
+#include "effects/nyquist/NyquistJobs.h"
+#endif
 
 #include "Import.h"
 
@@ -862,7 +865,11 @@ int main(int argc, char *argv[])
    CommandLineArgs::argc = argc;
    CommandLineArgs::argv = argv;
 
-   if(PluginHost::IsHostProcess())
+   bool isHelperProcess = PluginHost::IsHostProcess();
+#if USE_NYQUIST
+   isHelperProcess = isHelperProcess || NyquistJobPool::IsJobProcess();
+#endif
+   if(isHelperProcess)
    {
       sOSXIsGUIApplication = false;
       ProcessSerialNumber psn = { 0, kCurrentProcess };
@@ -1228,7 +1235,11 @@ AudacityApp::AudacityApp()
 
 bool AudacityApp::Initialize(int& argc, wxChar** argv)
 {
-   if(!PluginHost::IsHostProcess())
+   bool isHelperProcess = PluginHost::IsHostProcess();
+#if USE_NYQUIST
+   isHelperProcess = isHelperProcess || NyquistJobPool::IsJobProcess();
+#endif
+   if(!isHelperProcess)
    {
       InitCrashreports();
    }
@@ -0,0 +1,310 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file BatchEngine.cpp
+
+**********************************************************************/
+#include "BatchEngine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <optional>
+#include <thread>
+
+#include "AudacityException.h"
+#include "BasicUI.h"
+#include "Clipboard.h"
+#include "Import.h"
+#include "ImportPlugin.h"
+#include "ImportProgressListener.h"
+#include "MemoryX.h"
+#include "Prefs.h"
+#include "ProjectFileIO.h"
+#include "ProjectFileManager.h"
+#include "ProjectManager.h"
+#include "ProjectTimeSignature.h"
+#include "Tags.h"
+#include "TempoChange.h"
+#include "WaveTrack.h"
+
+namespace {
+//! Non-positive values mean as many as there are cores
+IntSetting BatchImportThreads{ L"/Batch/ImportThreads", 0 };
+
+//! How often Run() yields to the event loop while it waits
+constexpr auto PollInterval = std::chrono::milliseconds(50);
+
+//! Shows nothing, and stops importing on cancellation
+class BatchImportProgress final : public ImportProgressListener
+{
+public:
+   BatchImportProgress(
+      ImportFileHandle &importFileHandle, const std::atomic<bool> &cancelled)
+      : mImportFileHandle{ importFileHandle }
+      , mCancelled{ cancelled }
+   {}
+
+   bool OnImportFileOpened(ImportFileHandle &) override
+   {
+      return !mCancelled.load(std::memory_order_relaxed);
+   }
+
+   void OnImportProgress(double) override
+   {
+      if (mCancelled.load(std::memory_order_relaxed))
+         mImportFileHandle.Cancel();
+   }
+
+   void OnImportResult(ImportResult result) override
+   {
+      mResult = result;
+   }
+
+   ImportResult GetResult() const { return mResult; }
+
+private:
+   ImportFileHandle &mImportFileHandle;
+   const std::atomic<bool> &mCancelled;
+   ImportResult mResult{ ImportResult::Error };
+};
+}
+
+struct BatchEngine::Job {
+   explicit Job(FilePath fileName_) : fileName{ std::move(fileName_) } {}
+
+   const FilePath fileName;
+   std::atomic<FileState> state{ FileState::Waiting };
+   TranslatableString error;
+
+   // These are created and destroyed on the main thread, but used only by
+   // the worker thread while it imports
+   std::unique_ptr<InvisibleTemporaryProject> pTemp;
+   std::unique_ptr<ImportFileHandle> pFile;
+   WaveTrackFactory *pTrackFactory{};
+   std::shared_ptr<Tags> pTags;
+   std::future<void> future;
+
+   TrackHolders tracks;
+   bool imported{ false };
+};
+
+BatchEngine::BatchEngine(AudacityProject &project,
+   std::vector<FilePath> files, size_t nWorkers)
+   : mProject{ project }
+   , mNWorkers{ nWorkers ? nWorkers
+      : BatchImportThreads.Read() > 0
+         ? static_cast<size_t>(BatchImportThreads.Read())
+      : std::max(1u, std::thread::hardware_concurrency()) }
+{
+   mJobs.reserve(files.size());
+   for (auto &file : files)
+      mJobs.push_back(std::make_unique<Job>(std::move(file)));
+}
+
+BatchEngine::~BatchEngine() = default;
+
+auto BatchEngine::GetProgress() const -> Progress
+{
+   return { mJobs.size(), mNImported.load(), mNSucceeded, mNFailed };
+}
+
+size_t BatchEngine::GetNFiles() const
+{
+   return mJobs.size();
+}
+
+const FilePath &BatchEngine::GetFile(size_t index) const
+{
+   return mJobs[index]->fileName;
+}
+
+auto BatchEngine::GetState(size_t index) const -> FileState
+{
+   return mJobs[index]->state.load();
+}
+
+const TranslatableString &BatchEngine::GetError(size_t index) const
+{
+   return mJobs[index]->error;
+}
+
+bool BatchEngine::Run(const Processor &process, const ProgressCallback &progress)
+{
+   const auto nJobs = mJobs.size();
+   size_t nLaunched = 0;
+   mCancelled = false;
+
+   // Wait for the workers and release all temporary projects, even on
+   // cancellation or exception
+   auto cleanup = finally([&]{
+      mCancelled = true;
+      for (size_t ii = 0; ii < nLaunched; ++ii) {
+         auto &job = *mJobs[ii];
+         if (job.future.valid())
+            job.future.wait();
+         job.tracks.clear();
+         job.pFile.reset();
+         job.pTags.reset();
+         job.pTemp.reset();
+      }
+   });
+
+   const auto poll = [&]{
+      BasicUI::Yield();
+      if (progress && !progress(*this))
+         mCancelled = true;
+      return !mCancelled;
+   };
+
+   for (size_t ii = 0; ii < nJobs; ++ii) {
+      // Keep all workers busy with the files after this one
+      for (; nLaunched < std::min(nJobs, ii + 1 + mNWorkers); ++nLaunched)
+         Launch(*mJobs[nLaunched]);
+
+      auto &job = *mJobs[ii];
+      while (job.future.valid() &&
+         job.future.wait_for(PollInterval) != std::future_status::ready)
+         if (!poll())
+            return false;
+      if (!poll())
+         return false;
+
+      if (job.future.valid()) {
+         try {
+            job.future.get();
+         }
+         catch (...) {
+            job.imported = false;
+         }
+         if (!job.imported) {
+            // Let Process() import it again on this thread, trying all
+            // importers and reporting errors in the usual way
+            job.tracks.clear();
+            job.pFile.reset();
+            job.pTags.reset();
+            job.pTemp.reset();
+         }
+      }
+
+      const bool success = Process(ii, process);
+      Finish(job, success);
+      if (progress && !progress(*this))
+         return false;
+   }
+   return !mCancelled;
+}
+
+void BatchEngine::Launch(Job &job)
+{
+   // Make the project and open its database here, on the main thread; the
+   // worker only adds sample blocks to it
+   job.pTemp = std::make_unique<InvisibleTemporaryProject>();
+   auto &project = job.pTemp->Project();
+   if (!ProjectFileIO::Get(project).OpenProject()) {
+      job.error = XO("Failed to open a temporary project");
+      job.pTemp.reset();
+      return;
+   }
+
+   // Choose the importer here too, reading preferences; only thread-safe
+   // importers, which read preferences in Open(), may run on the worker
+   job.pFile = Importer::Get().OpenForWorkerThread(&project, job.fileName);
+   if (!job.pFile) {
+      // Process() will import it on this thread
+      job.pTemp.reset();
+      return;
+   }
+   // No stream selection dialog:  use all streams
+   for (wxInt32 ii = 0, nn = job.pFile->GetStreamCount(); ii < nn; ++ii)
+      job.pFile->SetStreamUsage(ii, true);
+   // Build the factory and the project's rate now, which read preferences
+   job.pTrackFactory = &WaveTrackFactory::Get(project);
+   job.pTags = Tags::Get(mProject).Duplicate();
+   job.state = FileState::Importing;
+   job.future = std::async(std::launch::async, [this, &job]{ Import(job); });
+}
+
+void BatchEngine::Import(Job &job)
+{
+   auto &file = *job.pFile;
+   BatchImportProgress importProgress{ file, mCancelled };
+   if (!importProgress.OnImportFileOpened(file))
+      return;
+   std::optional<LibFileFormats::AcidizerTags> acidTags;
+   file.Import(importProgress, job.pTrackFactory, job.tracks,
+      job.pTags.get(), acidTags);
+   const auto result = importProgress.GetResult();
+   job.imported = !job.tracks.empty() &&
+      (result == ImportProgressListener::ImportResult::Success ||
+       result == ImportProgressListener::ImportResult::Stopped);
+   if (job.imported) {
+      job.state = FileState::Imported;
+      ++mNImported;
+   }
+}
+
+bool BatchEngine::Process(size_t index, const Processor &process)
+{
+   auto &job = *mJobs[index];
+   job.state = FileState::Processing;
+   return GuardedCall<bool>([&]{
+      auto &manager = ProjectFileManager::Get(mProject);
+      if (!job.pTemp) {
+         if (!job.error.empty())
+            return false;
+         // Not imported ahead
+         manager.Import(job.fileName);
+         ++mNImported;
+      }
+      else if (!job.imported)
+         return false;
+      else {
+         // Copy the samples into the project's own database
+         auto &factory =
+            WaveTrackFactory::Get(mProject).GetSampleBlockFactory();
+         TrackHolders tracks;
+         for (const auto &pTrack : job.tracks) {
+            if (const auto pWaveTrack =
+               dynamic_cast<const WaveTrack*>(pTrack.get())) {
+               auto pCopy = pWaveTrack->EmptyCopy(factory);
+               pCopy->Paste(0.0, *pWaveTrack);
+               tracks.push_back(pCopy);
+            }
+            else
+               tracks.push_back(pTrack->Duplicate());
+         }
+         job.tracks.clear();
+         const auto projectTempo =
+            ProjectTimeSignature::Get(mProject).GetTempo();
+         for (const auto &pTrack : tracks)
+            DoProjectTempoChange(*pTrack, projectTempo);
+         Tags::Set(mProject, job.pTags);
+         if (!tracks.empty())
+            manager.AddImportedTracks(job.fileName, std::move(tracks));
+      }
+      return process(index);
+   });
+}
+
+void BatchEngine::Finish(Job &job, bool success)
+{
+   // Ensure project is completely reset
+   GuardedCall([&]{ ProjectManager::Get(mProject).ResetProjectToEmpty(); });
+   // Bug2567:
+   // Must also destroy the clipboard, to be sure sample blocks are
+   // all freed and their ids can be reused safely in the next pass
+   Clipboard::Get().Clear();
+
+   // Free the blocks before closing the database that holds them
+   job.tracks.clear();
+   job.pFile.reset();
+   job.pTags.reset();
+   job.pTemp.reset();
+   job.state = success ? FileState::Succeeded : FileState::Failed;
+   ++(success ? mNSucceeded : mNFailed);
+   if (!success && job.error.empty())
+      job.error = XO("Macro failed on \"%s\"").Format(job.fileName);
+}
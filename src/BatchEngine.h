@@ -0,0 +1,106 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file BatchEngine.h
+  @brief Applies macros to many files, importing them concurrently
+
+**********************************************************************/
+#ifndef __AUDACITY_BATCH_ENGINE__
+#define __AUDACITY_BATCH_ENGINE__
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Identifier.h"
+#include "TranslatableString.h"
+
+class AudacityProject;
+
+//! Imports a list of files on worker threads, and hands them one at a time
+//! to the main thread for processing in a project
+/*!
+ Each file is imported into its own invisible temporary project, which has its
+ own database connection and sample block factory, so that the imports share
+ nothing.  Commands in macros may show dialogs and need the project window, so
+ the imported tracks are then copied into the given project and processed
+ there, in the order of the files, while the next files are importing.
+
+ Preferences are read, and the importer chosen, on the main thread.  Only
+ files whose importer is thread-safe (see ImportPlugin::IsThreadSafe) import
+ on workers; that includes the PCM, FLAC, Ogg Vorbis, Opus, MP3, WavPack and
+ FFmpeg importers.  Any other file imports on the main thread when its turn
+ comes, since its importer may read preferences or show dialogs.
+
+ The copy into the given project writes every sample block again, on the main
+ thread, so the batch gains most where decoding costs more than writing the
+ samples, as for compressed files; an uncompressed file may gain little.
+
+ At most GetNWorkers() files import at once.  Failure of one file is recorded
+ and does not stop the batch; only cancellation does.  The project is reset to
+ empty after each file.
+ */
+class AUDACITY_DLL_API BatchEngine final
+{
+public:
+   enum class FileState {
+      Waiting,
+      Importing,
+      Imported,
+      Processing,
+      Succeeded,
+      Failed,
+   };
+
+   //! Counts of files
+   struct Progress {
+      size_t total{};
+      size_t imported{};
+      size_t succeeded{};
+      size_t failed{};
+   };
+
+   //! Process file number `index`, whose tracks are now in the project
+   /*! Called on the main thread.  @return false on failure */
+   using Processor = std::function<bool(size_t index)>;
+   //! Called on the main thread, often; @return false to cancel
+   using ProgressCallback = std::function<bool(const BatchEngine &)>;
+
+   //! @param nWorkers if zero, use the preference, or else the number of cores
+   BatchEngine(AudacityProject &project,
+      std::vector<FilePath> files, size_t nWorkers = 0);
+   ~BatchEngine();
+
+   //! Import and process all files; must be called on the main thread
+   /*! @return false if cancelled */
+   bool Run(const Processor &process, const ProgressCallback &progress = {});
+
+   size_t GetNWorkers() const { return mNWorkers; }
+   Progress GetProgress() const;
+   size_t GetNFiles() const;
+   const FilePath &GetFile(size_t index) const;
+   FileState GetState(size_t index) const;
+   //! Why file number `index` failed, or empty
+   const TranslatableString &GetError(size_t index) const;
+
+private:
+   struct Job;
+
+   void Launch(Job &job);
+   void Import(Job &job);
+   bool Process(size_t index, const Processor &process);
+   void Finish(Job &job, bool success);
+
+   AudacityProject &mProject;
+   const size_t mNWorkers;
+   std::vector<std::unique_ptr<Job>> mJobs;
+   std::atomic<size_t> mNImported{ 0 };
+   size_t mNSucceeded{ 0 };
+   size_t mNFailed{ 0 };
+   std::atomic<bool> mCancelled{ false };
+};
+
+#endif
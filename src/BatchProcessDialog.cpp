@@ -34,6 +34,7 @@
 #include <wx/imaglist.h>
 #include <wx/settings.h>
 
+#include "BatchEngine.h"
 #include "Clipboard.h"
 #include "ShuttleGui.h"
 #include "MenuCreator.h"
@@ -41,7 +42,6 @@
 #include "Project.h"
 #include "ProjectFileManager.h"
 #include "ProjectHistory.h"
-#include "ProjectManager.h"
 #include "ProjectWindows.h"
 #include "SelectUtilities.h"
 #include "Track.h"
@@ -393,7 +393,7 @@ void ApplyMacroDialog::OnApplyToFiles(wxCommandEvent & WXUNUSED(event))
          fileList = S.Id(CommandsListID)
             .Style(wxSUNKEN_BORDER | wxLC_REPORT | wxLC_HRULES | wxLC_VRULES |
                 wxLC_SINGLE_SEL)
-            .AddListControlReportMode( { XO("File") } );
+            .AddListControlReportMode( { XO("File"), XO("Status") } );
          // AssignImageList takes ownership
          fileList->AssignImageList(imageList.release(), wxIMAGE_LIST_SMALL);
       }
@@ -453,37 +453,58 @@ void ApplyMacroDialog::OnApplyToFiles(wxCommandEvent & WXUNUSED(event))
       Clipboard::Scope scope;
 
       wxWindowDisabler wd(&activityWin);
-      for (i = 0; i < (int)files.size(); i++) {
-         if (i > 0) {
-            //Clear the arrow in previous item.
-            fileList->SetItemImage(i - 1, 0, 0);
+      BatchEngine engine{ *project,
+         { files.begin(), files.end() } };
+      using FileState = BatchEngine::FileState;
+      std::vector<FileState> shown(files.size(), FileState::Waiting);
+      const auto stateName = [](FileState state) -> TranslatableString {
+         switch (state) {
+         case FileState::Importing:
+            return XO("Importing");
+         case FileState::Imported:
+            return XO("Imported");
+         case FileState::Processing:
+            return XO("Applying");
+         case FileState::Succeeded:
+            return XO("Done");
+         case FileState::Failed:
+            return XO("Failed");
+         default:
+            return {};
          }
-         fileList->SetItemImage(i, 1, 1);
-         fileList->EnsureVisible(i);
-
-         auto success = GuardedCall<bool>([&] {
-            ProjectFileManager::Get(*project).Import(files[i]);
-            Viewport::Get(*project).ZoomFitHorizontallyAndShowTrack(nullptr);
-            SelectUtilities::DoSelectAll(*project);
-            if (!mMacroCommands.ApplyMacro(mCatalog))
-               return false;
-
-            if (!activityWin.IsShown() || mAbort)
-               return false;
-
-            return true;
-         });
-
-         // Ensure project is completely reset
-         ProjectManager::Get(*project).ResetProjectToEmpty();
-         // Bug2567:
-         // Must also destroy the clipboard, to be sure sample blocks are
-         // all freed and their ids can be reused safely in the next pass
-         globalClipboard.Clear();
-
-         if (!success)
-            break;
-      }
+      };
+      const auto title = activityWin.GetTitle();
+
+      const auto progress = [&](const BatchEngine &engine) {
+         for (size_t ii = 0; ii < shown.size(); ++ii) {
+            const auto state = engine.GetState(ii);
+            if (state == shown[ii])
+               continue;
+            shown[ii] = state;
+            fileList->SetItemImage(ii, state == FileState::Processing ? 1 : 0);
+            fileList->SetItem(ii, 1, state == FileState::Failed
+               ? engine.GetError(ii).Translation()
+               : stateName(state).Translation());
+            if (state == FileState::Processing)
+               fileList->EnsureVisible(ii);
+         }
+         const auto counts = engine.GetProgress();
+         activityWin.SetTitle(
+            /* i18n-hint: The first %s is the title of the macro window */
+            XO("%s - %d of %d done, %d failed")
+               .Format(title,
+                  static_cast<int>(counts.succeeded + counts.failed),
+                  static_cast<int>(counts.total),
+                  static_cast<int>(counts.failed))
+               .Translation());
+         return activityWin.IsShown() && !mAbort;
+      };
+
+      engine.Run([&](size_t) {
+         Viewport::Get(*project).ZoomFitHorizontallyAndShowTrack(nullptr);
+         SelectUtilities::DoSelectAll(*project);
+         return mMacroCommands.ApplyMacro(mCatalog);
+      }, progress);
    }
 
    Show();
@@ -34,6 +34,7 @@ the mouse around.
 #include "FreqWindow.h"
 
 #include <algorithm>
+#include <chrono>
 
 #include <wx/setup.h> // for wxUSE_* macros
 
@@ -73,6 +74,7 @@ the mouse around.
 #include "SelectFile.h"
 #include "ShuttleGui.h"
 #include "Theme.h"
+#include "TimeStretching.h"
 #include "ViewInfo.h"
 
 #include "FileNames.h"
@@ -114,6 +116,9 @@ enum {
 #define FREQ_WINDOW_WIDTH 480
 #define FREQ_WINDOW_HEIGHT 330
 
+// Least time between redrawings of partial results
+static constexpr auto RefreshInterval = std::chrono::milliseconds(250);
+
 static const char * ZoomIn[] = {
 "16 16 6 1",
 " 	c None",
@@ -581,83 +586,81 @@ bool FrequencyPlotDialog::Show(bool show)
    return res;
 }
 
+namespace {
+void ShowAnalysisError()
+{
+   using namespace BasicUI;
+   ShowMessageBox(
+      XO("Audio could not be analyzed. This may be due to a stretched or pitch-shifted clip.\nTry resetting any stretched clips, or mixing and rendering the tracks before analyzing"),
+      MessageBoxOptions {}.Caption(XO("Error")).IconStyle(Icon::Error));
+}
+}
+
 bool FrequencyPlotDialog::GetAudio()
 {
-   mData.reset();
+   mTracks.clear();
+   mStart = 0;
    mDataLen = 0;
 
-   int selcount = 0;
-   bool warning = false;
+   auto &selectedRegion = ViewInfo::Get(*mProject).selectedRegion;
+   const auto t0 = selectedRegion.t0(), t1 = selectedRegion.t1();
    for (auto track :
       TrackList::Get(*mProject).Selected<const WaveTrack>()
    ) {
-      auto &selectedRegion = ViewInfo::Get(*mProject).selectedRegion;
-      auto start = track->TimeToLongSamples(selectedRegion.t0());
-      if (selcount == 0) {
+      if (mTracks.empty()) {
          mRate = track->GetRate();
-         auto end = track->TimeToLongSamples(selectedRegion.t1());
-         auto dataLen = end - start;
-         // Permit approximately 46.60 minutes of selected samples at
-         // a sampling frequency of 48 kHz (11.65 minutes at 192 kHz).
-         auto maxDataLen = size_t(2) << 26;
-         if (dataLen > maxDataLen) {
-            warning = true;
-            mDataLen = maxDataLen;
-         }
-         else
-            mDataLen = dataLen.as_size_t();
-         mData = Floats{ mDataLen };
+         mStart = track->TimeToLongSamples(t0);
+         const auto end = track->TimeToLongSamples(t1);
+         mDataLen = std::max<long long>(0, (end - mStart).as_long_long());
       }
-      const auto nChannels = track->NChannels();
       if (track->GetRate() != mRate) {
          using namespace BasicUI;
          ShowMessageBox(
             XO("To plot the spectrum, all selected tracks must have the same sample rate."),
             MessageBoxOptions {}.Caption(XO("Error")).IconStyle(Icon::Error));
-         mData.reset();
+         mTracks.clear();
          mDataLen = 0;
          return false;
       }
-      Floats buffer1{ mDataLen };
-      Floats buffer2{ mDataLen };
-      float *const buffers[]{ buffer1.get(), buffer2.get() };
-      // Don't allow throw for bad reads
-      if (!track->GetFloats(
-             0, nChannels, buffers, start, mDataLen, false,
-             FillFormat::fillZero, false))
-      {
-         using namespace BasicUI;
-         ShowMessageBox(
-            XO("Audio could not be analyzed. This may be due to a stretched or pitch-shifted clip.\nTry resetting any stretched clips, or mixing and rendering the tracks before analyzing"),
-            MessageBoxOptions {}.Caption(XO("Error")).IconStyle(Icon::Error));
-         mData.reset();
+      if (TimeStretching::HasPitchOrSpeed(*track, t0, t1)) {
+         ShowAnalysisError();
+         mTracks.clear();
          mDataLen = 0;
          return false;
       }
-      size_t iChannel = 0;
-      if (selcount == 0) {
-         // First channel -- assign into mData
-         for (size_t i = 0; i < mDataLen; i++)
-            mData[i] = buffers[0][i];
-         ++iChannel;
-      }
-      // Later channels -- accumulate
-      for (; iChannel < nChannels; ++iChannel) {
-         const auto buffer = buffers[iChannel];
-         for (size_t i = 0; i < mDataLen; i++)
-            mData[i] += buffer[i];
-      }
-      ++selcount;
+      // The copy shares sample blocks with the original, so it costs little
+      // even for long selections
+      mTracks.push_back(
+         std::static_pointer_cast<const WaveTrack>(track->Duplicate()));
    }
 
-   if (selcount == 0)
-      return false;
+   return !mTracks.empty();
+}
 
-   if (warning) {
-      auto msg = XO(
-"Too much audio was selected. Only the first %.1f seconds of audio will be analyzed.")
-         .Format(mDataLen / mRate);
-      AudacityMessageBox( msg );
+bool FrequencyPlotDialog::ReadMixed(
+   unsigned long long start, size_t len, float *buffer)
+{
+   mMixBuffer.resize(2 * len);
+   float *const buffers[]{ mMixBuffer.data(), mMixBuffer.data() + len };
+   bool first = true;
+   for (const auto &pTrack : mTracks) {
+      const auto nChannels = pTrack->NChannels();
+      // Don't allow throw for bad reads
+      if (!pTrack->GetFloats(
+             0, nChannels, buffers, mStart + start, len, false,
+             FillFormat::fillZero, false))
+         return false;
+      for (size_t iChannel = 0; iChannel < nChannels; ++iChannel) {
+         const auto channel = buffers[iChannel];
+         if (first)
+            // First channel -- assign
+            std::copy(channel, channel + len, buffer);
+         else
+            // Later channels -- accumulate
+            for (size_t i = 0; i < len; i++)
+               buffer[i] += channel[i];
+         first = false;
+      }
    }
    return true;
 }
@@ -695,7 +698,7 @@ void FrequencyPlotDialog::DrawBackground(wxMemoryDC & dc)
 
 void FrequencyPlotDialog::DrawPlot()
 {
-   if (!mData || mDataLen < mWindowSize || mAnalyst->GetProcessedSize() == 0) {
+   if (mTracks.empty() || mDataLen < mWindowSize || mAnalyst->GetProcessedSize() == 0) {
       wxMemoryDC memDC;
 
       vRuler->ruler.SetUpdater(&LinearUpdater::Instance());
@@ -913,7 +916,7 @@ void FrequencyPlotDialog::PlotPaint(wxPaintEvent & event)
 
    dc.DrawBitmap( *mBitmap, 0, 0, true );
    // Fix for Bug 1226 "Plot Spectrum freezes... if insufficient samples selected"
-   if (!mData || mDataLen < mWindowSize)
+   if (mTracks.empty() || mDataLen < mWindowSize)
       return;
 
    dc.SetFont(mFreqFont);
@@ -1023,7 +1026,7 @@ void FrequencyPlotDialog::OnCloseButton(wxCommandEvent & WXUNUSED(event))
    gPrefs->Write(wxT("/FrequencyPlotDialog/FuncChoice"), mFuncChoice->GetSelection());
    gPrefs->Write(wxT("/FrequencyPlotDialog/AxisChoice"), mAxisChoice->GetSelection());
    gPrefs->Flush();
-   mData.reset();
+   mTracks.clear();
    Show(false);
 }
 
@@ -1035,7 +1038,7 @@ void FrequencyPlotDialog::SendRecalcEvent()
 
 void FrequencyPlotDialog::Recalc()
 {
-   if (!mData || mDataLen < mWindowSize) {
+   if (mTracks.empty() || mDataLen < mWindowSize) {
       DrawPlot();
       return;
    }
@@ -1055,14 +1058,36 @@ void FrequencyPlotDialog::Recalc()
          blocker.emplace(this);
       wxYieldIfNeeded();
 
-      mAnalyst->Calculate(alg, windowFunc, mWindowSize, mRate,
-         mData.get(), mDataLen,
-         &mYMin, &mYMax, mProgress);
+      // Show coarser results while the calculation continues, at first as
+      // soon as there are any
+      using Clock = std::chrono::steady_clock;
+      auto lastShown = Clock::now() - RefreshInterval;
+      const auto refresh = [&]{
+         const auto now = Clock::now();
+         if (IsShown() && now - lastShown >= RefreshInterval) {
+            ShowResults(alg);
+            mFreqPlot->Update();
+            lastShown = now;
+         }
+         return true;
+      };
+
+      if (!mAnalyst->Calculate(alg, windowFunc, mWindowSize, mRate,
+         [this](unsigned long long start, size_t len, float *buffer) {
+            return ReadMixed(start, len, buffer);
+         }, mDataLen,
+         &mYMin, &mYMax, mProgress, refresh))
+         ShowAnalysisError();
    }
    if (hadFocus) {
       hadFocus->SetFocus();
    }
 
+   ShowResults(alg);
+}
+
+void FrequencyPlotDialog::ShowResults(SpectrumAnalyst::Algorithm alg)
+{
    if (alg == SpectrumAnalyst::Spectrum) {
       if(mYMin < -dBRange)
          mYMin = -dBRange;
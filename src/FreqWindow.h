@@ -11,11 +11,12 @@
 #ifndef __AUDACITY_FREQ_WINDOW__
 #define __AUDACITY_FREQ_WINDOW__
 
+#include <memory>
 #include <vector>
 #include <wx/font.h> // member variable
 #include <wx/statusbr.h> // to inherit
 #include "Prefs.h"
-#include "SampleFormat.h"
+#include "SampleCount.h"
 #include "SpectrumAnalyst.h"
 #include "wxPanelWrapper.h" // to inherit
 
@@ -31,6 +32,7 @@ class AudacityProject;
 class FrequencyPlotDialog;
 class FreqGauge;
 class RulerPanel;
+class WaveTrack;
 
 DECLARE_EXPORTED_EVENT_TYPE(AUDACITY_DLL_API, EVT_FREQWINDOW_RECALC, -1);
 
@@ -68,6 +70,9 @@ private:
    void Populate();
 
    bool GetAudio();
+   //! Mix `len` samples of the selected tracks, beginning `start` samples
+   //! into the selection
+   bool ReadMixed(unsigned long long start, size_t len, float *buffer);
 
    void PlotMouseEvent(wxMouseEvent & event);
    void PlotPaint(wxPaintEvent & event);
@@ -89,6 +94,8 @@ private:
 
    void SendRecalcEvent();
    void Recalc();
+   //! Adjust the vertical range to the results of mAnalyst, and draw them
+   void ShowResults(SpectrumAnalyst::Algorithm alg);
    void DrawPlot();
    void DrawBackground(wxMemoryDC & dc);
 
@@ -137,8 +144,12 @@ private:
 
 
    double mRate;
-   size_t mDataLen;
-   Floats mData;
+   //! Copies of the selected tracks, as they were when GetAudio() was
+   //! called; they are read in pieces for each recalculation
+   std::vector<std::shared_ptr<const WaveTrack>> mTracks;
+   sampleCount mStart;
+   unsigned long long mDataLen;
+   std::vector<float> mMixBuffer;
    size_t mWindowSize;
 
    bool mLogAxis;
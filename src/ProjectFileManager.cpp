@@ -20,6 +20,7 @@ Paul Licameli split from AudacityProject.cpp
 #include "AudacityMessageBox.h"
 #include "AudacityMirProject.h"
 #include "BasicUI.h"
+#include "BufferedMirAudioReader.h"
 #include "ClipMirAudioReader.h"
 #include "CodeConversions.h"
 #include "Export.h"
@@ -28,6 +29,7 @@ Paul Licameli split from AudacityProject.cpp
 #include "ImportPlugin.h"
 #include "ImportProgressListener.h"
 #include "Legacy.h"
+#include "MirAnalysisService.h"
 #include "MusicInformationRetrieval.h"
 #include "PlatformCompatibility.h"
 #include "Project.h"
@@ -51,8 +53,8 @@ Paul Licameli split from AudacityProject.cpp
 #include "TimeDisplayMode.h"
 #include "TrackFocus.h"
 #include "TrackPanel.h"
+#include "UndoManager.h"
 #include "UndoTracks.h"
-#include "UserException.h"
 #include "WaveClip.h"
 #include "WaveTrack.h"
 #include "WaveTrackUtilities.h"
@@ -68,6 +70,7 @@ Paul Licameli split from AudacityProject.cpp
 #include "ProjectFileIOExtension.h"
 
 #include <optional>
+#include <unordered_set>
 #include <wx/frame.h>
 #include <wx/log.h>
 
@@ -1367,39 +1370,77 @@ bool ProjectFileManager::Import(const FilePath& fileName, bool addToHistory)
 
 namespace
 {
-std::vector<std::shared_ptr<MIR::AnalyzedAudioClip>> RunTempoDetection(
-   const std::vector<std::shared_ptr<ClipMirAudioReader>>& readers,
-   const MIR::ProjectInterface& project, bool projectWasEmpty)
+//! Whether all the clips are still in the project's tracks
+bool ClipsArePresent(AudacityProject& project,
+   const std::vector<std::shared_ptr<ClipMirAudioReader>>& readers)
 {
-   const auto isBeatsAndMeasures = project.ViewIsBeatsAndMeasures();
-   const auto projectTempo = project.GetTempo();
-
-   using namespace BasicUI;
-   auto progress = MakeProgress(
-      XO("Music Information Retrieval"), XO("Analyzing imported audio"),
-      ProgressShowCancel);
-   auto count = 0;
-   const auto reportProgress = [&](double progressFraction) {
-      const auto result = progress->Poll(
-         (count + progressFraction) / readers.size() * 1000, 1000);
-      if (result != ProgressResult::Success)
-         throw UserException {};
-   };
+   std::unordered_set<const WaveTrack::Interval*> clips;
+   for (const auto pTrack : TrackList::Get(project).Any<const WaveTrack>())
+      for (const auto& pInterval : pTrack->Intervals())
+         clips.insert(pInterval.get());
+   return std::all_of(readers.begin(), readers.end(), [&](const auto& reader) {
+      return clips.count(reader->clip.get()) > 0;
+   });
+}
 
-   std::vector<std::shared_ptr<MIR::AnalyzedAudioClip>> analyzedClips;
-   analyzedClips.reserve(readers.size());
-   std::transform(
-      readers.begin(), readers.end(), std::back_inserter(analyzedClips),
-      [&](const std::shared_ptr<ClipMirAudioReader>& reader) {
-         const MIR::ProjectSyncInfoInput input {
-            *reader,      reader->filename, reader->tags,       reportProgress,
+//! Analyze the clips on worker threads; synchronize the project with them on
+//! the main thread when all are done, if the project still exists, and was
+//! not edited meanwhile
+void StartTempoDetection(
+   AudacityProject& project,
+   std::vector<std::shared_ptr<ClipMirAudioReader>> readers,
+   bool projectWasEmpty)
+{
+   std::vector<MIR::AnalysisService::Request> requests;
+   {
+      const AudacityMirProject mirInterface { project };
+      const auto isBeatsAndMeasures = mirInterface.ViewIsBeatsAndMeasures();
+      const auto projectTempo = mirInterface.GetTempo();
+      requests.reserve(readers.size());
+      for (const auto& reader : readers)
+      {
+         // Copy the audio now, so that the workers don't read the clip while
+         // it is edited
+         const auto source = std::make_shared<MIR::BufferedMirAudioReader>(
+            *reader, MIR::maxAnalyzedSignalDuration);
+         MIR::AnalysisService::Request request {
+            source,       reader->filename, reader->tags,
             projectTempo, projectWasEmpty,  isBeatsAndMeasures,
          };
-         auto syncInfo = MIR::GetProjectSyncInfo(input);
-         ++count;
-         return std::make_shared<AnalyzedWaveClip>(reader, syncInfo);
+         if (source->HasSamples())
+            request.contentHash = source->GetContentHash();
+         requests.push_back(std::move(request));
+      }
+   }
+
+   // Any undo, redo, or further edit makes the analysis, and projectWasEmpty,
+   // stale
+   auto &undoManager = UndoManager::Get(project);
+   const auto undoState = undoManager.GetCurrentState();
+   const auto numUndoStates = undoManager.GetNumStates();
+
+   std::weak_ptr<AudacityProject> wProject = project.shared_from_this();
+   MIR::AnalysisService::Get().Analyze(
+      std::move(requests), [=](MIR::AnalysisService::Results results) {
+         BasicUI::CallAfter([=] {
+            const auto pProject = wProject.lock();
+            if (!pProject)
+               return;
+            auto &undoManager = UndoManager::Get(*pProject);
+            if (undoManager.GetCurrentState() != undoState ||
+                undoManager.GetNumStates() != numUndoStates ||
+                !ClipsArePresent(*pProject, readers))
+               return;
+            std::vector<std::shared_ptr<MIR::AnalyzedAudioClip>> analyzedClips;
+            analyzedClips.reserve(readers.size());
+            for (size_t i = 0; i < readers.size(); ++i)
+               analyzedClips.push_back(
+                  std::make_shared<AnalyzedWaveClip>(readers[i], results[i]));
+            AudacityMirProject mirInterface { *pProject };
+            MIR::SynchronizeProject(
+               analyzedClips, mirInterface, projectWasEmpty);
+         });
       });
-   return analyzedClips;
 }
 } // namespace
 
@@ -1418,15 +1459,8 @@ bool ProjectFileManager::Import(
          return success;
       });
    if (success && !resultingReaders.empty())
-   {
-      const auto pProj = mProject.shared_from_this();
-      BasicUI::CallAfter([=] {
-         AudacityMirProject mirInterface { *pProj };
-         const auto analyzedClips =
-            RunTempoDetection(resultingReaders, mirInterface, projectWasEmpty);
-         MIR::SynchronizeProject(analyzedClips, mirInterface, projectWasEmpty);
-      });
-   }
+      StartTempoDetection(
+         mProject, std::move(resultingReaders), projectWasEmpty);
    return success;
 }
 
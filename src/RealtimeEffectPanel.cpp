@@ -1175,6 +1175,7 @@ RealtimeEffectPanel::RealtimeEffectPanel(
          if (
             message.type == UndoRedoMessage::Type::Purge ||
             message.type == UndoRedoMessage::Type::BeginPurge ||
+            message.type == UndoRedoMessage::Type::CommitPurge ||
             message.type == UndoRedoMessage::Type::EndPurge)
             return;
 
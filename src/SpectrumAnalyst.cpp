@@ -24,10 +24,16 @@ and in the spectrogram spectral selection.
 
 #include "SpectrumAnalyst.h"
 #include "FFT.h"
+#include "WelchAverager.h"
 
 #include "SampleFormat.h"
 #include <wx/dcclient.h>
 
+namespace {
+//! Steps of the progress gauge
+constexpr int ProgressRange = 1000;
+}
+
 FreqGauge::FreqGauge(wxWindow * parent, wxWindowID winid)
 :  wxStatusBar(parent, winid, wxST_SIZEGRIP)
 {
@@ -93,6 +99,21 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
                                 const float *data, size_t dataLen,
                                 float *pYMin, float *pYMax,
                                 FreqGauge *progress)
+{
+   return Calculate(alg, windowFunc, windowSize, rate,
+      [data](unsigned long long start, size_t len, float *buffer) {
+         std::copy(data + start, data + start + len, buffer);
+         return true;
+      },
+      dataLen, pYMin, pYMax, progress);
+}
+
+bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
+                                size_t windowSize, double rate,
+                                const Reader &reader,
+                                unsigned long long dataLen,
+                                float *pYMin, float *pYMax,
+                                FreqGauge *progress, const Refresh &refresh)
 {
    // Wipe old data
    mProcessed.resize(0);
@@ -121,9 +142,6 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
    auto half = mWindowSize / 2;
    mProcessed.resize(mWindowSize);
 
-   Floats in{ mWindowSize };
-   Floats out{ mWindowSize };
-   Floats out2{ mWindowSize };
    Floats win{ mWindowSize };
 
    for (size_t i = 0; i < mWindowSize; i++) {
@@ -143,36 +161,35 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
    else
       wss = 1.0;
 
-   if (progress) {
-      progress->SetRange(dataLen);
-   }
-
-   size_t start = 0;
-   int windows = 0;
-   while (start + mWindowSize <= dataLen) {
-      for (size_t i = 0; i < mWindowSize; i++)
-         in[i] = win[i] * data[start + i];
-
+   // Sum the results for some windows; this may run on any thread
+   const auto analysis = [&](float *in, size_t nFrames, float *sums) {
+      const auto size = mWindowSize;
       switch (alg) {
          case Spectrum:
-            PowerSpectrum(mWindowSize, in.get(), out.get());
+         {
+            const auto nBins = half + 1;
+            std::vector<float> out(nFrames * nBins);
+            PowerSpectra(size, nFrames, in, out.data());
 
-            for (size_t i = 0; i < half; i++)
-               mProcessed[i] += out[i];
+            for (size_t frame = 0; frame < nFrames; ++frame)
+               for (size_t i = 0; i < half; i++)
+                  sums[i] += out[frame * nBins + i];
             break;
+         }
 
          case Autocorrelation:
          case CubeRootAutocorrelation:
          case EnhancedAutocorrelation:
-
+         {
+            std::vector<float> out(nFrames * size), out2(nFrames * size);
             // Take FFT
-            RealFFT(mWindowSize, in.get(), out.get(), out2.get());
+            RealFFTs(size, nFrames, in, out.data(), out2.data());
             // Compute power
-            for (size_t i = 0; i < mWindowSize; i++)
+            for (size_t i = 0; i < nFrames * size; i++)
                in[i] = (out[i] * out[i]) + (out2[i] * out2[i]);
 
             if (alg == Autocorrelation) {
-               for (size_t i = 0; i < mWindowSize; i++)
+               for (size_t i = 0; i < nFrames * size; i++)
                   in[i] = sqrt(in[i]);
             }
             if (alg == CubeRootAutocorrelation ||
@@ -180,70 +197,100 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
                // Tolonen and Karjalainen recommend taking the cube root
                // of the power, instead of the square root
 
-               for (size_t i = 0; i < mWindowSize; i++)
+               for (size_t i = 0; i < nFrames * size; i++)
                   in[i] = pow(in[i], 1.0f / 3.0f);
             }
             // Take FFT
-            RealFFT(mWindowSize, in.get(), out.get(), out2.get());
+            RealFFTs(size, nFrames, in, out.data(), out2.data());
 
             // Take real part of result
-            for (size_t i = 0; i < half; i++)
-               mProcessed[i] += out[i];
+            for (size_t frame = 0; frame < nFrames; ++frame)
+               for (size_t i = 0; i < half; i++)
+                  sums[i] += out[frame * size + i];
             break;
+         }
 
          case Cepstrum:
-            RealFFT(mWindowSize, in.get(), out.get(), out2.get());
+         {
+            std::vector<float> out(nFrames * size), out2(nFrames * size);
+            RealFFTs(size, nFrames, in, out.data(), out2.data());
 
             // Compute log power
             // Set a sane lower limit assuming maximum time amplitude of 1.0
+            float power;
+            float minpower = 1e-20*size*size;
+            for (size_t i = 0; i < nFrames * size; i++)
             {
-               float power;
-               float minpower = 1e-20*mWindowSize*mWindowSize;
-               for (size_t i = 0; i < mWindowSize; i++)
-               {
-                  power = (out[i] * out[i]) + (out2[i] * out2[i]);
-                  if(power < minpower)
-                     in[i] = log(minpower);
-                  else
-                     in[i] = log(power);
-               }
+               power = (out[i] * out[i]) + (out2[i] * out2[i]);
+               if(power < minpower)
+                  in[i] = log(minpower);
+               else
+                  in[i] = log(power);
+            }
+            for (size_t frame = 0; frame < nFrames; ++frame) {
                // Take IFFT
-               InverseRealFFT(mWindowSize, in.get(), NULL, out.get());
+               InverseRealFFT(size, in + frame * size, NULL, out.data());
 
                // Take real part of result
                for (size_t i = 0; i < half; i++)
-                  mProcessed[i] += out[i];
+                  sums[i] += out[i];
             }
-
             break;
+         }
 
          default:
             wxASSERT(false);
             break;
       }                         //switch
+   };
 
-      // Update the progress bar
+   if (progress) {
+      progress->SetRange(ProgressRange);
+   }
+
+   // Report progress, and maybe an intermediate result, after each round
+   const auto onRound = [&](const WelchAverager &averager) {
       if (progress) {
-         progress->SetValue(start);
+         // Update the progress bar
+         progress->SetValue(
+            ProgressRange * averager.GetNWindows() /
+               averager.GetTotalWindows());
       }
+      if (!refresh)
+         return true;
+      Finish(averager, wss, pYMin, pYMax);
+      return refresh();
+   };
 
-      start += half;
-      windows++;
-   }
+   WelchAverager averager{ win.get(), mWindowSize };
+   const auto completed = averager.Process(dataLen, reader, analysis, onRound);
 
    if (progress) {
       // Reset for next time
       progress->Reset();
    }
 
+   if (!completed) {
+      mProcessed.resize(0);
+      return false;
+   }
+
+   Finish(averager, wss, pYMin, pYMax);
+   return true;
+}
+
+void SpectrumAnalyst::Finish(const WelchAverager &averager, double scale,
+   float *pYMin, float *pYMax)
+{
+   auto half = mWindowSize / 2;
+   averager.GetAverage(mProcessed.data());
+
    float mYMin = 1000000, mYMax = -1000000;
-   double scale;
-   switch (alg) {
+   switch (mAlg) {
    case Spectrum:
       // Convert to decibels
       mYMin = 1000000.;
       mYMax = -1000000.;
-      scale = wss / (double)windows;
       for (size_t i = 0; i < half; i++)
       {
          mProcessed[i] = 10 * log10(mProcessed[i] * scale);
@@ -256,9 +303,6 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
 
    case Autocorrelation:
    case CubeRootAutocorrelation:
-      for (size_t i = 0; i < half; i++)
-         mProcessed[i] = mProcessed[i] / windows;
-
       // Find min/max
       mYMin = mProcessed[0];
       mYMax = mProcessed[0];
@@ -270,12 +314,11 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
       break;
 
    case EnhancedAutocorrelation:
-      for (size_t i = 0; i < half; i++)
-         mProcessed[i] = mProcessed[i] / windows;
-
+   {
       // Peak Pruning as described by Tolonen and Karjalainen, 2000
 
       // Clip at zero, copy to temp array
+      Floats out{ half };
       for (size_t i = 0; i < half; i++) {
          if (mProcessed[i] < 0.0)
             mProcessed[i] = float(0.0);
@@ -304,11 +347,9 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
          else if (mProcessed[i] < mYMin)
             mYMin = mProcessed[i];
       break;
+   }
 
    case Cepstrum:
-      for (size_t i = 0; i < half; i++)
-         mProcessed[i] = mProcessed[i] / windows;
-
       // Find min/max, ignoring first and last few values
       {
          size_t ignore = 4;
@@ -331,8 +372,6 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
       *pYMin = mYMin;
    if (pYMax)
       *pYMax = mYMax;
-
-   return true;
 }
 
 const float *SpectrumAnalyst::GetProcessed() const
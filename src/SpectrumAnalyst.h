@@ -12,10 +12,12 @@
 #ifndef __AUDACITY_SPECTRUM_ANALYST__
 #define __AUDACITY_SPECTRUM_ANALYST__
 
+#include <functional>
 #include <vector>
 #include <wx/statusbr.h>
 
 class FreqGauge;
+class WelchAverager;
 
 class AUDACITY_DLL_API SpectrumAnalyst
 {
@@ -31,6 +33,14 @@ public:
       NumAlgorithms
    };
 
+   //! Fills `buffer` with `len` samples beginning at `start`; return false
+   //! if that fails
+   using Reader =
+      std::function<bool(unsigned long long start, size_t len, float *buffer)>;
+   //! Called now and then while calculating, when GetProcessed() gives a
+   //! coarser version of the final result; return false to stop
+   using Refresh = std::function<bool()>;
+
    SpectrumAnalyst();
    ~SpectrumAnalyst();
 
@@ -42,6 +52,19 @@ public:
       float *pYMin = NULL, float *pYMax = NULL, // outputs
       FreqGauge *progress = NULL);
 
+   //! Calculate from samples read in pieces, which need not all be in memory
+   /*!
+    The windows are analyzed on several threads, and in an order that makes
+    the intermediate results passed to `refresh` representative of all of
+    the data.
+    */
+   bool Calculate(Algorithm alg,
+      int windowFunc, // see FFT.h for values
+      size_t windowSize, double rate,
+      const Reader &reader, unsigned long long dataLen,
+      float *pYMin, float *pYMax, // outputs
+      FreqGauge *progress, const Refresh &refresh = {});
+
    const float *GetProcessed() const;
    int GetProcessedSize() const;
 
@@ -49,6 +72,10 @@ public:
    float FindPeak(float xPos, float *pY) const;
 
 private:
+   //! Compute mProcessed from the averages of the windows analyzed so far
+   void Finish(const WelchAverager &averager, double scale,
+      float *pYMin, float *pYMax);
+
    float CubicInterpolate(float y0, float y1, float y2, float y3, float x) const;
    float CubicMaximize(float y0, float y1, float y2, float y3, float * max) const;
 
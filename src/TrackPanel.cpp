@@ -505,6 +505,7 @@ void TrackPanel::OnPaint(wxPaintEvent & /* event */)
       {
          // Reset (should a mutex be used???)
          mRefreshBacking = false;
+         mBackingDamage = {};
 
          // Redraw the backing bitmap
          DrawTracks(&GetBackingDCForRepaint());
@@ -514,6 +515,14 @@ void TrackPanel::OnPaint(wxPaintEvent & /* event */)
       }
       else
       {
+         if (!mBackingDamage.IsEmpty()) {
+            // Redraw just the damaged part of the backing bitmap
+            auto &backingDC = GetBackingDC();
+            wxDCClipper clipper{ backingDC, mBackingDamage };
+            mBackingDamage = {};
+            DrawTracks(&backingDC);
+         }
+
          // Copy full, possibly clipped, damage rectangle
          RepairBitmap(dc, box.x, box.y, box.width, box.height);
       }
@@ -799,6 +808,12 @@ void TrackPanel::RefreshTrack(Track *trk, bool refreshbacking)
 /// boolean play indicator can be set to false, so that an old play indicator that is
 /// no longer there won't get  XORed (to erase it), thus redrawing it on the
 /// TrackPanel
+void TrackPanel::RefreshBackingRect(const wxRect &rect)
+{
+   mBackingDamage.Union(rect);
+   wxWindow::Refresh(false, &rect);
+}
+
 void TrackPanel::Refresh(bool eraseBackground /* = TRUE */,
                          const wxRect *rect /* = NULL */)
 {
@@ -105,6 +105,9 @@ class AUDACITY_DLL_API TrackPanel final
 
    void RefreshTrack(Track *trk, bool refreshbacking = true);
 
+   //! Redraw only this part of the backing bitmap at the next paint
+   void RefreshBackingRect(const wxRect &rect);
+
    void HandlePageUpKey();
    void HandlePageDownKey();
    AudacityProject * GetProject() const override;
@@ -213,6 +216,8 @@ protected:
    int mTimeCount;
 
    bool mRefreshBacking;
+   //! Part of the backing bitmap to redraw, if not all of it
+   wxRect mBackingDamage;
 
 
 protected:
@@ -0,0 +1,133 @@
+/**********************************************************************
+
+   Audacity - A Digital Audio Editor
+   Copyright 1999-2018 Audacity Team
+   License: wxwidgets
+
+******************************************************************//**
+
+\file AudioTelemetryCommand.cpp
+\brief Definitions of AudioTelemetryCommand
+
+*//*******************************************************************/
+
+
+#include "AudioTelemetryCommand.h"
+
+#include "CommandContext.h"
+#include "CommandDispatch.h"
+#include "MenuRegistry.h"
+#include "LoadCommands.h"
+#include "SettingsVisitor.h"
+#include "ShuttleGui.h"
+#include "Telemetry.h"
+
+#include <sstream>
+#include <wx/ffile.h>
+
+namespace {
+const char *KindName(Telemetry::Kind kind)
+{
+   switch (kind) {
+   case Telemetry::Kind::Timer:
+      return "timer";
+   case Telemetry::Kind::Gauge:
+      return "gauge";
+   case Telemetry::Kind::Counter:
+   default:
+      return "counter";
+   }
+}
+}
+
+const ComponentInterfaceSymbol AudioTelemetryCommand::Symbol
+{ XO("Audio Telemetry") };
+
+namespace{ BuiltinCommandsModule::Registration< AudioTelemetryCommand > reg; }
+
+template<bool Const>
+bool AudioTelemetryCommand::VisitSettings( SettingsVisitorBase<Const> & S ){
+   S.OptionalN( bHasTrace     ).Define( mTrace,     wxT("Trace"),     false );
+   S.OptionalN( bHasTraceFile ).Define( mTraceFile, wxT("TraceFile"), wxString{} );
+   S.Define(                            mReset,     wxT("Reset"),     false );
+   return true;
+}
+
+bool AudioTelemetryCommand::VisitSettings( SettingsVisitor & S )
+   { return VisitSettings<false>(S); }
+
+bool AudioTelemetryCommand::VisitSettings( ConstSettingsVisitor & S )
+   { return VisitSettings<true>(S); }
+
+void AudioTelemetryCommand::PopulateOrExchange(ShuttleGui & S)
+{
+   S.AddSpace(0, 5);
+
+   S.StartMultiColumn(3, wxALIGN_CENTER);
+   {
+      S.Optional( bHasTrace     ).TieCheckBox( XXO("Trace"),       mTrace );
+      S.Optional( bHasTraceFile ).TieTextBox(  XXO("Trace File:"), mTraceFile );
+   }
+   S.EndMultiColumn();
+   S.StartMultiColumn(2, wxALIGN_CENTER);
+   {
+      S.TieCheckBox( XXO("Reset"), mReset );
+   }
+   S.EndMultiColumn();
+}
+
+bool AudioTelemetryCommand::Apply(const CommandContext & context)
+{
+   // Report before any reset
+   context.StartArray();
+   for (const auto &series : Telemetry::Snapshot()) {
+      const auto &summary = series.summary;
+      context.StartStruct();
+      context.AddItem( series.category, "category" );
+      context.AddItem( series.name, "name" );
+      context.AddItem( KindName(series.kind), "kind" );
+      context.AddItem( summary.count, "count" );
+      context.AddItem( summary.total, "total" );
+      context.AddItem( summary.Mean(), "mean" );
+      context.AddItem( summary.min, "min" );
+      context.AddItem( summary.max, "max" );
+      context.AddItem( summary.last, "last" );
+      context.AddItem( summary.Percentile(0.5), "p50" );
+      context.AddItem( summary.Percentile(0.99), "p99" );
+      context.EndStruct();
+   }
+   context.EndArray();
+
+   if (bHasTraceFile && !mTraceFile.empty()) {
+      std::ostringstream out;
+      Telemetry::WriteChromeTrace(out);
+      const auto json = out.str();
+      wxFFile file{ mTraceFile, wxT("wb") };
+      if (!file.IsOpened() || !file.Write(json.data(), json.size())
+          || !file.Close()) {
+         context.Error(wxT("Could not write the trace file."));
+         return false;
+      }
+   }
+
+   if (mReset)
+      Telemetry::Reset();
+   if (bHasTrace)
+      Telemetry::EnableTracing(mTrace);
+   return true;
+}
+
+namespace {
+using namespace MenuRegistry;
+
+// Register menu items
+
+AttachedItem sAttachment1{
+   Items( wxT(""),
+      // Usable while audio is busy, which is the point
+      Command( wxT("AudioTelemetry"), XXO("Audio Telemetry..."),
+         CommandDispatch::OnAudacityCommand, AlwaysEnabledFlag )
+   ),
+   wxT("Optional/Extra/Part2/Scriptables2")
+};
+}
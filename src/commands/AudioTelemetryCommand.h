@@ -0,0 +1,53 @@
+/**********************************************************************
+
+   Audacity - A Digital Audio Editor
+   Copyright 1999-2018 Audacity Team
+   License: wxwidgets
+
+******************************************************************//**
+
+\file AudioTelemetryCommand.h
+\brief Declarations of AudioTelemetryCommand class
+
+\class AudioTelemetryCommand
+\brief Command that reports the timings, buffer levels and xruns of audio
+I/O and of realtime effects, and controls tracing of them
+
+Timings are in nanoseconds.  The trace file is JSON in Chrome's trace event
+format, which chrome://tracing and https://ui.perfetto.dev can display.
+
+*//*******************************************************************/
+
+#ifndef __AUDIO_TELEMETRY_COMMAND__
+#define __AUDIO_TELEMETRY_COMMAND__
+
+#include "Command.h"
+#include "CommandType.h"
+
+class AudioTelemetryCommand final : public AudacityCommand
+{
+public:
+   static const ComponentInterfaceSymbol Symbol;
+
+   // ComponentInterface overrides
+   ComponentInterfaceSymbol GetSymbol() const override {return Symbol;};
+   TranslatableString GetDescription() const override {return XO("Reports timings and underruns of audio input and output.");};
+   template<bool Const> bool VisitSettings( SettingsVisitorBase<Const> &S );
+   bool VisitSettings( SettingsVisitor & S ) override;
+   bool VisitSettings( ConstSettingsVisitor & S ) override;
+   void PopulateOrExchange(ShuttleGui & S) override;
+
+   // AudacityCommand overrides
+   ManualPageID ManualPage() override {return L"Extra_Menu:_Scriptables_II#audio_telemetry";}
+   bool Apply(const CommandContext & context) override;
+
+public:
+   bool mTrace;
+   wxString mTraceFile;
+   bool mReset;
+
+   bool bHasTrace;
+   bool bHasTraceFile;
+};
+
+#endif /* End of include guard: __AUDIO_TELEMETRY_COMMAND__ */
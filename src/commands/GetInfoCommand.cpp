@@ -72,6 +72,7 @@ enum {
    kEnvelopes,
    kLabels,
    kBoxes,
+   kProject,
    nTypes
 };
 
@@ -86,6 +87,8 @@ static const EnumValueSymbol kTypes[nTypes] =
    { XO("Envelopes") },
    { XO("Labels") },
    { XO("Boxes") },
+   /* i18n-hint: Type of information, giving tracks with their clips and labels at once */
+   { XO("Project") },
 };
 
 enum {
@@ -171,6 +174,7 @@ bool GetInfoCommand::ApplyInner(const CommandContext &context)
       case kEnvelopes    : return SendEnvelopes( context );
       case kLabels       : return SendLabels( context );
       case kBoxes        : return SendBoxes( context );
+      case kProject      : return SendProject( context );
       default:
          context.Status( "Command options not recognised" );
    }
@@ -474,41 +478,93 @@ bool GetInfoCommand::SendTracks(const CommandContext & context)
    context.StartArray();
    for (auto trk : tracks)
    {
-      auto &trackFocus = TrackFocus::Get( context.project );
-      Track * fTrack = trackFocus.Get();
-
       context.StartStruct();
-      context.AddItem( trk->GetName(), "name" );
-      context.AddBool( (trk == fTrack), "focused");
-      context.AddBool( trk->GetSelected(), "selected" );
-      //JKC: Possibly add later...
-      //context.AddItem(ChannelView::GetChannelGroupHeight(*trk), "height");
-      trk->TypeSwitch( [&] (const WaveTrack &t) {
-         float vzmin, vzmax;
-         WaveformScale::Get(t).GetDisplayBounds(vzmin, vzmax);
-         context.AddItem( "wave", "kind" );
-         context.AddItem( t.GetStartTime(), "start" );
-         context.AddItem( t.GetEndTime(), "end" );
-         context.AddItem( t.GetPan() , "pan");
-         context.AddItem( t.GetGain() , "gain");
-         context.AddItem( t.NChannels(), "channels");
-         context.AddBool( t.GetSolo(), "solo" );
-         context.AddBool( t.GetMute(), "mute");
-         context.AddItem( vzmin, "VZoomMin");
-         context.AddItem( vzmax, "VZoomMax");
-      },
+      SendTrackItems( context, *trk );
+      context.EndStruct();
+   }
+   context.EndArray();
+   return true;
+}
+
+void GetInfoCommand::SendTrackItems(
+   const CommandContext & context, const Track &trk)
+{
+   auto &trackFocus = TrackFocus::Get( context.project );
+   Track * fTrack = trackFocus.Get();
+
+   context.AddItem( trk.GetName(), "name" );
+   context.AddBool( (&trk == fTrack), "focused");
+   context.AddBool( trk.GetSelected(), "selected" );
+   //JKC: Possibly add later...
+   //context.AddItem(ChannelView::GetChannelGroupHeight(trk), "height");
+   trk.TypeSwitch( [&] (const WaveTrack &t) {
+      float vzmin, vzmax;
+      WaveformScale::Get(t).GetDisplayBounds(vzmin, vzmax);
+      context.AddItem( "wave", "kind" );
+      context.AddItem( t.GetStartTime(), "start" );
+      context.AddItem( t.GetEndTime(), "end" );
+      context.AddItem( t.GetPan() , "pan");
+      context.AddItem( t.GetGain() , "gain");
+      context.AddItem( t.NChannels(), "channels");
+      context.AddBool( t.GetSolo(), "solo" );
+      context.AddBool( t.GetMute(), "mute");
+      context.AddItem( vzmin, "VZoomMin");
+      context.AddItem( vzmax, "VZoomMax");
+   },
 #if defined(USE_MIDI)
-      [&](const NoteTrack &) {
-         context.AddItem( "note", "kind" );
-      },
+   [&](const NoteTrack &) {
+      context.AddItem( "note", "kind" );
+   },
 #endif
-      [&](const LabelTrack &) {
-         context.AddItem( "label", "kind" );
+   [&](const LabelTrack &) {
+      context.AddItem( "label", "kind" );
+   },
+   [&](const TimeTrack &) {
+      context.AddItem( "time", "kind" );
+   }
+   );
+}
+
+// All of Tracks, Clips and Labels in one response, with the clips and labels
+// nested in their tracks, so that scripts need not ask for each
+bool GetInfoCommand::SendProject(const CommandContext &context)
+{
+   auto &tracks = TrackList::Get( context.project );
+   context.StartArray();
+   for (auto trk : tracks)
+   {
+      context.StartStruct();
+      SendTrackItems( context, *trk );
+      trk->TypeSwitch( [&](WaveTrack &waveTrack) {
+         context.StartField( "clips" );
+         context.StartArray();
+         for (const auto pInterval : waveTrack.Intervals()) {
+            context.StartStruct();
+            context.AddItem(pInterval->GetPlayStartTime(), "start");
+            context.AddItem(pInterval->GetPlayEndTime(), "end");
+            // Assuming same colors, look at only left channel
+            const auto &colors =
+               WaveColorAttachment::Get(**pInterval->Channels().begin());
+            context.AddItem(colors.GetColorIndex(), "color");
+            context.AddItem(pInterval->GetName(), "name");
+            context.EndStruct();
+         }
+         context.EndArray();
+         context.EndField();
       },
-      [&](const TimeTrack &) {
-         context.AddItem( "time", "kind" );
-      }
-      );
+      [&](LabelTrack &labelTrack) {
+         context.StartField( "labels" );
+         context.StartArray();
+         for ( const auto &label : labelTrack.GetLabels() ) {
+            context.StartStruct();
+            context.AddItem( label.getT0(), "start" );
+            context.AddItem( label.getT1(), "end" );
+            context.AddItem( label.title, "text" );
+            context.EndStruct();
+         }
+         context.EndArray();
+         context.EndField();
+      } );
       context.EndStruct();
    }
    context.EndArray();
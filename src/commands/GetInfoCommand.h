@@ -25,6 +25,7 @@ channel.
 
 class wxMenuBar;
 class wxPoint;
+class Track;
 
 class GetInfoCommand : public AudacityCommand
 {
@@ -57,6 +58,9 @@ private:
    bool SendClips(const CommandContext & context);
    bool SendEnvelopes(const CommandContext & context);
    bool SendBoxes(const CommandContext & context);
+   bool SendProject(const CommandContext & context);
+
+   void SendTrackItems(const CommandContext & context, const Track &track);
 
    void ExploreMenu( const CommandContext &context, wxMenu * pMenu, int Id, int depth );
    void ExploreTrackPanel( const CommandContext & context,
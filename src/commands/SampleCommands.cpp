@@ -0,0 +1,177 @@
+/**********************************************************************
+
+   Audacity - A Digital Audio Editor
+   Copyright 1999-2018 Audacity Team
+   License: wxwidgets
+
+******************************************************************//**
+
+\file SampleCommands.cpp
+\brief Definitions of GetSamplesCommand and SetSamplesCommand
+
+*//*******************************************************************/
+
+
+#include "SampleCommands.h"
+
+#include "CommandContext.h"
+#include "CommandDispatch.h"
+#include "MappedBuffer.h"
+#include "MenuRegistry.h"
+#include "../CommonCommandFlags.h"
+#include "LoadCommands.h"
+#include "ProjectHistory.h"
+#include "SettingsVisitor.h"
+#include "ShuttleGui.h"
+#include "UndoManager.h"
+#include "WaveTrack.h"
+
+namespace {
+
+WaveChannel *FindChannel(const CommandContext &context,
+   int trackIndex, int channelIndex)
+{
+   int ii = 0;
+   for (auto pTrack : TrackList::Get(context.project)) {
+      if (ii++ != trackIndex)
+         continue;
+      const auto pWaveTrack = dynamic_cast<WaveTrack*>(pTrack);
+      if (!pWaveTrack) {
+         context.Error(wxT("Track is not a wave track."));
+         return nullptr;
+      }
+      if (channelIndex < 0 ||
+          static_cast<size_t>(channelIndex) >= pWaveTrack->NChannels()) {
+         context.Error(wxT("Track has no such channel."));
+         return nullptr;
+      }
+      return pWaveTrack->GetChannel(channelIndex).get();
+   }
+   context.Error(wxT("No such track."));
+   return nullptr;
+}
+
+//! Describe what was transferred, so the script can ask for the next chunk
+void SendResult(const CommandContext &context, const WaveChannel &channel,
+   sampleCount start, size_t count)
+{
+   const auto &track = channel.GetTrack();
+   context.StartStruct();
+   context.AddItem(start.as_double(), "start");
+   context.AddItem(static_cast<double>(count), "count");
+   context.AddItem(track.GetRate(), "rate");
+   context.AddItem(
+      track.TimeToLongSamples(track.GetEndTime()).as_double(), "length");
+   context.EndStruct();
+}
+}
+
+template<bool Const>
+bool SampleCommandBase::VisitSettings( SettingsVisitorBase<Const> & S ){
+   S.Define( mTrackIndex,   wxT("Track"),   0, 0, 100000 );
+   S.Define( mChannelIndex, wxT("Channel"), 0, 0, 100 );
+   S.Define( mStart,        wxT("Start"),   0.0, 0.0, 1.0e15 );
+   // The size of the buffer may limit the count further
+   S.Define( mCount,        wxT("Count"),   1 << 20, 0, 1 << 30 );
+   S.Define( mBuffer,       wxT("Buffer"),  wxString{} );
+   return true;
+}
+
+bool SampleCommandBase::VisitSettings( SettingsVisitor & S )
+   { return VisitSettings<false>(S); }
+
+bool SampleCommandBase::VisitSettings( ConstSettingsVisitor & S )
+   { return VisitSettings<true>(S); }
+
+void SampleCommandBase::PopulateOrExchange(ShuttleGui & S)
+{
+   S.AddSpace(0, 5);
+
+   S.StartMultiColumn(2, wxALIGN_CENTER);
+   {
+      S.TieNumericTextBox(XXO("Track:"), mTrackIndex);
+      S.TieNumericTextBox(XXO("Channel:"), mChannelIndex);
+      S.TieNumericTextBox(XXO("Start sample:"), mStart);
+      S.TieNumericTextBox(XXO("Count:"), mCount);
+      S.TieTextBox(XXO("Buffer file:"), mBuffer);
+   }
+   S.EndMultiColumn();
+}
+
+const ComponentInterfaceSymbol GetSamplesCommand::Symbol
+{ XO("Get Samples") };
+
+namespace{ BuiltinCommandsModule::Registration< GetSamplesCommand > reg; }
+
+bool GetSamplesCommand::Apply(const CommandContext & context)
+{
+   const auto pChannel = FindChannel(context, mTrackIndex, mChannelIndex);
+   if (!pChannel)
+      return false;
+   MappedBuffer buffer{ mBuffer, true };
+   if (!buffer.Floats()) {
+      context.Error(wxT("Could not map the buffer file."));
+      return false;
+   }
+
+   const sampleCount start{ static_cast<long long>(mStart) };
+   const auto count =
+      std::min(static_cast<size_t>(std::max(mCount, 0)), buffer.NFloats());
+   // Samples go straight from the sample blocks into the shared memory;
+   // gaps between clips read as zeroes
+   if (!pChannel->GetFloats(buffer.Floats(), start, count,
+         FillFormat::fillZero, false)) {
+      context.Error(wxT("Could not read the samples."));
+      return false;
+   }
+   SendResult(context, *pChannel, start, count);
+   return true;
+}
+
+const ComponentInterfaceSymbol SetSamplesCommand::Symbol
+{ XO("Set Samples") };
+
+namespace{ BuiltinCommandsModule::Registration< SetSamplesCommand > reg2; }
+
+bool SetSamplesCommand::Apply(const CommandContext & context)
+{
+   const auto pChannel = FindChannel(context, mTrackIndex, mChannelIndex);
+   if (!pChannel)
+      return false;
+   MappedBuffer buffer{ mBuffer, false };
+   if (!buffer.Floats()) {
+      context.Error(wxT("Could not map the buffer file."));
+      return false;
+   }
+
+   const sampleCount start{ static_cast<long long>(mStart) };
+   const auto count =
+      std::min(static_cast<size_t>(std::max(mCount, 0)), buffer.NFloats());
+   // Only samples within clips are replaced; SetFloats skips the gaps
+   if (!pChannel->SetFloats(buffer.Floats(), start, count)) {
+      context.Error(wxT("Could not write the samples."));
+      return false;
+   }
+   // A script streams long ranges in chunks; make one history entry of
+   // consecutive chunks, rather than one for each
+   ProjectHistory::Get(context.project).PushState(
+      XO("Set samples"), XO("Set Samples"), UndoPush::CONSOLIDATE);
+   SendResult(context, *pChannel, start, count);
+   return true;
+}
+
+namespace {
+using namespace MenuRegistry;
+
+// Register menu items
+
+AttachedItem sAttachment1{
+   Items( wxT(""),
+      Command( wxT("GetSamples"), XXO("Get Samples..."),
+         CommandDispatch::OnAudacityCommand, AudioIONotBusyFlag() ),
+      Command( wxT("SetSamples"), XXO("Set Samples..."),
+         CommandDispatch::OnAudacityCommand, AudioIONotBusyFlag() )
+   ),
+   wxT("Optional/Extra/Part2/Scriptables2")
+};
+}
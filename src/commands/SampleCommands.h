@@ -0,0 +1,78 @@
+/**********************************************************************
+
+   Audacity - A Digital Audio Editor
+   Copyright 1999-2018 Audacity Team
+   License: wxwidgets
+
+******************************************************************//**
+
+\file SampleCommands.h
+\brief Declarations of GetSamplesCommand and SetSamplesCommand classes
+
+\class GetSamplesCommand
+\brief Command that copies samples of one channel into shared memory
+
+\class SetSamplesCommand
+\brief Command that copies samples of one channel from shared memory
+
+Both commands map a file named by the script, such as one in /dev/shm, and
+transfer 32 bit floats in the byte order of the machine, starting at the
+beginning of the file, with no copies besides that into or out of the map.
+At most as many samples as fit in the file are transferred, so a script can
+stream a long range in chunks, with the same file.
+
+*//*******************************************************************/
+
+#ifndef __SAMPLE_COMMANDS__
+#define __SAMPLE_COMMANDS__
+
+#include "Command.h"
+#include "CommandType.h"
+
+class SampleCommandBase /* not final */ : public AudacityCommand
+{
+public:
+   template<bool Const> bool VisitSettings( SettingsVisitorBase<Const> &S );
+   bool VisitSettings( SettingsVisitor & S ) override;
+   bool VisitSettings( ConstSettingsVisitor & S ) override;
+   void PopulateOrExchange(ShuttleGui & S) override;
+
+public:
+   //! Counts all tracks, as in GetInfo
+   int mTrackIndex;
+   int mChannelIndex;
+   //! First sample, counted from time zero
+   double mStart;
+   int mCount;
+   wxString mBuffer;
+};
+
+class GetSamplesCommand final : public SampleCommandBase
+{
+public:
+   static const ComponentInterfaceSymbol Symbol;
+
+   // ComponentInterface overrides
+   ComponentInterfaceSymbol GetSymbol() const override {return Symbol;};
+   TranslatableString GetDescription() const override {return XO("Copies samples of a channel to shared memory.");};
+
+   // AudacityCommand overrides
+   ManualPageID ManualPage() override {return L"Extra_Menu:_Scriptables_II#get_samples";}
+   bool Apply(const CommandContext & context) override;
+};
+
+class SetSamplesCommand final : public SampleCommandBase
+{
+public:
+   static const ComponentInterfaceSymbol Symbol;
+
+   // ComponentInterface overrides
+   ComponentInterfaceSymbol GetSymbol() const override {return Symbol;};
+   TranslatableString GetDescription() const override {return XO("Copies samples of a channel from shared memory.");};
+
+   // AudacityCommand overrides
+   ManualPageID ManualPage() override {return L"Extra_Menu:_Scriptables_I#set_samples";}
+   bool Apply(const CommandContext & context) override;
+};
+
+#endif /* End of include guard: __SAMPLE_COMMANDS__ */
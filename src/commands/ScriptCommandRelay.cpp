@@ -25,41 +25,130 @@ code out of ModuleManager.
 #include "CommandBuilder.h"
 #include "ActiveProject.h"
 #include "AppCommandEvent.h"
+#include "BasicUI.h"
+#include "MemoryX.h"
 #include "Project.h"
 #include <wx/app.h>
+#include <chrono>
+#include <deque>
+#include <mutex>
 #include <thread>
 
-/// This is the function which actually obeys one command.
-static int ExecCommand(wxString *pIn, wxString *pOut, bool fromMain)
+namespace {
+//! Commands posted from script threads, to run in order on the main thread
+class CommandQueue
 {
-   if (auto pProject = ::GetActiveProject().lock()) {
-      CommandBuilder builder(*pProject, *pIn);
-      if (builder.WasValid())
-      {
-         OldStyleCommandPointer cmd = builder.GetCommand();
+public:
+   static CommandQueue &Get()
+   {
+      static CommandQueue queue;
+      return queue;
+   }
 
-         AppCommandEvent ev;
-         ev.SetCommand(cmd);
+   void Post(const OldStyleCommandPointer &cmd)
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mCommands.push_back(cmd);
+      if (!mScheduled) {
+         mScheduled = true;
+         BasicUI::CallAfter([this]{ Run(); });
+      }
+   }
 
-         if (fromMain)
-         {
-            // Use SafelyProcessEvent, which stops exceptions, because this is
-            // expected to be reached from within the XLisp runtime
-            wxTheApp->SafelyProcessEvent(ev);
-         }
-         else
+private:
+   //! Leave the event loop a turn after running commands for so long
+   static constexpr auto TimeSlice = std::chrono::milliseconds(20);
+
+   //! Called on the main thread only
+   void Run()
+   {
+      // A command that yields to the event loop must finish before the next
+      if (mRunning)
+         return;
+      mRunning = true;
+      auto cleanup = finally([this]{ mRunning = false; });
+
+      const auto start = std::chrono::steady_clock::now();
+      while (true) {
+         OldStyleCommandPointer cmd;
          {
-            // Send the event to the main thread
-            wxTheApp->AddPendingEvent(ev);
+            std::lock_guard<std::mutex> lock{ mMutex };
+            if (mCommands.empty()) {
+               mScheduled = false;
+               return;
+            }
+            if (std::chrono::steady_clock::now() - start > TimeSlice) {
+               BasicUI::CallAfter([this]{ Run(); });
+               return;
+            }
+            cmd = std::move(mCommands.front());
+            mCommands.pop_front();
          }
+         AppCommandEvent ev;
+         ev.SetCommand(cmd);
+         wxTheApp->SafelyProcessEvent(ev);
       }
+   }
+
+   std::mutex mMutex;
+   std::deque<OldStyleCommandPointer> mCommands;
+   //! Whether a call to Run() is pending, or commands are running
+   bool mScheduled{ false };
+   bool mRunning{ false };
+};
 
-      // Wait for and retrieve the response
-      *pOut = builder.GetResponse();
+//! Build the command, and run it or queue it
+std::unique_ptr<CommandBuilder> SendCommand(const wxString &in, bool fromMain)
+{
+   auto pProject = ::GetActiveProject().lock();
+   if (!pProject)
+      return nullptr;
+
+   auto pBuilder = std::make_unique<CommandBuilder>(*pProject, in);
+   if (pBuilder->WasValid())
+   {
+      OldStyleCommandPointer cmd = pBuilder->GetCommand();
+      if (fromMain)
+      {
+         AppCommandEvent ev;
+         ev.SetCommand(cmd);
+
+         // Use SafelyProcessEvent, which stops exceptions, because this is
+         // expected to be reached from within the XLisp runtime
+         wxTheApp->SafelyProcessEvent(ev);
+      }
+      else
+         // Send the command to the main thread
+         CommandQueue::Get().Post(cmd);
    }
-   else
-      *pOut = wxString{};
+   return pBuilder;
+}
+}
+
+PendingScriptCommand::PendingScriptCommand(
+   std::unique_ptr<CommandBuilder> pBuilder)
+   : mpBuilder{ std::move(pBuilder) }
+{
+}
 
+PendingScriptCommand::~PendingScriptCommand() = default;
+
+wxString PendingScriptCommand::GetResponse()
+{
+   return mpBuilder ? mpBuilder->GetResponse() : wxString{};
+}
+
+std::unique_ptr<PendingScriptCommand>
+ScriptCommandRelay::PostCommand(const wxString &command)
+{
+   return std::make_unique<PendingScriptCommand>(SendCommand(command, false));
+}
+
+/// This is the function which actually obeys one command.
+static int ExecCommand(wxString *pIn, wxString *pOut, bool fromMain)
+{
+   // Wait for and retrieve the response
+   *pOut = PendingScriptCommand{ SendCommand(*pIn, fromMain) }.GetResponse();
    return 0;
 }
 
@@ -21,14 +21,39 @@
 #include <memory>
 
 class wxString;
+class CommandBuilder;
 
 typedef int(*tpExecScriptServerFunc)(wxString * pIn, wxString * pOut);
 typedef int(*tpRegScriptServerFunc)(tpExecScriptServerFunc pFn);
 
+//! A command sent to the main thread, whose response can be awaited later
+class AUDACITY_DLL_API PendingScriptCommand
+{
+public:
+   explicit PendingScriptCommand(std::unique_ptr<CommandBuilder> pBuilder);
+   ~PendingScriptCommand();
+
+   //! Wait for the main thread to run the command, if it has not yet
+   wxString GetResponse();
+
+private:
+   std::unique_ptr<CommandBuilder> mpBuilder;
+};
+
 class AUDACITY_DLL_API ScriptCommandRelay
 {
 public:
    static void StartScriptServer(tpRegScriptServerFunc scriptFn);
+
+   //! Queue a command for the main thread without waiting for it
+   /*!
+    Commands run in the order they are posted from any thread, several in
+    each turn of the event loop, so that scripts can send many before
+    reading the first response.  Queued commands do not run while another
+    one is still running, even if it yields to the event loop.
+    */
+   static std::unique_ptr<PendingScriptCommand>
+   PostCommand(const wxString &command);
 };
 
 // The void * return is actually a Lisp LVAL and will be cast to such as needed.
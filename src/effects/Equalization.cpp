@@ -37,6 +37,7 @@
 #include "EffectEditor.h"
 #include "EffectOutputTracks.h"
 #include "LoadEffects.h"
+#include "OverlapSaveConvolver.h"
 #include "ShuttleGui.h"
 
 #include "WaveClip.h"
@@ -364,13 +365,16 @@ bool EffectEqualization::Init()
 }
 
 struct EffectEqualization::Task {
-   Task(size_t M, size_t idealBlockLen, WaveChannel &channel)
+   Task(size_t M, size_t idealBlockLen,
+      std::shared_ptr<const OverlapSaveConvolver::Kernel> pKernel,
+      WaveChannel &channel)
       : buffer{ idealBlockLen }
       , idealBlockLen{ idealBlockLen }
+      // Filter long blocks on all cores
+      , convolver{ std::move(pKernel), 0 }
       , output{ channel }
-      , leftTailRemaining{ (M - 1) / 2 }
+      , leftTailRemaining{ (M - 1) / 2 + convolver.GetLatency() }
    {
-      memset(lastWindow, 0, windowSize * sizeof(float));
    }
 
    void AccumulateSamples(constSamplePtr buffer, size_t len)
@@ -382,16 +386,10 @@ struct EffectEqualization::Task {
       output.Append(buffer, floatSample, len);
    }
 
-   static constexpr auto windowSize = EqualizationFilter::windowSize;
-   Floats window1{ windowSize };
-   Floats window2{ windowSize };
-
    Floats buffer;
    const size_t idealBlockLen;
 
-   // These pointers are swapped after each FFT window
-   float *thisWindow{ window1.get() };
-   float *lastWindow{ window2.get() };
+   OverlapSaveConvolver convolver;
 
    // a new WaveChannel to hold all of the output,
    // including 'tails' each end
@@ -406,6 +404,13 @@ bool EffectEqualization::Process(EffectInstance &, EffectSettings &)
    mParameters.CalcFilter();
    bool bGoodResult = true;
 
+   const auto &M = mParameters.mM;
+   // The whole response fits in one partition of half the window size
+   wxASSERT(M <= EqualizationFilter::windowSize / 2);
+   const auto pKernel = std::make_shared<OverlapSaveConvolver::Kernel>(
+      mParameters.mImpulseResponse.data(), M,
+      EqualizationFilter::windowSize / 2);
+
    int count = 0;
    for (auto track : outputs.Get().Selected<WaveTrack>()) {
       double trackStart = track->GetStartTime();
@@ -423,17 +428,9 @@ bool EffectEqualization::Process(EffectInstance &, EffectSettings &)
          auto iter0 = pTempTrack->Channels().begin();
 
          for (const auto pChannel : track->Channels()) {
-            constexpr auto windowSize = EqualizationFilter::windowSize;
-            const auto &M = mParameters.mM;
-
-            wxASSERT(M - 1 < windowSize);
-            size_t L = windowSize - (M - 1);   //Process L samples at a go
-            auto s = start;
             auto idealBlockLen = pChannel->GetMaxBlockSize() * 4;
-            if (idealBlockLen % L != 0)
-               idealBlockLen += (L - (idealBlockLen % L));
             auto pNewChannel = *iter0++;
-            Task task{ M, idealBlockLen, *pNewChannel };
+            Task task{ M, idealBlockLen, pKernel, *pNewChannel };
             bGoodResult = ProcessOne(task, count, *pChannel, start, len);
             if (!bGoodResult)
                goto done;
@@ -475,27 +472,16 @@ bool EffectEqualization::TransferDataToWindow(const EffectSettings &settings)
 bool EffectEqualization::ProcessOne(Task &task,
    int count, const WaveChannel &t, sampleCount start, sampleCount len)
 {
-   constexpr auto windowSize = EqualizationFilter::windowSize;
-
    const auto &M = mParameters.mM;
-
-   wxASSERT(M - 1 < windowSize);
-   size_t L = windowSize - (M - 1);   //Process L samples at a go
    auto s = start;
 
    auto &buffer = task.buffer;
-   auto &window1 = task.window1;
-   auto &window2 = task.window2;
-   auto &thisWindow = task.thisWindow;
-   auto &lastWindow = task.lastWindow;
+   auto &convolver = task.convolver;
 
    auto originalLen = len;
 
-   auto &output = task.output;
-
    TrackProgress(count, 0.);
    bool bLoopSuccess = true;
-   size_t wcopy = 0;
 
    while (len != 0)
    {
@@ -503,24 +489,8 @@ bool EffectEqualization::ProcessOne(Task &task,
 
       t.GetFloats(buffer.get(), s, block);
 
-      for(size_t i = 0; i < block; i += L)   //go through block in lumps of length L
-      {
-         wcopy = std::min <size_t> (L, block - i);
-         for(size_t j = 0; j < wcopy; j++)
-            thisWindow[j] = buffer[i+j];   //copy the L (or remaining) samples
-         for(auto j = wcopy; j < windowSize; j++)
-            thisWindow[j] = 0;   //this includes the padding
-
-         mParameters.Filter(windowSize, thisWindow);
-
-         // Overlap - Add
-         for(size_t j = 0; (j < M - 1) && (j < wcopy); j++)
-            buffer[i+j] = thisWindow[j] + lastWindow[L + j];
-         for(size_t j = M - 1; j < wcopy; j++)
-            buffer[i+j] = thisWindow[j];
-
-         std::swap( thisWindow, lastWindow );
-      }  //next i, lump of this block
+      // Fast convolution, in place
+      convolver.Process(buffer.get(), buffer.get(), block);
 
       task.AccumulateSamples((samplePtr)buffer.get(), block);
       len -= block;
@@ -535,22 +505,16 @@ bool EffectEqualization::ProcessOne(Task &task,
    }
 
    if (bLoopSuccess) {
-      // M-1 samples of 'tail' left in lastWindow, get them now
-      if(wcopy < (M - 1)) {
-         // Still have some overlap left to process
-         // (note that lastWindow and thisWindow have been exchanged at this point
-         //  so that 'thisWindow' is really the window prior to 'lastWindow')
-         size_t j = 0;
-         for(; j < M - 1 - wcopy; j++)
-            buffer[j] = lastWindow[wcopy + j] + thisWindow[L + wcopy + j];
-         // And fill in the remainder after the overlap
-         for( ; j < M - 1; j++)
-            buffer[j] = lastWindow[wcopy + j];
-      } else {
-         for(size_t j = 0; j < M - 1; j++)
-            buffer[j] = lastWindow[wcopy + j];
+      // M-1 samples of 'tail' remain, and the convolver holds back some more;
+      // push zeroes through to get them
+      auto tailLen = M - 1 + convolver.GetLatency();
+      while (tailLen > 0) {
+         const auto block = std::min(tailLen, task.idealBlockLen);
+         std::fill(buffer.get(), buffer.get() + block, 0.0f);
+         convolver.Process(buffer.get(), buffer.get(), block);
+         task.AccumulateSamples((samplePtr)buffer.get(), block);
+         tailLen -= block;
       }
-      task.AccumulateSamples((samplePtr)buffer.get(), M - 1);
    }
    return bLoopSuccess;
 }
@@ -28,7 +28,6 @@ EqualizationFilter::EqualizationFilter(const EffectSettingsManager &manager)
    mLinEnvelope.SetTrackLen(1.0);
 }
 
-#include "RealFFTf.h"
 bool EqualizationFilter::CalcFilter()
 {
    // Inverse-transform the given curve from frequency domain to time;
@@ -135,6 +134,7 @@ bool EqualizationFilter::CalcFilter()
    {   //and copy useful values back
       outr[i] = tempr[i];
    }
+   mImpulseResponse.assign(outr.get(), outr.get() + mM);
    for (size_t i = mM; i < mWindowSize; i++)
    {   //rest is padding
       outr[i]=0.;
@@ -145,32 +145,3 @@ bool EqualizationFilter::CalcFilter()
 
    return TRUE;
 }
-
-void EqualizationFilter::Filter(size_t len, float *buffer) const
-{
-   // Transform a window of the time-domain signal to frequency;
-   // Multiply by corresponding coefficients;
-   // Inverse transform back to time domain:  that's fast convolution.
-
-   float re,im;
-   // Apply FFT
-   RealFFTf(buffer, hFFT.get());
-   //FFT(len, false, inr, NULL, outr, outi);
-
-   // Apply filter
-   // DC component is purely real
-   mFFTBuffer[0] = buffer[0] * mFilterFuncR[0];
-   for(size_t i = 1; i < (len / 2); i++)
-   {
-      re=buffer[hFFT->BitReversed[i]  ];
-      im=buffer[hFFT->BitReversed[i]+1];
-      mFFTBuffer[2*i  ] = re*mFilterFuncR[i] - im*mFilterFuncI[i];
-      mFFTBuffer[2*i+1] = re*mFilterFuncI[i] + im*mFilterFuncR[i];
-   }
-   // Fs/2 component is purely real
-   mFFTBuffer[1] = buffer[1] * mFilterFuncR[len/2];
-
-   // Inverse FFT and normalization
-   InverseRealFFTf(mFFTBuffer.get(), hFFT.get());
-   ReorderToTime(hFFT.get(), mFFTBuffer.get(), buffer);
-}
@@ -13,7 +13,7 @@
 
 *//*******************************************************************/
 #include "Loudness.h"
-#include "EBUR128.h"
+#include "LoudnessAnalysis.h"
 #include "EffectEditor.h"
 #include "EffectOutputTracks.h"
 
@@ -113,15 +113,66 @@ bool EffectLoudness::Process(EffectInstance &, EffectSettings &)
    AllocBuffers(outputs.Get());
    mProgressVal = 0;
 
-   for (auto pTrack : outputs.Get().Selected<WaveTrack>()) {
-      // Get start and end times from track
-      double trackStart = pTrack->GetStartTime();
-      double trackEnd = pTrack->GetEndTime();
+   // Set the current bounds to whichever left marker is
+   // greater and whichever right marker is less:
+   const auto getBounds = [&](const WaveTrack &track) {
+      return std::pair{ std::max(track.GetStartTime(), mT0),
+         std::min(track.GetEndTime(), mT1) };
+   };
 
-      // Set the current bounds to whichever left marker is
-      // greater and whichever right marker is less:
-      const double curT0 = std::max(trackStart, mT0);
-      const double curT1 = std::min(trackEnd, mT1);
+   // Measure all tracks (or channels, if stereo is independent) at once, so
+   // that many tracks and long tracks are analysed on all processor cores
+   std::vector<double> loudness;
+   size_t iLoudness = 0;
+   if (mNormalizeTo == kLoudness) {
+      std::vector<LoudnessAnalysisJob> jobs;
+      const auto addJob = [&](std::vector<WaveChannel*> channels,
+         double curT0, double curT1
+      ){
+         const auto &first = *channels.front();
+         jobs.push_back({ first.GetRate(), channels.size(),
+            first.TimeToLongSamples(curT0), first.TimeToLongSamples(curT1),
+            [channels = std::move(channels)](size_t iChannel,
+               sampleCount start, size_t len, float *buffer
+            ){
+               channels[iChannel]->GetFloats(buffer, start, len); // may throw
+            }
+         });
+      };
+      for (auto pTrack : outputs.Get().Selected<WaveTrack>()) {
+         const auto [curT0, curT1] = getBounds(*pTrack);
+         // Abort if the right marker is not to the right of the left marker
+         if (curT1 <= curT0) {
+            bGoodResult = false;
+            goto done;
+         }
+         std::vector<WaveChannel*> channels;
+         for (const auto pChannel : pTrack->Channels())
+            channels.push_back(pChannel.get());
+         if (mStereoInd)
+            for (const auto pChannel : channels)
+               addJob({ pChannel }, curT0, curT1);
+         else
+            addJob(std::move(channels), curT0, curT1);
+      }
+
+      mProgressMsg = topMsg;
+      // This is the first of two steps; see UpdateProgress
+      loudness = AnalyseIntegrativeLoudness(jobs, [&](double fraction){
+         return !TotalProgress(fraction / 2, mProgressMsg);
+      });
+      if (loudness.empty()) {
+         // Cancelled
+         bGoodResult = false;
+         goto done;
+      }
+      mProgressVal = 0.5;
+   }
+
+   for (auto pTrack : outputs.Get().Selected<WaveTrack>()) {
+      const auto bounds = getBounds(*pTrack);
+      const double curT0 = bounds.first;
+      const double curT1 = bounds.second;
 
       // Get the track rate
       mCurRate = pTrack->GetRate();
@@ -139,17 +190,9 @@ bool EffectLoudness::Process(EffectInstance &, EffectSettings &)
       mProcStereo = nChannels > 1;
 
       const auto processOne = [&](WaveChannel &track){
-         std::optional<EBUR128> loudnessProcessor;
          float RMS[2];
 
-         if (mNormalizeTo == kLoudness) {
-            loudnessProcessor.emplace(mCurRate, nChannels);
-            if (!ProcessOne(track, nChannels,
-               curT0, curT1, 0, &*loudnessProcessor))
-               // Processing failed -> abort
-               return false;
-         }
-         else {
+         if (mNormalizeTo != kLoudness) {
             // RMS
             if (mProcStereo) {
                size_t idx = 0;
@@ -168,7 +211,7 @@ bool EffectLoudness::Process(EffectInstance &, EffectSettings &)
          // Calculate normalization values the analysis results
          float extent;
          if (mNormalizeTo == kLoudness)
-            extent = loudnessProcessor->IntegrativeLoudness();
+            extent = loudness[iLoudness++];
          else {
             // RMS
             extent = RMS[0];
@@ -197,7 +240,7 @@ bool EffectLoudness::Process(EffectInstance &, EffectSettings &)
          }
 
          mProgressMsg = topMsg + XO("Processing: %s").Format( trackName );
-         if (!ProcessOne(track, nChannels, curT0, curT1, mult, nullptr)) {
+         if (!ProcessOne(track, nChannels, curT0, curT1, mult)) {
             // Processing failed -> abort
             return false;
          }
@@ -393,13 +436,9 @@ bool EffectLoudness::GetTrackRMS(WaveChannel &track,
 
 /// ProcessOne() takes a track, transforms it to bunch of buffer-blocks,
 /// and executes ProcessData, on it...
-///  uses mMult to normalize a track.
-///  mMult must be set before this is called
-/// In analyse mode, it executes the selected analyse operation on it...
-///  mMult does not have to be set before this is called
+///  uses mult to normalize a track.
 bool EffectLoudness::ProcessOne(WaveChannel &track, size_t nChannels,
-   const double curT0, const double curT1, const float mult,
-   EBUR128 *pLoudnessProcessor)
+   const double curT0, const double curT1, const float mult)
 {
    // Transform the marker timepoints to samples
    auto start = track.TimeToLongSamples(curT0);
@@ -429,16 +468,10 @@ bool EffectLoudness::ProcessOne(WaveChannel &track, size_t nChannels,
       LoadBufferBlock(track, nChannels, s, blockLen);
 
       // Process the buffer.
-      if (pLoudnessProcessor) {
-         if (!AnalyseBufferBlock(*pLoudnessProcessor))
-            return false;
-      }
-      else {
-         if (!ProcessBufferBlock(mult))
-            return false;
-         if (!StoreBufferBlock(track, nChannels, s, blockLen))
-            return false;
-      }
+      if (!ProcessBufferBlock(mult))
+         return false;
+      if (!StoreBufferBlock(track, nChannels, s, blockLen))
+         return false;
 
       // Increment s one blockfull of samples
       s += blockLen;
@@ -467,23 +500,6 @@ void EffectLoudness::LoadBufferBlock(WaveChannel &track, size_t nChannels,
    mTrackBufferLen = len;
 }
 
-/// Calculates sample sum (for DC) and EBU R128 weighted square sum
-/// (for loudness).
-bool EffectLoudness::AnalyseBufferBlock(EBUR128 &loudnessProcessor)
-{
-   for(size_t i = 0; i < mTrackBufferLen; i++)
-   {
-      loudnessProcessor.ProcessSampleFromChannel(mTrackBuffer[0][i], 0);
-      if (mProcStereo)
-         loudnessProcessor.ProcessSampleFromChannel(mTrackBuffer[1][i], 1);
-      loudnessProcessor.NextSample();
-   }
-
-   if (!UpdateProgress())
-      return false;
-   return true;
-}
-
 bool EffectLoudness::ProcessBufferBlock(const float mult)
 {
    for(size_t i = 0; i < mTrackBufferLen; i++)
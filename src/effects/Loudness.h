@@ -24,7 +24,6 @@
 
 class wxChoice;
 class wxSimplebook;
-class EBUR128;
 class ShuttleGui;
 class WaveChannel;
 using Floats = ArrayOf<float>;
@@ -73,10 +72,9 @@ private:
    static bool GetTrackRMS(WaveChannel &track,
       double curT0, double curT1, float &rms);
    [[nodiscard]] bool ProcessOne(WaveChannel &track, size_t nChannels,
-      double curT0, double curT1, float mult, EBUR128 *pLoudnessProcessor);
+      double curT0, double curT1, float mult);
    void LoadBufferBlock(WaveChannel &track, size_t nChannels,
       sampleCount pos, size_t len);
-   bool AnalyseBufferBlock(EBUR128 &loudnessProcessor);
    bool ProcessBufferBlock(float mult);
    [[nodiscard]] bool StoreBufferBlock(WaveChannel &track, size_t nChannels,
       sampleCount pos, size_t len);
@@ -50,7 +50,7 @@
 #include "FFT.h"
 #include "Prefs.h"
 #include "RealFFTf.h"
-#include "../SpectrumTransformer.h"
+#include "SpectrumTransformer.h"
 
 #include "WaveTrack.h"
 #include "AudacityMessageBox.h"
@@ -262,6 +262,11 @@ struct MyTransformer : TrackSpectrumTransformer {
          windowSize, stepsPerWindow, leadingPadding, trailingPadding
       }
       , mWorker{ worker }
+      , mFreqSmoothingScratch(windowSize / 2 + 2)
+      , mGreatest(windowSize / 2 + 1)
+      , mSecond(windowSize / 2 + 1)
+      , mThird(windowSize / 2 + 1)
+      , mAttacking(windowSize / 2 + 1)
    {
    }
    struct MyWindow : public Window
@@ -283,6 +288,15 @@ struct MyTransformer : TrackSpectrumTransformer {
    bool DoFinish() override;
 
    EffectNoiseReduction::Worker &mWorker;
+
+   // Scratch space, so that each transformer may run on its own thread
+   std::vector<double> mFreqSmoothingScratch;
+   // Order statistics of power in each band, over the examined windows
+   FloatVector mGreatest;
+   FloatVector mSecond;
+   FloatVector mThird;
+   // Whether the attack curve is still rising in each band
+   std::vector<char> mAttacking;
 };
 
 //----------------------------------------------------------------------------
@@ -308,12 +322,14 @@ public:
       TrackList &tracks, double mT0, double mT1);
 
    static bool Processor(SpectrumTransformer &transformer);
+   static bool ConcurrentProcessor(SpectrumTransformer &transformer);
 
-   void ApplyFreqSmoothing(FloatVector &gains);
+   void ProcessWindow(MyTransformer &transformer);
+   void ApplyFreqSmoothing(
+      FloatVector &gains, std::vector<double> &scratch) const;
    void GatherStatistics(MyTransformer &transformer);
-   inline bool Classify(
-      MyTransformer &transformer, unsigned nWindows, int band);
-   void ReduceNoise(MyTransformer &transformer);
+   inline void Classify(MyTransformer &transformer, unsigned nWindows) const;
+   void ReduceNoise(MyTransformer &transformer) const;
    void FinishTrackStatistics();
 
    const bool mDoProfile;
@@ -322,7 +338,6 @@ public:
    const Settings &mSettings;
    Statistics &mStatistics;
 
-   FloatVector mFreqSmoothingScratch;
    const size_t mFreqSmoothingBins;
    // When spectral selection limits the affected band:
    size_t mBinLow;  // inclusive lower bound
@@ -336,10 +351,14 @@ public:
    float     mOneBlockRelease;
    float     mNoiseAttenFactor;
    float     mOldSensitivityFactor;
+   // Power in each band at or below which it is classified as noise
+   std::vector<double> mThresholds;
 
    unsigned  mNWindowsToExamine;
    unsigned  mCenter;
    unsigned  mHistoryLen;
+   // Windows after which the gains no longer depend on windows before them
+   unsigned  mWarmUpSteps;
 
    // Following are for progress indicator only:
    unsigned  mProgressTrackCount = 0;
@@ -759,24 +778,54 @@ bool EffectNoiseReduction::Worker::Process(
          auto t0 = track->LongSamplesToTime(start);
          auto tLen = track->LongSamplesToTime(len);
          std::optional<WaveTrack::Holder> ppTempTrack;
-         std::optional<ChannelGroup::ChannelIterator<WaveChannel>> pIter;
          WaveTrack *pFirstTrack{};
          if (!mSettings.mDoProfile) {
             ppTempTrack.emplace(track->EmptyCopy());
             pFirstTrack = ppTempTrack->get();
-            pIter.emplace(pFirstTrack->Channels().begin());
          }
-         for (const auto pChannel : track->Channels()) {
-            auto pOutputTrack = pIter ? *(*pIter)++ : nullptr;
-            MyTransformer transformer{ *this, pOutputTrack.get(),
-               !mSettings.mDoProfile, inWindowType, outWindowType,
-               mSettings.WindowSize(), mSettings.StepsPerWindow(),
-               !mSettings.mDoProfile, !mSettings.mDoProfile
+         if (mSettings.mDoProfile) {
+            // Statistics accumulate window by window; do it in one pass
+            for (const auto pChannel : track->Channels()) {
+               MyTransformer transformer{ *this, nullptr,
+                  false, inWindowType, outWindowType,
+                  mSettings.WindowSize(), mSettings.StepsPerWindow(),
+                  false, false
+               };
+               if (!transformer
+                  .Process(Processor, *pChannel, mHistoryLen, start, len))
+                  return false;
+               ++mProgressTrackCount;
+            }
+         }
+         else {
+            // Reduce all channels at once, each in segments on many threads
+            std::vector<std::shared_ptr<const WaveChannel>> channels;
+            std::vector<std::shared_ptr<WaveChannel>> outputs;
+            for (const auto pChannel : track->Channels())
+               channels.push_back(pChannel);
+            for (const auto pChannel : pFirstTrack->Channels())
+               outputs.push_back(pChannel);
+            std::vector<const WaveChannel*> pChannels;
+            std::vector<WaveChannel*> pOutputs;
+            for (const auto &pChannel : channels)
+               pChannels.push_back(pChannel.get());
+            for (const auto &pChannel : outputs)
+               pOutputs.push_back(pChannel.get());
+
+            const auto factory = [&](WaveChannel &output) {
+               return std::make_unique<MyTransformer>(*this, &output,
+                  true, inWindowType, outWindowType,
+                  mSettings.WindowSize(), mSettings.StepsPerWindow(),
+                  true, true);
+            };
+            const auto progress = [&](double fraction) {
+               return !mEffect.TrackProgress(mProgressTrackCount, fraction);
             };
-            if (!transformer
-               .Process(Processor, *pChannel, mHistoryLen, start, len))
+            if (!TrackSpectrumTransformer::ProcessConcurrently(factory,
+               ConcurrentProcessor, pChannels, pOutputs, mHistoryLen,
+               start, len, mWarmUpSteps, progress))
                return false;
-            ++mProgressTrackCount;
+            mProgressTrackCount += channels.size();
          }
          if (ppTempTrack) {
             TrackSpectrumTransformer::PostProcess(*pFirstTrack, len);
@@ -799,7 +848,8 @@ bool EffectNoiseReduction::Worker::Process(
    return true;
 }
 
-void EffectNoiseReduction::Worker::ApplyFreqSmoothing(FloatVector &gains)
+void EffectNoiseReduction::Worker::ApplyFreqSmoothing(
+   FloatVector &gains, std::vector<double> &scratch) const
 {
    // Given an array of gain mutipliers, average them
    // GEOMETRICALLY.  Don't multiply and take nth root --
@@ -810,26 +860,17 @@ void EffectNoiseReduction::Worker::ApplyFreqSmoothing(FloatVector &gains)
 
    const auto spectrumSize = mSettings.SpectrumSize();
 
-   {
-      auto pScratch = mFreqSmoothingScratch.data();
-      std::fill(pScratch, pScratch + spectrumSize, 0.0f);
-   }
-
+   // Running sums of the logs, so that each average costs the same however
+   // many bins are smoothed
+   scratch[0] = 0;
    for (size_t ii = 0; ii < spectrumSize; ++ii)
-      gains[ii] = log(gains[ii]);
-
-   // ii must be signed
-   for (int ii = 0; ii < (int)spectrumSize; ++ii) {
-      const int j0 = std::max(0, ii - (int)mFreqSmoothingBins);
-      const int j1 = std::min(spectrumSize - 1, ii + mFreqSmoothingBins);
-      for(int jj = j0; jj <= j1; ++jj) {
-         mFreqSmoothingScratch[ii] += gains[jj];
-      }
-      mFreqSmoothingScratch[ii] /= (j1 - j0 + 1);
-   }
+      scratch[ii + 1] = scratch[ii] + log(gains[ii]);
 
-   for (size_t ii = 0; ii < spectrumSize; ++ii)
-      gains[ii] = exp(mFreqSmoothingScratch[ii]);
+   for (size_t ii = 0; ii < spectrumSize; ++ii) {
+      const auto j0 = ii - std::min(ii, mFreqSmoothingBins);
+      const auto j1 = std::min(spectrumSize - 1, ii + mFreqSmoothingBins);
+      gains[ii] = exp((scratch[j1 + 1] - scratch[j0]) / (j1 - j0 + 1));
+   }
 }
 
 EffectNoiseReduction::Worker::Worker(EffectNoiseReduction &effect,
@@ -844,7 +885,6 @@ EffectNoiseReduction::Worker::Worker(EffectNoiseReduction &effect,
 , mSettings{ settings }
 , mStatistics{ statistics }
 
-, mFreqSmoothingScratch(mSettings.SpectrumSize())
 , mFreqSmoothingBins{ size_t(std::max(0.0, settings.mFreqSmoothingBands)) }
 , mBinLow{ 0 }
 , mBinHigh{ mSettings.SpectrumSize() }
@@ -890,6 +930,18 @@ EffectNoiseReduction::Worker::Worker(EffectNoiseReduction &effect,
    mCenter = mNWindowsToExamine / 2;
    wxASSERT(mCenter >= 1); // release depends on this assumption
 
+   if (!mDoProfile) {
+      const auto spectrumSize = mSettings.SpectrumSize();
+      mThresholds.resize(spectrumSize);
+      for (size_t jj = 0; jj < spectrumSize; ++jj)
+         mThresholds[jj] =
+#ifdef OLD_METHOD_AVAILABLE
+            (mMethod == DM_OLD_METHOD)
+               ? mOldSensitivityFactor * mStatistics.mNoiseThreshold[jj] :
+#endif
+            mNewSensitivity * mStatistics.mMeans[jj];
+   }
+
    if (mDoProfile)
 #ifdef OLD_METHOD_AVAILABLE
       mHistoryLen = mNWindowsToExamine;
@@ -902,6 +954,9 @@ EffectNoiseReduction::Worker::Worker(EffectNoiseReduction &effect,
       // See ReduceNoise()
       mHistoryLen = std::max(mNWindowsToExamine, mCenter + nAttackBlocks);
    }
+
+   // A gain raised by release decays to the floor after nReleaseBlocks
+   mWarmUpSteps = nReleaseBlocks + 1;
 }
 
 bool MyTransformer::DoStart()
@@ -915,10 +970,8 @@ bool MyTransformer::DoStart()
    return TrackSpectrumTransformer::DoStart();
 }
 
-bool EffectNoiseReduction::Worker::Processor(SpectrumTransformer &trans)
+void EffectNoiseReduction::Worker::ProcessWindow(MyTransformer &transformer)
 {
-   auto &transformer = static_cast<MyTransformer &>(trans);
-   auto &worker = transformer.mWorker;
    // Compute power spectrum in the newest window
    {
       auto &record = transformer.NthWindow(0);
@@ -926,7 +979,7 @@ bool EffectNoiseReduction::Worker::Processor(SpectrumTransformer &trans)
       const double dc = record.mRealFFTs[0];
       *pSpectrum++ = dc * dc;
       float *pReal = &record.mRealFFTs[1], *pImag = &record.mImagFFTs[1];
-      for (size_t nn = worker.mSettings.SpectrumSize() - 2; nn--;) {
+      for (size_t nn = mSettings.SpectrumSize() - 2; nn--;) {
          const double re = *pReal++, im = *pImag++;
          *pSpectrum++ = re * re + im * im;
       }
@@ -934,10 +987,26 @@ bool EffectNoiseReduction::Worker::Processor(SpectrumTransformer &trans)
       *pSpectrum = nyquist * nyquist;
    }
 
-   if (worker.mDoProfile)
-      worker.GatherStatistics(transformer);
+   if (mDoProfile)
+      GatherStatistics(transformer);
    else
-      worker.ReduceNoise(transformer);
+      ReduceNoise(transformer);
+}
+
+bool EffectNoiseReduction::Worker::ConcurrentProcessor(
+   SpectrumTransformer &trans)
+{
+   // Progress is reported by TrackSpectrumTransformer::ProcessConcurrently
+   auto &transformer = static_cast<MyTransformer &>(trans);
+   transformer.mWorker.ProcessWindow(transformer);
+   return true;
+}
+
+bool EffectNoiseReduction::Worker::Processor(SpectrumTransformer &trans)
+{
+   auto &transformer = static_cast<MyTransformer &>(trans);
+   auto &worker = transformer.mWorker;
+   worker.ProcessWindow(transformer);
 
    // Update the Progress meter, let user cancel
    return !worker.mEffect.TrackProgress(worker.mProgressTrackCount,
@@ -1002,21 +1071,31 @@ void EffectNoiseReduction::Worker::GatherStatistics(MyTransformer &transformer)
 #endif
 }
 
-// Return true iff the given band of the "center" window looks like noise.
-// Examine the band in a few neighboring windows to decide.
+// Find the statistic of power in each band of a few windows around the
+// "center" window, which is compared with mThresholds to decide whether the
+// band looks like noise.
+// Loops over windows enclose loops over bands, without branches, so that the
+// compiler can vectorize them.
 inline
-bool EffectNoiseReduction::Worker::Classify(
-   MyTransformer &transformer, unsigned nWindows, int band)
+void EffectNoiseReduction::Worker::Classify(
+   MyTransformer &transformer, unsigned nWindows) const
 {
+   const auto pGreatest = transformer.mGreatest.data();
+   const auto pSecond = transformer.mSecond.data();
+   const auto pThird = transformer.mThird.data();
    switch (mMethod) {
 #ifdef OLD_METHOD_AVAILABLE
    case DM_OLD_METHOD:
       {
-         float min = NthWindow(0).mSpectrums[band];
-         for (unsigned ii = 1; ii < nWindows; ++ii)
-            min = std::min(min, NthWindow(ii).mSpectrums[band]);
-         return
-            min <= mOldSensitivityFactor * mStatistics.mNoiseThreshold[band];
+         // Use the least power
+         std::copy(transformer.NthWindow(0).mSpectrums.begin(),
+            transformer.NthWindow(0).mSpectrums.end(), pSecond);
+         for (unsigned ii = 1; ii < nWindows; ++ii) {
+            const auto pPower = transformer.NthWindow(ii).mSpectrums.data();
+            for (size_t jj = mBinLow; jj < mBinHigh; ++jj)
+               pSecond[jj] = std::min(pSecond[jj], pPower[jj]);
+         }
+         return;
       }
 #endif
    // New methods suppose an exponential distribution of power values
@@ -1038,22 +1117,27 @@ bool EffectNoiseReduction::Worker::Classify(
          goto secondGreatest;
       else if (nWindows <= 5)
       {
-         float greatest = 0.0, second = 0.0, third = 0.0;
+         std::fill(pGreatest + mBinLow, pGreatest + mBinHigh, 0.0f);
+         std::fill(pSecond + mBinLow, pSecond + mBinHigh, 0.0f);
+         std::fill(pThird + mBinLow, pThird + mBinHigh, 0.0f);
          for (unsigned ii = 0; ii < nWindows; ++ii) {
-            const float power = transformer.NthWindow(ii).mSpectrums[band];
-            if (power >= greatest)
-               third = second, second = greatest, greatest = power;
-            else if (power >= second)
-               third = second, second = power;
-            else if (power >= third)
-               third = power;
+            const auto pPower = transformer.NthWindow(ii).mSpectrums.data();
+            for (size_t jj = mBinLow; jj < mBinHigh; ++jj) {
+               const float power = pPower[jj];
+               pThird[jj] = std::max(pThird[jj], std::min(power, pSecond[jj]));
+               pSecond[jj] =
+                  std::max(pSecond[jj], std::min(power, pGreatest[jj]));
+               pGreatest[jj] = std::max(pGreatest[jj], power);
+            }
          }
-         return third <= mNewSensitivity * mStatistics.mMeans[band];
+         std::copy(pThird + mBinLow, pThird + mBinHigh, pSecond + mBinLow);
+         return;
       }
       else {
          // not implemented
          wxASSERT(false);
-         return true;
+         std::fill(pSecond + mBinLow, pSecond + mBinHigh, 0.0f);
+         return;
       }
    secondGreatest:
    case DM_SECOND_GREATEST:
@@ -1061,23 +1145,28 @@ bool EffectNoiseReduction::Worker::Classify(
          // This method just throws out the high outlier.  It
          // should be less prone to distortions and more prone to
          // chimes.
-         float greatest = 0.0, second = 0.0;
+         std::fill(pGreatest + mBinLow, pGreatest + mBinHigh, 0.0f);
+         std::fill(pSecond + mBinLow, pSecond + mBinHigh, 0.0f);
          for (unsigned ii = 0; ii < nWindows; ++ii) {
-            const float power = transformer.NthWindow(ii).mSpectrums[band];
-            if (power >= greatest)
-               second = greatest, greatest = power;
-            else if (power >= second)
-               second = power;
+            const auto pPower = transformer.NthWindow(ii).mSpectrums.data();
+            for (size_t jj = mBinLow; jj < mBinHigh; ++jj) {
+               const float power = pPower[jj];
+               pSecond[jj] =
+                  std::max(pSecond[jj], std::min(power, pGreatest[jj]));
+               pGreatest[jj] = std::max(pGreatest[jj], power);
+            }
          }
-         return second <= mNewSensitivity * mStatistics.mMeans[band];
+         return;
       }
    default:
       wxASSERT(false);
-      return true;
+      std::fill(pSecond + mBinLow, pSecond + mBinHigh, 0.0f);
+      return;
    }
 }
 
-void EffectNoiseReduction::Worker::ReduceNoise(MyTransformer &transformer)
+void EffectNoiseReduction::Worker::ReduceNoise(
+   MyTransformer &transformer) const
 {
    auto historyLen = transformer.CurrentQueueSize();
    auto nWindows = std::min<unsigned>(mNWindowsToExamine, historyLen);
@@ -1097,27 +1186,26 @@ void EffectNoiseReduction::Worker::ReduceNoise(MyTransformer &transformer)
    // or, if isolating noise, zero out the non-noise
    if (nWindows > mCenter)
    {
+      Classify(transformer, nWindows);
+      const auto pStatistic = transformer.mSecond.data();
+      const auto pThreshold = mThresholds.data();
       auto pGain = transformer.NthWindow(mCenter).mGains.data();
       if (mNoiseReductionChoice == NRC_ISOLATE_NOISE) {
          // All above or below the selected frequency range is non-noise
          std::fill(pGain, pGain + mBinLow, 0.0f);
          std::fill(pGain + mBinHigh, pGain + spectrumSize, 0.0f);
-         pGain += mBinLow;
          for (size_t jj = mBinLow; jj < mBinHigh; ++jj) {
-               const bool isNoise = Classify(transformer, nWindows, jj);
-            *pGain++ = isNoise ? 1.0 : 0.0;
+            const bool isNoise = pStatistic[jj] <= pThreshold[jj];
+            pGain[jj] = isNoise ? 1.0f : 0.0f;
          }
       }
       else {
          // All above or below the selected frequency range is non-noise
          std::fill(pGain, pGain + mBinLow, 1.0f);
          std::fill(pGain + mBinHigh, pGain + spectrumSize, 1.0f);
-         pGain += mBinLow;
          for (size_t jj = mBinLow; jj < mBinHigh; ++jj) {
-            const bool isNoise = Classify(transformer, nWindows, jj);
-            if (!isNoise)
-               *pGain = 1.0;
-            ++pGain;
+            const bool isNoise = pStatistic[jj] <= pThreshold[jj];
+            pGain[jj] = isNoise ? pGain[jj] : 1.0f;
          }
       }
    }
@@ -1130,19 +1218,24 @@ void EffectNoiseReduction::Worker::ReduceNoise(MyTransformer &transformer)
 
       // First, the attack, which goes backward in time, which is,
       // toward higher indices in the queue.
-      for (size_t jj = 0; jj < spectrumSize; ++jj) {
-         for (unsigned ii = mCenter + 1; ii < historyLen; ++ii) {
+      // In each band, stop where our attack curve is intersecting
+      // the release curve of some window previously processed.
+      const auto pAttacking = transformer.mAttacking.data();
+      std::fill(pAttacking, pAttacking + spectrumSize, 1);
+      for (unsigned ii = mCenter + 1; ii < historyLen; ++ii) {
+         const auto pPrevGain = transformer.NthWindow(ii - 1).mGains.data();
+         const auto pGain = transformer.NthWindow(ii).mGains.data();
+         char attacking = 0;
+         for (size_t jj = 0; jj < spectrumSize; ++jj) {
             const float minimum =
-               std::max(mNoiseAttenFactor,
-                  transformer.NthWindow(ii - 1).mGains[jj] * mOneBlockAttack);
-            float &gain = transformer.NthWindow(ii).mGains[jj];
-            if (gain < minimum)
-               gain = minimum;
-            else
-               // We can stop now, our attack curve is intersecting
-               // the release curve of some window previously processed.
-               break;
+               std::max(mNoiseAttenFactor, pPrevGain[jj] * mOneBlockAttack);
+            const char raise = pAttacking[jj] & (pGain[jj] < minimum);
+            pGain[jj] = raise ? minimum : pGain[jj];
+            pAttacking[jj] = raise;
+            attacking |= raise;
          }
+         if (!attacking)
+            break;
       }
 
       // Now, release.  We need only look one window ahead.  This part will
@@ -1169,8 +1262,7 @@ void EffectNoiseReduction::Worker::ReduceNoise(MyTransformer &transformer)
       if (mNoiseReductionChoice != NRC_ISOLATE_NOISE)
          // Apply frequency smoothing to output gain
          // Gains are not less than mNoiseAttenFactor
-         ApplyFreqSmoothing(record.mGains);
-
+         ApplyFreqSmoothing(record.mGains, transformer.mFreqSmoothingScratch);
       // Apply gain to FFT
       {
          const float *pGain = &record.mGains[1];
@@ -26,6 +26,7 @@ effects from this one class.
 
 
 #include "Nyquist.h"
+#include "NyquistJobs.h"
 #include "EffectOutputTracks.h"
 
 #include <algorithm>
@@ -54,6 +55,7 @@ effects from this one class.
 #include "../../LabelTrack.h"
 #include "NoteTrack.h"
 #include "../../ShuttleGetDefinition.h"
+#include "../../prefs/EffectsPrefs.h"
 #include "../../prefs/GUIPrefs.h"
 #include "../../prefs/SpectrogramSettings.h"
 #include "../../tracks/playabletrack/wavetrack/ui/WaveChannelView.h"
@@ -661,7 +663,7 @@ bool NyquistEffect::Init()
    return true;
 }
 
-static void RegisterFunctions();
+static void RegisterFunctions(bool withCommands = true);
 
 //! Reads and writes Audacity's track objects, interchanging with Nyquist
 //! sound objects (implemented in the library layer written in C)
@@ -707,6 +709,15 @@ struct NyquistEffect::NyxContext {
    std::exception_ptr mpException{};
 };
 
+//! A channel group whose evaluation is left to a helper process
+struct NyquistEffect::TrackJob {
+   std::unique_ptr<NyxContext> pContext;
+   wxString cmd;
+   //! Values of mFirstInGroup and mCount that ProcessOne would have seen
+   bool firstInGroup;
+   unsigned count;
+};
+
 bool NyquistEffect::Process(EffectInstance &, EffectSettings &settings)
 {
    if (mIsPrompt && mControls.size() > 0 && !IsBatchProcessing()) {
@@ -919,6 +930,10 @@ bool NyquistEffect::Process(EffectInstance &, EffectSettings &settings)
    Track *gtLast = NULL;
    double progressTot{};
 
+   // Evaluations deferred to helper processes
+   std::vector<TrackJob> jobs;
+   const bool bInHelpers = !bOnePassTool && UseHelperProcesses(pRange->size());
+
    for (;
         bOnePassTool || pRange->first != pRange->second;
         (void) (!pRange || (++pRange->first, true))
@@ -928,8 +943,10 @@ bool NyquistEffect::Process(EffectInstance &, EffectSettings &settings)
       mDebugOutput = Verbatim( "%s" ).Format( std::cref( mDebugOutputStr ) );
 
       // New context for each channel group of input
-      NyxContext nyxContext{ [this](double frac){ return TotalProgress(frac); },
-         scale, progressTot };
+      auto pNyxContext = std::make_unique<NyxContext>(
+         [this](double frac){ return TotalProgress(frac); },
+         scale, progressTot);
+      auto &nyxContext = *pNyxContext;
       auto &mCurNumChannels = nyxContext.mCurNumChannels;
       auto &mCurChannelGroup = nyxContext.mCurChannelGroup;
       auto &mCurTrack = nyxContext.mCurTrack;
@@ -968,29 +985,6 @@ bool NyquistEffect::Process(EffectInstance &, EffectSettings &settings)
             mCurLen = std::min(mCurLen, mMaxLen);
          }
 
-         // libnyquist breaks except in LC_NUMERIC=="C".
-         //
-         // Note that we must set the locale to "C" even before calling
-         // nyx_init() because otherwise some effects will not work!
-         //
-         // MB: setlocale is not thread-safe.  Should use uselocale()
-         //     if available, or fix libnyquist to be locale-independent.
-         // See also http://bugzilla.audacityteam.org/show_bug.cgi?id=642#c9
-         // for further info about this thread safety question.
-         wxString prevlocale = wxSetlocale(LC_NUMERIC, NULL);
-         wxSetlocale(LC_NUMERIC, wxString(wxT("C")));
-
-         nyx_init();
-         nyx_set_os_callback(StaticOSCallback, (void *)this);
-         nyx_capture_output(StaticOutputCallback, (void *)this);
-
-         auto cleanup = finally( [&] {
-            nyx_capture_output(NULL, (void *)NULL);
-            nyx_set_os_callback(NULL, (void *)NULL);
-            nyx_cleanup();
-         } );
-
-
          if (mVersion >= 4)
          {
             mPerTrackProps = wxEmptyString;
@@ -1037,20 +1031,29 @@ bool NyquistEffect::Process(EffectInstance &, EffectSettings &settings)
                Internat::ToString(t1));
          }
 
-         success = ProcessOne(nyxContext, oOutputs ? &*oOutputs : nullptr);
-
-         // Reset previous locale
-         wxSetlocale(LC_NUMERIC, prevlocale);
-
-         if (!success || bOnePassTool) {
-            goto finish;
+         const auto pOutputs = oOutputs ? &*oOutputs : nullptr;
+         auto cmd = MakeCommand(nyxContext, pOutputs);
+         if (bInHelpers)
+            jobs.push_back({ move(pNyxContext), move(cmd), mFirstInGroup,
+               mCount });
+         else {
+            success = ProcessOne(nyxContext, pOutputs, cmd);
+            if (!success || bOnePassTool) {
+               goto finish;
+            }
+            progressTot += nyxContext.mProgressIn + nyxContext.mProgressOut;
          }
-         progressTot += nyxContext.mProgressIn + nyxContext.mProgressOut;
       }
 
       mCount += mCurNumChannels;
    }
 
+   if (bInHelpers) {
+      success = ProcessInHelpers(jobs, *oOutputs);
+      if (!success)
+         goto finish;
+   }
+
    if (mOutputTime > 0.0) {
       mT1 = mT0 + mOutputTime;
    }
@@ -1267,11 +1270,10 @@ wxString GetClipBoundaries(const Track* t)
 
 // NyquistEffect implementation
 
-bool NyquistEffect::ProcessOne(
+wxString NyquistEffect::MakeCommand(
    NyxContext &nyxContext, EffectOutputTracks *pOutputs)
 {
    const auto mCurNumChannels = nyxContext.mCurNumChannels;
-   nyx_rval rval;
 
    wxString cmd;
    cmd += wxT("(snd-set-latency  0.1)");
@@ -1280,14 +1282,10 @@ bool NyquistEffect::ProcessOne(
    // so tools do not get *TRACK*.
    if (GetType() == EffectTypeTool)
       cmd += wxT("(setf S 0.25)\n");  // No Track.
-   else if (mVersion >= 4) {
-      nyx_set_audio_name("*TRACK*");
+   else if (mVersion >= 4)
       cmd += wxT("(setf S 0.25)\n");
-   }
-   else {
-      nyx_set_audio_name("S");
+   else
       cmd += wxT("(setf *TRACK* '*unbound*)\n");
-   }
 
    if(mVersion >= 4) {
       cmd += mProps;
@@ -1449,18 +1447,6 @@ bool NyquistEffect::ProcessOne(
          cmd += wxString::Format(wxT("(putprop '*SELECTION* %s 'RMS)\n"), rmsString);
    }
 
-   // If in tool mode, then we don't do anything with the track and selection.
-   if (GetType() == EffectTypeTool)
-      nyx_set_audio_params(44100, 0);
-   else if (GetType() == EffectTypeGenerate)
-      nyx_set_audio_params(mCurChannelGroup->GetRate(), 0);
-   else {
-      auto curLen = nyxContext.mCurLen.as_long_long();
-      nyx_set_audio_params(mCurChannelGroup->GetRate(), curLen);
-      nyx_set_input_audio(NyxContext::StaticGetCallback, &nyxContext,
-         (int)mCurNumChannels, curLen, mCurChannelGroup->GetRate());
-   }
-
    // Restore the Nyquist sixteenth note symbol for Generate plug-ins.
    // See http://bugzilla.audacityteam.org/show_bug.cgi?id=490.
    if (GetType() == EffectTypeGenerate) {
@@ -1545,6 +1531,56 @@ bool NyquistEffect::ProcessOne(
       cmd += mCmd;
    }
 
+   return cmd;
+}
+
+bool NyquistEffect::ProcessOne(
+   NyxContext &nyxContext, EffectOutputTracks *pOutputs, const wxString &cmd)
+{
+   const auto mCurNumChannels = nyxContext.mCurNumChannels;
+   const auto& mCurChannelGroup = nyxContext.mCurChannelGroup;
+   nyx_rval rval;
+
+   // libnyquist breaks except in LC_NUMERIC=="C".
+   //
+   // Note that we must set the locale to "C" even before calling
+   // nyx_init() because otherwise some effects will not work!
+   //
+   // MB: setlocale is not thread-safe.  Should use uselocale()
+   //     if available, or fix libnyquist to be locale-independent.
+   // See also http://bugzilla.audacityteam.org/show_bug.cgi?id=642#c9
+   // for further info about this thread safety question.
+   wxString prevlocale = wxSetlocale(LC_NUMERIC, NULL);
+   wxSetlocale(LC_NUMERIC, wxString(wxT("C")));
+
+   nyx_init();
+   nyx_set_os_callback(StaticOSCallback, (void *)this);
+   nyx_capture_output(StaticOutputCallback, (void *)this);
+
+   auto cleanup = finally( [&] {
+      nyx_capture_output(NULL, (void *)NULL);
+      nyx_set_os_callback(NULL, (void *)NULL);
+      nyx_cleanup();
+      // Reset previous locale
+      wxSetlocale(LC_NUMERIC, prevlocale);
+   } );
+
+   // Tools do not get *TRACK*; see MakeCommand()
+   if (GetType() != EffectTypeTool)
+      nyx_set_audio_name(mVersion >= 4 ? "*TRACK*" : "S");
+
+   // If in tool mode, then we don't do anything with the track and selection.
+   if (GetType() == EffectTypeTool)
+      nyx_set_audio_params(44100, 0);
+   else if (GetType() == EffectTypeGenerate)
+      nyx_set_audio_params(mCurChannelGroup->GetRate(), 0);
+   else {
+      auto curLen = nyxContext.mCurLen.as_long_long();
+      nyx_set_audio_params(mCurChannelGroup->GetRate(), curLen);
+      nyx_set_input_audio(NyxContext::StaticGetCallback, &nyxContext,
+         (int)mCurNumChannels, curLen, mCurChannelGroup->GetRate());
+   }
+
    // Evaluate the expression, which may invoke the get callback, but often does
    // not, leaving that to delayed evaluation of the output sound
    rval = nyx_eval_expression(cmd.mb_str(wxConvUTF8));
@@ -1709,7 +1745,6 @@ bool NyquistEffect::ProcessOne(
    }
 
    nyxContext.mOutputTrack = mCurChannelGroup->EmptyCopy();
-   auto out = nyxContext.mOutputTrack;
 
    // Now fully evaluate the sound
    int success = nyx_get_audio(NyxContext::StaticPutCallback, &nyxContext);
@@ -1721,6 +1756,15 @@ bool NyquistEffect::ProcessOne(
    if (!success)
       return false;
 
+   return PasteOutput(nyxContext, outChannels);
+}
+
+bool NyquistEffect::PasteOutput(NyxContext &nyxContext, int outChannels)
+{
+   const auto mCurNumChannels = nyxContext.mCurNumChannels;
+   const auto& mCurChannelGroup = nyxContext.mCurChannelGroup;
+   auto out = nyxContext.mOutputTrack;
+
    mOutputTime = out->GetEndTime();
    if (mOutputTime <= 0) {
       EffectUIServices::DoMessageBox(
@@ -1768,6 +1812,141 @@ bool NyquistEffect::ProcessOne(
    return true;
 }
 
+namespace {
+//! Longer selections are evaluated in this process, rather than be copied
+//! through a socket
+constexpr int64_t MaxHelperFrames = 1 << 24;
+
+//! Bytes of samples of the jobs given to helpers and not yet pasted, beyond
+//! which no more are given, unless there is none
+/*! Each such job holds its input, a serialized copy while it is sent, and
+ then its result, which may arrive before the results of earlier jobs */
+constexpr size_t MaxHelperBytes = size_t{ 1 } << 28;
+}
+
+bool NyquistEffect::UseHelperProcesses(size_t nTracks) const
+{
+   // Only plain effects whose programs can be evaluated for each track
+   // independently, with no interaction.
+   // *SCRATCH* keeps its value between runs in this process only; a helper
+   // would neither see it nor update it, and give different audio silently.
+   return NyquistHelperProcesses.Read()
+      && nTracks > 1
+      && GetType() == EffectTypeProcess
+      && !mDebug && !mTrace && !mRedirectOutput
+      && !mCmd.Lower().Contains(wxT("*scratch*"))
+      && NyquistJobPool::DefaultSize() > 1;
+}
+
+bool NyquistEffect::ProcessInHelpers(
+   std::vector<TrackJob> &jobs, EffectOutputTracks &outputs)
+{
+   NyquistJobPool pool{ std::min(jobs.size(), NyquistJobPool::DefaultSize()) };
+   std::vector<std::optional<NyquistJobResult>> results(jobs.size());
+   size_t nCompleted = 0;
+   size_t next = 0;
+   std::vector<size_t> jobBytes(jobs.size());
+   size_t bytesInFlight = 0;
+
+   const auto makeJob = [this](const TrackJob &trackJob) {
+      const auto &nyxContext = *trackJob.pContext;
+      NyquistJob job;
+      job.command = trackJob.cmd.utf8_str().data();
+      job.audioName = mVersion >= 4 ? "*TRACK*" : "S";
+      job.rate = nyxContext.mCurChannelGroup->GetRate();
+      job.length = nyxContext.mCurLen.as_long_long();
+      for (size_t ii = 0; ii < nyxContext.mCurNumChannels; ++ii) {
+         auto &samples = job.channels.emplace_back(job.length);
+         nyxContext.mCurTrack[ii]->GetFloats(
+            samples.data(), nyxContext.mCurStart, samples.size()); // may throw
+      }
+      return job;
+   };
+
+   // Keep the helpers busy, reading input for the jobs only as they start
+   const auto submitMore = [&]{
+      while (next < jobs.size() && pool.CanSubmit()) {
+         if (jobs[next].pContext->mCurLen.as_long_long() > MaxHelperFrames) {
+            // Leave it for this process
+            results[next].emplace();
+            ++nCompleted;
+         }
+         else {
+            const auto &nyxContext = *jobs[next].pContext;
+            const auto bytes =
+               static_cast<size_t>(nyxContext.mCurLen.as_long_long()) *
+               nyxContext.mCurNumChannels * sizeof(float);
+            if (bytesInFlight > 0 && bytesInFlight + bytes > MaxHelperBytes)
+               // Wait for earlier results to be pasted and freed
+               break;
+            if (!pool.Submit(next, makeJob(jobs[next])))
+               break;
+            bytesInFlight += (jobBytes[next] = bytes);
+         }
+         ++next;
+      }
+   };
+
+   // Paste the results in the order of the tracks, as ProcessOne would
+   for (size_t ii = 0; ii < jobs.size(); ++ii) {
+      while (!results[ii]) {
+         submitMore();
+         if (next <= ii && !pool.IsAlive()) {
+            // No helper is left to do it
+            results[ii].emplace();
+            ++nCompleted;
+            ++next;
+            break;
+         }
+         if (auto completed = pool.WaitNext(std::chrono::milliseconds{ 100 })) {
+            results[completed->id] = move(completed->result);
+            ++nCompleted;
+         }
+         if (TotalProgress(double(nCompleted) / jobs.size()))
+            return false;
+      }
+
+      auto &trackJob = jobs[ii];
+      auto &nyxContext = *trackJob.pContext;
+      auto result = move(*results[ii]);
+      results[ii].reset();
+      bytesInFlight -= jobBytes[ii];
+      mFirstInGroup = trackJob.firstInGroup;
+      mCount = trackJob.count;
+
+      const int outChannels = result.channels.size();
+      if (!result.audio || outChannels == 0 ||
+          outChannels > static_cast<int>(nyxContext.mCurNumChannels)) {
+         // Evaluate again here, where other results and errors are handled
+         if (!ProcessOne(nyxContext, &outputs, trackJob.cmd))
+            return false;
+      }
+      else {
+         for (auto c : result.output)
+            OutputCallback(c);
+         const auto output = mDebugOutput.Translation();
+         if (!output.empty())
+            /* i18n-hint: An effect "returned" a message.*/
+            wxLogMessage(wxT("\'%s\' returned:\n%s"),
+               mName.Translation(), output);
+
+         nyxContext.mOutputTrack = nyxContext.mCurChannelGroup->EmptyCopy();
+         auto iChannel = nyxContext.mOutputTrack->Channels().begin();
+         for (auto &samples : result.channels) {
+            (*iChannel)->Append(reinterpret_cast<constSamplePtr>(samples.data()),
+               floatSample, samples.size());
+            ++iChannel;
+            // Free memory as soon as possible
+            samples = {};
+         }
+         if (!PasteOutput(nyxContext, outChannels))
+            return false;
+      }
+      trackJob.pContext.reset();
+   }
+   return true;
+}
+
 // ============================================================================
 // NyquistEffect Implementation
 // ============================================================================
@@ -2640,6 +2819,73 @@ int NyquistEffect::NyxContext::PutCallback(float *buffer, int channel,
    }, MakeSimpleGuard(-1)); // translate all exceptions into failure
 }
 
+NyquistJobResult NyquistEffect::RunJob(const NyquistJob &job)
+{
+   RegisterFunctions(false);
+
+   NyquistJobResult result;
+   const auto nChannels = job.channels.size();
+   if (nChannels < 1 || nChannels > 2)
+      return result;
+
+   // See ProcessOne
+   wxString prevlocale = wxSetlocale(LC_NUMERIC, NULL);
+   wxSetlocale(LC_NUMERIC, wxString(wxT("C")));
+
+   nyx_init();
+   nyx_capture_output([](int c, void *userdata){
+      static_cast<std::string*>(userdata)->push_back(static_cast<char>(c));
+   }, &result.output);
+
+   auto cleanup = finally( [&] {
+      nyx_capture_output(NULL, (void *)NULL);
+      nyx_cleanup();
+      wxSetlocale(LC_NUMERIC, prevlocale);
+   } );
+
+   nyx_set_audio_name(job.audioName.c_str());
+   nyx_set_audio_params(job.rate, job.length);
+   nyx_set_input_audio([](float *buffer, int channel,
+      int64_t start, int64_t len, int64_t, void *userdata) {
+         auto &samples =
+            static_cast<const NyquistJob*>(userdata)->channels[channel];
+         if (start < 0 || len < 0 ||
+             start + len > static_cast<int64_t>(samples.size()))
+            return -1;
+         std::copy_n(samples.data() + start, len, buffer);
+         return 0;
+      }, const_cast<NyquistJob*>(&job),
+      static_cast<int>(nChannels), job.length, job.rate);
+
+   if (nyx_eval_expression(job.command.c_str()) != nyx_audio)
+      return result;
+
+   // Other checks of the result are left to the application, which repeats
+   // the job if it is not audio
+   const auto outChannels = nyx_get_audio_num_channels();
+   if (outChannels < 1 || outChannels > static_cast<int>(nChannels))
+      return result;
+
+   result.channels.resize(outChannels);
+   const auto success = nyx_get_audio([](float *buffer, int channel,
+      int64_t, int64_t len, int64_t, void *userdata) {
+         // Don't let C++ exceptions propagate through the Nyquist library
+         return GuardedCall<int>( [&] {
+            auto &samples = (*static_cast<std::vector<std::vector<float>>*>(
+               userdata))[channel];
+            samples.insert(samples.end(), buffer, buffer + len);
+            return 0;
+         }, MakeSimpleGuard(-1));
+      }, &result.channels);
+   if (!success) {
+      result.channels.clear();
+      return result;
+   }
+
+   result.audio = true;
+   return result;
+}
+
 void NyquistEffect::StaticOutputCallback(int c, void *This)
 {
    ((NyquistEffect *)This)->OutputCallback(c);
@@ -3609,7 +3855,7 @@ LVAL xlc_aud_do(void)
     return (dst);
 }
 
-static void RegisterFunctions()
+static void RegisterFunctions(bool withCommands)
 {
    // Add functions to XLisp.  Do this only once,
    // before the first call to nyx_init.
@@ -3623,9 +3869,17 @@ static void RegisterFunctions()
          { "_C", SUBR, gettextc },
          { "NGETTEXT", SUBR, ngettext },
          { "NGETTEXTC", SUBR, ngettextc },
-         { "AUD-DO",  SUBR, xlc_aud_do },
        };
 
       xlbindfunctions( functions, WXSIZEOF( functions ) );
+
+      // Helper processes have no project to run commands on
+      if (withCommands) {
+         static const FUNDEF commandFunctions[] = {
+            { "AUD-DO",  SUBR, xlc_aud_do },
+          };
+
+         xlbindfunctions( commandFunctions, WXSIZEOF( commandFunctions ) );
+      }
    }
 }
@@ -24,6 +24,8 @@ class wxCheckBox;
 class wxTextCtrl;
 
 class EffectOutputTracks;
+struct NyquistJob;
+struct NyquistJobResult;
 
 #define NYQUISTEFFECTS_VERSION wxT("1.0.0.0")
 
@@ -140,6 +142,9 @@ public:
    void Break();
    void Stop();
 
+   //! Evaluate a program for one track in a helper process
+   static NyquistJobResult RunJob(const NyquistJob &job);
+
 private:
    wxWeakRef<wxWindow> mUIParent{};
 
@@ -147,7 +152,14 @@ private:
    // NyquistEffect implementation
 
    struct NyxContext;
-   bool ProcessOne(NyxContext &nyxContext, EffectOutputTracks *pOutputs);
+   struct TrackJob;
+   wxString MakeCommand(NyxContext &nyxContext, EffectOutputTracks *pOutputs);
+   bool ProcessOne(NyxContext &nyxContext, EffectOutputTracks *pOutputs,
+      const wxString &cmd);
+   bool PasteOutput(NyxContext &nyxContext, int outChannels);
+   bool UseHelperProcesses(size_t nTracks) const;
+   bool ProcessInHelpers(
+      std::vector<TrackJob> &jobs, EffectOutputTracks &outputs);
 
    void BuildPromptWindow(ShuttleGui & S);
    void BuildEffectWindow(ShuttleGui & S);
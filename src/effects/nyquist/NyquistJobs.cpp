@@ -0,0 +1,538 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file NyquistJobs.cpp
+
+**********************************************************************/
+#include "NyquistJobs.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include <wx/log.h>
+#include <wx/module.h>
+#include <wx/process.h>
+#include <wx/utils.h>
+
+#include "CommandLineArgs.h"
+#include "FileNames.h"
+#include "IPCChannel.h"
+#include "IPCClient.h"
+#include "IPCServer.h"
+#include "LoadNyquist.h"
+#include "Nyquist.h"
+#include "PlatformCompatibility.h"
+
+namespace
+{
+constexpr auto JobArgument = "--nyquist-job";
+
+//! Builds one message:  the length of the payload, then the payload
+class MessageWriter
+{
+public:
+   MessageWriter() : mBytes(sizeof(uint64_t)) {}
+
+   template<typename T> void Put(const T &value)
+   {
+      const auto offset = mBytes.size();
+      mBytes.resize(offset + sizeof(T));
+      std::memcpy(mBytes.data() + offset, &value, sizeof(T));
+   }
+   void PutString(const std::string &value)
+   {
+      Put<uint64_t>(value.size());
+      mBytes.insert(mBytes.end(), value.begin(), value.end());
+   }
+   void PutSamples(const std::vector<float> &samples)
+   {
+      Put<uint64_t>(samples.size());
+      const auto begin = reinterpret_cast<const char*>(samples.data());
+      mBytes.insert(mBytes.end(), begin, begin + samples.size() * sizeof(float));
+   }
+
+   std::vector<char> Finish()
+   {
+      const uint64_t size = mBytes.size() - sizeof(uint64_t);
+      std::memcpy(mBytes.data(), &size, sizeof(size));
+      return move(mBytes);
+   }
+
+private:
+   std::vector<char> mBytes;
+};
+
+//! Parses the payload of one message; throws if it is truncated
+class MessageReader
+{
+public:
+   explicit MessageReader(const std::vector<char> &payload)
+      : mPos{ payload.data() }, mEnd{ payload.data() + payload.size() }
+   {}
+
+   template<typename T> T Get()
+   {
+      T value;
+      std::memcpy(&value, Take(sizeof(T)), sizeof(T));
+      return value;
+   }
+   std::string GetString()
+   {
+      const auto size = Get<uint64_t>();
+      const auto begin = Take(size);
+      return { begin, begin + size };
+   }
+   std::vector<float> GetSamples()
+   {
+      const auto size = Get<uint64_t>();
+      if (size > Remaining() / sizeof(float))
+         throw std::runtime_error("truncated message");
+      std::vector<float> samples(size);
+      std::memcpy(samples.data(), Take(size * sizeof(float)),
+         size * sizeof(float));
+      return samples;
+   }
+
+private:
+   size_t Remaining() const { return mEnd - mPos; }
+   const char *Take(size_t size)
+   {
+      if (size > Remaining())
+         throw std::runtime_error("truncated message");
+      return std::exchange(mPos, mPos + size);
+   }
+
+   const char *mPos;
+   const char *const mEnd;
+};
+
+//! Collects bytes from a channel, until whole messages can be extracted
+class MessageBuffer
+{
+public:
+   void Consume(const void *bytes, size_t size)
+   {
+      const auto begin = static_cast<const char*>(bytes);
+      mBytes.insert(mBytes.end(), begin, begin + size);
+   }
+
+   //! @return the payload of the first whole message, which is removed
+   std::optional<std::vector<char>> Pop()
+   {
+      uint64_t size;
+      if (mBytes.size() < sizeof(size))
+         return {};
+      std::memcpy(&size, mBytes.data(), sizeof(size));
+      if (mBytes.size() - sizeof(size) < size)
+         return {};
+      const auto begin = mBytes.begin() + sizeof(size);
+      std::vector<char> payload{ begin, begin + size };
+      mBytes.erase(mBytes.begin(), begin + size);
+      return payload;
+   }
+
+private:
+   std::vector<char> mBytes;
+};
+
+std::vector<char> Write(const NyquistJob &job)
+{
+   MessageWriter writer;
+   writer.Put(job.rate);
+   writer.Put(job.length);
+   writer.PutString(job.audioName);
+   writer.PutString(job.command);
+   writer.Put<uint32_t>(job.channels.size());
+   for (auto &channel : job.channels)
+      writer.PutSamples(channel);
+   return writer.Finish();
+}
+
+NyquistJob ReadJob(const std::vector<char> &payload)
+{
+   MessageReader reader{ payload };
+   NyquistJob job;
+   job.rate = reader.Get<double>();
+   job.length = reader.Get<int64_t>();
+   job.audioName = reader.GetString();
+   job.command = reader.GetString();
+   const auto nChannels = reader.Get<uint32_t>();
+   for (uint32_t ii = 0; ii < nChannels; ++ii)
+      job.channels.push_back(reader.GetSamples());
+   return job;
+}
+
+std::vector<char> Write(const NyquistJobResult &result)
+{
+   MessageWriter writer;
+   writer.Put<uint8_t>(result.audio);
+   writer.PutString(result.output);
+   writer.Put<uint32_t>(result.channels.size());
+   for (auto &channel : result.channels)
+      writer.PutSamples(channel);
+   return writer.Finish();
+}
+
+NyquistJobResult ReadResult(const std::vector<char> &payload)
+{
+   MessageReader reader{ payload };
+   NyquistJobResult result;
+   result.audio = reader.Get<uint8_t>() != 0;
+   result.output = reader.GetString();
+   const auto nChannels = reader.Get<uint32_t>();
+   for (uint32_t ii = 0; ii < nChannels; ++ii)
+      result.channels.push_back(reader.GetSamples());
+   return result;
+}
+
+//! Runs in the helper process, evaluating one job at a time
+class NyquistJobHost final : public IPCChannelStatusCallback
+{
+public:
+   explicit NyquistJobHost(int connectPort)
+   {
+      mClient = std::make_unique<IPCClient>(connectPort, *this);
+   }
+
+   ~NyquistJobHost() override
+   {
+      mClient.reset();
+   }
+
+   void OnConnect(IPCChannel &channel) noexcept override
+   {
+      std::lock_guard lck(mSync);
+      mChannel = &channel;
+   }
+
+   void OnDisconnect() noexcept override { Stop(); }
+   void OnConnectionError() noexcept override { Stop(); }
+
+   void OnDataAvailable(const void *data, size_t size) noexcept override
+   {
+      try {
+         mInput.Consume(data, size);
+         if (auto payload = mInput.Pop()) {
+            {
+               std::lock_guard lck(mSync);
+               mRequest = move(payload);
+            }
+            mCondition.notify_one();
+         }
+      }
+      catch (...) {
+         Stop();
+      }
+   }
+
+   //! @return false when the application closed the connection
+   bool Serve()
+   {
+      std::unique_lock lck(mSync);
+      mCondition.wait(lck, [this]{ return !mRunning || mRequest; });
+      if (!mRunning)
+         return false;
+
+      auto payload = std::exchange(mRequest, std::nullopt);
+      lck.unlock();
+
+      NyquistJobResult result;
+      try {
+         result = NyquistEffect::RunJob(ReadJob(*payload));
+      }
+      catch (...) {
+         // Reply that the job must be repeated in the application
+         result = {};
+      }
+      const auto reply = Write(result);
+
+      lck.lock();
+      if (mChannel)
+         mChannel->Send(reply.data(), reply.size());
+      return true;
+   }
+
+private:
+   void Stop() noexcept
+   {
+      try {
+         std::lock_guard lck(mSync);
+         mRunning = false;
+         mChannel = nullptr;
+      }
+      catch (...) {
+      }
+      mCondition.notify_one();
+   }
+
+   std::unique_ptr<IPCClient> mClient;
+   IPCChannel *mChannel{};
+   MessageBuffer mInput;
+   std::mutex mSync;
+   std::condition_variable mCondition;
+   std::optional<std::vector<char>> mRequest;
+   bool mRunning{ true };
+};
+}
+
+//! The application's end of the connection to one helper process
+class NyquistJobPool::Helper final : public IPCChannelStatusCallback
+{
+public:
+   explicit Helper(NyquistJobPool &pool) : mPool{ pool } {}
+
+   ~Helper() override
+   {
+      // Callbacks may happen until the server is destroyed
+      mServer.reset();
+   }
+
+   //! Called on the main thread only
+   bool Start()
+   {
+      auto server = std::make_unique<IPCServer>(*this);
+      const auto cmd = wxString::Format("\"%s\" %s %d",
+         PlatformCompatibility::GetExecutablePath(),
+         JobArgument,
+         server->GetConnectPort());
+
+      auto process = std::make_unique<wxProcess>();
+      process->Detach();
+      mPid = wxExecute(cmd, wxEXEC_ASYNC, process.get());
+      if (mPid == 0)
+         return false;
+      //process will delete itself upon termination
+      process.release();
+      mServer = move(server);
+      return true;
+   }
+
+   void OnConnect(IPCChannel &channel) noexcept override
+   {
+      std::lock_guard lck(mPool.mSync);
+      mChannel = &channel;
+      if (!mPending.empty()) {
+         try {
+            mChannel->Send(mPending.data(), mPending.size());
+         }
+         catch (...) {
+            Fail();
+         }
+         mPending = {};
+      }
+   }
+
+   void OnDisconnect() noexcept override
+   {
+      std::lock_guard lck(mPool.mSync);
+      mChannel = nullptr;
+      Fail();
+   }
+
+   void OnConnectionError() noexcept override
+   {
+      std::lock_guard lck(mPool.mSync);
+      Fail();
+   }
+
+   void OnDataAvailable(const void *data, size_t size) noexcept override
+   {
+      try {
+         mInput.Consume(data, size);
+         while (auto payload = mInput.Pop()) {
+            auto result = ReadResult(*payload);
+            std::lock_guard lck(mPool.mSync);
+            if (mJob) {
+               mPool.mCompleted.push_back({ *mJob, move(result) });
+               mJob.reset();
+               mPool.mCondition.notify_all();
+            }
+         }
+      }
+      catch (...) {
+         std::lock_guard lck(mPool.mSync);
+         Fail();
+      }
+   }
+
+   // Remaining members are accessed with the pool's mutex locked
+
+   bool IsAlive() const { return mAlive; }
+   bool IsIdle() const { return mAlive && !mJob; }
+
+   bool Submit(size_t id, std::vector<char> message)
+   {
+      try {
+         if (mChannel)
+            mChannel->Send(message.data(), message.size());
+         else
+            // Send when the helper connects
+            mPending = move(message);
+      }
+      catch (...) {
+         return false;
+      }
+      mJob = id;
+      mSubmitted = std::chrono::steady_clock::now();
+      return true;
+   }
+
+   //! Give up a helper that started but never connected
+   void CheckConnection()
+   {
+      if (mJob && !mChannel &&
+          std::chrono::steady_clock::now() - mSubmitted > ConnectTimeout) {
+         Fail();
+         wxProcess::Kill(mPid, wxSIGKILL);
+      }
+   }
+
+   //! Helpers still evaluating a job are killed, not merely disconnected
+   long BusyPid() const { return mAlive && mJob ? mPid : 0; }
+
+private:
+   //! Report any job as not done, and take no more
+   void Fail()
+   {
+      mAlive = false;
+      if (mJob) {
+         mPool.mCompleted.push_back({ *mJob, {} });
+         mJob.reset();
+         mPool.mCondition.notify_all();
+      }
+   }
+
+   NyquistJobPool &mPool;
+   std::unique_ptr<IPCServer> mServer;
+   long mPid{};
+
+   //! Accessed only by the IPC receiving thread
+   MessageBuffer mInput;
+
+   IPCChannel *mChannel{};
+   std::vector<char> mPending;
+   std::optional<size_t> mJob;
+   std::chrono::steady_clock::time_point mSubmitted;
+   bool mAlive{ true };
+};
+
+size_t NyquistJobPool::DefaultSize()
+{
+   return std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool NyquistJobPool::IsJobProcess()
+{
+   return CommandLineArgs::argc >= 3 &&
+      wxStrcmp(CommandLineArgs::argv[1], JobArgument) == 0;
+}
+
+NyquistJobPool::NyquistJobPool(size_t nProcesses)
+{
+   for (size_t ii = 0; ii < nProcesses; ++ii) {
+      try {
+         auto helper = std::make_unique<Helper>(*this);
+         if (!helper->Start())
+            break;
+         std::lock_guard lck(mSync);
+         mHelpers.push_back(move(helper));
+      }
+      catch (...) {
+         break;
+      }
+   }
+}
+
+NyquistJobPool::~NyquistJobPool()
+{
+   std::vector<long> busy;
+   {
+      std::lock_guard lck(mSync);
+      for (auto &pHelper : mHelpers)
+         if (auto pid = pHelper->BusyPid())
+            busy.push_back(pid);
+   }
+   for (auto pid : busy)
+      wxProcess::Kill(pid, wxSIGKILL);
+   // Not holding the lock, which the callbacks take while the connections
+   // close; idle helpers exit when they see the disconnection
+   mHelpers.clear();
+}
+
+bool NyquistJobPool::IsAlive() const
+{
+   std::lock_guard lck(mSync);
+   return std::any_of(mHelpers.begin(), mHelpers.end(),
+      [](auto &pHelper){ return pHelper->IsAlive(); });
+}
+
+bool NyquistJobPool::CanSubmit() const
+{
+   std::lock_guard lck(mSync);
+   return std::any_of(mHelpers.begin(), mHelpers.end(),
+      [](auto &pHelper){ return pHelper->IsIdle(); });
+}
+
+bool NyquistJobPool::Submit(size_t id, const NyquistJob &job)
+{
+   // Serialize before locking
+   auto message = Write(job);
+   std::lock_guard lck(mSync);
+   for (auto &pHelper : mHelpers)
+      if (pHelper->IsIdle())
+         return pHelper->Submit(id, move(message));
+   return false;
+}
+
+auto NyquistJobPool::WaitNext(std::chrono::milliseconds timeout)
+   -> std::optional<Completed>
+{
+   std::unique_lock lck(mSync);
+   for (auto &pHelper : mHelpers)
+      pHelper->CheckConnection();
+   if (!mCondition.wait_for(lck, timeout,
+      [this]{ return !mCompleted.empty(); }))
+      return {};
+   auto result = move(mCompleted.front());
+   mCompleted.pop_front();
+   return result;
+}
+
+//! Makes a helper process serve jobs and then quit, before the application
+//! initializes anything else
+class NyquistJobHostModule final : public wxModule
+{
+public:
+   DECLARE_DYNAMIC_CLASS(NyquistJobHostModule)
+
+   bool OnInit() override
+   {
+      if (NyquistJobPool::IsJobProcess()) {
+         long connectPort;
+         if (!wxString{ CommandLineArgs::argv[2] }.ToLong(&connectPort))
+            return false;
+
+         wxLog::EnableLogging(false);
+
+         // Find the Lisp files of the Nyquist runtime as the application does
+         FileNames::InitializePathList();
+         NyquistEffectsModule{}.Initialize();
+
+         NyquistJobHost host(connectPort);
+         while (host.Serve()) { }
+         //...and terminate
+         return false;
+      }
+      return true;
+   }
+
+   void OnExit() override
+   {
+   }
+};
+IMPLEMENT_DYNAMIC_CLASS(NyquistJobHostModule, wxModule);
@@ -0,0 +1,105 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file NyquistJobs.h
+
+  @brief Evaluates Nyquist programs for several tracks at once, in helper
+  processes
+
+**********************************************************************/
+#ifndef __AUDACITY_NYQUIST_JOBS__
+#define __AUDACITY_NYQUIST_JOBS__
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+//! Input for one evaluation of a Nyquist program, for one track
+struct NyquistJob {
+   //! UTF-8 expression for nyx_eval_expression
+   std::string command;
+   //! Lisp variable bound to the input sound
+   std::string audioName;
+   double rate{};
+   //! Frames in each channel
+   int64_t length{};
+   std::vector<std::vector<float>> channels;
+};
+
+//! What a helper process made of a NyquistJob
+struct NyquistJobResult {
+   //! Whether `channels` holds the sound that the program returned
+   /*!
+    False if the program returned anything else or failed, or the helper
+    process died.  The job should then be evaluated again in this process,
+    which can handle every kind of result and report errors.
+    */
+   bool audio{ false };
+   //! What the interpreter printed
+   std::string output;
+   std::vector<std::vector<float>> channels;
+};
+
+//! Helper processes, each running a separate instance of the Nyquist
+//! interpreter, which has global state, on one job at a time
+/*!
+ The helpers are further instances of the application, started with a
+ special argument, like the plug-in validation host.  Jobs and results are
+ transferred over lib-ipc connections.
+
+ Jobs are identified by numbers that the caller chooses.  Results may arrive
+ in any order.
+ */
+class NyquistJobPool final
+{
+public:
+   //! How long a helper may take to connect, before it is given up
+   static constexpr std::chrono::seconds ConnectTimeout{ 10 };
+
+   //! Helpers to start, by default:  one for each core
+   static size_t DefaultSize();
+
+   //! Returns true if the current process is a helper process
+   static bool IsJobProcess();
+
+   //! Starts up to `nProcesses` helpers; some may fail to start
+   explicit NyquistJobPool(size_t nProcesses);
+   //! Stops all helpers, abandoning unfinished jobs
+   ~NyquistJobPool();
+
+   //! Whether any helper is still usable
+   bool IsAlive() const;
+   //! Whether some helper has no job
+   bool CanSubmit() const;
+
+   //! Give the job to a helper without a job
+   /*! @return false if there was none */
+   bool Submit(size_t id, const NyquistJob &job);
+
+   struct Completed {
+      size_t id;
+      NyquistJobResult result;
+   };
+   //! Waits at most `timeout` for any job to complete
+   std::optional<Completed> WaitNext(std::chrono::milliseconds timeout);
+
+private:
+   class Helper;
+   friend Helper;
+
+   //! Guards all state of the helpers, which the IPC threads update
+   mutable std::mutex mSync;
+   std::condition_variable mCondition;
+   std::vector<std::unique_ptr<Helper>> mHelpers;
+   std::deque<Completed> mCompleted;
+};
+
+#endif
@@ -22,6 +22,7 @@ other settings.
 
 *//********************************************************************/
 #include "DevicePrefs.h"
+#include "AudioIO.h"
 #include "AudioIOBase.h"
 
 #include "IteratorX.h"
@@ -313,6 +314,8 @@ void DevicePrefs::PopulateOrExchange(ShuttleGui & S)
          S.AddUnits(XO("milliseconds"));
       }
       S.EndThreeColumn();
+      S.TieCheckBox(XXO("&Adapt buffering to the load"),
+         AudioIOAdaptiveBuffering);
    }
    S.EndStatic();
 
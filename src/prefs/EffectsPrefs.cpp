@@ -93,6 +93,11 @@ BoolSetting SkipEffectsScanAtStartup {
    false
 };
 
+BoolSetting NyquistHelperProcesses {
+   wxT("/Effects/NyquistHelperProcesses"),
+   false
+};
+
 ChoiceSetting EffectsGroupBy{
    wxT("/Effects/GroupBy"),
    EffectsGroupSymbols,
@@ -120,6 +125,13 @@ void EffectsPrefs::PopulateOrExchange(ShuttleGui & S)
           .TieChoice( XXO("Realtime effect o&rganization:"), RealtimeEffectsGroupBy);
       }
       S.TieCheckBox(XXO("&Skip effects scanning at startup"), SkipEffectsScanAtStartup);
+#if USE_NYQUIST
+      S.TieCheckBox(
+         /* i18n-hint: *SCRATCH* is a variable of the Nyquist language; don't
+            translate it */
+         XXO("Run &Nyquist effects on several tracks in parallel (not those using *SCRATCH*)"),
+         NyquistHelperProcesses);
+#endif
       S.EndMultiColumn();
    }
    S.EndStatic();
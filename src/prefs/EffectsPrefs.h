@@ -39,6 +39,7 @@ class EffectsPrefs final : public PrefsPanel
 };
 
 AUDACITY_DLL_API extern BoolSetting   SkipEffectsScanAtStartup;
+AUDACITY_DLL_API extern BoolSetting   NyquistHelperProcesses;
 AUDACITY_DLL_API extern ChoiceSetting EffectsGroupBy;
 AUDACITY_DLL_API extern ChoiceSetting RealtimeEffectsGroupBy;
 #endif
@@ -64,10 +64,19 @@ struct MinMaxSumsq
 bool GetWaveDisplay(const Sequence &sequence,
    float *min, float *max, float *rms,
    size_t len, const sampleCount *where)
+{
+   return GetWaveDisplay(sequence.GetBlockArray(),
+      sequence.GetNumSamples(), sequence.GetMaxBlockSize(),
+      min, max, rms, len, where);
+}
+
+bool GetWaveDisplay(const BlockArray &blocks,
+   sampleCount numSamples, size_t maxBlockSize,
+   float *min, float *max, float *rms,
+   size_t len, const sampleCount *where)
 {
    wxASSERT(len > 0);
    const auto s0 = std::max(sampleCount(0), where[0]);
-   const auto numSamples = sequence.GetNumSamples();
    if (s0 >= numSamples)
       // None of the samples asked for are in range. Abandon.
       return false;
@@ -76,7 +85,7 @@ bool GetWaveDisplay(const Sequence &sequence,
    // so we load at least one pixel for column len - 1
    // ... unless the mNumSamples ceiling applies, and then there are other defenses
    const auto s1 = std::clamp(where[len], 1 + where[len - 1], numSamples);
-   const auto maxSamples = sequence.GetMaxBlockSize();
+   const auto maxSamples = maxBlockSize;
    Floats temp{ maxSamples };
 
    decltype(len) pixel = 0;
@@ -89,9 +98,8 @@ bool GetWaveDisplay(const Sequence &sequence,
    decltype(whereNow) whereNext = 0;
    // Loop over block files, opening and reading and closing each
    // not more than once
-   const auto &blocks = sequence.GetBlockArray();
    unsigned nBlocks = blocks.size();
-   const unsigned int block0 = sequence.FindBlock(s0);
+   const unsigned int block0 = blocks.FindBlock(s0);
    for (unsigned int b = block0; b < nBlocks; ++b) {
       if (b > block0)
          srcX = nextSrcX;
@@ -168,7 +176,7 @@ bool GetWaveDisplay(const Sequence &sequence,
       case 1:
          // Read samples
          // no-throw for display operations!
-         sequence.Read(
+         Sequence::Read(
             (samplePtr)temp.get(), floatSample, seqBlock, startPosition, num, false);
          break;
       case 256:
@@ -12,6 +12,7 @@
 #define __AUDACITY_GET_WAVE_DISPLAY__
 
 #include <cstddef>
+class BlockArray;
 class Sequence;
 class sampleCount;
 
@@ -25,4 +26,14 @@ bool GetWaveDisplay(const Sequence &sequence,
    float *min, float *max, float *rms,
    size_t len, const sampleCount *where);
 
+//! Same, but reading a copy of the blocks of a Sequence
+/*!
+ Copying a BlockArray is cheap and the copy does not change, so it can be
+ taken on the main thread and read on another.
+ */
+bool GetWaveDisplay(const BlockArray &blocks,
+   sampleCount numSamples, size_t maxBlockSize,
+   float *min, float *max, float *rms,
+   size_t len, const sampleCount *where);
+
 #endif
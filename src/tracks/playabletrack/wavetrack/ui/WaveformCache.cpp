@@ -10,7 +10,19 @@
 
 #include "WaveformCache.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
 #include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include "BasicUI.h"
+#include "Project.h"
+#include "ProjectFileIO.h"
+#include "SampleBlock.h"
 #include "Sequence.h"
 #include "GetWaveDisplay.h"
 #include "WaveClipUIUtilities.h"
@@ -40,6 +52,7 @@ public:
       , min(len)
       , max(len)
       , rms(len)
+      , pending(len)
    {
    }
 
@@ -56,6 +69,330 @@ public:
    std::vector<float> min;
    std::vector<float> max;
    std::vector<float> rms;
+
+   //! Which columns hold only approximations
+   std::vector<bool> pending;
+   //! Not null while the worker thread computes exact columns for this
+   std::shared_ptr<int> request;
+   //! Earlier contents, at other positions or zoom levels, kept only to
+   //! approximate missing columns
+   std::unique_ptr<WaveCache> previous;
+};
+
+namespace {
+
+//! How many earlier contents of the cache to keep for approximations
+constexpr size_t MaxLevels = 4;
+
+//! Combines min, max, and rms values of several columns
+struct ColumnSum
+{
+   void Add(float theMin, float theMax, float theRms)
+   {
+      min = std::min(min, theMin);
+      max = std::max(max, theMax);
+      sumsq += theRms * theRms;
+      ++count;
+   }
+
+   void Store(float &theMin, float &theMax, float &theRms) const
+   {
+      if (count == 0)
+         theMin = theMax = theRms = 0;
+      else {
+         theMin = min;
+         theMax = max;
+         theRms = sqrt(sumsq / count);
+      }
+   }
+
+   float min{ FLT_MAX };
+   float max{ -FLT_MAX };
+   double sumsq{ 0 };
+   size_t count{ 0 };
+};
+
+//! Combine the exact columns of an earlier cache that cover samples
+//! [s0, s1), if there are such
+bool SumLevel(const WaveCache &level, sampleCount s0, sampleCount s1,
+   ColumnSum &sum)
+{
+   const auto &where = level.where;
+   const auto len = level.len;
+   if (len == 0 || where[0] > s0 || where[len] < s1)
+      return false;
+   // The last column starting not after s0
+   auto j = static_cast<size_t>(
+      std::upper_bound(where.begin(), where.begin() + len, s0)
+         - where.begin() - 1);
+   ColumnSum result;
+   for (; j < len && where[j] < s1; ++j) {
+      if (level.pending[j])
+         return false;
+      result.Add(level.min[j], level.max[j], level.rms[j]);
+   }
+   sum = result;
+   return true;
+}
+
+//! Combine the summaries of whole blocks overlapping samples [s0, s1)
+/*! These are in memory, so no database access is needed */
+void SumBlocks(const BlockArray &blocks, sampleCount numSamples,
+   sampleCount s0, sampleCount s1, ColumnSum &sum)
+{
+   s0 = std::max(sampleCount{ 0 }, s0);
+   if (s0 >= numSamples)
+      return;
+   for (auto b = blocks.FindBlock(s0), nBlocks = blocks.size();
+      b < nBlocks; ++b
+   ) {
+      const auto seqBlock = blocks[b];
+      if (seqBlock.start >= s1)
+         break;
+      if (seqBlock.sb) {
+         const auto values = seqBlock.sb->GetMinMaxRMS(false);
+         sum.Add(values.min, values.max, values.RMS);
+      }
+   }
+}
+
+//! Fill columns [first, last) quickly, with the finest earlier contents of
+//! the cache that cover them, else with block summaries; mark them pending
+void Approximate(WaveCache &cache, int dirty,
+   const BlockArray &blocks, sampleCount numSamples, size_t first, size_t last)
+{
+   for (auto i = first; i < last; ++i) {
+      const auto s0 = cache.where[i];
+      const auto s1 = std::max(cache.where[i + 1], s0 + 1);
+      ColumnSum sum;
+      auto bestSamplesPerPixel = std::numeric_limits<double>::infinity();
+      for (auto level = cache.previous.get(); level;
+         level = level->previous.get()
+      ) {
+         if (level->dirty == dirty &&
+             level->samplesPerPixel < bestSamplesPerPixel &&
+             SumLevel(*level, s0, s1, sum))
+            bestSamplesPerPixel = level->samplesPerPixel;
+      }
+      if (std::isinf(bestSamplesPerPixel))
+         SumBlocks(blocks, numSamples, s0, s1, sum);
+      sum.Store(cache.min[i], cache.max[i], cache.rms[i]);
+      // Columns after the end of the sequence have nothing better
+      cache.pending[i] = (s0 < numSamples);
+   }
+}
+
+//! Exact columns to compute for a cache, and then the results
+struct ColumnJob
+{
+   const WaveClipWaveformCache *owner{};
+   //! Expires when the cache no longer wants the results
+   std::weak_ptr<int> token;
+   //! Valid only on the main thread, while token is unexpired
+   WaveCache *cache{};
+   size_t first{};
+   std::vector<sampleCount> where;
+   //! Snapshot of the sequence.  The job must be destroyed on the main
+   //! thread, in case it holds the last references to blocks.
+   BlockArray blocks;
+   sampleCount numSamples;
+   size_t maxBlockSize{};
+   WaveClipWaveformCache::ColumnsReady onReady;
+
+   std::vector<float> min, max, rms;
+   bool done{ false };
+   //! Reading failed; don't ask again for the same columns
+   bool failed{ false };
+};
+using ColumnJobPtr = std::shared_ptr<ColumnJob>;
+
+//! Copy results into the cache, if it still wants them; on the main thread
+void Deliver(ColumnJob &job)
+{
+   const auto token = job.token.lock();
+   if (!token)
+      // The cache was replaced or destroyed meanwhile
+      return;
+   auto &cache = *job.cache;
+   cache.request.reset();
+   const auto first = job.first;
+   const auto last = first + job.where.size() - 1;
+   if (job.failed) {
+      // Keep the approximations, rather than submit the same job at every
+      // repaint
+      std::fill(cache.pending.begin() + first, cache.pending.begin() + last,
+         false);
+      return;
+   }
+   if (!job.done)
+      // Cancelled; the next repaint asks again
+      return;
+   std::copy(job.min.begin(), job.min.end(), cache.min.begin() + first);
+   std::copy(job.max.begin(), job.max.end(), cache.max.begin() + first);
+   std::copy(job.rms.begin(), job.rms.end(), cache.rms.begin() + first);
+   std::fill(cache.pending.begin() + first, cache.pending.begin() + last,
+      false);
+   if (job.onReady)
+      job.onReady(first, last);
+}
+
+//! One thread that reads block summaries for all caches, so that drawing
+//! never waits for the database
+class ColumnWorker
+{
+public:
+   static ColumnWorker &Get()
+   {
+      static ColumnWorker instance;
+      return instance;
+   }
+
+   ~ColumnWorker()
+   {
+      {
+         std::lock_guard lock{ mMutex };
+         mStop = true;
+      }
+      mCondition.notify_all();
+      if (mThread.joinable())
+         mThread.join();
+   }
+
+   void Submit(ColumnJobPtr pJob)
+   {
+      {
+         std::lock_guard lock{ mMutex };
+         mJobs.push_back(move(pJob));
+         if (!mThread.joinable())
+            mThread = std::thread{ [this]{ Run(); } };
+      }
+      mCondition.notify_all();
+   }
+
+   //! Discard queued jobs for the owner, and wait for any it has running
+   void Cancel(const WaveClipWaveformCache *owner)
+   {
+      std::unique_lock lock{ mMutex };
+      std::deque<ColumnJobPtr> cancelled, kept;
+      for (auto &pJob : mJobs)
+         (pJob->owner == owner ? cancelled : kept).push_back(move(pJob));
+      mJobs.swap(kept);
+      mCondition.wait(lock, [&]{ return mBusyOwner != owner; });
+      lock.unlock();
+      // Now cancelled jobs are delivered empty, outside the lock
+      for (auto &pJob : cancelled)
+         Deliver(*pJob);
+   }
+
+   //! Discard all queued jobs, wait for any running, and start no more
+   //! until Resume(); on the main thread
+   /*! A database connection that the worker uses may close meanwhile */
+   void Suspend()
+   {
+      std::unique_lock lock{ mMutex };
+      ++mSuspended;
+      std::deque<ColumnJobPtr> cancelled;
+      cancelled.swap(mJobs);
+      mCondition.wait(lock, [this]{ return !mBusy; });
+      lock.unlock();
+      for (auto &pJob : cancelled)
+         Deliver(*pJob);
+   }
+
+   void Resume()
+   {
+      {
+         std::lock_guard lock{ mMutex };
+         assert(mSuspended > 0);
+         --mSuspended;
+      }
+      mCondition.notify_all();
+   }
+
+private:
+   void Run()
+   {
+      while (true) {
+         ColumnJobPtr pJob;
+         {
+            std::unique_lock lock{ mMutex };
+            mCondition.wait(lock, [this]{
+               return mStop || (mSuspended == 0 && !mJobs.empty()); });
+            if (mStop)
+               return;
+            pJob = move(mJobs.front());
+            mJobs.pop_front();
+            mBusyOwner = pJob->owner;
+            mBusy = true;
+         }
+         auto &job = *pJob;
+         // Skip work for caches that were replaced since
+         if (!job.token.expired()) {
+            const auto len = job.where.size() - 1;
+            job.min.resize(len);
+            job.max.resize(len);
+            job.rms.resize(len);
+            try {
+               job.done = ::GetWaveDisplay(job.blocks,
+                  job.numSamples, job.maxBlockSize,
+                  job.min.data(), job.max.data(), job.rms.data(),
+                  len, job.where.data());
+            }
+            catch (...) {
+               // Such as for a missing database connection; nothing to show
+               // the user from this thread
+            }
+            job.failed = !job.done;
+         }
+         // Give up this thread's reference to the job
+         BasicUI::CallAfter([pJob = move(pJob)]{ Deliver(*pJob); });
+         {
+            std::lock_guard lock{ mMutex };
+            mBusyOwner = nullptr;
+            mBusy = false;
+         }
+         mCondition.notify_all();
+      }
+   }
+
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   std::deque<ColumnJobPtr> mJobs;
+   const WaveClipWaveformCache *mBusyOwner{};
+   bool mBusy{ false };
+   size_t mSuspended{ 0 };
+   bool mStop{ false };
+   std::thread mThread;
+};
+
+}
+
+//! Keeps the worker away from a project's database while its connection is
+//! closed or replaced, as by Save As or Compact, which finalizes the
+//! statements that the worker prepared
+struct ColumnWorkerSuspender final : ClientData::Base
+{
+   explicit ColumnWorkerSuspender(AudacityProject &project)
+      : mSubscription{ ProjectFileIO::Get(project)
+         .Subscribe([](ProjectFileIOMessage message){
+            switch (message) {
+            case ProjectFileIOMessage::ConnectionChanging:
+               return ColumnWorker::Get().Suspend();
+            case ProjectFileIOMessage::ConnectionChanged:
+               return ColumnWorker::Get().Resume();
+            default:
+               return;
+            }
+         }) }
+   {}
+
+   Observer::Subscription mSubscription;
+};
+
+static const AudacityProject::AttachedObjects::RegisteredFactory sSuspenderKey{
+   [](AudacityProject &project) {
+      return std::make_shared<ColumnWorkerSuspender>(project);
+   }
 };
 
 //
@@ -65,13 +402,15 @@ public:
 
 bool WaveClipWaveformCache::GetWaveDisplay(
    const WaveChannelInterval &clip, WaveDisplay &display,
-   double t0, double pixelsPerSecond)
+   double t0, double pixelsPerSecond, const ColumnsReady &onReady)
 {
    auto &waveCache = mWaveCaches[clip.GetChannelIndex()];
 
    t0 += clip.GetTrimLeft();
 
    const bool allocated = (display.where != 0);
+   // Whether missing columns may be approximated now and made exact later
+   const bool deferred = !allocated && onReady;
 
    const size_t numPixels = (int)display.width;
 
@@ -111,6 +450,10 @@ bool WaveClipWaveformCache::GetWaveDisplay(
          waveCache->len >= numPixels) {
 
          // Satisfy the request completely from the cache
+         if (deferred && !waveCache->request)
+            // Exact values may have been abandoned, if the cache moved
+            // between clips
+            RequestColumns(clip, *waveCache, onReady);
          display.min = &waveCache->min[0];
          display.max = &waveCache->max[0];
          display.rms = &waveCache->rms[0];
@@ -135,8 +478,6 @@ bool WaveClipWaveformCache::GetWaveDisplay(
             (int)oldCache->len - oldX0
          ));
       }
-      if (!(copyEnd > copyBegin))
-         oldCache.reset(0);
 
       waveCache = std::make_unique<WaveCache>(
          numPixels, samplesPerPixel, sampleRate, t0, mDirty);
@@ -158,7 +499,7 @@ bool WaveClipWaveformCache::GetWaveDisplay(
       // with the current one, re-use as much of the cache as
       // possible
 
-      if (oldCache) {
+      if (copyEnd > copyBegin) {
 
          // Copy what we can from the old cache.
          const int length = copyEnd - copyBegin;
@@ -167,6 +508,24 @@ bool WaveClipWaveformCache::GetWaveDisplay(
          memcpy(&min[copyBegin], &oldCache->min[srcIdx], sizeFloats);
          memcpy(&max[copyBegin], &oldCache->max[srcIdx], sizeFloats);
          memcpy(&rms[copyBegin], &oldCache->rms[srcIdx], sizeFloats);
+         std::copy(oldCache->pending.begin() + srcIdx,
+            oldCache->pending.begin() + srcIdx + length,
+            waveCache->pending.begin() + copyBegin);
+      }
+
+      if (deferred &&
+          oldCache && oldCache->len > 0 && oldCache->dirty == mDirty) {
+         // Keep the old contents for approximations, with a few before them
+         // that are still valid
+         oldCache->request.reset();
+         waveCache->previous = std::move(oldCache);
+         auto pLevel = waveCache.get();
+         for (size_t nLevels = 0; pLevel->previous; ++nLevels) {
+            if (nLevels == MaxLevels || pLevel->previous->dirty != mDirty)
+               pLevel->previous.reset();
+            else
+               pLevel = pLevel->previous.get();
+         }
       }
    }
 
@@ -236,6 +595,8 @@ bool WaveClipWaveformCache::GetWaveDisplay(
                min[i] = theMin;
                max[i] = theMax;
                rms[i] = (float)sqrt(sumsq / len);
+               if (!allocated)
+                  waveCache->pending[i] = false;
 
                didUpdate=true;
             }
@@ -249,14 +610,28 @@ bool WaveClipWaveformCache::GetWaveDisplay(
       // Done with append buffer, now fetch the rest of the cache miss
       // from the sequence
       if (p1 > p0) {
-         if (!::GetWaveDisplay(sequence, &min[p0], &max[p0], &rms[p0], p1 - p0,
-            &where[p0]))
+         if (deferred) {
+            if (std::max(sampleCount{ 0 }, where[p0]) >= numSamples)
+               // None of the samples asked for are in range. Abandon.
+               return false;
+            // Don't wait for the database; fill in exact values later
+            Approximate(*waveCache, mDirty,
+               sequence.GetBlockArray(), numSamples, p0, p1);
+         }
+         else if (!::GetWaveDisplay(sequence, &min[p0], &max[p0], &rms[p0],
+            p1 - p0, &where[p0]))
          {
             return false;
          }
+         else if (!allocated)
+            std::fill(waveCache->pending.begin() + p0,
+               waveCache->pending.begin() + p1, false);
       }
    }
 
+   if (deferred && !waveCache->request)
+      RequestColumns(clip, *waveCache, onReady);
+
    if (!allocated) {
       // Now report the results
       display.min = min;
@@ -277,6 +652,39 @@ WaveClipWaveformCache::WaveClipWaveformCache(size_t nChannels)
 
 WaveClipWaveformCache::~WaveClipWaveformCache()
 {
+   // The worker thread must not still read blocks when the project closes
+   if (mRequested)
+      ColumnWorker::Get().Cancel(this);
+}
+
+void WaveClipWaveformCache::RequestColumns(const WaveChannelInterval &clip,
+   WaveCache &cache, const ColumnsReady &onReady)
+{
+   size_t first = cache.len, last = 0;
+   for (size_t i = 0; i < cache.len; ++i)
+      if (cache.pending[i]) {
+         first = std::min(first, i);
+         last = i + 1;
+      }
+   if (first >= last)
+      return;
+
+   const auto &sequence = clip.GetSequence();
+   cache.request = std::make_shared<int>();
+   auto pJob = std::make_shared<ColumnJob>();
+   auto &job = *pJob;
+   job.owner = this;
+   job.token = cache.request;
+   job.cache = &cache;
+   job.first = first;
+   job.where.assign(
+      cache.where.begin() + first, cache.where.begin() + last + 1);
+   job.blocks = sequence.GetBlockArray();
+   job.numSamples = sequence.GetNumSamples();
+   job.maxBlockSize = sequence.GetMaxBlockSize();
+   job.onReady = onReady;
+   ColumnWorker::Get().Submit(move(pJob));
+   mRequested = true;
 }
 
 std::unique_ptr<WaveClipListener> WaveClipWaveformCache::Clone() const
@@ -313,6 +721,9 @@ void WaveClipWaveformCache::MakeStereo(WaveClipListener &&other, bool)
    auto pOther = dynamic_cast<WaveClipWaveformCache *>(&other);
    assert(pOther); // precondition
    mWaveCaches.push_back(move(pOther->mWaveCaches[0]));
+   // The other's results, if any are due, won't arrive here
+   if (const auto &pCache = mWaveCaches.back())
+      pCache->request.reset();
 }
 
 void WaveClipWaveformCache::SwapChannels()
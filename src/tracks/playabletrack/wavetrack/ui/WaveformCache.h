@@ -12,6 +12,7 @@
 #define __AUDACITY_WAVEFORM_CACHE__
 
 #include "WaveClip.h"
+#include <functional>
 using WaveChannelInterval = WaveClipChannel;
 
 class WaveCache;
@@ -77,13 +78,34 @@ struct WaveClipWaveformCache final : WaveClipListener
    ///Delete the wave cache - force redraw.  Thread-safe
    void Clear();
 
+   //! Called on the main thread, when exact values have replaced
+   //! approximate ones in columns [first, last) of a display
+   using ColumnsReady = std::function<void(size_t first, size_t last)>;
+
    /** Getting high-level data for screen display */
+   /*!
+    If `onReady` is not null, and display is not allocated, then columns
+    missing from the cache are filled at once with approximations, from the
+    cache's earlier contents at other zoom levels or from summaries of whole
+    blocks.  Exact values are then computed on a worker thread, and `onReady`
+    is called when they are in the cache.  Otherwise all columns are exact on
+    return.
+    */
    bool GetWaveDisplay(const WaveChannelInterval &clip,
-      WaveDisplay &display, double t0, double pixelsPerSecond);
+      WaveDisplay &display, double t0, double pixelsPerSecond,
+      const ColumnsReady &onReady = {});
 
    void MakeStereo(WaveClipListener &&other, bool aligned) override;
    void SwapChannels() override;
    void Erase(size_t index) override;
+
+private:
+   //! Start computing exact values for the approximate columns of the cache
+   void RequestColumns(const WaveChannelInterval &clip, WaveCache &cache,
+      const ColumnsReady &onReady);
+
+   //! Whether any job for the worker thread was made
+   bool mRequested{ false };
 };
 
 #endif
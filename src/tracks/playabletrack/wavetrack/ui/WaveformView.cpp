@@ -30,6 +30,7 @@ Paul Licameli split from WaveChannelView.cpp
 #include "SyncLock.h"
 #include "../../../../TrackArt.h"
 #include "../../../../TrackArtist.h"
+#include "../../../../TrackPanel.h"
 #include "../../../../TrackPanelDrawingContext.h"
 #include "../../../../TrackPanelMouseEvent.h"
 #include "ViewInfo.h"
@@ -43,6 +44,7 @@ Paul Licameli split from WaveChannelView.cpp
 #include "FrameStatistics.h"
 
 #include <wx/graphics.h>
+#include <wx/weakref.h>
 #include <wx/dc.h>
 
 static WaveChannelSubView::Type sType{
@@ -766,8 +768,25 @@ void DrawClipWaveform(TrackPanelDrawingContext &context,
          // fisheye moves over the background, there is then less to do when
          // redrawing.
 
+         // Columns missing from the cache are approximated, and repainted
+         // when exact values are ready.  The track may have moved or been
+         // resized or scrolled by then, so find where it is at that time,
+         // and repaint all of it.
+         WaveClipWaveformCache::ColumnsReady onReady;
+         if (artist->parent)
+            onReady = [
+               pPanel = wxWeakRef<TrackPanel>{ artist->parent },
+               wTrack = channel.GetTrack().weak_from_this()
+            ](size_t, size_t){
+               const auto pTrack = wTrack.lock();
+               if (!pPanel || !pTrack)
+                  return;
+               const auto trackRect = pPanel->FindTrackRect(pTrack.get());
+               if (!trackRect.IsEmpty())
+                  pPanel->RefreshBackingRect(trackRect);
+            };
          if (!clipCache.GetWaveDisplay(clip,
-            display, t0, averagePixelsPerSecond))
+            display, t0, averagePixelsPerSecond, onReady))
             return;
       }
    }
@@ -1375,8 +1375,7 @@ void SelectHandle::StartSnappingFreqSelection(SpectrumAnalyst &analyst,
       wc.TimeToLongSamples(viewInfo.selectedRegion.t1());
    const auto length =
       std::min(frequencySnappingData.max_size(),
-         limitSampleBufferSize(10485760, // as in FreqWindow.cpp
-            end - start));
+         limitSampleBufferSize(10485760, end - start));
    const auto effectiveLength = std::max(minLength, length);
    frequencySnappingData.resize(effectiveLength, 0.0f);
    wc.GetFloats(
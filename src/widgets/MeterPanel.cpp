@@ -61,6 +61,7 @@
 #include "ImageManipulation.h"
 #include "Decibels.h"
 #include "LinearUpdater.h"
+#include "MeterStats.h"
 #include "Project.h"
 #include "ProjectAudioIO.h"
 #include "ProjectStatus.h"
@@ -957,36 +958,34 @@ static float ToDB(float v, float range)
 void MeterPanel::UpdateDisplay(
    unsigned numChannels, int numFrames, const float *sampleData)
 {
-   auto sptr = sampleData;
+   MeterStats stats[kMaxMeterBars];
+   const auto num = std::min(numChannels, mNumBars);
+   ComputeMeterStats(sampleData, numChannels, std::max(numFrames, 0),
+      num, stats, MAX_AUDIO);
+   UpdateDisplay(num, numFrames, sampleData, stats);
+}
+
+void MeterPanel::UpdateDisplay(unsigned numChannels, int numFrames,
+   const float *, const MeterStats *stats)
+{
    auto num = std::min(numChannels, mNumBars);
    MeterUpdateMsg msg;
 
    memset(&msg, 0, sizeof(msg));
    msg.numFrames = numFrames;
 
-   for(int i=0; i<numFrames; i++) {
-      for(unsigned int j=0; j<num; j++) {
-         msg.peak[j] = floatMax(msg.peak[j], fabs(sptr[j]));
-         msg.rms[j] += sptr[j]*sptr[j];
-
-         // In addition to looking for mNumPeakSamplesToClip peaked
-         // samples in a row, also send the number of peaked samples
-         // at the head and tail, in case there's a run of peaked samples
-         // that crosses block boundaries
-         if (fabs(sptr[j])>=MAX_AUDIO) {
-            if (msg.headPeakCount[j]==i)
-               msg.headPeakCount[j]++;
-            msg.tailPeakCount[j]++;
-            if (msg.tailPeakCount[j] > mNumPeakSamplesToClip)
-               msg.clipping[j] = true;
-         }
-         else
-            msg.tailPeakCount[j] = 0;
-      }
-      sptr += numChannels;
+   for(unsigned int j=0; j<num; j++) {
+      msg.peak[j] = stats[j].peak;
+      msg.rms[j] = stats[j].rms;
+      // In addition to looking for mNumPeakSamplesToClip peaked
+      // samples in a row, also send the number of peaked samples
+      // at the head and tail, in case there's a run of peaked samples
+      // that crosses block boundaries
+      msg.headPeakCount[j] = stats[j].headPeakCount;
+      msg.tailPeakCount[j] = stats[j].tailPeakCount;
+      msg.clipping[j] =
+         stats[j].longestPeakRun > size_t(mNumPeakSamplesToClip);
    }
-   for(unsigned int j=0; j<mNumBars; j++)
-      msg.rms[j] = sqrt(msg.rms[j]/numFrames);
 
    mQueue.Put(msg);
 }
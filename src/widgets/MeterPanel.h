@@ -164,6 +164,9 @@ class AUDACITY_DLL_API MeterPanel final
     */
    void UpdateDisplay(unsigned numChannels,
                       int numFrames, const float *sampleData) override;
+   //! Uses statistics already computed by MeterThread
+   void UpdateDisplay(unsigned numChannels, int numFrames,
+      const float *sampleData, const MeterStats *stats) override;
 
    // Vaughan, 2010-11-29: This not currently used. See comments in MixerTrackCluster::UpdateMeter().
    //void UpdateDisplay(int numChannels, int numFrames,
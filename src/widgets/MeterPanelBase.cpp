@@ -41,6 +41,12 @@ struct MeterPanelBase::Forwarder : Meter
       if (mOwner)
          mOwner->UpdateDisplay( numChannels, numFrames, sampleData );
    }
+   void UpdateDisplay(unsigned numChannels, unsigned long numFrames,
+      const float *sampleData, const MeterStats *stats) override
+   {
+      if (mOwner)
+         mOwner->UpdateDisplay( numChannels, numFrames, sampleData, stats );
+   }
    bool IsMeterDisabled() const override
    {
       if (mOwner)
@@ -86,3 +92,9 @@ std::shared_ptr<Meter> MeterPanelBase::GetMeter() const
 {
    return mForwarder;
 }
+
+void MeterPanelBase::UpdateDisplay(unsigned numChannels,
+   int numFrames, const float *sampleData, const MeterStats *)
+{
+   UpdateDisplay(numChannels, numFrames, sampleData);
+}
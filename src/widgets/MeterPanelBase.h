@@ -15,6 +15,7 @@ Paul Licameli split from MeterPanel.h
 #include "wxPanelWrapper.h"
 
 class Meter;
+struct MeterStats;
 
 //! Inherits wxPanel and has a Meter; exposes shared_ptr to the Meter.
 /*! Derived classes supply implementations of its pure virtual functions,
@@ -40,6 +41,9 @@ public:
    virtual void Reset(double sampleRate, bool resetClipping) = 0;
    virtual void UpdateDisplay(unsigned numChannels,
                       int numFrames, const float *sampleData) = 0;
+   //! The default ignores the statistics
+   virtual void UpdateDisplay(unsigned numChannels,
+      int numFrames, const float *sampleData, const MeterStats *stats);
    virtual bool IsMeterDisabled() const = 0;
    virtual float GetMaxPeak() const = 0;
    virtual bool IsClipping() const = 0;